@@ -5,6 +5,7 @@
 #include "EmBankMapped.h"
 #include "EmCPU68K.h"
 #include "EmCommon.h"
+#include "EmMemory.h"
 #include "MetaMemory.h"
 
 namespace {
@@ -16,7 +17,7 @@ namespace {
         uint16* stub;
     };
 
-    map<emuptr, RegisteredCallback> registeredCallbacks;
+    thread_local map<emuptr, RegisteredCallback> registeredCallbacks;
 }  // namespace
 
 void CallbackManager::Clear() {
@@ -1,5 +1,7 @@
 #include "Debugger.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 
 #include "DebuggerMemoryBinding.h"
@@ -17,8 +19,7 @@ namespace {
     }
 }  // namespace
 
-Debugger gDebugger;
-void* gDebuggerPtr = &gDebugger;
+thread_local Debugger gDebugger;
 
 Debugger::BreakState Debugger::GetBreakState() const { return breakState; }
 
@@ -35,6 +36,10 @@ void Debugger::Reset() {
     breakpoints.clear();
     watchpointsRead.clear();
     watchpointsWrite.clear();
+
+    breakpointFilter.Clear();
+    watchpointReadFilter.Clear();
+    watchpointWriteFilter.Clear();
 }
 
 void Debugger::Enable() {
@@ -65,6 +70,7 @@ uint32 Debugger::GetAppSize() const { return appSize; }
 
 void Debugger::NotificyPc(emuptr pc) {
     if (!enabled) return;
+    if (!stepping && !breakpointFilter.MayContain(pc, pc)) return;
     if (breakMode == BreakMode::appOnly && (pc < appStart || pc >= appStart + appSize)) return;
     if (breakMode == BreakMode::ramOnly && pc >= romStart && pc < romStart + romSize) return;
 
@@ -80,7 +86,7 @@ void Debugger::NotificyPc(emuptr pc) {
 void Debugger::NotifyMemoryRead8(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsRead, address)) {
+    if (CheckWatchpoints(watchpointsRead, watchpointReadFilter, address, address)) {
         Break(BreakState::trapRead);
 
         watchpointAddress = address;
@@ -90,7 +96,7 @@ void Debugger::NotifyMemoryRead8(emuptr address) {
 void Debugger::NotifyMemoryRead16(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsRead, address) || setContains(watchpointsRead, address + 1)) {
+    if (CheckWatchpoints(watchpointsRead, watchpointReadFilter, address, address + 1)) {
         Break(BreakState::trapRead);
 
         watchpointAddress = address;
@@ -100,8 +106,7 @@ void Debugger::NotifyMemoryRead16(emuptr address) {
 void Debugger::NotifyMemoryRead32(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsRead, address) || setContains(watchpointsRead, address + 1) ||
-        setContains(watchpointsRead, address + 2) || setContains(watchpointsRead, address + 3)) {
+    if (CheckWatchpoints(watchpointsRead, watchpointReadFilter, address, address + 3)) {
         Break(BreakState::trapRead);
 
         watchpointAddress = address;
@@ -111,7 +116,7 @@ void Debugger::NotifyMemoryRead32(emuptr address) {
 void Debugger::NotifyMemoryWrite8(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsWrite, address)) {
+    if (CheckWatchpoints(watchpointsWrite, watchpointWriteFilter, address, address)) {
         Break(BreakState::trapWrite);
 
         watchpointAddress = address;
@@ -121,7 +126,7 @@ void Debugger::NotifyMemoryWrite8(emuptr address) {
 void Debugger::NotifyMemoryWrite16(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsWrite, address) || setContains(watchpointsWrite, address + 1)) {
+    if (CheckWatchpoints(watchpointsWrite, watchpointWriteFilter, address, address + 1)) {
         Break(BreakState::trapWrite);
 
         watchpointAddress = address;
@@ -131,8 +136,7 @@ void Debugger::NotifyMemoryWrite16(emuptr address) {
 void Debugger::NotifyMemoryWrite32(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsWrite, address) || setContains(watchpointsWrite, address + 1) ||
-        setContains(watchpointsWrite, address + 2) || setContains(watchpointsWrite, address + 3)) {
+    if (CheckWatchpoints(watchpointsWrite, watchpointWriteFilter, address, address + 3)) {
         Break(BreakState::trapWrite);
 
         watchpointAddress = address;
@@ -148,46 +152,36 @@ void Debugger::NotifyTrap(uint16 trapWord) {
     }
 }
 
-void Debugger::SetBreakpoint(emuptr pc) { breakpoints.insert(pc); }
+void Debugger::SetBreakpoint(emuptr pc) {
+    breakpoints.insert(pc);
+    breakpointFilter.Add(pc, pc);
+}
 
-void Debugger::ClearBreakpoint(emuptr pc) { breakpoints.erase(pc); }
+void Debugger::ClearBreakpoint(emuptr pc) {
+    breakpoints.erase(pc);
+    RebuildBreakpointFilter();
+}
 
 void Debugger::SetWatchpoint(emuptr address, WatchpointType type, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        switch (type) {
-            case WatchpointType::read:
-                watchpointsRead.insert(address + i);
-                break;
-
-            case WatchpointType::write:
-                watchpointsWrite.insert(address + i);
-                break;
-
-            case WatchpointType::readwrite:
-                watchpointsRead.insert(address + i);
-                watchpointsWrite.insert(address + i);
-                break;
-        }
-    }
+    if (len == 0) return;
+    const emuptr last = address + len - 1;
+
+    if (type != WatchpointType::write)
+        AddWatchpointRange(watchpointsRead, watchpointReadFilter, address, last);
+
+    if (type != WatchpointType::read)
+        AddWatchpointRange(watchpointsWrite, watchpointWriteFilter, address, last);
 }
 
 void Debugger::ClearWatchpoint(emuptr address, WatchpointType type, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        switch (type) {
-            case WatchpointType::read:
-                watchpointsRead.erase(address + i);
-                break;
-
-            case WatchpointType::write:
-                watchpointsWrite.erase(address + i);
-                break;
-
-            case WatchpointType::readwrite:
-                watchpointsRead.erase(address + i);
-                watchpointsWrite.erase(address + i);
-                break;
-        }
-    }
+    if (len == 0) return;
+    const emuptr last = address + len - 1;
+
+    if (type != WatchpointType::write)
+        RemoveWatchpointRange(watchpointsRead, watchpointReadFilter, address, last);
+
+    if (type != WatchpointType::read)
+        RemoveWatchpointRange(watchpointsWrite, watchpointWriteFilter, address, last);
 }
 
 void Debugger::SetSyscallTrap(uint16 trapWord) { syscallTraps.insert(trapWord); }
@@ -199,9 +193,9 @@ void Debugger::ClearAllSyscallTraps() { syscallTraps.clear(); }
 const std::unordered_set<uint16> Debugger::GetSyscallTraps() const { return syscallTraps; }
 
 Debugger::WatchpointType Debugger::GetWatchpointType() const {
-    if (setContains(watchpointsRead, watchpointAddress))
-        return setContains(watchpointsWrite, watchpointAddress) ? WatchpointType::readwrite
-                                                                : WatchpointType::read;
+    if (RangesContain(watchpointsRead, watchpointAddress))
+        return RangesContain(watchpointsWrite, watchpointAddress) ? WatchpointType::readwrite
+                                                                  : WatchpointType::read;
 
     return WatchpointType::write;
 }
@@ -306,26 +300,98 @@ void Debugger::Break(BreakState state) {
     }
 }
 
+void Debugger::RebuildBreakpointFilter() {
+    breakpointFilter.Clear();
+
+    for (emuptr pc : breakpoints) breakpointFilter.Add(pc, pc);
+}
+
+bool Debugger::CheckWatchpoints(const vector<AddressRange>& ranges, const AddressFilter& filter,
+                                emuptr first, emuptr last) const {
+    if (!filter.MayContain(first, last)) return false;
+
+    for (const auto& range : ranges)
+        if (first <= range.last && last >= range.first) return true;
+
+    return false;
+}
+
+void Debugger::AddWatchpointRange(vector<AddressRange>& ranges, AddressFilter& filter,
+                                  emuptr first, emuptr last) {
+    ranges.push_back({first, last});
+    filter.Add(first, last);
+}
+
+void Debugger::RemoveWatchpointRange(vector<AddressRange>& ranges, AddressFilter& filter,
+                                     emuptr first, emuptr last) {
+    // Watchpoints are cleared bytewise, so partially covered ranges are trimmed or split
+    vector<AddressRange> remaining;
+
+    for (const auto& range : ranges) {
+        if (last < range.first || first > range.last) {
+            remaining.push_back(range);
+            continue;
+        }
+
+        if (range.first < first) remaining.push_back({range.first, first - 1});
+        if (range.last > last) remaining.push_back({last + 1, range.last});
+    }
+
+    ranges = std::move(remaining);
+
+    filter.Clear();
+    for (const auto& range : ranges) filter.Add(range.first, range.last);
+}
+
+bool Debugger::RangesContain(const vector<AddressRange>& ranges, emuptr address) {
+    return any_of(ranges.begin(), ranges.end(), [=](const AddressRange& range) {
+        return address >= range.first && address <= range.last;
+    });
+}
+
+void Debugger::AddressFilter::Clear() {
+    memset(pages, 0, sizeof(pages));
+
+    lo = 0xffffffff;
+    hi = 0;
+}
+
+void Debugger::AddressFilter::Add(emuptr first, emuptr last) {
+    lo = min(lo, first);
+    hi = max(hi, last);
+
+    const uint32 firstPage = first >> PAGE_SHIFT;
+    const uint32 lastPage = last >> PAGE_SHIFT;
+
+    if (lastPage - firstPage >= PAGE_COUNT - 1) {
+        memset(pages, 0xff, sizeof(pages));
+        return;
+    }
+
+    for (uint32 page = firstPage; page <= lastPage; page++)
+        pages[(page % PAGE_COUNT) >> 6] |= 1ull << (page & 63);
+}
+
 void DbgNotifyRead8(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryRead8(address);
+    gDebugger.NotifyMemoryRead8(address);
 }
 
 void DbgNotifyRead16(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryRead16(address);
+    gDebugger.NotifyMemoryRead16(address);
 }
 
 void DbgNotifyRead32(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryRead32(address);
+    gDebugger.NotifyMemoryRead32(address);
 }
 
 void DbgNotifyWrite8(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryWrite8(address);
+    gDebugger.NotifyMemoryWrite8(address);
 }
 
 void DbgNotifyWrite16(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryWrite16(address);
+    gDebugger.NotifyMemoryWrite16(address);
 }
 
 void DbgNotifyWrite32(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryWrite32(address);
+    gDebugger.NotifyMemoryWrite32(address);
 }
@@ -3,6 +3,7 @@
 
 #include <array>
 #include <unordered_set>
+#include <vector>
 
 #include "EmCommon.h"
 
@@ -88,9 +89,56 @@ class Debugger {
     const array<uint32, REGISTER_COUNT>& ReadRegisters();
     void SetRegister(size_t index, uint32 value);
 
+   private:
+    // Conservative prefilter for address sets. Addresses are hashed into a bitmap of 256 byte
+    // pages, and the overall bounds give a fast reject. A hit still requires an exact lookup.
+    class AddressFilter {
+       public:
+        static constexpr uint32 PAGE_SHIFT = 8;
+        static constexpr uint32 PAGE_COUNT = 4096;
+
+       public:
+        void Clear();
+        void Add(emuptr first, emuptr last);
+
+        // The range may span at most two pages, which covers any single memory access
+        inline bool MayContain(emuptr first, emuptr last) const {
+            if (last < lo || first > hi) return false;
+
+            return TestPage(first >> PAGE_SHIFT) || TestPage(last >> PAGE_SHIFT);
+        }
+
+       private:
+        inline bool TestPage(uint32 page) const {
+            return (pages[(page % PAGE_COUNT) >> 6] >> (page & 63)) & 1;
+        }
+
+       private:
+        uint64 pages[PAGE_COUNT / 64]{};
+
+        emuptr lo{0xffffffff};
+        emuptr hi{0};
+    };
+
+    struct AddressRange {
+        emuptr first;
+        emuptr last;
+    };
+
    private:
     void Break(BreakState state);
 
+    void RebuildBreakpointFilter();
+
+    bool CheckWatchpoints(const vector<AddressRange>& ranges, const AddressFilter& filter,
+                          emuptr first, emuptr last) const;
+
+    static void AddWatchpointRange(vector<AddressRange>& ranges, AddressFilter& filter,
+                                   emuptr first, emuptr last);
+    static void RemoveWatchpointRange(vector<AddressRange>& ranges, AddressFilter& filter,
+                                      emuptr first, emuptr last);
+    static bool RangesContain(const vector<AddressRange>& ranges, emuptr address);
+
    private:
     bool enabled{false};
     BreakState breakState{BreakState::none};
@@ -103,10 +151,14 @@ class Debugger {
     bool memoryAccess{false};
 
     unordered_set<emuptr> breakpoints;
-    unordered_set<emuptr> watchpointsRead;
-    unordered_set<emuptr> watchpointsWrite;
+    vector<AddressRange> watchpointsRead;
+    vector<AddressRange> watchpointsWrite;
     unordered_set<uint16> syscallTraps;
 
+    AddressFilter breakpointFilter;
+    AddressFilter watchpointReadFilter;
+    AddressFilter watchpointWriteFilter;
+
     emuptr watchpointAddress;
 
     BreakMode breakMode{BreakMode::all};
@@ -123,6 +175,6 @@ class Debugger {
     Debugger& operator=(Debugger&&) = delete;
 };
 
-extern Debugger gDebugger;
+extern thread_local Debugger gDebugger;
 
 #endif  // _DEBUGGER_H_
@@ -7,8 +7,6 @@
 extern "C" {
 #endif
 
-extern void* gDebuggerPtr;
-
 void DbgNotifyRead8(emuptr address);
 void DbgNotifyRead16(emuptr address);
 void DbgNotifyRead32(emuptr address);
@@ -40,15 +40,16 @@ namespace {
     constexpr int EVENT_QUEUE_SIZE = 20;
 }  // namespace
 
-static emuptr gBigROMEntry;
-
-EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueue{EVENT_QUEUE_SIZE};
-EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueue{EVENT_QUEUE_SIZE};
-EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueueIncoming{EVENT_QUEUE_SIZE};
-EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueueIncoming{EVENT_QUEUE_SIZE};
-uint64 EmPalmOS::lastEventPromotedAt{0};
-LocalID EmPalmOS::dbForLaunch{0};
-bool EmPalmOS::postNilEvent{false};
+static thread_local emuptr gBigROMEntry;
+
+thread_local EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueue{EVENT_QUEUE_SIZE};
+thread_local EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueue{EVENT_QUEUE_SIZE};
+thread_local EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueueIncoming{EVENT_QUEUE_SIZE};
+thread_local EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueueIncoming{
+    EVENT_QUEUE_SIZE};
+thread_local uint64 EmPalmOS::lastEventPromotedAt{0};
+thread_local LocalID EmPalmOS::dbForLaunch{0};
+thread_local bool EmPalmOS::postNilEvent{false};
 
 /***********************************************************************
  *
@@ -54,15 +54,15 @@ class EmPalmOS {
 
     static void ClearQueues();
 
-    static EmThreadSafeQueue<PenEvent> penEventQueue;
-    static EmThreadSafeQueue<KeyboardEvent> keyboardEventQueue;
+    static thread_local EmThreadSafeQueue<PenEvent> penEventQueue;
+    static thread_local EmThreadSafeQueue<KeyboardEvent> keyboardEventQueue;
 
-    static EmThreadSafeQueue<PenEvent> penEventQueueIncoming;
-    static EmThreadSafeQueue<KeyboardEvent> keyboardEventQueueIncoming;
-    static uint64 lastEventPromotedAt;
+    static thread_local EmThreadSafeQueue<PenEvent> penEventQueueIncoming;
+    static thread_local EmThreadSafeQueue<KeyboardEvent> keyboardEventQueueIncoming;
+    static thread_local uint64 lastEventPromotedAt;
 
-    static LocalID dbForLaunch;
-    static bool postNilEvent;
+    static thread_local LocalID dbForLaunch;
+    static thread_local bool postNilEvent;
 };
 
 #endif /* EmPalmOS_h */
@@ -1,9 +1,12 @@
 #include "EmSession.h"
 
+#include <cstring>
 #include <functional>
+#include <vector>
 
 #include "CallbackManager.h"
 #include "Chars.h"
+#include "CowImage.h"
 #include "Debugger.h"
 #include "EmBankSRAM.h"
 #include "EmCPU.h"
@@ -26,6 +29,7 @@
 #include "savestate/Savestate.h"
 #include "savestate/SavestateLoader.h"
 #include "savestate/SavestateProbe.h"
+#include "session/session_delta.h"
 
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 3;
@@ -37,7 +41,7 @@ namespace {
 
     constexpr double DEFAULT_CLOCK_FACTOR = 0.5;
 
-    EmSession _gSession;
+    thread_local EmSession _gSession;
 
     uint32 CurrentDate() {
         uint32 year, month, day;
@@ -48,7 +52,26 @@ namespace {
     }
 }  // namespace
 
-EmSession* gSession = &_gSession;
+struct SessionSnapshot {
+    struct Card {
+        string key;
+        unique_ptr<CowImage> image;
+    };
+
+    string deviceId;
+
+    size_t romSize;
+    unique_ptr<uint8[]> romImage;
+
+    unique_ptr<CowImage> memory;
+
+    size_t savestateSize;
+    unique_ptr<uint8[]> savestate;
+
+    vector<Card> cards;
+};
+
+thread_local EmSession* gSession = &_gSession;
 
 bool EmSession::Initialize(EmDevice* device, uint8* romImage, size_t romLength) {
     if (isInitialized) {
@@ -147,6 +170,22 @@ bool EmSession::SaveImage(SessionImage& image) {
     return image.Serialize();
 }
 
+bool EmSession::SaveDelta(SessionDelta& delta) {
+    EmAssert(romImage);
+
+    if (!savestate.Save(*this)) {
+        logPrintf("failed to save savestate");
+        return false;
+    }
+
+    delta.SetImage(SessionDelta::Image::nor, romSize, romImage.get(), 1024, nullptr)
+        .SetImage(SessionDelta::Image::memory, GetMemorySize(), GetMemoryPtr(), 1024,
+                  GetDirtyPagesPtr())
+        .SetSavestate(savestate.GetSize(), savestate.GetBuffer());
+
+    return delta.Serialize();
+}
+
 bool EmSession::LoadImage(SessionImage& image) {
     EmDevice* device = new EmDevice(image.GetDeviceId());
     if (device->GetIDString() != device->GetIDString()) {
@@ -198,6 +237,74 @@ bool EmSession::LoadImage(SessionImage& image) {
     return true;
 }
 
+shared_ptr<const SessionSnapshot> EmSession::Snapshot() {
+    EmAssert(romImage);
+
+    if (!savestate.Save(*this)) {
+        logPrintf("failed to save savestate");
+        return nullptr;
+    }
+
+    auto snapshot = make_shared<SessionSnapshot>();
+
+    snapshot->deviceId = device->GetIDString();
+
+    snapshot->romSize = romSize;
+    snapshot->romImage = make_unique<uint8[]>(romSize);
+    memcpy(snapshot->romImage.get(), romImage.get(), romSize);
+
+    snapshot->memory = make_unique<CowImage>(GetMemoryPtr(), GetMemorySize());
+
+    snapshot->savestateSize = savestate.GetSize();
+    snapshot->savestate = make_unique<uint8[]>(savestate.GetSize());
+    memcpy(snapshot->savestate.get(), savestate.GetBuffer(), savestate.GetSize());
+
+    for (uint8 slot = 0; slot <= static_cast<uint8>(EmHAL::MAX_SLOT); slot++) {
+        CardImage* image = gExternalStorage.GetImageInSlot(static_cast<EmHAL::Slot>(slot));
+        if (!image) continue;
+
+        snapshot->cards.push_back(
+            {.key = gExternalStorage.GetImageKeyInSlot(static_cast<EmHAL::Slot>(slot)),
+             .image = image->Snapshot()});
+    }
+
+    return snapshot;
+}
+
+bool EmSession::Clone(const SessionSnapshot& snapshot) {
+    unique_ptr<uint8[]> romImage = make_unique<uint8[]>(snapshot.romSize);
+    memcpy(romImage.get(), snapshot.romImage.get(), snapshot.romSize);
+
+    if (!Initialize(new EmDevice(snapshot.deviceId), romImage.get(), snapshot.romSize)) {
+        logPrintf("failed to initialize session");
+        return false;
+    }
+
+    romImage.release();
+
+    if (!EmMemory::LoadMemoryImage(*snapshot.memory)) {
+        logPrintf("failed to map memory image");
+        return false;
+    }
+
+    for (auto& card : snapshot.cards) {
+        gExternalStorage.RemoveImage(card.key);
+        gExternalStorage.AddImage(card.key, make_shared<CardImage>(*card.image));
+    }
+
+    if (!Load(snapshot.savestateSize, snapshot.savestate.get())) {
+        logPrintf("failed to restore savestate");
+        return false;
+    }
+
+    // Restoring the savestate touches memory, but the clone has not diverged yet
+    ResetDirtyPages();
+
+    gExternalStorage.Remount();
+
+    return true;
+}
+
 template <typename T>
 void EmSession::Save(T& savestate) {
     EmAssert(nestLevel == 0);
@@ -543,6 +650,8 @@ uint32 EmSession::GetRandomSeed() const { return EmLowMem::fgLowMem.globals.sysR
 
 uint8* EmSession::GetDirtyPagesPtr() const { return EmMemory::GetTotalDirtyPages(); }
 
+void EmSession::ResetDirtyPages() { EmMemory::ResetDirtyPages(); }
+
 void EmSession::SetHotsyncUserName(string hotsyncUserName) {
     gSystemState.SetHotsyncUserName(hotsyncUserName);
 
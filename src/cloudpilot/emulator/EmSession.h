@@ -23,6 +23,8 @@ template <typename ChunkType>
 class SavestateLoader;
 
 class SessionImage;
+class SessionDelta;
+struct SessionSnapshot;
 
 class EmSession {
    public:
@@ -34,6 +36,20 @@ class EmSession {
     bool SaveImage(SessionImage& image);
     bool LoadImage(SessionImage& image);
 
+    // Records the savestate and the memory pages dirtied since the last call to
+    // ResetDirtyPages. The base of the delta must be set by the caller.
+    bool SaveDelta(SessionDelta& delta);
+
+    // Captures ROM, memory, savestate and the mounted card images for cloning.
+    // The snapshot is immutable and may be shared across threads.
+    shared_ptr<const SessionSnapshot> Snapshot();
+
+    // Turns this session into a clone of the snapshot. Memory is shared with the
+    // snapshot copy-on-write, and the dirty pages track where the clone diverged.
+    // As all sessions, the clone is confined to the calling thread, and it must be
+    // deinitialized before the thread exits.
+    bool Clone(const SessionSnapshot& snapshot);
+
     template <typename T>
     void Save(T& savestate);
     void Load(SavestateLoader<ChunkType>& loader);
@@ -57,6 +73,7 @@ class EmSession {
     uint32 GetMemorySize() const;
     uint8* GetMemoryPtr() const;
     uint8* GetDirtyPagesPtr() const;
+    void ResetDirtyPages();
 
     void QueuePenEvent(PenEvent evt);
     void QueueKeyboardEvent(KeyboardEvent evt);
@@ -157,7 +174,10 @@ class EmSession {
     int transportSerialRequiresSyncChangedHandle{-1};
 };
 
-extern EmSession* gSession;
+// Emulator instances are confined to a thread: the session and the other
+// singletons that make up an instance are thread local, so a process can host
+// one instance per thread.
+extern thread_local EmSession* gSession;
 
 ///////////////////////////////////////////////////////////////////////////////
 // IMPLEMENTATION
@@ -6,7 +6,7 @@
 #include "savestate/SavestateLoader.h"
 #include "savestate/SavestateProbe.h"
 
-EmSystemState gSystemState;
+thread_local EmSystemState gSystemState;
 
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 2;
@@ -113,3 +113,55 @@ emuptr EmSystemState::GetScreenLowWatermark() const { return screenLowWatermark;
 bool EmSystemState::ScreenRequiresFullRefresh() const {
     return screenState == ScreenState::needsFullRefresh;
 }
+
+size_t EmSystemState::GetScreenDirtySpanCount() const { return screenDirtySpanCount; }
+
+const EmSystemState::ScreenDirtySpan& EmSystemState::GetScreenDirtySpan(size_t index) const {
+    return screenDirtySpans[index];
+}
+
+void EmSystemState::AddScreenDirtySpan(emuptr addressLo, emuptr addressHi) {
+    auto gap = [&](const ScreenDirtySpan& span) -> emuptr {
+        if (addressHi < span.lo) return span.lo - addressHi;
+        if (addressLo > span.hi) return addressLo - span.hi;
+
+        return 0;
+    };
+
+    // Extend the closest span if it is near enough or if there is no room for another one
+    uint8 closest = 0;
+    for (uint8 i = 1; i < screenDirtySpanCount; i++)
+        if (gap(screenDirtySpans[i]) < gap(screenDirtySpans[closest])) closest = i;
+
+    if (gap(screenDirtySpans[closest]) > SCREEN_DIRTY_SPAN_GAP &&
+        screenDirtySpanCount < MAX_SCREEN_DIRTY_SPANS) {
+        screenDirtySpans[screenDirtySpanCount] = {addressLo, addressHi};
+        currentScreenDirtySpan = screenDirtySpanCount++;
+
+        return;
+    }
+
+    ScreenDirtySpan span = screenDirtySpans[closest];
+    if (addressLo < span.lo) span.lo = addressLo;
+    if (addressHi > span.hi) span.hi = addressHi;
+
+    // The grown span may now swallow others
+    for (uint8 i = 0; i < screenDirtySpanCount;) {
+        const ScreenDirtySpan& other = screenDirtySpans[i];
+
+        if (i == closest || other.lo > span.hi + SCREEN_DIRTY_SPAN_GAP ||
+            other.hi + SCREEN_DIRTY_SPAN_GAP < span.lo) {
+            i++;
+            continue;
+        }
+
+        if (other.lo < span.lo) span.lo = other.lo;
+        if (other.hi > span.hi) span.hi = other.hi;
+
+        screenDirtySpans[i] = screenDirtySpans[--screenDirtySpanCount];
+        if (closest == screenDirtySpanCount) closest = i;
+    }
+
+    screenDirtySpans[closest] = span;
+    currentScreenDirtySpan = closest;
+}
@@ -9,6 +9,14 @@ template <typename ChunkType>
 class SavestateLoader;
 
 class EmSystemState {
+   public:
+    struct ScreenDirtySpan {
+        emuptr lo;
+        emuptr hi;
+    };
+
+    static constexpr size_t MAX_SCREEN_DIRTY_SPANS = 4;
+
    public:
     EmSystemState() = default;
 
@@ -44,6 +52,12 @@ class EmSystemState {
     emuptr GetScreenHighWatermark() const;
     emuptr GetScreenLowWatermark() const;
 
+    // Address ranges written since the screen was last marked clean. They lie within the
+    // watermarks, but are not ordered. Only valid if the screen is dirty and does not require a
+    // full refresh.
+    size_t GetScreenDirtySpanCount() const;
+    const ScreenDirtySpan& GetScreenDirtySpan(size_t index) const;
+
    public:
     EmEvent<> onMarkScreenClean;
 
@@ -51,9 +65,14 @@ class EmSystemState {
     template <typename T>
     void DoSaveLoad(T& helper, uint32 version);
 
+    void AddScreenDirtySpan(emuptr addressLo, emuptr addressHi);
+
    private:
     enum class ScreenState : uint8 { clean, dirty, needsFullRefresh };
 
+    // Writes that are closer than this to a dirty span extend it instead of starting a new one
+    static constexpr emuptr SCREEN_DIRTY_SPAN_GAP = 256;
+
     uint32 osVersion{0};
 
     bool uiInitialized{false};
@@ -64,9 +83,13 @@ class EmSystemState {
     ScreenState screenState;
     emuptr screenHighWatermark;
     emuptr screenLowWatermark;
+
+    ScreenDirtySpan screenDirtySpans[MAX_SCREEN_DIRTY_SPANS];
+    uint8 screenDirtySpanCount{0};
+    uint8 currentScreenDirtySpan{0};
 };
 
-extern EmSystemState gSystemState;
+extern thread_local EmSystemState gSystemState;
 
 ///////////////////////////////////////////////////////////////////////////////
 // IMPLEMENTATION
@@ -78,10 +101,29 @@ inline void EmSystemState::MarkScreenDirty(emuptr addressLo, emuptr addressHi) {
     if (likely(screenState == ScreenState::dirty)) {
         if (addressLo < screenLowWatermark) screenLowWatermark = addressLo;
         if (addressHi > screenHighWatermark) screenHighWatermark = addressHi;
+
+        // Consecutive writes usually hit or extend the span that was written last
+        ScreenDirtySpan& span = screenDirtySpans[currentScreenDirtySpan];
+
+        if (likely(addressLo >= span.lo && addressHi <= span.hi)) return;
+
+        if (addressLo <= span.hi + SCREEN_DIRTY_SPAN_GAP &&
+            addressHi + SCREEN_DIRTY_SPAN_GAP >= span.lo) {
+            if (addressLo < span.lo) span.lo = addressLo;
+            if (addressHi > span.hi) span.hi = addressHi;
+
+            return;
+        }
+
+        AddScreenDirtySpan(addressLo, addressHi);
     } else if (screenState == ScreenState::clean) {
         screenLowWatermark = addressLo;
         screenHighWatermark = addressHi;
         screenState = ScreenState::dirty;
+
+        screenDirtySpans[0] = {addressLo, addressHi};
+        screenDirtySpanCount = 1;
+        currentScreenDirtySpan = 0;
     }
 }
 
@@ -6,7 +6,7 @@
 #include "savestate/SavestateLoader.h"
 #include "savestate/SavestateProbe.h"
 
-ExternalStorage gExternalStorage;
+thread_local ExternalStorage gExternalStorage;
 
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 1;
@@ -27,6 +27,14 @@ bool ExternalStorage::AddImage(const string& key, uint8* imageData, size_t size)
     return true;
 }
 
+bool ExternalStorage::AddImage(const string& key, shared_ptr<CardImage> image) {
+    if (key.length() > MAX_KEY_LENGTH || !image->RawData() || HasImage(key)) return false;
+
+    images.emplace(key, image);
+
+    return true;
+}
+
 bool ExternalStorage::Mount(const string& key, EmHAL::Slot slot) {
     if (slot == EmHAL::Slot::none || IsMounted(slot) || !HasImage(key) ||
         GetSlot(key) != EmHAL::Slot::none || !EmHAL::SupportsImageInSlot(slot, *images.at(key)))
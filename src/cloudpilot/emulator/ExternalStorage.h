@@ -32,6 +32,7 @@ class ExternalStorage {
     bool HasImage(const string& key) const;
     CardImage* GetImage(const string& key);
     bool AddImage(const string& key, uint8* imageData, size_t size);
+    bool AddImage(const string& key, shared_ptr<CardImage> image);
 
     bool Mount(const string& key, EmHAL::Slot slot);
     bool Mount(const string& key);
@@ -80,6 +81,6 @@ class ExternalStorage {
     ExternalStorage& operator=(ExternalStorage&&) = delete;
 };
 
-extern ExternalStorage gExternalStorage;
+extern thread_local ExternalStorage gExternalStorage;
 
 #endif  // _EXTERNAL_STORAGE_H_
@@ -3,9 +3,9 @@
 #include "SuspendContext.h"
 #include "SuspendManager.h"
 
-bool Feature::clipboardIntegration{false};
-bool Feature::networkRedirection{false};
-bool Feature::hotsyncNameManagement{true};
+__thread bool Feature::clipboardIntegration{false};
+__thread bool Feature::networkRedirection{false};
+__thread bool Feature::hotsyncNameManagement{true};
 
 void Feature::SetClipboardIntegration(bool toggle) {
     clipboardIntegration = toggle;
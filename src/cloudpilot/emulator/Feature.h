@@ -16,9 +16,9 @@ class Feature {
     static bool GetHotsyncNameManagement();
 
    private:
-    static bool clipboardIntegration;
-    static bool networkRedirection;
-    static bool hotsyncNameManagement;
+    static __thread bool clipboardIntegration;
+    static __thread bool networkRedirection;
+    static __thread bool hotsyncNameManagement;
 };
 
 #endif  // _FEATURE_H_
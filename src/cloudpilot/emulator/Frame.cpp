@@ -4,6 +4,8 @@
 
 #include "EmSystemState.h"
 
+static_assert(Frame::MAX_DIRTY_SPANS >= EmSystemState::MAX_SCREEN_DIRTY_SPANS);
+
 Frame::Frame(size_t bufferSize)
     : buffer(make_unique<uint8[]>(bufferSize)), bufferSize(bufferSize) {}
 
@@ -25,6 +27,16 @@ uint32 Frame::GetFirstDirtyLine() const { return firstDirtyLine; }
 
 uint32 Frame::GetLastDirtyLine() const { return lastDirtyLine; }
 
+uint32 Frame::GetDirtySpanCount() const { return dirtySpanCount; }
+
+uint32 Frame::GetDirtySpanFirstLine(uint32 index) const {
+    return index < dirtySpanCount ? dirtySpans[index].firstLine : 0;
+}
+
+uint32 Frame::GetDirtySpanLastLine(uint32 index) const {
+    return index < dirtySpanCount ? dirtySpans[index].lastLine : 0;
+}
+
 bool Frame::GetHasChanges() const { return hasChanges; }
 
 uint8 Frame::GetScaleX() const { return scaleX; }
@@ -47,6 +59,7 @@ void Frame::UpdateDirtyLines(const EmSystemState& systemState, emuptr baseAddr,
         fullRefresh) {
         firstDirtyLine = 0;
         lastDirtyLine = maxLine;
+        CollapseDirtySpans();
 
         return;
     }
@@ -56,10 +69,47 @@ void Frame::UpdateDirtyLines(const EmSystemState& systemState, emuptr baseAddr,
         return;
     }
 
-    firstDirtyLine =
-        min((max(systemState.GetScreenLowWatermark(), baseAddr) - baseAddr) / rowBytes, maxLine);
+    dirtySpanCount = 0;
+
+    for (size_t i = 0; i < systemState.GetScreenDirtySpanCount(); i++) {
+        const EmSystemState::ScreenDirtySpan& span = systemState.GetScreenDirtySpan(i);
+        if (span.hi < baseAddr) continue;
+
+        // Screen buffer tracking is page granular, so writes may land past the frame
+        if (span.lo > baseAddr && (span.lo - baseAddr) / rowBytes > maxLine) continue;
+
+        DirtySpan lineSpan{min((max(span.lo, baseAddr) - baseAddr) / rowBytes, maxLine),
+                           min((span.hi - baseAddr) / rowBytes, maxLine)};
+
+        // Insert in order, merging with spans that overlap or touch
+        size_t j = 0;
+        while (j < dirtySpanCount && dirtySpans[j].lastLine + 1 < lineSpan.firstLine) j++;
+
+        size_t k = j;
+        while (k < dirtySpanCount && dirtySpans[k].firstLine <= lineSpan.lastLine + 1) {
+            lineSpan.firstLine = min(lineSpan.firstLine, dirtySpans[k].firstLine);
+            lineSpan.lastLine = max(lineSpan.lastLine, dirtySpans[k].lastLine);
+            k++;
+        }
+
+        if (k == j) {
+            for (size_t l = dirtySpanCount; l > j; l--) dirtySpans[l] = dirtySpans[l - 1];
+            dirtySpanCount++;
+        } else {
+            for (size_t l = k; l < dirtySpanCount; l++) dirtySpans[l - (k - j) + 1] = dirtySpans[l];
+            dirtySpanCount -= k - j - 1;
+        }
 
-    lastDirtyLine = min((systemState.GetScreenHighWatermark() - baseAddr) / rowBytes, maxLine);
+        dirtySpans[j] = lineSpan;
+    }
+
+    if (dirtySpanCount == 0) {
+        hasChanges = false;
+        return;
+    }
+
+    firstDirtyLine = dirtySpans[0].firstLine;
+    lastDirtyLine = dirtySpans[dirtySpanCount - 1].lastLine;
 }
 
 void Frame::FlipDirtyRegion() {
@@ -68,6 +118,15 @@ void Frame::FlipDirtyRegion() {
     const uint32 tmp = maxLine - firstDirtyLine;
     firstDirtyLine = maxLine - lastDirtyLine;
     lastDirtyLine = tmp;
+
+    for (size_t i = 0; i < dirtySpanCount / 2; i++)
+        swap(dirtySpans[i], dirtySpans[dirtySpanCount - 1 - i]);
+
+    for (size_t i = 0; i < dirtySpanCount; i++) {
+        const uint32 first = maxLine - dirtySpans[i].lastLine;
+        dirtySpans[i].lastLine = maxLine - dirtySpans[i].firstLine;
+        dirtySpans[i].firstLine = first;
+    }
 }
 
 void Frame::ResetDirtyRegion(bool dirtyRegionIsVertical) {
@@ -75,4 +134,10 @@ void Frame::ResetDirtyRegion(bool dirtyRegionIsVertical) {
 
     firstDirtyLine = 0;
     lastDirtyLine = lines - 1;
+    CollapseDirtySpans();
+}
+
+void Frame::CollapseDirtySpans() {
+    dirtySpans[0] = {firstDirtyLine, lastDirtyLine};
+    dirtySpanCount = 1;
 }
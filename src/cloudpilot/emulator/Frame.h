@@ -8,6 +8,13 @@
 class EmSystemState;
 
 struct Frame {
+    struct DirtySpan {
+        uint32 firstLine;
+        uint32 lastLine;
+    };
+
+    static constexpr size_t MAX_DIRTY_SPANS = 4;
+
     Frame(size_t bufferSize);
 
     uint8 bpp{0};
@@ -22,6 +29,11 @@ struct Frame {
     uint32 firstDirtyLine{0};
     uint32 lastDirtyLine{0};
 
+    // Disjoint line ranges that changed, in ascending order, from firstDirtyLine to
+    // lastDirtyLine. Lines in between are unchanged since the previous frame.
+    DirtySpan dirtySpans[MAX_DIRTY_SPANS]{};
+    uint8 dirtySpanCount{0};
+
     uint8 scaleX{0};
     uint8 scaleY{0};
 
@@ -38,6 +50,9 @@ struct Frame {
 
     uint32 GetFirstDirtyLine() const;
     uint32 GetLastDirtyLine() const;
+    uint32 GetDirtySpanCount() const;
+    uint32 GetDirtySpanFirstLine(uint32 index) const;
+    uint32 GetDirtySpanLastLine(uint32 index) const;
     bool GetHasChanges() const;
 
     uint8 GetScaleX() const;
@@ -49,6 +64,9 @@ struct Frame {
     void FlipDirtyRegion();
     void ResetDirtyRegion(bool dirtyRegionIsVertical = false);
 
+    // Replaces the dirty spans with the single span firstDirtyLine..lastDirtyLine
+    void CollapseDirtySpans();
+
    private:
     const unique_ptr<uint8[]> buffer;
     const size_t bufferSize;
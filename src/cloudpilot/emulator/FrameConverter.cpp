@@ -0,0 +1,109 @@
+#include "FrameConverter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr uint32 BACKGROUND_HUE = 0xd2;
+    constexpr uint32 FOREGROUND_COLOR = 0xff000000;
+    constexpr uint32 BACKGROUND_COLOR =
+        0xff000000 | BACKGROUND_HUE | (BACKGROUND_HUE << 8) | (BACKGROUND_HUE << 16);
+
+    constexpr uint32 PALETTE_GRAYSCALE_16[] = {
+        0xffd2d2d2, 0xffc4c4c4, 0xffb6b6b6, 0xffa8a8a8, 0xff9a9a9a, 0xff8c8c8c, 0xff7e7e7e,
+        0xff707070, 0xff626262, 0xff545454, 0xff464646, 0xff383838, 0xff2a2a2a, 0xff1c1c1c,
+        0xff0e0e0e, 0xff000000};
+
+    // Pixels are packed starting with the most significant bits of each byte
+    template <int bpp>
+    void buildTable(uint32* table, const uint32* palette) {
+        constexpr uint32 pixelsPerByte = 8 / bpp;
+        constexpr uint32 mask = (1 << bpp) - 1;
+
+        for (uint32 byte = 0; byte < 256; byte++)
+            for (uint32 i = 0; i < pixelsPerByte; i++)
+                *(table++) = palette[(byte >> (8 - bpp * (i + 1))) & mask];
+    }
+
+    // The copies have a size known at compile time and compile to vector stores
+    template <int bpp>
+    void convertLine(uint32* dest, const uint8* src, uint32 margin, uint32 width,
+                     const uint32* table) {
+        constexpr uint32 pixelsPerByte = 8 / bpp;
+
+        src += margin / pixelsPerByte;
+
+        if (const uint32 skip = margin % pixelsPerByte; skip > 0 && width > 0) {
+            const uint32 count = std::min(pixelsPerByte - skip, width);
+
+            memcpy(dest, table + *(src++) * pixelsPerByte + skip, 4 * count);
+            dest += count;
+            width -= count;
+        }
+
+        for (; width >= pixelsPerByte; width -= pixelsPerByte, dest += pixelsPerByte)
+            memcpy(dest, table + *(src++) * pixelsPerByte, 4 * pixelsPerByte);
+
+        if (width > 0) memcpy(dest, table + *src * pixelsPerByte, 4 * width);
+    }
+
+    template <int bpp>
+    void convertLines(Frame& frame, uint32* pixels, uint32 pitch, const uint32* table) {
+        const uint8* buffer = frame.GetBuffer();
+
+        for (size_t i = 0; i < frame.dirtySpanCount; i++)
+            for (uint32 y = frame.dirtySpans[i].firstLine; y <= frame.dirtySpans[i].lastLine; y++)
+                convertLine<bpp>(pixels + y * pitch, buffer + y * frame.bytesPerLine,
+                                 frame.margin, frame.lineWidth, table);
+    }
+}  // namespace
+
+FrameConverter::FrameConverter() {
+    const uint32 palette1bit[] = {BACKGROUND_COLOR, FOREGROUND_COLOR};
+
+    buildTable<1>(table1bit, palette1bit);
+    buildTable<4>(table4bit, PALETTE_GRAYSCALE_16);
+}
+
+void FrameConverter::Convert(Frame& frame, uint32* pixels, uint32 pitch,
+                             uint16 palette2bitMapping) {
+    switch (frame.bpp) {
+        case 1:
+            convertLines<1>(frame, pixels, pitch, table1bit);
+            break;
+
+        case 2:
+            Update2bitTable(palette2bitMapping);
+            convertLines<2>(frame, pixels, pitch, table2bit);
+            break;
+
+        case 4:
+            convertLines<4>(frame, pixels, pitch, table4bit);
+            break;
+
+        case 24: {
+            const uint8* buffer = frame.GetBuffer();
+
+            for (size_t i = 0; i < frame.dirtySpanCount; i++)
+                for (uint32 y = frame.dirtySpans[i].firstLine; y <= frame.dirtySpans[i].lastLine;
+                     y++) {
+                    memcpy(pixels + y * pitch, buffer + y * frame.bytesPerLine + 4 * frame.margin,
+                           4 * frame.lineWidth);
+                }
+        } break;
+    }
+}
+
+void FrameConverter::Update2bitTable(uint16 palette2bitMapping) {
+    if (table2bitValid && palette2bitMapping == table2bitMapping) return;
+
+    const uint32 palette[4] = {PALETTE_GRAYSCALE_16[palette2bitMapping & 0x000f],
+                               PALETTE_GRAYSCALE_16[(palette2bitMapping >> 4) & 0x000f],
+                               PALETTE_GRAYSCALE_16[(palette2bitMapping >> 8) & 0x000f],
+                               PALETTE_GRAYSCALE_16[(palette2bitMapping >> 12) & 0x000f]};
+
+    buildTable<2>(table2bit, palette);
+
+    table2bitMapping = palette2bitMapping;
+    table2bitValid = true;
+}
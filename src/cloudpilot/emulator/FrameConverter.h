@@ -0,0 +1,35 @@
+#ifndef _FRAME_CONVERTER_H_
+#define _FRAME_CONVERTER_H_
+
+#include "EmCommon.h"
+#include "Frame.h"
+
+// Converts frames to ABGR8888. Grayscale frames expand through lookup tables that map each source
+// byte to its 8, 4 or 2 pixels, so every byte is emitted with a single fixed size copy.
+class FrameConverter {
+   public:
+    FrameConverter();
+
+    // Converts the dirty spans of a frame. Line y ends up at pixels + y * pitch, the pitch is
+    // measured in pixels. palette2bitMapping is the value of EmHAL::GetLCD2bitMapping().
+    void Convert(Frame& frame, uint32* pixels, uint32 pitch, uint16 palette2bitMapping);
+
+   private:
+    void Update2bitTable(uint16 palette2bitMapping);
+
+   private:
+    uint32 table1bit[256 * 8];
+    uint32 table2bit[256 * 4];
+    uint32 table4bit[256 * 2];
+
+    uint16 table2bitMapping{0};
+    bool table2bitValid{false};
+
+   private:
+    FrameConverter(const FrameConverter&) = delete;
+    FrameConverter(FrameConverter&&) = delete;
+    FrameConverter& operator=(const FrameConverter&) = delete;
+    FrameConverter& operator=(FrameConverter&&) = delete;
+};
+
+#endif  // _FRAME_CONVERTER_H_
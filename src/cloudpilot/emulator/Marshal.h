@@ -114,9 +114,9 @@ typedef struct ExgSocketType* ExgSocketPtr;
 typedef UInt8* UInt8Ptr;
 
 #define CALLED_SETUP(return_decl, parameter_decl)      \
-    static EmSubroutine sub;                           \
+    static thread_local EmSubroutine sub;              \
                                                        \
-    static Bool initialized;                           \
+    static thread_local Bool initialized;              \
     if (!initialized) {                                \
         initialized = true;                            \
         sub.DescribeDecl(return_decl, parameter_decl); \
@@ -125,9 +125,9 @@ typedef UInt8* UInt8Ptr;
     sub.PrepareStack(kForBeingCalled, false)
 
 #define CALLED_SETUP_HC(return_decl, parameter_decl)                                         \
-    static EmSubroutine sub;                                                                 \
+    static thread_local EmSubroutine sub;                                                    \
                                                                                              \
-    static Bool initialized;                                                                 \
+    static thread_local Bool initialized;                                                    \
     if (!initialized) {                                                                      \
         initialized = true;                                                                  \
         sub.DescribeDecl(return_decl, "HostControlSelectorType _selector, " parameter_decl); \
@@ -146,9 +146,9 @@ typedef UInt8* UInt8Ptr;
     sub.PrepareStack(kForBeingCalled, true)
 
 #define CALLER_SETUP(return_decl, parameter_decl)      \
-    static EmSubroutine sub;                           \
+    static thread_local EmSubroutine sub;              \
                                                        \
-    static Bool initialized;                           \
+    static thread_local Bool initialized;              \
     if (!initialized) {                                \
         initialized = true;                            \
         sub.DescribeDecl(return_decl, parameter_decl); \
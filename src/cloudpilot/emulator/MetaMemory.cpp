@@ -13,221 +13,103 @@
 
 #include "MetaMemory.h"
 
-#include <cstddef>
+#include <cstring>
 
-#include "EmBankSRAM.h"
+#include "EmCPU68K.h"  // gCPU68K
 #include "EmCommon.h"
 #include "EmMemory.h"
 #include "MemoryRegion.h"
+#include "Platform.h"
 
-set<emuptr> MetaMemory::breakpoints;
-
-void MetaMemory::Clear() { breakpoints.clear(); }
-
-void MetaMemory::MarkRange(emuptr start, emuptr end, uint8 v) {
-    if (end <= start) return;
-
-    // If there's no meta-memory (not needed for dedicated framebuffers)
-    // just leave.
-    if (EmMemGetBank(start).xlatemetaaddr == NULL) return;
-
-    uint8* startP = EmMemGetMetaAddress(start);
-    uint8* endP = startP + (end - start);  // EmMemGetMetaAddress (end);
-    uint8* end4P = (uint8*)(((long)endP) & ~3);
-    uint8* p = startP;
-
-    // Guard against memory corruption
-    size_t ramSize = EmMemory::GetRegionSize(MemoryRegion::ram);
-    if (startP < gRAM_MetaMemory) return;
-    endP = min(endP, startP + ramSize);
-
-    EmAssert(end >= start);
-    EmAssert(endP >= startP);
-    EmAssert(endP - startP == (ptrdiff_t)(end - start));
-
-#if 1
-    // Optimization: if there are no middle longs to fill, just
-    // do everything a byte at a time.
-
-    if (end - start < 12) {
-        while (p < endP) {
-            *p++ &= v;
-        }
-    } else {
-        uint32 longValue = v;
-        longValue |= (longValue << 8);
-        longValue |= (longValue << 16);
-
-        while (((long)p) & 3)  // while there are leading bytes
-        {
-            *p++ |= v;
-        }
-
-        while (p < end4P)  // while there are middle longs
-        {
-            *(uint32*)p |= longValue;
-            p += 4;
-        }
-
-        while (p < endP)  // while there are trailing bytes
-        {
-            *p++ |= v;
-        }
-    }
-#else
-    for (p = startP; p < endP; ++p) {
-        *p |= v;
+namespace {
+    thread_local uint32 ramSize;
+    thread_local uint8* ram;
+
+    uint32 BankCount() {
+        // Word-sized screen buffer checks at the very end of RAM look one bank
+        // further
+
+        return ramSize / 0x10000 + 2;
     }
-#endif
+}  // namespace
+
+thread_local set<emuptr> MetaMemory::breakpoints;
+thread_local uint64* MetaMemory::screenPages;
+
+void MetaMemory::Initialize() {
+    ramSize = EmMemory::GetRegionSize(MemoryRegion::ram);
+    ram = EmMemory::GetForRegion(MemoryRegion::ram);
+
+    EmAssert(screenPages == NULL);
+
+    screenPages = (uint64*)Platform::AllocateMemoryClear(BankCount() * sizeof(uint64));
 }
 
-// ---------------------------------------------------------------------------
-//		� MetaMemory::UnmarkRange
-// ---------------------------------------------------------------------------
+void MetaMemory::Reset() { memset(screenPages, 0, BankCount() * sizeof(uint64)); }
 
-void MetaMemory::UnmarkRange(emuptr start, emuptr end, uint8 v) {
-    if (end <= start) return;
-
-    // If there's no meta-memory (not needed for dedicated framebuffers)
-    // just leave.
-    if (!EmMemGetBank(start).xlatemetaaddr) return;
-
-    uint8* startP = EmMemGetMetaAddress(start);
-    uint8* endP = startP + (end - start);  // EmMemGetMetaAddress (end);
-    uint8* end4P = (uint8*)(((long)endP) & ~3);
-    uint8* p = startP;
-
-    // Guard against memory corruption
-    size_t ramSize = EmMemory::GetRegionSize(MemoryRegion::ram);
-    if (startP < gRAM_MetaMemory) return;
-    endP = min(endP, startP + ramSize);
-
-    EmAssert(end >= start);
-    EmAssert(endP >= startP);
-    EmAssert(endP - startP == (ptrdiff_t)(end - start));
-
-    v = ~v;
-
-#if 1
-    // Optimization: if there are no middle longs to fill, just
-    // do everything a byte at a time.
-
-    if (end - start < 12) {
-        while (p < endP) {
-            *p++ &= v;
-        }
-    } else {
-        uint32 longValue = v;
-        longValue |= (longValue << 8);
-        longValue |= (longValue << 16);
-
-        while (((long)p) & 3)  // while there are leading bytes
-        {
-            *p++ &= v;
-        }
-
-        while (p < end4P)  // while there are middle longs
-        {
-            *(uint32*)p &= longValue;
-            p += 4;
-        }
-
-        while (p < endP)  // while there are trailing bytes
-        {
-            *p++ &= v;
-        }
-    }
-#else
-    for (p = startP; p < endP; ++p) {
-        *p &= v;
-    }
-#endif
+void MetaMemory::Dispose() { Platform::DisposeMemory(screenPages); }
+
+// Breakpoints are baked into the instructions predecoded by the CPU, so
+// they need to be invalidated whenever a breakpoint changes.
+
+void MetaMemory::Clear() {
+    if (gCPU68K)
+        for (emuptr opcodeLocation : breakpoints)
+            gCPU68K->InvalidateDecodedInstruction(opcodeLocation);
+
+    breakpoints.clear();
+}
+
+void MetaMemory::MarkInstructionBreak(emuptr opcodeLocation) {
+    breakpoints.insert(opcodeLocation);
+
+    if (gCPU68K) gCPU68K->InvalidateDecodedInstruction(opcodeLocation);
+}
+
+void MetaMemory::UnmarkInstructionBreak(emuptr opcodeLocation) {
+    breakpoints.erase(opcodeLocation);
+
+    if (gCPU68K) gCPU68K->InvalidateDecodedInstruction(opcodeLocation);
+}
+
+// Writes to the screen buffer cannot bypass the bank functions, so the
+// host banks need to be refreshed whenever the screen moves.
+
+void MetaMemory::MarkScreen(emuptr begin, emuptr end) {
+    MarkUnmarkScreen(begin, end, true);
+
+    Memory::UpdateHostBanks(begin, end);
+}
+
+void MetaMemory::UnmarkScreen(emuptr begin, emuptr end) {
+    MarkUnmarkScreen(begin, end, false);
+
+    Memory::UpdateHostBanks(begin, end);
 }
 
 // ---------------------------------------------------------------------------
-//		� MetaMemory::MarkUnmarkRange
+//		� MetaMemory::MarkUnmarkScreen
 // ---------------------------------------------------------------------------
 
-void MetaMemory::MarkUnmarkRange(emuptr start, emuptr end, uint8 andValue, uint8 orValue) {
-    size_t ramSize = EmMemory::GetRegionSize(MemoryRegion::ram);
+void MetaMemory::MarkUnmarkScreen(emuptr begin, emuptr end, bool mark) {
+    if (end <= begin) return;
 
-    // If there's no meta-memory (not needed for dedicated framebuffers)
-    // just leave.
+    // Only RAM carries metadata, dedicated framebuffers are tracked by their
+    // own banks.
 
-    if (EmMemGetBank(start).xlatemetaaddr == NULL) return;
+    const uint8* realAddress = EmMemGetRealAddress(begin);
+    if (realAddress < ram || realAddress >= ram + ramSize) return;
 
-    // If the beginning and end of the buffer are not in the same address
-    // space, just leave.  This can happen while initializing the Dragonball's
-    // LCD -- for a while, the LCD framebuffer range falls off the end
-    // of the dynamic heap.
+    // The range may fall off the end of RAM. This can happen while initializing
+    // the Dragonball's LCD.
 
-    if (start < 0 + ramSize && end >= 0 + ramSize) {
-        end = ramSize - 1;
-    }
-
-    if (start >= gMemoryStart && start < gMemoryStart + ramSize && end >= gMemoryStart + ramSize) {
-        end = gMemoryStart + ramSize - 1;
-    }
+    const uint32 first = realAddress - ram;
+    const uint32 last = min(end - begin, ramSize - first) + first - 1;
 
-    uint8* startP = EmMemGetMetaAddress(start);
-    uint8* endP = startP + (end - start);  // EmMemGetMetaAddress (end);
-    uint8* end4P = (uint8*)(((long)endP) & ~3);
-    uint8* p = startP;
-
-    EmAssert(end >= start);
-    EmAssert(endP >= startP);
-    EmAssert(endP - startP == (ptrdiff_t)(end - start));
-
-    if (andValue == 0xFF) {
-        while (p < endP) {
-            *p++ |= orValue;
-        }
-    } else if (orValue == 0x00) {
-        while (p < endP) {
-            *p++ &= andValue;
-        }
-    } else {
-#if 1
-        // Optimization: if there are no middle longs to fill, just
-        // do everything a byte at a time.
-
-        if (end - start < 12) {
-            while (p < endP)  // while there are trailing bytes
-            {
-                *p = (*p & andValue) | orValue;
-                p++;
-            }
-        } else {
-            uint32 longAnd = andValue;
-            longAnd |= (longAnd << 8);
-            longAnd |= (longAnd << 16);
-
-            uint32 longOr = orValue;
-            longOr |= (longOr << 8);
-            longOr |= (longOr << 16);
-
-            while (((long)p) & 3)  // while there are leading bytes
-            {
-                *p = (*p & andValue) | orValue;
-                p++;
-            }
-
-            while (p < end4P)  // while there are middle longs
-            {
-                *(uint32*)p = ((*(uint32*)p) & longAnd) | longOr;
-                p += 4;
-            }
-
-            while (p < endP)  // while there are trailing bytes
-            {
-                *p = (*p & andValue) | orValue;
-                p++;
-            }
-        }
-#else
-        for (p = startP; p < endP; ++p) {
-            *p = (*p & andValue) | orValue;
-        }
-#endif
+    for (uint32 page = first >> 10; page <= last >> 10; page++) {
+        if (mark)
+            screenPages[page >> 6] |= 1ULL << (page & 0x3f);
+        else
+            screenPages[page >> 6] &= ~(1ULL << (page & 0x3f));
     }
 }
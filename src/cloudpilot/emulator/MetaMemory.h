@@ -16,15 +16,22 @@
 
 #include <set>
 
-#include "EmMemory.h"  // EmMemGetMetaAddress
+#include "EmCommon.h"
+
+// Metadata about RAM. Screen buffer membership is tracked per 1k page of physical
+// RAM, with one 64 bit word per 64k bank, so a bank without screen pages costs a
+// single load to check. The words double as the slowPages masks of the host banks.
 
 class MetaMemory {
    public:
-    static void Clear();
+    static void Initialize();
+    static void Reset();
+    static void Dispose();
 
-    static void MarkTotalAccess(emuptr begin, emuptr end);
-    static void SetAccess(emuptr begin, emuptr end, uint8 bits);
+    static void Clear();
 
+    // Screen buffer marks cover whole pages, so writes next to the screen
+    // buffer may mark the screen dirty as well.
     static void MarkScreen(emuptr begin, emuptr end);
     static void UnmarkScreen(emuptr begin, emuptr end);
 
@@ -32,149 +39,31 @@ class MetaMemory {
     static void UnmarkInstructionBreak(emuptr opcodeLocation);
     static Bool IsCPUBreak(emuptr opcodeLocation);
 
-    static Bool IsScreenBuffer8(uint8* metaAddress);   // Inlined, defined below
-    static Bool IsScreenBuffer16(uint8* metaAddress);  // Inlined, defined below
-    static Bool IsScreenBuffer32(uint8* metaAddress);  // Inlined, defined below
-    static Bool IsScreenBuffer(uint8* metaAddress, uint32 size);
+    // offset is relative to the start of RAM
+    static Bool IsScreenBuffer(uint32 offset, uint32 size);  // Inlined, defined below
+    static uint64 GetScreenPages(uint32 bankOffset);         // Inlined, defined below
 
    private:
-    static void MarkRange(emuptr start, emuptr end, uint8 v);
-    static void UnmarkRange(emuptr start, emuptr end, uint8 v);
-    static void MarkUnmarkRange(emuptr start, emuptr end, uint8 andValue, uint8 orValue);
-
-    static std::set<emuptr> breakpoints;
-
-    enum {
-        kNoAppAccess = 0x0001,
-        kNoSystemAccess = 0x0002,
-        kNoMemMgrAccess = 0x0004,
-        kUnusedMeta1 = 0x0008,
-        kStackBuffer = 0x0010,   // Stack buffer; check to see if below-SP access is made.
-        kScreenBuffer = 0x0020,  // Screen buffer; update host screen if these bytes are changed.
-        kInstructionBreak = 0x0040,  // Halt CPU emulation and check to see why.
-        kDataBreak = 0x0080,         // Halt CPU emulation and check to see why.
-
-        kLowMemoryBits = kNoAppAccess | kNoSystemAccess | kNoMemMgrAccess,
-        kGlobalsBits = kNoAppAccess,
-        kMPTBits = kNoAppAccess,
-        kMemStructBits = kNoAppAccess | kNoSystemAccess,
-        kLowStackBits = kNoAppAccess | kNoSystemAccess | kNoMemMgrAccess,
-        kFreeChunkBits = kNoAppAccess | kNoSystemAccess,
-        kUnlockedChunkBits = kNoAppAccess | kNoSystemAccess,
-        kScreenBits = kNoAppAccess | kScreenBuffer,
-        kUIObjectBits = kNoAppAccess,
-        kAccessBitMask = kNoAppAccess | kNoSystemAccess | kNoMemMgrAccess,
-        kFreeAccessBits = 0
-    };
-};
-
-// Macros to take a byte of bits and produce an
-// 8-bit, 16-bit, or 32-bit version of it.
-
-#define META_BITS_32(bits)                                                          \
-    (((uint32)(bits)) << 24) | (((uint32)(bits)) << 16) | (((uint32)(bits)) << 8) | \
-        (((uint32)(bits)))
-
-#define META_BITS_16(bits) (((uint16)(bits)) << 8) | (((uint16)(bits)))
-
-#define META_BITS_8(bits) (((uint8)(bits)))
-
-// Macros to fetch the appropriate 8-bit, 16-bit, or
-// 32-bit value from meta-memory.
-//
-// Fetch the values with byte operations in order to
-// support CPUs that don't allow, say, 16-bit fetches
-// on odd boundaries or 32-bit fetches on odd 16-bit
-// boundaries.
-
-#define META_VALUE_32(p)                                                   \
-    ((((uint32)((uint8*)p)[0]) << 24) | (((uint32)((uint8*)p)[1]) << 16) | \
-     (((uint32)((uint8*)p)[2]) << 8) | (((uint32)((uint8*)p)[3])))
+    static void MarkUnmarkScreen(emuptr begin, emuptr end, bool mark);
 
-#define META_VALUE_16(p) ((((uint16)((uint8*)p)[0]) << 8) | (((uint16)((uint8*)p)[1])))
-
-#define META_VALUE_8(p) (*(uint8*)p)
-
-inline Bool MetaMemory::IsScreenBuffer(uint8* metaAddress, uint32 size) {
-    if (size == 1) {
-        const uint8 kMask = META_BITS_8(kScreenBuffer);
-
-        return (META_VALUE_8(metaAddress) & kMask) != 0;
-    } else if (size == 2) {
-        const uint16 kMask = META_BITS_16(kScreenBuffer);
-
-        return (META_VALUE_16(metaAddress) & kMask) != 0;
-    } else if (size == 4) {
-        const uint32 kMask = META_BITS_32(kScreenBuffer);
-
-        return (META_VALUE_32(metaAddress) & kMask) != 0;
-    }
-
-    const uint8 kMask = META_BITS_8(kScreenBuffer);
-
-    for (uint32 ii = 0; ii < size; ++ii) {
-        if (((*(uint8*)(metaAddress + ii)) & kMask) != 0) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-inline Bool MetaMemory::IsScreenBuffer8(uint8* metaAddress) {
-    const uint8 kMask = META_BITS_8(kScreenBuffer);
-
-    return (META_VALUE_8(metaAddress) & kMask) != 0;
-}
+    static thread_local std::set<emuptr> breakpoints;
+    static thread_local uint64* screenPages;
+};
 
-inline Bool MetaMemory::IsScreenBuffer16(uint8* metaAddress) {
-    const uint16 kMask = META_BITS_16(kScreenBuffer);
+inline Bool MetaMemory::IsScreenBuffer(uint32 offset, uint32 size) {
+    const uint32 last = offset + size - 1;
 
-    return (META_VALUE_16(metaAddress) & kMask) != 0;
+    return ((screenPages[offset >> 16] >> ((offset >> 10) & 0x3f)) |
+            (screenPages[last >> 16] >> ((last >> 10) & 0x3f))) &
+           1;
 }
 
-inline Bool MetaMemory::IsScreenBuffer32(uint8* metaAddress) {
-    const uint32 kMask = META_BITS_32(kScreenBuffer);
-
-    return (META_VALUE_32(metaAddress) & kMask) != 0;
+inline uint64 MetaMemory::GetScreenPages(uint32 bankOffset) {
+    return screenPages[bankOffset >> 16];
 }
 
 inline Bool MetaMemory::IsCPUBreak(emuptr opcodeLocation) {
     return breakpoints.find(opcodeLocation) != breakpoints.end();
 }
 
-// ---------------------------------------------------------------------------
-//		� MetaMemory::SetAccess
-// ---------------------------------------------------------------------------
-
-inline void MetaMemory::SetAccess(emuptr begin, emuptr end, uint8 bits) {
-    MarkUnmarkRange(begin, end, ~0, bits);
-}
-
-inline void MetaMemory::MarkScreen(emuptr begin, emuptr end) { SetAccess(begin, end, kScreenBits); }
-
-// ---------------------------------------------------------------------------
-//		� MetaMemory::UnmarkScreen
-// ---------------------------------------------------------------------------
-
-inline void MetaMemory::UnmarkScreen(emuptr begin, emuptr end) {
-    UnmarkRange(begin, end, kScreenBuffer);
-}
-
-// ---------------------------------------------------------------------------
-//		� MetaMemory::MarkInstructionBreak
-// ---------------------------------------------------------------------------
-
-inline void MetaMemory::MarkInstructionBreak(emuptr opcodeLocation) {
-    breakpoints.insert(opcodeLocation);
-}
-
-// ---------------------------------------------------------------------------
-//		� MetaMemory::UnmarkInstructionBreak
-// ---------------------------------------------------------------------------
-
-inline void MetaMemory::UnmarkInstructionBreak(emuptr opcodeLocation) {
-    breakpoints.erase(opcodeLocation);
-}
-
 #endif  // _METAMEMORY_H_
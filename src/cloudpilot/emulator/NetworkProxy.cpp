@@ -70,7 +70,7 @@ namespace {
     constexpr size_t REQUEST_STATIC_SIZE = 128;
     constexpr uint16 VALID_FLAGS = netIOFlagOutOfBand | netIOFlagPeek | netIOFlagDontRoute;
 
-    NetworkProxy networkProxy;
+    thread_local NetworkProxy networkProxy;
 
     bool serializeAddress(const NetSocketAddrType* sockAddr, Address& address) {
         if (sockAddr->family != netSocketAddrINET) return false;
@@ -166,7 +166,7 @@ namespace {
     }
 }  // namespace
 
-NetworkProxy& gNetworkProxy{networkProxy};
+thread_local NetworkProxy& gNetworkProxy{networkProxy};
 
 void NetworkProxy::Reset() {
     if (this->openCount > 0) {
@@ -151,6 +151,6 @@ class NetworkProxy {
     NetworkProxy& operator=(NetworkProxy&&) = delete;
 };
 
-extern NetworkProxy& gNetworkProxy;
+extern thread_local NetworkProxy& gNetworkProxy;
 
 #endif  // _NETWORK_PROXY_H_
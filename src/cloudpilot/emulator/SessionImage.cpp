@@ -1,6 +1,7 @@
 #include "SessionImage.h"
 
 #include "miniz.h"
+#include "session/session_delta.h"
 
 namespace {
     constexpr uint32 MAGIC = 0x20150103;
@@ -40,6 +41,7 @@ void* SessionImage::GetRomImage() const { return romImage; }
 size_t SessionImage::GetRomImageSize() const { return romSize; }
 
 SessionImage& SessionImage::SetRomImage(void* image, size_t size) {
+    ownsImages = false;
     romImage = image;
     romSize = size;
 
@@ -51,6 +53,7 @@ void* SessionImage::GetMemoryImage() const { return ramImage; }
 size_t SessionImage::GetMemoryImageSize() const { return ramSize; }
 
 SessionImage& SessionImage::SetMemoryImage(void* image, size_t size) {
+    ownsImages = false;
     ramImage = image;
     ramSize = size;
 
@@ -200,6 +203,9 @@ size_t SessionImage::GetSerializedImageSize() const { return serizalizedImageSiz
 bool SessionImage::Deserialize(void* _buffer, size_t size) {
     uint8* buffer = static_cast<uint8*>(_buffer);
 
+    ownsImages = false;
+    deltaState.reset();
+
     if (size < 16) return false;
     if (get32(buffer) != MAGIC) return false;
 
@@ -258,6 +264,36 @@ bool SessionImage::Deserialize(void* _buffer, size_t size) {
 
     savestate = savestateSize > 0 ? buffer : nullptr;
 
+    // Older images are not compressed and point into the caller's buffer
+    ownsImages = version > 2;
+
+    return true;
+}
+
+bool SessionImage::ApplyDelta(const SessionDelta& delta) {
+    // Deltas are recorded against the V4 memory layout
+    if (!ownsImages || version != VERSION) return false;
+
+    if ((delta.GetPageCount(SessionDelta::Image::nor) > 0 &&
+         delta.GetImageSize(SessionDelta::Image::nor) != romSize) ||
+        (delta.GetPageCount(SessionDelta::Image::memory) > 0 &&
+         delta.GetImageSize(SessionDelta::Image::memory) != ramSize) ||
+        delta.GetPageCount(SessionDelta::Image::nand) > 0)
+        return false;
+
+    delta.Apply(SessionDelta::Image::nor, romSize, romImage);
+    delta.Apply(SessionDelta::Image::memory, ramSize, ramImage);
+
+    metadataSize = delta.GetMetadataSize();
+    savestateSize = delta.GetSavestateSize();
+    deltaState = make_unique<uint8[]>(metadataSize + savestateSize);
+
+    metadata = metadataSize > 0 ? deltaState.get() : nullptr;
+    if (metadata) memcpy(metadata, delta.GetMetadata(), metadataSize);
+
+    savestate = savestateSize > 0 ? deltaState.get() + metadataSize : nullptr;
+    if (savestate) memcpy(savestate, delta.GetSavestate(), savestateSize);
+
     return true;
 }
 
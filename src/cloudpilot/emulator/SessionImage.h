@@ -7,6 +7,7 @@
 #include "EmCommon.h"
 
 struct mz_stream_s;
+class SessionDelta;
 
 class SessionImage {
    public:
@@ -41,6 +42,10 @@ class SessionImage {
 
     bool Deserialize(void* buffer, size_t size);
 
+    // Applies a delta to a deserialized image. Metadata and savestate are replaced, so
+    // serializing the result compacts base and delta into a new full image.
+    bool ApplyDelta(const SessionDelta& delta);
+
    private:
     bool DeserializeLegacyImage(void* buffer, size_t size);
 
@@ -58,6 +63,8 @@ class SessionImage {
 
     unique_ptr<uint8[]> serializationBuffer;
     unique_ptr<uint8[]> deserializationBuffer;
+    unique_ptr<uint8[]> deltaState;
+    bool ownsImages{false};
 };
 
 #endif  // _SESSION_IMAGE_
@@ -14,7 +14,7 @@
 
 namespace {
     constexpr uint32 RTS_SEARCH_LIMIT = 0x400;
-    bool wroteRam{false};
+    thread_local bool wroteRam{false};
 
     bool inRom(emuptr ptr) {
         emuptr romStart = EmBankROM::GetMemoryStart();
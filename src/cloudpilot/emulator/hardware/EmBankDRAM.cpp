@@ -32,23 +32,23 @@
 namespace {
     constexpr uint32 kMemoryStart = 0x00000000;
 
-    uint32 dynamicHeapSize;
+    thread_local uint32 dynamicHeapSize;
 
     EmAddressBank addressBank = {EmBankDRAM::GetLong,        EmBankDRAM::GetWord,
                                  EmBankDRAM::GetByte,        EmBankDRAM::SetLong,
                                  EmBankDRAM::SetWord,        EmBankDRAM::SetByte,
                                  EmBankDRAM::GetRealAddress, EmBankDRAM::ValidAddress,
-                                 EmBankDRAM::GetMetaAddress, EmBankDRAM::AddOpcodeCycles};
+                                 EmBankDRAM::AddOpcodeCycles, EmBankDRAM::GetHostBank};
 
     EmAddressBank addressBankDisabled = {EmBankDRAM::GetDummy,       EmBankDRAM::GetDummy,
                                          EmBankDRAM::GetDummy,       EmBankDRAM::SetDummy,
                                          EmBankDRAM::SetDummy,       EmBankDRAM::SetDummy,
                                          EmBankDRAM::GetRealAddress, EmBankDRAM::ValidAddress,
-                                         EmBankDRAM::GetMetaAddress, EmBankDRAM::AddOpcodeCycles};
+                                         EmBankDRAM::AddOpcodeCycles};
 
-    uint32 ramSize;
-    uint8* ram;
-    uint8* dirtyPages;
+    thread_local uint32 ramSize;
+    thread_local uint8* ram;
+    thread_local uint8* dirtyPages;
 
     inline int InlineValidAddress(emuptr address, size_t size) {
         int result = (address + size) <= ramSize;
@@ -58,10 +58,6 @@ namespace {
 
     inline uint8* InlineGetRealAddress(emuptr address) { return (uint8*)&(ram[address]); }
 
-    inline uint8* InlineGetMetaAddress(emuptr address) {
-        return (uint8*)&(gRAM_MetaMemory[address]);
-    }
-
     inline void markDirty(emuptr address) {
         dirtyPages[address >> 13] |= (1 << ((address >> 10) & 0x07));
     }
@@ -221,7 +217,7 @@ void EmBankDRAM::SetLong(emuptr address, uint32 value) {
     markDirty(address);
     markDirty(address + 2);
 
-    if (MetaMemory::IsScreenBuffer32(InlineGetMetaAddress(address)))
+    if (MetaMemory::IsScreenBuffer(address, 4))
         gSystemState.MarkScreenDirty(address, address + 4);
 }
 
@@ -244,7 +240,7 @@ void EmBankDRAM::SetWord(emuptr address, uint32 value) {
 
     markDirty(address);
 
-    if (MetaMemory::IsScreenBuffer16(InlineGetMetaAddress(address)))
+    if (MetaMemory::IsScreenBuffer(address, 2))
         gSystemState.MarkScreenDirty(address, address + 2);
 }
 
@@ -262,7 +258,7 @@ void EmBankDRAM::SetByte(emuptr address, uint32 value) {
 
     markDirty(address);
 
-    if (MetaMemory::IsScreenBuffer8(InlineGetMetaAddress(address)))
+    if (MetaMemory::IsScreenBuffer(address, 1))
         gSystemState.MarkScreenDirty(address, address);
 }
 
@@ -287,16 +283,26 @@ int EmBankDRAM::ValidAddress(emuptr address, uint32 size) {
 uint8* EmBankDRAM::GetRealAddress(emuptr address) { return InlineGetRealAddress(address); }
 
 // ---------------------------------------------------------------------------
-//		� EmBankDRAM::GetMetaAddress
+//		� EmBankDRAM::AddOpcodeCycles
 // ---------------------------------------------------------------------------
 
-uint8* EmBankDRAM::GetMetaAddress(emuptr address) { return InlineGetMetaAddress(address); }
+void EmBankDRAM::AddOpcodeCycles(void) {}
 
 // ---------------------------------------------------------------------------
-//		� EmBankDRAM::AddOpcodeCycles
+//		� EmBankDRAM::GetHostBank
 // ---------------------------------------------------------------------------
+// Writes can bypass the functions above if the whole bank is part of the
+// dynamic heap.  Pages that are part of the screen buffer still go through
+// SetLong & co. so that the screen is marked dirty.
 
-void EmBankDRAM::AddOpcodeCycles(void) {}
+void EmBankDRAM::GetHostBank(emuptr bankStart, EmHostBank* hostBank) {
+    hostBank->memory = InlineGetRealAddress(bankStart);
+
+    if (bankStart + 0xFFFF > dynamicHeapSize) return;
+
+    hostBank->dirtyPages = dirtyPages + (bankStart >> 13);
+    hostBank->slowPages = MetaMemory::GetScreenPages(bankStart);
+}
 
 // ---------------------------------------------------------------------------
 //		� EmBankDRAM::AddressError
@@ -33,8 +33,8 @@ class EmBankDRAM {
     static void SetDummy(emuptr address, uint32 value);
     static int ValidAddress(emuptr address, uint32 size);
     static uint8* GetRealAddress(emuptr address);
-    static uint8* GetMetaAddress(emuptr address);
     static void AddOpcodeCycles(void);
+    static void GetHostBank(emuptr bankStart, struct EmHostBank* hostBank);
 
    private:
     static void AddressError(emuptr address, long size, Bool forRead);
@@ -23,13 +23,12 @@
 #include "MemoryRegion.h"
 
 namespace {
-    uint32 ramSize;
+    thread_local uint32 ramSize;
 
     EmAddressBank addressBank = {
         EmBankDummy::GetLong,        EmBankDummy::GetWord,      EmBankDummy::GetByte,
         EmBankDummy::SetLong,        EmBankDummy::SetWord,      EmBankDummy::SetByte,
-        EmBankDummy::GetRealAddress, EmBankDummy::ValidAddress, nullptr,
-        EmBankDummy::AddOpcodeCycles};
+        EmBankDummy::GetRealAddress, EmBankDummy::ValidAddress, EmBankDummy::AddOpcodeCycles};
 
     inline Bool HackForHwrGetRAMSize(emuptr address) {
         //	if ((address & 0xFF000000) == EmBankSRAM::GetMemoryStart ())
@@ -204,16 +203,6 @@ int EmBankDummy::ValidAddress(emuptr, uint32) {
 
 uint8* EmBankDummy::GetRealAddress(emuptr address) { return nullptr; }
 
-// ---------------------------------------------------------------------------
-//		� EmBankDummy::GetMetaAddress
-// ---------------------------------------------------------------------------
-
-uint8* EmBankDummy::GetMetaAddress(emuptr address) {
-    UNUSED_PARAM(address)
-
-    return nullptr;
-}
-
 // ---------------------------------------------------------------------------
 //		� EmBankDummy::AddOpcodeCycles
 // ---------------------------------------------------------------------------
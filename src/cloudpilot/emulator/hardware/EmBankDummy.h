@@ -32,7 +32,6 @@ class EmBankDummy {
     static void SetByte(emuptr address, uint32 value);
     static int ValidAddress(emuptr address, uint32 size);
     static uint8* GetRealAddress(emuptr address);
-    static uint8* GetMetaAddress(emuptr address);
     static void AddOpcodeCycles(void);
 
    private:
@@ -27,8 +27,7 @@
 static EmAddressBank gAddressBank = {
     EmBankMapped::GetLong,        EmBankMapped::GetWord,      EmBankMapped::GetByte,
     EmBankMapped::SetLong,        EmBankMapped::SetWord,      EmBankMapped::SetByte,
-    EmBankMapped::GetRealAddress, EmBankMapped::ValidAddress, nullptr,
-    EmBankMapped::AddOpcodeCycles};
+    EmBankMapped::GetRealAddress, EmBankMapped::ValidAddress, EmBankMapped::AddOpcodeCycles};
 
 struct MapRange {
     Bool Contains(const void* addr) {
@@ -51,8 +50,8 @@ struct MapRange {
 };
 typedef vector<MapRange> MapRangeList;
 
-static MapRangeList gMappedRanges;
-static MapRangeList::iterator gLastIter;
+static thread_local MapRangeList gMappedRanges;
+static thread_local MapRangeList::iterator gLastIter;
 
 // Map in blocks starting at this address.  I used to have it way out of
 // the way at 0x60000000.  However, there's a check in SysGetAppInfo to
@@ -39,7 +39,7 @@ class Card {
 
 // static member initialization
 
-emuptr EmBankROM::gROMMemoryStart = kDefaultROMMemoryStart;
+__thread emuptr EmBankROM::gROMMemoryStart = kDefaultROMMemoryStart;
 
 // ===========================================================================
 //		� ROM Bank Accessors
@@ -50,14 +50,14 @@ emuptr EmBankROM::gROMMemoryStart = kDefaultROMMemoryStart;
 static EmAddressBank gROMAddressBank = {
     EmBankROM::GetLong,        EmBankROM::GetWord,      EmBankROM::GetByte,
     EmBankROM::SetLong,        EmBankROM::SetWord,      EmBankROM::SetByte,
-    EmBankROM::GetRealAddress, EmBankROM::ValidAddress, nullptr,
-    EmBankROM::AddOpcodeCycles};
+    EmBankROM::GetRealAddress, EmBankROM::ValidAddress, EmBankROM::AddOpcodeCycles,
+    EmBankROM::GetHostBank};
 
-static uint32 gROMBank_Size;
-static uint32 gManagedROMSize;
-static uint32 gROMImage_Size;
-static uint32 gROMBank_Mask;
-static uint8* gROM_Memory;
+static thread_local uint32 gROMBank_Size;
+static thread_local uint32 gManagedROMSize;
+static thread_local uint32 gROMImage_Size;
+static thread_local uint32 gROMBank_Mask;
+static thread_local uint8* gROM_Memory;
 
 /***********************************************************************
  *
@@ -118,7 +118,11 @@ void EmBankROM::Reset(Bool /*hardwareReset*/) {}
  *
  ***********************************************************************/
 
-void EmBankROM::Dispose(void) { Platform::DisposeMemory(gROM_Memory); }
+void EmBankROM::Dispose(void) {
+    // Allocated with new[] by LoadROM
+    delete[] gROM_Memory;
+    gROM_Memory = nullptr;
+}
 
 /***********************************************************************
  *
@@ -264,6 +268,18 @@ uint8* EmBankROM::GetRealAddress(emuptr address) {
 
 void EmBankROM::AddOpcodeCycles(void) {}
 
+// ---------------------------------------------------------------------------
+//		� EmBankROM::GetHostBank
+// ---------------------------------------------------------------------------
+// The ROM is read only, and the part of the bank beyond the image is not
+// backed by any memory.
+
+void EmBankROM::GetHostBank(emuptr bankStart, EmHostBank* hostBank) {
+    const uint32 offset = bankStart & gROMBank_Mask;
+
+    if (offset + 0x10000 <= gROMImage_Size) hostBank->memory = gROM_Memory + offset;
+}
+
 // ---------------------------------------------------------------------------
 //		� EmBankROM::AddressError
 // ---------------------------------------------------------------------------
@@ -36,6 +36,7 @@ class EmBankROM {
     static int ValidAddress(emuptr address, uint32 size);
     static uint8* GetRealAddress(emuptr address);
     static void AddOpcodeCycles(void);
+    static void GetHostBank(emuptr bankStart, struct EmHostBank* hostBank);
 
     static emuptr GetMemoryStart(void) { return gROMMemoryStart; }
     static uint32 GetRomSize();
@@ -45,7 +46,7 @@ class EmBankROM {
     static void InvalidAccess(emuptr address, long size, Bool forRead);
     static bool LoadROM(size_t len, const uint8* buffer);
 
-    static emuptr gROMMemoryStart;
+    static __thread emuptr gROMMemoryStart;
 };
 
 #endif /* EmBankROM_h */
@@ -67,15 +67,14 @@ static EmAddressBank gAddressBank = {EmBankRegs::GetLong,
                                      EmBankRegs::SetByte,
                                      EmBankRegs::GetRealAddress,
                                      EmBankRegs::ValidAddress,
-                                     NULL,
                                      NULL};
 
-EmRegsList EmBankRegs::fgSubBanks;
-EmRegsList EmBankRegs::fgDisabledSubBanks;
+thread_local EmRegsList EmBankRegs::fgSubBanks;
+thread_local EmRegsList EmBankRegs::fgDisabledSubBanks;
 
-static EmRegs* gLastSubBank;
-static uint64 gLastStart;
-static uint32 gLastRange;
+static thread_local EmRegs* gLastSubBank;
+static thread_local uint64 gLastStart;
+static thread_local uint32 gLastRange;
 
 static void PrvSwitchBanks(EmRegsList& fromList, EmRegsList& toList, emuptr address);
 
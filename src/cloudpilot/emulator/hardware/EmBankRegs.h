@@ -51,8 +51,8 @@ class EmBankRegs {
     static void AddressError(emuptr address, long size, Bool forRead);
     static void InvalidAccess(emuptr address, long size, Bool forRead);
 
-    static EmRegsList fgSubBanks;
-    static EmRegsList fgDisabledSubBanks;
+    static thread_local EmRegsList fgSubBanks;
+    static thread_local EmRegsList fgDisabledSubBanks;
 
     friend class EmRegs;  // EmBankRegs::InvalidAccess
 };
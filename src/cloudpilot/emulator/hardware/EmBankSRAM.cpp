@@ -22,24 +22,23 @@
 #include "EmSystemState.h"
 #include "MemoryRegion.h"
 #include "MetaMemory.h"  // MetaMemory::
-#include "Platform.h"
 
 namespace {
-    uint32 ramSize;
-    uint8* dirtyPages;
-    uint8* ram;
+    thread_local uint32 ramSize;
+    thread_local uint8* dirtyPages;
+    thread_local uint8* ram;
 
     EmAddressBank gAddressBank = {EmBankSRAM::GetLong,        EmBankSRAM::GetWord,
                                   EmBankSRAM::GetByte,        EmBankSRAM::SetLong,
                                   EmBankSRAM::SetWord,        EmBankSRAM::SetByte,
                                   EmBankSRAM::GetRealAddress, EmBankSRAM::ValidAddress,
-                                  EmBankSRAM::GetMetaAddress, EmBankSRAM::AddOpcodeCycles};
+                                  EmBankSRAM::AddOpcodeCycles, EmBankSRAM::GetHostBank};
 
     EmAddressBank gAddressBankDisabled = {EmBankSRAM::GetDummy,       EmBankSRAM::GetDummy,
                                           EmBankSRAM::GetDummy,       EmBankSRAM::SetDummy,
                                           EmBankSRAM::SetDummy,       EmBankSRAM::SetDummy,
                                           EmBankSRAM::GetRealAddress, EmBankSRAM::ValidAddress,
-                                          EmBankSRAM::GetMetaAddress, EmBankSRAM::AddOpcodeCycles};
+                                          EmBankSRAM::AddOpcodeCycles};
 
     // Note: I'd've used hwrCardBase0 here, except that that
     // changes on different hardware. It's 0x10000000 in some
@@ -50,19 +49,14 @@ namespace {
     constexpr emuptr kMemoryStartVZ = 0x00000000;
     constexpr emuptr kMemoryStartSZ = 0x00000000;
 
-    inline uint8* InlineGetMetaAddress(emuptr address) {
-        return (uint8*)&(gRAM_MetaMemory[address]);
-    }
-
     inline void markDirty(emuptr address) {
         dirtyPages[address >> 13] |= (1 << ((address >> 10) & 0x07));
     }
 
 }  // namespace
 
-emuptr gMemoryStart;
-uint32 gRAMBank_Mask;
-uint8* gRAM_MetaMemory;
+__thread emuptr gMemoryStart;
+__thread uint32 gRAMBank_Mask;
 
 /***********************************************************************
  *
@@ -88,10 +82,8 @@ void EmBankSRAM::Initialize() {
     EmAssert(ram);
     EmAssert(dirtyPages);
 
-    EmAssert(gRAM_MetaMemory == NULL);
-
     gRAMBank_Mask = ramSize - 1;
-    gRAM_MetaMemory = (uint8*)Platform::AllocateMemoryClear(ramSize);
+    MetaMemory::Initialize();
 
     EmAssert(gSession);
 
@@ -123,7 +115,7 @@ void EmBankSRAM::Initialize() {
  *
  ***********************************************************************/
 
-void EmBankSRAM::Reset(Bool /*hardwareReset*/) { memset(gRAM_MetaMemory, 0, ramSize); }
+void EmBankSRAM::Reset(Bool /*hardwareReset*/) { MetaMemory::Reset(); }
 
 /***********************************************************************
  *
@@ -139,7 +131,7 @@ void EmBankSRAM::Reset(Bool /*hardwareReset*/) { memset(gRAM_MetaMemory, 0, ramS
  *
  ***********************************************************************/
 
-void EmBankSRAM::Dispose(void) { Platform::DisposeMemory(gRAM_MetaMemory); }
+void EmBankSRAM::Dispose(void) { MetaMemory::Dispose(); }
 
 /***********************************************************************
  *
@@ -232,15 +224,12 @@ void EmBankSRAM::SetLong(emuptr address, uint32 value) {
     emuptr phyAddress = address;
     phyAddress &= gRAMBank_Mask;
 
-    // uint8* metaAddress = InlineGetMetaAddress(phyAddress);
-    //	META_CHECK (metaAddress, address, SetLong, uint32, false);
-
     EmMemDoPut32(ram + phyAddress, value);
 
     markDirty(phyAddress);
     markDirty(phyAddress + 2);
 
-    if (MetaMemory::IsScreenBuffer32(InlineGetMetaAddress(phyAddress)))
+    if (MetaMemory::IsScreenBuffer(phyAddress, 4))
         gSystemState.MarkScreenDirty(address, address + 4);
 }
 
@@ -263,14 +252,11 @@ void EmBankSRAM::SetWord(emuptr address, uint32 value) {
     emuptr phyAddress = address;
     phyAddress &= gRAMBank_Mask;
 
-    // uint8* metaAddress = InlineGetMetaAddress(phyAddress);
-    //	META_CHECK (metaAddress, address, SetLong, uint16, false);
-
     EmMemDoPut16(ram + phyAddress, value);
 
     markDirty(phyAddress);
 
-    if (MetaMemory::IsScreenBuffer16(InlineGetMetaAddress(phyAddress)))
+    if (MetaMemory::IsScreenBuffer(phyAddress, 2))
         gSystemState.MarkScreenDirty(address, address + 2);
 }
 
@@ -286,14 +272,11 @@ void EmBankSRAM::SetByte(emuptr address, uint32 value) {
     emuptr phyAddress = address;
     phyAddress &= gRAMBank_Mask;
 
-    // uint8* metaAddress = InlineGetMetaAddress(phyAddress);
-    //	META_CHECK (metaAddress, address, SetLong, uint8, false);
-
     EmMemDoPut8(ram + phyAddress, value);
 
     markDirty(phyAddress);
 
-    if (MetaMemory::IsScreenBuffer8(InlineGetMetaAddress(phyAddress)))
+    if (MetaMemory::IsScreenBuffer(phyAddress, 1))
         gSystemState.MarkScreenDirty(address, address);
 }
 
@@ -324,18 +307,6 @@ uint8* EmBankSRAM::GetRealAddress(emuptr address) {
     return (uint8*)&(ram[address]);
 }
 
-// ---------------------------------------------------------------------------
-//		� EmBankSRAM::GetMetaAddress
-// ---------------------------------------------------------------------------
-
-uint8* EmBankSRAM::GetMetaAddress(emuptr address) {
-    // Strip the uppermost bit of the address.
-
-    address &= (ramSize - 1);
-
-    return (uint8*)&(gRAM_MetaMemory[address]);
-}
-
 // ---------------------------------------------------------------------------
 //		� EmBankSRAM::AddOpcodeCycles
 // ---------------------------------------------------------------------------
@@ -346,6 +317,21 @@ void EmBankSRAM::AddOpcodeCycles(void) {
 #endif
 }
 
+// ---------------------------------------------------------------------------
+//		� EmBankSRAM::GetHostBank
+// ---------------------------------------------------------------------------
+// Writes take the slow path while SRAM is write protected, and for pages that
+// are part of the screen buffer.
+
+void EmBankSRAM::GetHostBank(emuptr bankStart, EmHostBank* hostBank) {
+    emuptr phyAddress = bankStart & gRAMBank_Mask;
+
+    hostBank->memory = ram + phyAddress;
+    hostBank->dirtyPages = dirtyPages + (phyAddress >> 13);
+    hostBank->writeProtect = &gMemAccessFlags.fProtect_SRAMSet;
+    hostBank->slowPages = MetaMemory::GetScreenPages(phyAddress);
+}
+
 // ---------------------------------------------------------------------------
 //		� EmBankSRAM::AddressError
 // ---------------------------------------------------------------------------
@@ -16,11 +16,10 @@
 
 #include "EmCommon.h"
 
-extern emuptr gMemoryStart;
+extern __thread emuptr gMemoryStart;
 
 // These are also accessed by the DRAMBank functions.
-extern uint32 gRAMBank_Mask;
-extern uint8* gRAM_MetaMemory;
+extern __thread uint32 gRAMBank_Mask;
 
 class EmBankSRAM {
    public:
@@ -40,8 +39,8 @@ class EmBankSRAM {
     static void SetDummy(emuptr address, uint32 value);
     static int ValidAddress(emuptr address, uint32 size);
     static uint8* GetRealAddress(emuptr address);
-    static uint8* GetMetaAddress(emuptr address);
     static void AddOpcodeCycles(void);
+    static void GetHostBank(emuptr bankStart, struct EmHostBank* hostBank);
 
     static emuptr GetMemoryStart(void) { return gMemoryStart; }
 
@@ -15,7 +15,7 @@
 
 #include "EmCommon.h"
 
-EmCPU* gCPU;
+__thread EmCPU* gCPU;
 
 // ---------------------------------------------------------------------------
 //		� EmCPU::EmCPU
@@ -29,7 +29,7 @@ class SavestateLoader;
 class EmSession;
 
 class EmCPU;
-extern EmCPU* gCPU;
+extern __thread EmCPU* gCPU;
 
 class EmCPU {
    public:
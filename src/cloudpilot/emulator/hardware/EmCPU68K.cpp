@@ -18,6 +18,7 @@
 #endif
 
 #include <algorithm>  // find
+#include <mutex>      // call_once
 
 #include "Byteswapping.h"  // Canonical
 #include "Debugger.h"
@@ -48,6 +49,7 @@ constexpr uint32 SAVESTATE_VERSION = 1;
 // and avoid using the high bit just for safety.
 
 #define SPCFLAG_END_OF_CYCLE (0x40000000)
+#define SPCFLAG_END_OF_BLOCK (0x20000000)
 
 // Data needed by UAE.
 
@@ -64,12 +66,15 @@ cpuop_func* cpufunctbl_base;
 cpuop_func* cpufunctbl[65536];  // (normally in newcpu.c)
 #endif
 
-uint16 last_op_for_exception_3;    /* Opcode of faulting instruction */
-emuptr last_addr_for_exception_3;  /* PC at fault time */
-emuptr last_fault_for_exception_3; /* Address that generated the exception */
+// The CPU state is thread local: each emulator instance is confined to the thread
+// that created it.  The tables above are shared and immutable once initialized.
 
-struct regstruct regs;        // (normally in newcpu.c)
-struct flag_struct regflags;  // (normally in support.c)
+__thread uint16 last_op_for_exception_3;    /* Opcode of faulting instruction */
+__thread emuptr last_addr_for_exception_3;  /* PC at fault time */
+__thread emuptr last_fault_for_exception_3; /* Address that generated the exception */
+
+__thread struct regstruct regs;        // (normally in newcpu.c)
+__thread struct flag_struct regflags;  // (normally in support.c)
 
 // These variables should strictly be in a sub-system that implements
 // the stack overflow checking, etc.  However, for performance reasons,
@@ -78,10 +83,10 @@ struct flag_struct regflags;  // (normally in support.c)
 //
 // Similar comments for the CheckKernelStack function.
 
-uae_u32 gStackHigh;
-uae_u32 gStackLowWarn;
-uae_u32 gStackLow;
-uae_u32 gKernelStackOverflowed;
+__thread uae_u32 gStackHigh;
+__thread uae_u32 gStackLowWarn;
+__thread uae_u32 gStackLow;
+__thread uae_u32 gKernelStackOverflowed;
 
 // Definitions of the stack frames used in EmCPU68K::ProcessException.
 
@@ -102,7 +107,33 @@ struct ExceptionStackFrame2 {
 
 #include "PalmPackPop.h"
 
-EmCPU68K* gCPU68K;
+__thread EmCPU68K* gCPU68K;
+
+// Execute runs threaded code: for each 64k bank that is backed by plain host
+// memory we keep a table of predecoded instructions (UAE handler and opcode)
+// that is populated as code runs.  Entries are validated against memory on
+// each use, so writes to code need no bookkeeping.  CPU breakpoints are folded
+// into the entries, so the breakpoint set and the suspend state only need to
+// be consulted at block boundaries (i.e. when spcflags are raised).
+
+namespace {
+    constexpr uint32 kDecodedBankSize = 0x10000;
+    constexpr size_t kMaxDecodedBanks = 16;
+
+    constexpr uint16 kDecodedBreak = 0x0001;
+}  // namespace
+
+struct EmCPU68K::DecodedInstruction {
+    cpuop_func* handler;  // NULL if not decoded
+    uint16 opcode;
+    uint16 flags;
+};
+
+struct EmCPU68K::DecodedBank {
+    uint32 index;
+    uint8* memory;  // The host memory the instructions were decoded from
+    DecodedInstruction instructions[kDecodedBankSize / 2];
+};
 
 // ---------------------------------------------------------------------------
 //		� EmCPU68K::Cycle
@@ -212,7 +243,8 @@ EmCPU68K::EmCPU68K(EmSession* session)
     : EmCPU(session),
       fLastTraceAddress(EmMemNULL),
       //	fExceptionHandlers (),
-      fHookJSR_Ind()
+      fHookJSR_Ind(),
+      fDecodedBanks(make_unique<DecodedBank*[]>(65536))
 #if REGISTER_HISTORY
       ,
       fRegHistoryIndex(0)
@@ -291,6 +323,8 @@ void EmCPU68K::Reset(Bool hardwareReset) {
         regs.fpcr = regs.fpsr = regs.fpiar = 0;
     }
 
+    this->FlushDecodedInstructions();
+
     Memory::CheckNewPC(m68k_getpc());
 }
 
@@ -325,6 +359,7 @@ void EmCPU68K::Load(SavestateLoader<ChunkType>& loader) {
     DoSaveLoad(helper);
 
     SetRegisters(regs);
+    FlushDecodedInstructions();
 }
 
 template <typename T>
@@ -349,6 +384,91 @@ void EmCPU68K::DoSaveLoad(T& helper) {
 
 #pragma mark -
 
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::LookupDecodedInstruction
+// ---------------------------------------------------------------------------
+// Returns the predecoded instruction at the given address, or NULL if the
+// address is not in plain memory.
+
+inline const EmCPU68K::DecodedInstruction* EmCPU68K::LookupDecodedInstruction(emuptr address) {
+    const DecodedBank* bank = fDecodedBanks[EmMemBankIndex(address)];
+
+    if (bank && bank->memory == gEmMemHostBanks[EmMemBankIndex(address)].memory &&
+        (address & 1) == 0) {
+        const uint32 offset = address & (kDecodedBankSize - 1);
+        const DecodedInstruction& instruction = bank->instructions[offset >> 1];
+
+        if (instruction.handler && instruction.opcode == EmMemDoGet16(bank->memory + offset))
+            return &instruction;
+    }
+
+    return this->DecodeInstruction(address);
+}
+
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::DecodeInstruction
+// ---------------------------------------------------------------------------
+
+const EmCPU68K::DecodedInstruction* EmCPU68K::DecodeInstruction(emuptr address) {
+    // Odd addresses raise an address error in the bank functions.
+
+    if (address & 1) return NULL;
+
+    const uint32 index = EmMemBankIndex(address);
+    uint8* memory = gEmMemHostBanks[index].memory;
+
+    if (!memory) return NULL;
+    DecodedBank* bank = fDecodedBanks[index];
+
+    if (!bank) {
+        if (fDecodedBankPool.size() < kMaxDecodedBanks) {
+            fDecodedBankPool.push_back(make_unique<DecodedBank>());
+            bank = fDecodedBankPool.back().get();
+        } else {
+            bank = fDecodedBankPool[fNextDecodedBankVictim].get();
+            fNextDecodedBankVictim = (fNextDecodedBankVictim + 1) % kMaxDecodedBanks;
+
+            if (bank->memory) fDecodedBanks[bank->index] = NULL;
+        }
+
+        bank->index = index;
+        bank->memory = NULL;
+
+        fDecodedBanks[index] = bank;
+    }
+
+    if (bank->memory != memory) {
+        memset(bank->instructions, 0, sizeof(bank->instructions));
+
+        bank->memory = memory;
+    }
+
+    const uint32 offset = address & (kDecodedBankSize - 1);
+    DecodedInstruction& instruction = bank->instructions[offset >> 1];
+
+    instruction.opcode = EmMemDoGet16(bank->memory + offset);
+#ifdef __EMSCRIPTEN__
+    instruction.handler = (cpuop_func*)((long)cpufunctbl_base + instruction.opcode);
+#else
+    instruction.handler = cpufunctbl[instruction.opcode];
+#endif
+    instruction.flags = MetaMemory::IsCPUBreak(address) ? kDecodedBreak : 0;
+
+    return &instruction;
+}
+
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::FlushDecodedInstructions
+// ---------------------------------------------------------------------------
+
+void EmCPU68K::FlushDecodedInstructions(void) {
+    for (auto& bank : fDecodedBankPool) {
+        if (bank->memory) fDecodedBanks[bank->index] = NULL;
+
+        bank->memory = NULL;
+    }
+}
+
 // ---------------------------------------------------------------------------
 //		� EmCPU68K::Execute
 // ---------------------------------------------------------------------------
@@ -379,6 +499,8 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
 
     if (regs.stopped) goto StoppedLoop;
 
+    if (SuspendManager::IsSuspended() && !gSession->IsNested()) return fCurrentCycles;
+
     while (1) {
 #if REGISTER_HISTORY
         // -----------------------------------------------------------------------
@@ -395,39 +517,64 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
             fRegHistory[fRegHistoryIndex & (kRegHistorySize - 1)] = regs;
         }
 #endif
-        // -----------------------------------------------------------------------
-        // See if we need to halt CPU execution at this location.  We could need
-        // to do this for several reasons, including hitting soft breakpoints or
-        // needing to execute tailpatches.
-        // -----------------------------------------------------------------------
 
 #ifdef ENABLE_DEBUGGER
         gDebugger.NotificyPc(pc);
         if (gDebugger.IsStopped() && !gSession->IsNested()) break;
 #endif
 
-        if (MetaMemory::IsCPUBreak(m68k_getpc())) {
+        // =======================================================================
+        // Fetch the opcode.  Code that doesn't live in plain memory goes through
+        // the memory banks and the breakpoint set as usual.
+        // -----------------------------------------------------------------------
+
+        const DecodedInstruction* instruction;
+
+        instruction = this->LookupDecodedInstruction(pc);
+
+        // -----------------------------------------------------------------------
+        // See if we need to halt CPU execution at this location.  We could need
+        // to do this for several reasons, including hitting soft breakpoints or
+        // needing to execute tailpatches.
+        // -----------------------------------------------------------------------
+
+        if (instruction ? (instruction->flags & kDecodedBreak) : MetaMemory::IsCPUBreak(pc)) {
             session->HandleInstructionBreak();
-        }
 
-        if (SuspendManager::IsSuspended() && !gSession->IsNested()) break;
+            if (SuspendManager::IsSuspended() && !gSession->IsNested()) break;
+
+            instruction = this->LookupDecodedInstruction(pc);
+        }
 
         // =======================================================================
-        // Execute the opcode.
+        // Execute the opcode.  The handler may reenter Execute and recycle the
+        // decoded bank, so don't touch the instruction after the call.
         // -----------------------------------------------------------------------
 
         EmOpcode68K opcode;
 
-        opcode = EmMemGet16(pc);
+        if (instruction) {
+#ifdef ENABLE_DEBUGGER
+            DbgNotifyRead16(pc);
+#endif
+            opcode = instruction->opcode;
+#ifdef TRACE_FUNCTION_CALLS
+            traceFunctionCalls(opcode, pc);
+#endif
+            cycles = instruction->handler(opcode);
+        } else {
+            opcode = EmMemGet16(pc);
 #ifdef TRACE_FUNCTION_CALLS
-        traceFunctionCalls(opcode, pc);
+            traceFunctionCalls(opcode, pc);
 #endif
 
 #ifdef __EMSCRIPTEN__
-        cycles = ((cpuop_func*)((long)cpufunctbl_base + opcode))(opcode);
+            cycles = ((cpuop_func*)((long)cpufunctbl_base + opcode))(opcode);
 #else
-        cycles = (cpufunctbl[opcode])(opcode);
+            cycles = (cpufunctbl[opcode])(opcode);
 #endif
+        }
+
         fCurrentCycles += cycles;
         // =======================================================================
 
@@ -441,11 +588,13 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
         // Handle special conditions.  NB: the code reached by calling
         // EmCPU68K::ExecuteSpecial used to be inline in this function.  Moving it
         // out (thus simplifying both EmCPU68K::Execute and EmCPU68K::ExecuteSpecial)
-        // sped up the CPU loop by 9%!
+        // sped up the CPU loop by 9%!  This is also the block boundary: the
+        // session may have been suspended while handling the spcflags.
         // -----------------------------------------------------------------------
 
         if (spcflags || regs.stopped) {
             if (this->ExecuteSpecial(maxCycles)) break;
+            if (SuspendManager::IsSuspended() && !gSession->IsNested()) break;
         }
 
         if (fCurrentCycles >= maxCycles) break;
@@ -466,6 +615,8 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
 Bool EmCPU68K::ExecuteSpecial(uint32 maxCycles) {
     EmAssert(fSession);
 
+    regs.spcflags &= ~SPCFLAG_END_OF_BLOCK;
+
     // Return stopped, tracing, interrupts, reset when calling into PalmOS
     if (fSession->IsNested()) return this->CheckForBreak();
     if (SuspendManager::IsSuspended()) return true;
@@ -583,6 +734,22 @@ void EmCPU68K::CycleSlowly(Bool sleeping) { EmHAL::CycleSlowly(sleeping); }
 
 void EmCPU68K::CheckAfterCycle(void) { regs.spcflags |= SPCFLAG_END_OF_CYCLE; }
 
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::EndBlock
+// ---------------------------------------------------------------------------
+
+void EmCPU68K::EndBlock(void) { regs.spcflags |= SPCFLAG_END_OF_BLOCK; }
+
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::InvalidateDecodedInstruction
+// ---------------------------------------------------------------------------
+
+void EmCPU68K::InvalidateDecodedInstruction(emuptr address) {
+    DecodedBank* bank = fDecodedBanks[EmMemBankIndex(address)];
+
+    if (bank) bank->instructions[(address & (kDecodedBankSize - 1)) >> 1].handler = NULL;
+}
+
 // ---------------------------------------------------------------------------
 //		� EmCPU68K::GetPC
 // ---------------------------------------------------------------------------
@@ -1135,15 +1302,20 @@ void EmCPU68K::AddressError(emuptr address, long size, Bool forRead) {
 // ---------------------------------------------------------------------------
 
 void EmCPU68K::InitializeUAETables(void) {
-    static int initialized;
-
     // All of the stuff in this function needs to be done only once;
     // it doesn't need to be executed every time we create a new CPU.
+    // Instances may be created concurrently on different threads.
+
+    static once_flag initialized;
 
-    if (initialized) return;
+    call_once(initialized, InitializeUAETablesOnce);
+}
 
-    initialized = true;
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::InitializeUAETablesOnce
+// ---------------------------------------------------------------------------
 
+void EmCPU68K::InitializeUAETablesOnce(void) {
     // Initialize some CPU-related tables
     // (This initialization code is taken from init_m68k in newcpu.c)
 
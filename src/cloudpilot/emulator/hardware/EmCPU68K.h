@@ -14,6 +14,7 @@
 #ifndef EmCPU68K_h
 #define EmCPU68K_h
 
+#include <memory>  // unique_ptr
 #include <vector>  // vector
 
 #include "EmCPU.h"  // EmCPU
@@ -182,7 +183,7 @@ typedef vector<Hook68KNewPC> Hook68KNewPCList;
 typedef vector<Hook68KNewSP> Hook68KNewSPList;
 
 class EmCPU68K;
-extern EmCPU68K* gCPU68K;
+extern __thread EmCPU68K* gCPU68K;
 
 // These variables should strictly be in a sub-system that implements
 // the stack overflow checking, etc.  However, for performance reasons,
@@ -228,6 +229,17 @@ class EmCPU68K : public EmCPU {
     virtual uint32 Execute(uint32 maxCycles);
     virtual void CheckAfterCycle(void);
 
+    // Make Execute leave the current block before the next instruction, so
+    // that it rechecks the state it only polls at block boundaries (i.e.
+    // whether the session is suspended).
+
+    void EndBlock(void);
+
+    // Drop the predecoded instruction at the given address.  Called when the
+    // breakpoint at that address is set or cleared.
+
+    void InvalidateDecodedInstruction(emuptr);
+
     // Low-level access to CPU state.
 
     virtual emuptr GetPC(void);
@@ -270,15 +282,23 @@ class EmCPU68K : public EmCPU {
     void AddressError(emuptr address, long size, Bool forRead);
 
    private:
+    struct DecodedInstruction;
+    struct DecodedBank;
+
     Bool ExecuteSpecial(uint32 maxCycles);
     Bool ExecuteStoppedLoop(uint32 maxCycles);
 
+    inline const DecodedInstruction* LookupDecodedInstruction(emuptr address);
+    const DecodedInstruction* DecodeInstruction(emuptr address);
+    void FlushDecodedInstructions(void);
+
     void CycleSlowly(Bool sleeping);
     Bool CheckForBreak(void);
 
     void ProcessInterrupt(int32 interrupt);
 
     void InitializeUAETables(void);
+    static void InitializeUAETablesOnce(void);
 
     template <typename T>
     void DoSave(T& savestate);
@@ -293,6 +313,10 @@ class EmCPU68K : public EmCPU {
     uint32 fCurrentCycles{0};
     Bool isSettingUpExceptionFrame{false};
 
+    unique_ptr<DecodedBank*[]> fDecodedBanks;
+    vector<unique_ptr<DecodedBank>> fDecodedBankPool;
+    size_t fNextDecodedBankVictim{0};
+
 #if REGISTER_HISTORY
     #define kRegHistorySize 512
     long fRegHistoryIndex;
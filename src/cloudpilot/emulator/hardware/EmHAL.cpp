@@ -18,7 +18,7 @@
 #include "EmTransportSerial.h"
 #include "Logging.h"
 
-EmHALHandler* EmHAL::fgRootHandler;
+__thread EmHALHandler* EmHAL::fgRootHandler;
 
 #define PRINTF \
     if (!0)    \
@@ -39,11 +39,11 @@ EmHALHandler* EmHAL::fgRootHandler;
  *
  ***********************************************************************/
 
-EmEvent<> EmHAL::onSystemClockChange{};
-EmEvent<double, double> EmHAL::onPwmChange{};
-EmEvent<> EmHAL::onDayRollover{};
+thread_local EmEvent<> EmHAL::onSystemClockChange{};
+thread_local EmEvent<double, double> EmHAL::onPwmChange{};
+thread_local EmEvent<> EmHAL::onDayRollover{};
 
-vector<EmHAL::CycleConsumer> EmHAL::cycleConsumers;
+thread_local vector<EmHAL::CycleConsumer> EmHAL::cycleConsumers;
 
 // ---------------------------------------------------------------------------
 //		� EmHAL::AddHandler
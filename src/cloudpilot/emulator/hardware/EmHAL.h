@@ -102,9 +102,9 @@ class EmHAL {
 
     static void SetUARTSync(bool sync);
 
-    static EmEvent<> onSystemClockChange;
-    static EmEvent<double, double> onPwmChange;
-    static EmEvent<> onDayRollover;
+    static thread_local EmEvent<> onSystemClockChange;
+    static thread_local EmEvent<double, double> onPwmChange;
+    static thread_local EmEvent<> onDayRollover;
 
    private:
     struct CycleConsumer {
@@ -114,9 +114,9 @@ class EmHAL {
 
    private:
     static EmHALHandler* GetRootHandler(void) { return fgRootHandler; }
-    static EmHALHandler* fgRootHandler;
+    static __thread EmHALHandler* fgRootHandler;
 
-    static vector<CycleConsumer> cycleConsumers;
+    static thread_local vector<CycleConsumer> cycleConsumers;
 };
 
 class EmHALHandler {
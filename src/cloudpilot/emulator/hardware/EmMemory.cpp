@@ -21,6 +21,7 @@
 #include "EmBankROM.h"     // EmBankROM::Initialize
 #include "EmBankRegs.h"    // EmBankRegs::Initialize
 #include "EmBankSRAM.h"    // EmBankSRAM::Initialize
+#include "CowImage.h"
 #include "EmCommon.h"
 #include "EmDevice.h"
 #include "EmSession.h"  // gSession, GetDevice
@@ -187,10 +188,11 @@
 
 #pragma mark Globals
 
-EmAddressBank* gEmMemBanks[65536];  // (normally defined in memory.c)
+__thread EmAddressBank** gEmMemBanks;  // (normally defined in memory.c)
+__thread EmHostBank* gEmMemHostBanks;
 
-Bool gPCInRAM;
-Bool gPCInROM;
+__thread Bool gPCInRAM;
+__thread Bool gPCInROM;
 
 /*
 uint32 gTotalMemorySize;
@@ -204,24 +206,48 @@ uint8* gFramebufferMemory;
 uint8* gFramebufferDirtyPages;
 */
 
-MemAccessFlags gMemAccessFlags = {
+__thread MemAccessFlags gMemAccessFlags = {
     true  // SRAM-set
 };
 
 MemAccessFlags kZeroMemAccessFlags;
 
 namespace {
-    unique_ptr<uint8[]> memory;
-    unique_ptr<uint8[]> dirtyPages;
-    MemoryRegionMap regionMap;
+    constexpr uint32 N_BANKS = 65536;
 
-    array<uint8*, N_MEMORY_REGIONS> memoryRegionPointers;
-    array<uint8*, N_MEMORY_REGIONS> dirtyPageRegionPointers;
+    thread_local unique_ptr<EmAddressBank*[]> memBanks;
+    thread_local unique_ptr<EmHostBank[]> hostBanks;
+
+    struct MemoryDeleter {
+        size_t size;
+
+        void operator()(uint8* memory) const { CowImage::Free(memory, size); }
+    };
+
+    thread_local unique_ptr<uint8[], MemoryDeleter> memory;
+    thread_local unique_ptr<uint8[]> dirtyPages;
+    thread_local MemoryRegionMap regionMap;
+
+    thread_local array<uint8*, N_MEMORY_REGIONS> memoryRegionPointers;
+    thread_local array<uint8*, N_MEMORY_REGIONS> dirtyPageRegionPointers;
 
     constexpr MemoryRegion ORDERED_REGIONS[N_MEMORY_REGIONS] = {
         MemoryRegion::ram,     MemoryRegion::framebuffer, MemoryRegion::memorystick,
         MemoryRegion::sonyDsp, MemoryRegion::eSRAM,       MemoryRegion::metadata};
 
+    uint32 GetDirtyPagesSize() {
+        return regionMap.GetTotalSize() / 8192 + (regionMap.GetTotalSize() % 8192 == 0 ? 0 : 1);
+    }
+
+    void UpdateHostBank(uint32 bankIndex) {
+        const EmAddressBank* bank = gEmMemBanks[bankIndex];
+        EmHostBank& hostBank = gEmMemHostBanks[bankIndex];
+
+        hostBank = EmHostBank();
+
+        if (bank && bank->hostbank) bank->hostbank(bankIndex << 16, &hostBank);
+    }
+
     uint32 get32(uint8* address) {
         return address[0] | (address[1] << 8) | (address[2] << 16) | (address[3] << 24);
     }
@@ -240,21 +266,61 @@ namespace {
 bool Memory::Initialize(const uint8* romBuffer, size_t romSize, EmDevice& device) {
     bool success = true;
 
-    regionMap = device.GetMemoryRegionMap();
+    if (!Memory::InitializeRegions(device.GetMemoryRegionMap())) return false;
+
+    // Initialize the valid memory banks.
+
+    EmBankDummy::Initialize();
+
+    // Initialize the Hardware registers memory bank.  Do this
+    // *before* initializing the other RAM banks so that we
+    // know how memory is laid out from the chip selects.
+
+    EmBankRegs::Initialize();
+
+    // Initialize EmBankDRAM after initializing the EmBankSRAM. The order is
+    // important for DragonballEZ. On Dragonball devices, DRAM is
+    // at 0x00000000, and SRAM is at 0x10000000. But on EZ devices,
+    // both start at 0x00000000. By calling EmBankDRAM::Initialize
+    // second, we allow it to overwrite the EmAddressBank handlers
+    // for the part of memory where they overlap.
+
+    EmBankSRAM::Initialize();
+    EmBankDRAM::Initialize();
+
+    success = success && EmBankROM::Initialize(romSize, romBuffer);
+
+    EmBankMapped::Initialize();
 
-    const uint32 dirtyPagesSize =
-        regionMap.GetTotalSize() / 8192 + (regionMap.GetTotalSize() % 8192 == 0 ? 0 : 1);
+    EmAssert(gSession);
 
-    memory = make_unique<uint8[]>(regionMap.GetTotalSize());
+    return success;
+}
+
+// ---------------------------------------------------------------------------
+//		� Memory::InitializeRegions
+// ---------------------------------------------------------------------------
+// Allocates the memory regions and clears the bank tables.  Called by
+// Initialize before any of the banks are installed.
+
+bool Memory::InitializeRegions(const MemoryRegionMap& regions) {
+    regionMap = regions;
+
+    const uint32 dirtyPagesSize = GetDirtyPagesSize();
+
+    // Page aligned and zeroed, so the memory can be replaced copy-on-write by LoadMemoryImage
+    memory = unique_ptr<uint8[], MemoryDeleter>(
+        static_cast<uint8*>(CowImage::Allocate(regionMap.GetTotalSize())),
+        MemoryDeleter{regionMap.GetTotalSize()});
     dirtyPages = make_unique<uint8[]>(dirtyPagesSize);
 
+    if (!memory) return false;
+
     uint8* regionPtr = memory.get();
     uint8* dirtyPagePtr = dirtyPages.get();
     uint32* toc = reinterpret_cast<uint32*>(regionPtr + regionMap.GetTotalSize() -
                                             regionMap.GetRegionSize(MemoryRegion::metadata));
 
-    memset(memory.get(), 0, regionMap.GetTotalSize());
-
     for (const auto region : ORDERED_REGIONS) {
         uint32 size = regionMap.GetRegionSize(region);
 
@@ -271,40 +337,22 @@ bool Memory::Initialize(const uint8* romBuffer, size_t romSize, EmDevice& device
 
     *toc = 0xffffffff;
 
-    memset(dirtyPages.get(), 0, dirtyPagesSize);
-    dirtyPages[dirtyPagesSize - 1] = 0x01;
+    ResetDirtyPages();
 
     // Clear everything out.
 
-    memset(gEmMemBanks, 0, sizeof(gEmMemBanks));
-
-    // Initialize the valid memory banks.
-
-    EmBankDummy::Initialize();
-
-    // Initialize the Hardware registers memory bank.  Do this
-    // *before* initializing the other RAM banks so that we
-    // know how memory is laid out from the chip selects.
-
-    EmBankRegs::Initialize();
-
-    // Initialize EmBankDRAM after initializing the EmBankSRAM. The order is
-    // important for DragonballEZ. On Dragonball devices, DRAM is
-    // at 0x00000000, and SRAM is at 0x10000000. But on EZ devices,
-    // both start at 0x00000000. By calling EmBankDRAM::Initialize
-    // second, we allow it to overwrite the EmAddressBank handlers
-    // for the part of memory where they overlap.
-
-    EmBankSRAM::Initialize();
-    EmBankDRAM::Initialize();
-
-    success = success && EmBankROM::Initialize(romSize, romBuffer);
+    if (!memBanks) {
+        memBanks = make_unique<EmAddressBank*[]>(N_BANKS);
+        hostBanks = make_unique<EmHostBank[]>(N_BANKS);
 
-    EmBankMapped::Initialize();
+        gEmMemBanks = memBanks.get();
+        gEmMemHostBanks = hostBanks.get();
+    }
 
-    EmAssert(gSession);
+    memset(gEmMemBanks, 0, N_BANKS * sizeof(*gEmMemBanks));
+    memset(gEmMemHostBanks, 0, N_BANKS * sizeof(*gEmMemHostBanks));
 
-    return success;
+    return true;
 }
 
 /***********************************************************************
@@ -384,6 +432,23 @@ void Memory::InitializeBanks(EmAddressBank& iBankInitializer, int32 iStartingBan
     for (int32 aBankIndex = iStartingBankIndex; aBankIndex < iStartingBankIndex + iNumberOfBanks;
          aBankIndex++) {
         gEmMemBanks[aBankIndex] = &iBankInitializer;
+        UpdateHostBank(aBankIndex);
+    }
+}
+
+// ---------------------------------------------------------------------------
+//		� Memory::UpdateHostBanks
+// ---------------------------------------------------------------------------
+// Refreshes the host memory description of all banks that overlap the given
+// range.  Needs to be called whenever the conditions that allow accesses to
+// bypass the bank functions change, for example when the screen buffer moves.
+
+void Memory::UpdateHostBanks(emuptr begin, emuptr end) {
+    if (end <= begin) return;
+
+    for (uint32 aBankIndex = EmMemBankIndex(begin); aBankIndex <= EmMemBankIndex(end - 1);
+         aBankIndex++) {
+        UpdateHostBank(aBankIndex);
     }
 }
 
@@ -462,6 +527,13 @@ uint8* Memory::GetTotalMemory() { return memory.get(); }
 
 uint8* Memory::GetTotalDirtyPages() { return dirtyPages.get(); }
 
+void Memory::ResetDirtyPages() {
+    const uint32 dirtyPagesSize = GetDirtyPagesSize();
+
+    memset(dirtyPages.get(), 0, dirtyPagesSize);
+    dirtyPages[dirtyPagesSize - 1] = 0x01;
+}
+
 bool Memory::LoadMemoryV1(void* ram, size_t size) {
     if (size != regionMap.GetRegionSize(MemoryRegion::ram)) return false;
 
@@ -527,13 +599,22 @@ bool Memory::LoadMemoryV4(void* memory, size_t size) {
     return true;
 }
 
+bool Memory::LoadMemoryImage(const CowImage& image) {
+    if (image.GetSize() != regionMap.GetTotalSize() || !image.InstantiateAt(memory.get()))
+        return false;
+
+    ResetDirtyPages();
+
+    return true;
+}
+
 #pragma mark -
 
 // ===========================================================================
 //		� CEnableFullAccess
 // ===========================================================================
 
-long CEnableFullAccess::fgAccessCount = 0;
+thread_local long CEnableFullAccess::fgAccessCount = 0;
 
 // ---------------------------------------------------------------------------
 //		� CEnableFullAccess::CEnableFullAccess
@@ -23,7 +23,7 @@
 #include "EmAssert.h"   // EmAssert
 #include "EmTypes.h"    // uint32, etc.
 #include "Switches.h"   // WORDSWAP_MEMORY, UNALIGNED_LONG_ACCESS
-#include "sysconfig.h"  // STATIC_INLINE
+#include "sysconfig.h"  // STATIC_INLINE, STATIC_FORCE_INLINE
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,12 +33,14 @@ extern "C" {
 //		� EmAddressBank
 // ---------------------------------------------------------------------------
 
+struct EmHostBank;
+
 typedef uint32 (*EmMemGetFunc)(emuptr);
 typedef void (*EmMemPutFunc)(emuptr, uint32);
 typedef uint8* (*EmMemTranslateFunc)(emuptr);
 typedef int (*EmMemCheckFunc)(emuptr, uint32);
 typedef void (*EmMemCycleFunc)(void);
-typedef uint8* (*EmMemTranslateMetaFunc)(emuptr);
+typedef void (*EmMemHostBankFunc)(emuptr, struct EmHostBank*);
 
 typedef struct EmAddressBank {
     /* These ones should be self-explanatory... */
@@ -57,13 +59,38 @@ typedef struct EmAddressBank {
      * This is used for example to translate bitplane pointers in custom.c */
     EmMemCheckFunc checkaddr;
 
-    EmMemTranslateMetaFunc xlatemetaaddr;
     EmMemCycleFunc EmMemAddOpcodeCycles;
+
+    /* Banks that are backed by plain host memory describe that memory in
+     * hostbank, so that the accessors below can bypass the bank functions.
+     * NULL for all other banks. */
+    EmMemHostBankFunc hostbank;
 } EmAddressBank;
 
+// ---------------------------------------------------------------------------
+//		� EmHostBank
+// ---------------------------------------------------------------------------
+// Host memory backing a 64k bank.  Reading through memory is equivalent to
+// calling the bank functions as long as memory is not NULL.  Writes can bypass
+// the bank functions if dirtyPages is not NULL, the 1k page is not flagged in
+// slowPages (for example because it is part of the screen buffer) and
+// writeProtect is either NULL or points to false.
+
+typedef struct EmHostBank {
+    uint8* memory;
+    uint8* dirtyPages;
+    uint64 slowPages;
+    const Bool* writeProtect;
+} EmHostBank;
+
+// The bank tables are allocated per thread by Memory::Initialize, so every thread can
+// host an emulator instance of its own.
+
+extern __thread EmHostBank* gEmMemHostBanks;
+
 #ifndef ECM_DYNAMIC_PATCH
 
-extern EmAddressBank* gEmMemBanks[65536];
+extern __thread EmAddressBank** gEmMemBanks;
 
 #else  // ECM_DYNAMIC_PATCH
 
@@ -95,15 +122,116 @@ extern EmAddressBank** gDynEmMemBanksP;
 #define EmMemCallGetFunc(func, addr) ((*EmMemGetBank(addr).func)(addr))
 #define EmMemCallPutFunc(func, addr, v) ((*EmMemGetBank(addr).func)(addr, v))
 
+// ---------------------------------------------------------------------------
+//		� EmMemDoGet32
+// ---------------------------------------------------------------------------
+
+STATIC_INLINE uint32 EmMemDoGet32(void* a) {
+#if WORDSWAP_MEMORY || !UNALIGNED_LONG_ACCESS
+    return (((uint32) * (((uint16*)a) + 0)) << 16) | (((uint32) * (((uint16*)a) + 1)));
+#else
+    return *(uint32*)a;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//		� EmMemDoGet16
+// ---------------------------------------------------------------------------
+
+STATIC_INLINE uint16 EmMemDoGet16(void* a) { return *(uint16*)a; }
+
+// ---------------------------------------------------------------------------
+//		� EmMemDoGet8
+// ---------------------------------------------------------------------------
+
+STATIC_INLINE uint8 EmMemDoGet8(void* a) {
+#if WORDSWAP_MEMORY
+    return *(uint8*)((long)a ^ 1);
+#else
+    return *(uint8*)a;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//		� EmMemDoPut32
+// ---------------------------------------------------------------------------
+
+STATIC_INLINE void EmMemDoPut32(void* a, uint32 v) {
+#if WORDSWAP_MEMORY || !UNALIGNED_LONG_ACCESS
+    *(((uint16*)a) + 0) = (uint16)(v >> 16);
+    *(((uint16*)a) + 1) = (uint16)(v);
+#else
+    *(uint32*)a = v;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//		� EmMemDoPut16
+// ---------------------------------------------------------------------------
+
+STATIC_INLINE void EmMemDoPut16(void* a, uint16 v) { *(uint16*)a = v; }
+
+// ---------------------------------------------------------------------------
+//		� EmMemDoPut8
+// ---------------------------------------------------------------------------
+
+STATIC_INLINE void EmMemDoPut8(void* a, uint8 v) {
+#if WORDSWAP_MEMORY
+    *(uint8*)((long)a ^ 1) = v;
+#else
+    *(uint8*)a = v;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//		� EmMemGetHostReadAddress
+// ---------------------------------------------------------------------------
+// Returns the host address of the given number of bytes if they can be read
+// without calling the bank functions, NULL otherwise.  Misaligned accesses and
+// accesses that span two banks always take the slow path.
+
+STATIC_FORCE_INLINE uint8* EmMemGetHostReadAddress(emuptr addr, uint32 size) {
+    const EmHostBank* hostBank = &gEmMemHostBanks[EmMemBankIndex(addr)];
+    const uint32 offset = addr & 0xFFFF;
+
+    if (!hostBank->memory) return NULL;
+    if (size > 1 && ((offset & 1) || offset + size > 0x10000)) return NULL;
+
+    return hostBank->memory + offset;
+}
+
+// ---------------------------------------------------------------------------
+//		� EmMemGetHostWriteAddress
+// ---------------------------------------------------------------------------
+// Same as EmMemGetHostReadAddress, but for writes, which also take the slow
+// path if they span two pages.  Marks the page dirty.
+
+STATIC_FORCE_INLINE uint8* EmMemGetHostWriteAddress(emuptr addr, uint32 size) {
+    const EmHostBank* hostBank = &gEmMemHostBanks[EmMemBankIndex(addr)];
+    const uint32 offset = addr & 0xFFFF;
+
+    if (!hostBank->dirtyPages) return NULL;
+    if (size > 1 && ((offset & 1) || (offset & 0x3FF) + size > 0x400)) return NULL;
+    if ((hostBank->slowPages >> (offset >> 10)) & 1) return NULL;
+    if (hostBank->writeProtect && *hostBank->writeProtect) return NULL;
+
+    hostBank->dirtyPages[offset >> 13] |= 1 << ((offset >> 10) & 0x07);
+
+    return hostBank->memory + offset;
+}
+
 // ---------------------------------------------------------------------------
 //		� EmMemGet32
 // ---------------------------------------------------------------------------
 
-STATIC_INLINE uint32 EmMemGet32(emuptr addr) {
+STATIC_FORCE_INLINE uint32 EmMemGet32(emuptr addr) {
 #ifdef ENABLE_DEBUGGER
     DbgNotifyRead32(addr);
 #endif
 
+    uint8* p = EmMemGetHostReadAddress(addr, 4);
+    if (p) return EmMemDoGet32(p);
+
     return EmMemCallGetFunc(lget, addr);
 }
 
@@ -111,11 +239,14 @@ STATIC_INLINE uint32 EmMemGet32(emuptr addr) {
 //		� EmMemGet16
 // ---------------------------------------------------------------------------
 
-STATIC_INLINE uint16 EmMemGet16(emuptr addr) {
+STATIC_FORCE_INLINE uint16 EmMemGet16(emuptr addr) {
 #ifdef ENABLE_DEBUGGER
     DbgNotifyRead16(addr);
 #endif
 
+    uint8* p = EmMemGetHostReadAddress(addr, 2);
+    if (p) return EmMemDoGet16(p);
+
     return EmMemCallGetFunc(wget, addr);
 }
 
@@ -123,11 +254,14 @@ STATIC_INLINE uint16 EmMemGet16(emuptr addr) {
 //		� EmMemGet8
 // ---------------------------------------------------------------------------
 
-STATIC_INLINE uint8 EmMemGet8(emuptr addr) {
+STATIC_FORCE_INLINE uint8 EmMemGet8(emuptr addr) {
 #ifdef ENABLE_DEBUGGER
     DbgNotifyRead8(addr);
 #endif
 
+    uint8* p = EmMemGetHostReadAddress(addr, 1);
+    if (p) return EmMemDoGet8(p);
+
     return EmMemCallGetFunc(bget, addr);
 }
 
@@ -135,11 +269,17 @@ STATIC_INLINE uint8 EmMemGet8(emuptr addr) {
 //		� EmMemPut32
 // ---------------------------------------------------------------------------
 
-STATIC_INLINE void EmMemPut32(emuptr addr, uint32 l) {
+STATIC_FORCE_INLINE void EmMemPut32(emuptr addr, uint32 l) {
 #ifdef ENABLE_DEBUGGER
     DbgNotifyWrite32(addr);
 #endif
 
+    uint8* p = EmMemGetHostWriteAddress(addr, 4);
+    if (p) {
+        EmMemDoPut32(p, l);
+        return;
+    }
+
     EmMemCallPutFunc(lput, addr, l);
 }
 
@@ -147,11 +287,17 @@ STATIC_INLINE void EmMemPut32(emuptr addr, uint32 l) {
 //		� EmMemPut16
 // ---------------------------------------------------------------------------
 
-STATIC_INLINE void EmMemPut16(emuptr addr, uint16 w) {
+STATIC_FORCE_INLINE void EmMemPut16(emuptr addr, uint16 w) {
 #ifdef ENABLE_DEBUGGER
     DbgNotifyWrite16(addr);
 #endif
 
+    uint8* p = EmMemGetHostWriteAddress(addr, 2);
+    if (p) {
+        EmMemDoPut16(p, w);
+        return;
+    }
+
     EmMemCallPutFunc(wput, addr, w);
 }
 
@@ -159,11 +305,17 @@ STATIC_INLINE void EmMemPut16(emuptr addr, uint16 w) {
 //		� EmMemPut8
 // ---------------------------------------------------------------------------
 
-STATIC_INLINE void EmMemPut8(emuptr addr, uint8 b) {
+STATIC_FORCE_INLINE void EmMemPut8(emuptr addr, uint8 b) {
 #ifdef ENABLE_DEBUGGER
     DbgNotifyWrite8(addr);
 #endif
 
+    uint8* p = EmMemGetHostWriteAddress(addr, 1);
+    if (p) {
+        EmMemDoPut8(p, b);
+        return;
+    }
+
     EmMemCallPutFunc(bput, addr, b);
 }
 
@@ -190,76 +342,6 @@ STATIC_INLINE void EmMemAddOpcodeCycles(emuptr addr) {
     EmMemGetBank(addr).EmMemAddOpcodeCycles();
 }
 
-// ---------------------------------------------------------------------------
-//		� EmMemGetMetaAddress
-// ---------------------------------------------------------------------------
-
-STATIC_INLINE uint8* EmMemGetMetaAddress(emuptr addr) {
-    EmAssert(EmMemGetBank(addr).xlatemetaaddr);
-    return EmMemGetBank(addr).xlatemetaaddr(addr);
-}
-
-// ---------------------------------------------------------------------------
-//		� EmMemDoGet32
-// ---------------------------------------------------------------------------
-
-STATIC_INLINE uint32 EmMemDoGet32(void* a) {
-#if WORDSWAP_MEMORY || !UNALIGNED_LONG_ACCESS
-    return (((uint32) * (((uint16*)a) + 0)) << 16) | (((uint32) * (((uint16*)a) + 1)));
-#else
-    return *(uint32*)a;
-#endif
-}
-
-// ---------------------------------------------------------------------------
-//		� EmMemDoGet16
-// ---------------------------------------------------------------------------
-
-STATIC_INLINE uint16 EmMemDoGet16(void* a) { return *(uint16*)a; }
-
-// ---------------------------------------------------------------------------
-//		� EmMemDoGet8
-// ---------------------------------------------------------------------------
-
-STATIC_INLINE uint8 EmMemDoGet8(void* a) {
-#if WORDSWAP_MEMORY
-    return *(uint8*)((long)a ^ 1);
-#else
-    return *(uint8*)a;
-#endif
-}
-
-// ---------------------------------------------------------------------------
-//		� EmMemDoPut32
-// ---------------------------------------------------------------------------
-
-STATIC_INLINE void EmMemDoPut32(void* a, uint32 v) {
-#if WORDSWAP_MEMORY || !UNALIGNED_LONG_ACCESS
-    *(((uint16*)a) + 0) = (uint16)(v >> 16);
-    *(((uint16*)a) + 1) = (uint16)(v);
-#else
-    *(uint32*)a = v;
-#endif
-}
-
-// ---------------------------------------------------------------------------
-//		� EmMemDoPut16
-// ---------------------------------------------------------------------------
-
-STATIC_INLINE void EmMemDoPut16(void* a, uint16 v) { *(uint16*)a = v; }
-
-// ---------------------------------------------------------------------------
-//		� EmMemDoPut8
-// ---------------------------------------------------------------------------
-
-STATIC_INLINE void EmMemDoPut8(void* a, uint8 v) {
-#if WORDSWAP_MEMORY
-    *(uint8*)((long)a ^ 1) = v;
-#else
-    *(uint8*)a = v;
-#endif
-}
-
 #ifdef __cplusplus
 }
 #endif
@@ -285,9 +367,9 @@ struct MemAccessFlags {
 
 // Globals.
 
-extern MemAccessFlags gMemAccessFlags;
-extern Bool gPCInRAM;
-extern Bool gPCInROM;
+extern __thread MemAccessFlags gMemAccessFlags;
+extern __thread Bool gPCInRAM;
+extern __thread Bool gPCInROM;
 
 struct EmAddressBank;
 
@@ -297,10 +379,12 @@ class SavestateLoader;
 // Function prototypes.
 
 class EmDevice;
+class CowImage;
 
 class Memory {
    public:
     static bool Initialize(const uint8* romBuffer, size_t romSize, EmDevice& device);
+    static bool InitializeRegions(const MemoryRegionMap& regions);
     static void Reset(Bool hardwareReset);
 
     template <typename T>
@@ -313,6 +397,7 @@ class Memory {
                                 int32 iNumberOfBanks);
 
     static void ResetBankHandlers(void);
+    static void UpdateHostBanks(emuptr begin, emuptr end);
 
     static void MapPhysicalMemory(const void*, uint32);
     static void UnmapPhysicalMemory(const void*);
@@ -329,10 +414,15 @@ class Memory {
     static uint32 GetTotalMemorySize();
     static uint8* GetTotalMemory();
     static uint8* GetTotalDirtyPages();
+    static void ResetDirtyPages();
 
     static bool LoadMemoryV1(void* ram, size_t size);
     static bool LoadMemoryV2(void* memory, size_t size);
     static bool LoadMemoryV4(void* memory, size_t size);
+
+    // Replaces the whole memory with a copy-on-write instance of an image of
+    // GetTotalMemory() and resets the dirty pages
+    static bool LoadMemoryImage(const CowImage& image);
 };
 
 typedef Memory EmMemory;
@@ -358,7 +448,7 @@ class CEnableFullAccess {
    private:
     MemAccessFlags fOldMemAccessFlags;
 
-    static long fgAccessCount;
+    static thread_local long fgAccessCount;
 };
 
 // Std C Library-ish routines for manipulating data
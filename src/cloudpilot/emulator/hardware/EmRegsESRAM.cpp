@@ -7,8 +7,8 @@
 namespace {
     constexpr uint32 esramSize = 1024 * 100;
 
-    uint8* esram;
-    uint8* dirtyPages;
+    thread_local uint8* esram;
+    thread_local uint8* dirtyPages;
 
     inline void markDirty(emuptr offset) {
         dirtyPages[offset >> 13] |= (1 << ((offset >> 10) & 0x07));
@@ -948,8 +948,7 @@ bool EmRegsEZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     frame.lines = READ_REGISTER(lcdScreenHeight) + 1;
     frame.bytesPerLine = READ_REGISTER(lcdPageWidth) * 2;
     frame.margin = READ_REGISTER(lcdPanningOffset);
-    frame.firstDirtyLine = 0;
-    frame.lastDirtyLine = frame.lines - 1;
+    frame.ResetDirtyRegion();
     frame.scaleX = frame.scaleY = 1;
     frame.hasChanges = true;
 
@@ -985,6 +984,8 @@ bool EmRegsEZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
 
     if (frame.lines * frame.bytesPerLine > hwrEZ328LcdPageSize) return false;
 
+    EmASSERT(frame.GetBufferSize() >= hwrEZ328LcdPageSize);
+
     uint8* dst = frame.GetBuffer();
     emuptr boundaryAddr = ((baseAddr & hwrEZ328LcdPageMask) + hwrEZ328LcdPageSize);
 
@@ -992,22 +993,27 @@ bool EmRegsEZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
         frame.UpdateDirtyLines(gSystemState, baseAddr, frame.bytesPerLine, fullRefresh);
         if (!frame.hasChanges) return true;
 
-        firstLineAddr = baseAddr + frame.firstDirtyLine * frame.bytesPerLine;
-        lastLineAddr = baseAddr + (frame.lastDirtyLine + 1) * frame.bytesPerLine;
-        dst += frame.firstDirtyLine * frame.bytesPerLine;
-    } else {
-        // Bits straddle the 128K boundary;
-        // copy the first part here, the wrapped part below
-        // Dirty region tracking does not work in this case.
+        for (size_t i = 0; i < frame.dirtySpanCount; i++) {
+            const Frame::DirtySpan& span = frame.dirtySpans[i];
 
-        EmMem_memcpy((void*)dst, firstLineAddr, boundaryAddr - firstLineAddr);
-        dst += (boundaryAddr - firstLineAddr);
+            EmMem_memcpy((void*)(dst + span.firstLine * frame.bytesPerLine),
+                         baseAddr + span.firstLine * frame.bytesPerLine,
+                         (span.lastLine - span.firstLine + 1) * frame.bytesPerLine);
+        }
 
-        firstLineAddr = boundaryAddr - hwrEZ328LcdPageSize;
-        lastLineAddr -= hwrEZ328LcdPageSize;  // wrap around
+        return true;
     }
 
-    EmASSERT(frame.GetBufferSize() >= hwrEZ328LcdPageSize);
+    // Bits straddle the 128K boundary;
+    // copy the first part here, the wrapped part below
+    // Dirty region tracking does not work in this case.
+
+    EmMem_memcpy((void*)dst, firstLineAddr, boundaryAddr - firstLineAddr);
+    dst += (boundaryAddr - firstLineAddr);
+
+    firstLineAddr = boundaryAddr - hwrEZ328LcdPageSize;
+    lastLineAddr -= hwrEZ328LcdPageSize;  // wrap around
+
     EmMem_memcpy((void*)dst, firstLineAddr, lastLineAddr - firstLineAddr);
 
     return true;
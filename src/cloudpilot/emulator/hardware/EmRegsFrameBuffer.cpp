@@ -27,9 +27,9 @@
 namespace {
     constexpr int SAVESTATE_VERSION = 1;
 
-    uint32 framebufferSize;
-    uint8* framebuffer;
-    uint8* dirtyPages;
+    thread_local uint32 framebufferSize;
+    thread_local uint8* framebuffer;
+    thread_local uint8* dirtyPages;
 
     inline void markDirty(emuptr offset) {
         dirtyPages[offset >> 13] |= (1 << ((offset >> 10) & 0x07));
@@ -161,6 +161,18 @@ void EmRegsFrameBuffer::SetByte(emuptr address, uint32 value) {
     markDirty(offset);
 }
 
+// ---------------------------------------------------------------------------
+//		� EmRegsFrameBuffer::MarkDirty
+// ---------------------------------------------------------------------------
+
+void EmRegsFrameBuffer::MarkDirty(emuptr addressLo, emuptr addressHi) {
+    gSystemState.MarkScreenDirty(addressLo, addressHi);
+
+    for (uint32 offset = (addressLo - fBaseAddr) & ~0x3ff; offset <= addressHi - fBaseAddr;
+         offset += 1024)
+        markDirty(offset);
+}
+
 // ---------------------------------------------------------------------------
 //		� EmRegsFrameBuffer::ValidAddress
 // ---------------------------------------------------------------------------
@@ -37,6 +37,10 @@ class EmRegsFrameBuffer : public EmRegs {
     virtual emuptr GetAddressStart(void);
     virtual uint32 GetAddressRange(void);
 
+    // Bookkeeping for writes that bypass the bank handlers and go through GetRealAddress
+    // instead. The range is inclusive.
+    void MarkDirty(emuptr addressLo, emuptr addressHi);
+
    private:
     template <typename T>
     void DoSave(T& savestate);
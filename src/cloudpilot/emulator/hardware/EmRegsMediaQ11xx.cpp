@@ -45,12 +45,43 @@
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 1;
 
-    uint16 cscolor = 0;
+    thread_local uint16 cscolor = 0;
 
     template <typename T>
     bool IsEven(T t) {
         return ((t & 0x01) == 0);
     }
+
+    // Host side pixel access for the fast blitter. Offsets are relative to the start of the
+    // framebuffer.
+    struct Pixel8 {
+        static constexpr uint32 size = 1;
+
+        static uint16 Get(uint8* framebuffer, uint32 offset) {
+            return EmMemDoGet8(framebuffer + offset);
+        }
+
+        static void Put(uint8* framebuffer, uint32 offset, uint16 pixel) {
+            EmMemDoPut8(framebuffer + offset, pixel);
+        }
+    };
+
+    struct Pixel16 {
+        static constexpr uint32 size = 2;
+
+        static uint16 Get(uint8* framebuffer, uint32 offset) {
+            return EmMemDoGet16(framebuffer + offset);
+        }
+
+        static void Put(uint8* framebuffer, uint32 offset, uint16 pixel) {
+            EmMemDoPut16(framebuffer + offset, pixel);
+        }
+    };
+
+    constexpr uint8 kROPSrcCopy = 0xCC;
+    constexpr uint8 kROPPatCopy = 0xF0;
+    constexpr uint8 kROPSrcInvert = 0x66;
+    constexpr uint8 kROPPatInvert = 0x5A;
 }  // namespace
 
 /* --------------------------------------------------------------------------- *\
@@ -2435,6 +2466,15 @@ void EmRegsMediaQ11xx::PrvDoBitBLT(void) {
     cscolor += 0xf0f0;
 
     this->PrvIncBlitterInit();
+
+    // Fills, scrolls and XOR highlights that don't depend on the source FIFO complete
+    // immediately, so they can skip the per-pixel pipeline.
+
+    if (this->PrvFastBlitSupported()) {
+        this->PrvFastBlit();
+        return;
+    }
+
     this->PrvIncBlitterRun();
 }
 
@@ -3490,6 +3530,234 @@ void EmRegsMediaQ11xx::PrvIncBlitterRun(void) {
         "**************************************************");
 }
 
+// ---------------------------------------------------------------------------
+//		� EmRegsMediaQ11xx::PrvFastBlitSupported
+// ---------------------------------------------------------------------------
+// Check whether the blit set up by PrvIncBlitterInit can be handed to one of
+// the row kernels. These operate on the framebuffer directly, so the whole
+// blit must stay within it, and they visit the same pixels in the same order
+// as PrvIncBlitterRun, so overlapping copies give identical results.
+
+Bool EmRegsMediaQ11xx::PrvFastBlitSupported(void) {
+    switch (fState.rasterOperation) {
+        case kROPSrcCopy:
+        case kROPPatCopy:
+        case kROPSrcInvert:
+        case kROPPatInvert:
+            break;
+
+        default:
+            return false;
+    }
+
+    if (fState.rotate90 || fState.monoTransEnable) return false;
+    if (fState.colorDepth != kColorDepth8 && fState.colorDepth != kColorDepth16) return false;
+    if (fState.width == 0 || fState.height == 0) return false;
+
+    if (fUsesPattern && !fState.solidPattern && !fState.monoPattern) return false;
+
+    // Source data from the FIFO arrives incrementally, and packed or mono
+    // sources need unpacking.
+
+    if (fUsesSource && !fState.solidSourceColor &&
+        (fState.systemMemory || fState.memToScreen || fState.monoSource))
+        return false;
+
+    const int32 bytesPerPixel = fState.colorDepth == kColorDepth8 ? 1 : 2;
+
+    if (bytesPerPixel == 2 && (!IsEven(fState.baseAddr) || !IsEven(fState.destLineStride)))
+        return false;
+
+    // The pipes step through uint16 coordinates; stay clear of wraparound and of
+    // the registers behind the framebuffer.
+
+    auto inBounds = [&](int32 x, int32 y) {
+        const int32 xEnd = x + (fState.xDirection ? -1 : 1) * (fState.width - 1);
+        const int32 yEnd = y + (fState.yDirection ? -1 : 1) * (fState.height - 1);
+
+        if (min(x, xEnd) < 0 || max(x, xEnd) > 0xffff) return false;
+        if (min(y, yEnd) < 0 || max(y, yEnd) > 0xffff) return false;
+
+        return static_cast<int64>(fState.baseAddr) +
+                   static_cast<int64>(max(y, yEnd)) * fState.destLineStride +
+                   (max(x, xEnd) + 1) * bytesPerPixel <=
+               FRAMEBUFFER_SIZE;
+    };
+
+    if (!inBounds(fXDest, fYDest)) return false;
+    if (fUsesSource && !fState.solidSourceColor && !inBounds(fXSrc, fYSrc)) return false;
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+//		� EmRegsMediaQ11xx::PrvFastBlit
+// ---------------------------------------------------------------------------
+
+void EmRegsMediaQ11xx::PrvFastBlit(void) {
+    PRINTF_BLIT("	PrvFastBlit:	rop:	0x%02X", fState.rasterOperation);
+
+    if (fState.colorDepth == kColorDepth8) {
+        switch (fState.rasterOperation) {
+            case kROPSrcCopy:
+                this->PrvFastBlitRows<Pixel8, kROPSrcCopy>();
+                break;
+
+            case kROPPatCopy:
+                this->PrvFastBlitRows<Pixel8, kROPPatCopy>();
+                break;
+
+            case kROPSrcInvert:
+                this->PrvFastBlitRows<Pixel8, kROPSrcInvert>();
+                break;
+
+            case kROPPatInvert:
+                this->PrvFastBlitRows<Pixel8, kROPPatInvert>();
+                break;
+        }
+    } else {
+        switch (fState.rasterOperation) {
+            case kROPSrcCopy:
+                this->PrvFastBlitRows<Pixel16, kROPSrcCopy>();
+                break;
+
+            case kROPPatCopy:
+                this->PrvFastBlitRows<Pixel16, kROPPatCopy>();
+                break;
+
+            case kROPSrcInvert:
+                this->PrvFastBlitRows<Pixel16, kROPSrcInvert>();
+                break;
+
+            case kROPPatInvert:
+                this->PrvFastBlitRows<Pixel16, kROPPatInvert>();
+                break;
+        }
+    }
+
+    fBlitInProgress = false;
+}
+
+// ---------------------------------------------------------------------------
+//		� EmRegsMediaQ11xx::PrvFastBlitRows
+// ---------------------------------------------------------------------------
+
+template <typename Pixel, uint8 rop>
+void EmRegsMediaQ11xx::PrvFastBlitRows(void) {
+    uint8* framebufferBase = framebuffer.GetRealAddress(this->GetFrameBufferBase());
+
+    const int32 xStep = fState.xDirection ? -1 : 1;
+    const int32 yStep = fState.yDirection ? -1 : 1;
+
+    const bool readSource = fUsesSource && !fState.solidSourceColor;
+    const uint16 fixedSource = fUsesSource ? fState.fgColorMonoSrc : 0;
+
+    // Whole rows can be moved or filled at once if there is no transparency and
+    // the framebuffer holds pixels in host order.
+
+    const bool rowOps = Pixel::size == 2 && !fState.colorTransEnable;
+
+    // PrvTransparent without the mono cases
+
+    const bool compareSource = fState.colorTransCmpSrc == 0;
+    auto transparent = [&](uint16 source, uint16 dest) {
+        if (!fState.colorTransEnable) return false;
+        if (compareSource && fState.monoSource) return false;
+
+        return ((compareSource ? source : dest) == fState.destTransColor) ==
+               (fState.destTransPolarity == 0);
+    };
+
+    // Clipping only depends on the destination coordinates, so it reduces to a
+    // range of pixel indices within each row.
+
+    int32 firstIndex = 0;
+    int32 lastIndex = fState.width - 1;
+
+    if (fState.clipEnable) {
+        const int32 first = xStep > 0 ? fState.clipLeft - fXDest : fXDest - fState.clipRight + 1;
+        const int32 last = xStep > 0 ? fState.clipRight - 1 - fXDest : fXDest - fState.clipLeft;
+
+        firstIndex = max(firstIndex, first);
+        lastIndex = min(lastIndex, last);
+    }
+
+    if (firstIndex > lastIndex) return;
+
+    const int32 count = lastIndex - firstIndex + 1;
+    const int32 destFirstX = fXDest + xStep * firstIndex;
+    const int32 destLeftX = min(destFirstX, destFirstX + xStep * (count - 1));
+    const int32 srcFirstX = fXSrc + xStep * firstIndex;
+    const int32 srcLeftX = min(srcFirstX, srcFirstX + xStep * (count - 1));
+
+    for (int32 row = 0; row < fState.height; row++) {
+        const int32 yDest = fYDest + yStep * row;
+        const int32 ySrc = fYSrc + yStep * row;
+
+        if (fState.clipEnable && (yDest < fState.clipTop || yDest >= fState.clipBottom))
+            continue;
+
+        const uint32 destLine = fState.baseAddr + yDest * fState.destLineStride;
+        const uint32 srcLine = fState.baseAddr + ySrc * fState.destLineStride;
+        const uint32 destStart = destLine + destLeftX * Pixel::size;
+
+        framebuffer.MarkDirty(this->GetFrameBufferBase() + destStart,
+                              this->GetFrameBufferBase() + destStart + count * Pixel::size - 1);
+
+        if constexpr (rop == kROPSrcCopy) {
+            // memmove gives the same result as copying pixel by pixel unless the
+            // pipe runs into pixels that it has written already.
+
+            const uint32 srcStart = srcLine + srcLeftX * Pixel::size;
+            const uint32 size = count * Pixel::size;
+
+            if (rowOps && readSource &&
+                ((xStep > 0 ? destStart <= srcStart : destStart >= srcStart) ||
+                 destStart + size <= srcStart || srcStart + size <= destStart)) {
+                memmove(framebufferBase + destStart, framebufferBase + srcStart, size);
+                continue;
+            }
+        }
+
+        if constexpr (rop == kROPPatCopy) {
+            if (rowOps && fState.solidPattern) {
+                uint16* dest = reinterpret_cast<uint16*>(framebufferBase + destStart);
+
+                std::fill(dest, dest + count, fState.fgColorMonoPat);
+                continue;
+            }
+        }
+
+        const uint16* patternLine = &fPatternPipe[((fYPattern + row) % 8) * 8];
+
+        for (int32 i = 0; i < count; i++) {
+            const uint32 destOffset = destLine + (destFirstX + xStep * i) * Pixel::size;
+
+            const uint16 source =
+                readSource ? Pixel::Get(framebufferBase,
+                                        srcLine + (srcFirstX + xStep * i) * Pixel::size)
+                           : fixedSource;
+            const uint16 pattern = patternLine[(fXPattern + firstIndex + i) % 8];
+            const uint16 dest = Pixel::Get(framebufferBase, destOffset);
+
+            if (transparent(source, dest)) continue;
+
+            uint16 output;
+
+            if constexpr (rop == kROPSrcCopy)
+                output = source;
+            else if constexpr (rop == kROPPatCopy)
+                output = pattern;
+            else if constexpr (rop == kROPSrcInvert)
+                output = dest ^ source;
+            else
+                output = dest ^ pattern;
+
+            Pixel::Put(framebufferBase, destOffset, output);
+        }
+    }
+}
+
 #pragma mark -
 
 // ---------------------------------------------------------------------------
@@ -191,6 +191,7 @@ struct GEState {
 
 class EmRegsMediaQ11xx : public EmRegs, public MediaQFramebuffer<EmRegsMediaQ11xx> {
     friend MediaQFramebuffer<EmRegsMediaQ11xx>;
+    friend class MediaQBlitterTest;
 
    public:
     static constexpr uint32 FRAMEBUFFER_SIZE = 256 * 1024;
@@ -288,6 +289,12 @@ class EmRegsMediaQ11xx : public EmRegs, public MediaQFramebuffer<EmRegsMediaQ11x
     void PrvIncBlitterInit();
     void PrvIncBlitterRun();
 
+    Bool PrvFastBlitSupported();
+    void PrvFastBlit();
+
+    template <typename Pixel, uint8 rop>
+    void PrvFastBlitRows();
+
     void PrvPatternPipeInit();
     uint16 PrvPatternPipeNextPixel();
     void PrvPatternPipeNextX();
@@ -269,55 +269,58 @@ bool EmRegsSED1375::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     frame.UpdateDirtyLines(gSystemState, baseAddr, rowBytes, fullRefresh);
     if (!frame.hasChanges) return true;
 
-    uint32* buffer =
-        reinterpret_cast<uint32*>(frame.GetBuffer() + frame.firstDirtyLine * frame.bytesPerLine);
+    if (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8) return false;
 
-    switch (bpp) {
-        case 1: {
-            Nibbler<1, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
+    for (size_t i = 0; i < frame.dirtySpanCount; i++) {
+        const Frame::DirtySpan& span = frame.dirtySpans[i];
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = fClutData[nibbler.nibble()];
+        uint32* buffer =
+            reinterpret_cast<uint32*>(frame.GetBuffer() + span.firstLine * frame.bytesPerLine);
 
-            return true;
-        }
+        switch (bpp) {
+            case 1: {
+                Nibbler<1, true> nibbler;
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes), 0);
 
-        case 2: {
-            Nibbler<2, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++) *(buffer++) = fClutData[nibbler.nibble()];
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = fClutData[nibbler.nibble()];
+                break;
+            }
 
-            return true;
-        }
+            case 2: {
+                Nibbler<2, true> nibbler;
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes), 0);
 
-        case 4: {
-            Nibbler<4, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++) *(buffer++) = fClutData[nibbler.nibble()];
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = fClutData[nibbler.nibble()];
+                break;
+            }
 
-            return true;
-        }
+            case 4: {
+                Nibbler<4, true> nibbler;
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes), 0);
+
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++) *(buffer++) = fClutData[nibbler.nibble()];
+
+                break;
+            }
 
-        case 8: {
-            uint8* fbuf = framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes);
+            case 8: {
+                uint8* fbuf = framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes);
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++)
-                    *(buffer++) = fClutData[*(uint8*)((long)(fbuf++) ^ 1)];
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++)
+                        *(buffer++) = fClutData[*(uint8*)((long)(fbuf++) ^ 1)];
 
-            return true;
+                break;
+            }
         }
     }
 
-    return false;
+    return true;
 }
 
 uint16 EmRegsSED1375::GetLCD2bitMapping() { return 0xfa50; }
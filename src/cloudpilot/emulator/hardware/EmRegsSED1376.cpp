@@ -639,89 +639,93 @@ bool EmRegsSED1376PalmGeneric::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     frame.UpdateDirtyLines(gSystemState, baseAddr, rowBytes, fullRefresh);
     if (!frame.hasChanges) return true;
 
-    uint32* buffer =
-        reinterpret_cast<uint32*>(frame.GetBuffer() + frame.firstDirtyLine * frame.bytesPerLine);
     const uint32* lut = GetLUT(mono);
 
-    switch (bpp) {
-        case 1: {
-            Nibbler<1, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
+    for (size_t i = 0; i < frame.dirtySpanCount; i++) {
+        const Frame::DirtySpan& span = frame.dirtySpans[i];
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
+        uint32* buffer =
+            reinterpret_cast<uint32*>(frame.GetBuffer() + span.firstLine * frame.bytesPerLine);
 
-            break;
-        }
+        switch (bpp) {
+            case 1: {
+                Nibbler<1, true> nibbler;
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes), 0);
 
-        case 2: {
-            Nibbler<2, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
+                break;
+            }
 
-            break;
-        }
+            case 2: {
+                Nibbler<2, true> nibbler;
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes), 0);
 
-        case 4: {
-            Nibbler<4, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
+                break;
+            }
 
-            break;
-        }
+            case 4: {
+                Nibbler<4, true> nibbler;
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes), 0);
+
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
 
-        case 8: {
-            uint8* fbuf = framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes);
+                break;
+            }
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[*(uint8*)((long)(fbuf++) ^ 1)];
+            case 8: {
+                uint8* fbuf = framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes);
 
-            break;
-        }
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++)
+                        *(buffer++) = lut[*(uint8*)((long)(fbuf++) ^ 1)];
+
+                break;
+            }
 
-        default: {
-            uint8* fbuf = framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes);
-
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) {
-                    uint8 p1 = *(uint8*)((long)(fbuf++) ^ 1);  // GGGBBBBB
-                    uint8 p2 = *(uint8*)((long)(fbuf++) ^ 1);  // RRRRRGGG
-
-                    // Merge the two together so that we get RRRRRGGG GGGBBBBB
-
-                    uint16 p;
-
-                    if (!byteSwapped)
-                        p = (p2 << 8) | p1;
-                    else
-                        p = (p1 << 8) | p2;
-
-                    // Shift the bits around, forming RRRRRrrr, GGGGGGgg, and
-                    // BBBBBbbb values, where the lower-case bits are copies of
-                    // the least significant bits in the upper-case bits.
-                    //
-                    // Note that all of this could also be done with three 64K
-                    // lookup tables.  If speed is an issue, we might want to
-                    // investigate that.
-
-                    if (mono) {
-                        uint8 green = ((p >> 3) & 0xFC) | ((p >> 5) & 0x03);
-                        *buffer++ = 0xff000000 | (green << 16) | (green << 8) | green;
-                    } else {
-                        *buffer++ = 0xff000000 | ((((p << 3) & 0xF8) | ((p >> 0) & 0x07)) << 16) |
-                                    ((((p >> 3) & 0xFC) | ((p >> 5) & 0x03)) << 8) |
-                                    (((p >> 8) & 0xF8) | ((p >> 11) & 0x07));
+            default: {
+                uint8* fbuf = framebuffer.GetRealAddress(baseAddr + span.firstLine * rowBytes);
+
+                for (uint32 y = span.firstLine; y <= span.lastLine; y++)
+                    for (int32 x = 0; x < width; x++) {
+                        uint8 p1 = *(uint8*)((long)(fbuf++) ^ 1);  // GGGBBBBB
+                        uint8 p2 = *(uint8*)((long)(fbuf++) ^ 1);  // RRRRRGGG
+
+                        // Merge the two together so that we get RRRRRGGG GGGBBBBB
+
+                        uint16 p;
+
+                        if (!byteSwapped)
+                            p = (p2 << 8) | p1;
+                        else
+                            p = (p1 << 8) | p2;
+
+                        // Shift the bits around, forming RRRRRrrr, GGGGGGgg, and
+                        // BBBBBbbb values, where the lower-case bits are copies of
+                        // the least significant bits in the upper-case bits.
+                        //
+                        // Note that all of this could also be done with three 64K
+                        // lookup tables.  If speed is an issue, we might want to
+                        // investigate that.
+
+                        if (mono) {
+                            uint8 green = ((p >> 3) & 0xFC) | ((p >> 5) & 0x03);
+                            *buffer++ = 0xff000000 | (green << 16) | (green << 8) | green;
+                        } else {
+                            *buffer++ = 0xff000000 |
+                                        ((((p << 3) & 0xF8) | ((p >> 0) & 0x07)) << 16) |
+                                        ((((p >> 3) & 0xFC) | ((p >> 5) & 0x03)) << 8) |
+                                        (((p >> 8) & 0xF8) | ((p >> 11) & 0x07));
+                        }
                     }
-                }
 
-            break;
+                break;
+            }
         }
     }
 
@@ -1889,7 +1889,7 @@ int32 EmRegsSZ::GetInterruptLevel(void) {
                     * Port D,E,F,G,J,K,M,N,P,R (configurable from level 1 to 6)
     */
 
-    static int8 intLevel[32] = {
+    static thread_local int8 intLevel[32] = {
         0,  // 0x00 - LCD controller (configurable)
         0,  // 0x01 - hwrSZ328IntLoTimer (configurable)
         0,  // 0x02 - hwrSZ328IntLoUART (configurable)
@@ -3781,16 +3781,27 @@ bool EmRegsSZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     frame.UpdateDirtyLines(gSystemState, startAddress, virtualPageWidth, fullRefresh);
     if (!frame.hasChanges) return true;
 
-    uint32* dest =
-        reinterpret_cast<uint32*>(frame.GetBuffer()) + frame.firstDirtyLine * frame.lineWidth;
+    if (bpp != 4 && bpp != 8 && bpp != 16) return false;
+    if (bpp != 16) UpdatePalette();
+
+    for (size_t i = 0; i < frame.dirtySpanCount; i++)
+        CopyLCDLines(frame, frame.dirtySpans[i].firstLine, frame.dirtySpans[i].lastLine,
+                     startAddress, virtualPageWidth, panningOffset, bpp);
+
+    return true;
+}
+
+void EmRegsSZ::CopyLCDLines(Frame& frame, uint32 firstLine, uint32 lastLine, emuptr startAddress,
+                            uint16 virtualPageWidth, uint8 panningOffset, uint8 bpp) {
+    const uint32 screenWidth = frame.lineWidth;
+    uint32* dest = reinterpret_cast<uint32*>(frame.GetBuffer()) + firstLine * screenWidth;
 
     switch (bpp) {
         case 4: {
-            UpdatePalette();
             uint8* base = EmMemGetRealAddress(startAddress);
             Nibbler<4, true> nibbler;
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+            for (uint32 y = firstLine; y <= lastLine; y++) {
                 nibbler.reset(base + y * virtualPageWidth, panningOffset);
 
                 for (uint32 x = 0; x < screenWidth; x++) {
@@ -3798,14 +3809,13 @@ bool EmRegsSZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
                 }
             }
 
-            return true;
+            break;
         }
 
         case 8: {
-            UpdatePalette();
             uint8* base = EmMemGetRealAddress(startAddress);
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+            for (uint32 y = firstLine; y <= lastLine; y++) {
                 uint8* src = base + y * virtualPageWidth + (panningOffset >> 3);
 
                 for (uint32 x = 0; x < screenWidth; x++) {
@@ -3813,13 +3823,13 @@ bool EmRegsSZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
                 }
             }
 
-            return true;
+            break;
         }
 
         case 16: {
             uint16* base = reinterpret_cast<uint16*>(EmMemGetRealAddress(startAddress & ~1));
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+            for (uint32 y = firstLine; y <= lastLine; y++) {
                 uint16* src = base + y * (virtualPageWidth >> 1) + (panningOffset >> 4);
 
                 for (uint32 x = 0; x < screenWidth; x++) {
@@ -3827,11 +3837,9 @@ bool EmRegsSZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
                 }
             }
 
-            return true;
+            break;
         }
     }
-
-    return false;
 }
 
 uint16 EmRegsSZ::GetLCD2bitMapping() { return 0x3210; }
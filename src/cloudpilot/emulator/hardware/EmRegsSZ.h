@@ -156,6 +156,8 @@ class EmRegsSZ : public EmRegs, public EmHALHandler {
     void UpdateEsramLocation();
 
     void UpdatePalette();
+    void CopyLCDLines(Frame& frame, uint32 firstLine, uint32 lastLine, emuptr startAddress,
+                      uint16 virtualPageWidth, uint8 panningOffset, uint8 bpp);
 
     void UpdateTimers();
     void HandleDayRollover();
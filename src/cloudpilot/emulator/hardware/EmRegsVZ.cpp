@@ -1082,7 +1082,7 @@ int32 EmRegsVZ::GetInterruptLevel(void) {
                     * IRQ1 external interrupt (level 1)
     */
 
-    static int8 intLevel[32] = {
+    static thread_local int8 intLevel[32] = {
         4,  // 0x00 - hwrVZ328IntLoSPIM
         6,  // 0x01 - hwrVZ328IntLoTimer
         4,  // 0x02 - hwrVZ328IntLoUART
@@ -1218,15 +1218,17 @@ bool EmRegsVZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
             return false;
     }
 
-    // Determine first and last scanlines to fetch, and fetch them.
+    // Fetch the dirty scanlines.
 
-    emuptr firstLineAddr = baseAddr + frame.firstDirtyLine * frame.bytesPerLine;
-    emuptr lastLineAddr = baseAddr + (frame.lastDirtyLine + 1) * frame.bytesPerLine;
+    EmASSERT(frame.GetBufferSize() >= (frame.lastDirtyLine + 1) * frame.bytesPerLine);
 
-    uint8* dst = frame.GetBuffer() + frame.firstDirtyLine * frame.bytesPerLine;
+    for (size_t i = 0; i < frame.dirtySpanCount; i++) {
+        const Frame::DirtySpan& span = frame.dirtySpans[i];
 
-    EmASSERT(frame.GetBufferSize() >= lastLineAddr - firstLineAddr);
-    EmMem_memcpy((void*)dst, firstLineAddr, lastLineAddr - firstLineAddr);
+        EmMem_memcpy((void*)(frame.GetBuffer() + span.firstLine * frame.bytesPerLine),
+                     baseAddr + span.firstLine * frame.bytesPerLine,
+                     (span.lastLine - span.firstLine + 1) * frame.bytesPerLine);
+    }
 
     return true;
 }
@@ -42,11 +42,11 @@
 
 // Table of currently Patched shared libraries
 //
-static PatchedLibIndex gPatchedLibs;
+static thread_local PatchedLibIndex gPatchedLibs;
 
 // Table of currently installed tail patches
 //
-static TailPatchIndex gInstalledTailpatches;
+static thread_local TailPatchIndex gInstalledTailpatches;
 
 // ======================================================================
 //	Private functions
@@ -78,13 +78,13 @@ namespace {
         DoSaveLoad(helper, patch.fContext);
     }
 
-    bool executingPatch = false;
+    thread_local bool executingPatch = false;
 }  // namespace
 
-EmPatchModule* EmPatchMgr::patchModuleSys = nullptr;
-EmPatchModule* EmPatchMgr::patchModuleHtal = nullptr;
-EmPatchModule* EmPatchMgr::patchModuleNetlib = nullptr;
-EmPatchModule* EmPatchMgr::patchModuleClieStubAll = nullptr;
+thread_local EmPatchModule* EmPatchMgr::patchModuleSys = nullptr;
+thread_local EmPatchModule* EmPatchMgr::patchModuleHtal = nullptr;
+thread_local EmPatchModule* EmPatchMgr::patchModuleNetlib = nullptr;
+thread_local EmPatchModule* EmPatchMgr::patchModuleClieStubAll = nullptr;
 
 /***********************************************************************
  *
@@ -60,10 +60,10 @@ class EmPatchMgr {
     static void SetupForTailpatch(TailpatchProc tp, const SystemCallContext&);
     static TailpatchProc RecoverFromTailpatch(emuptr oldpc);
 
-    static EmPatchModule* patchModuleSys;
-    static EmPatchModule* patchModuleHtal;
-    static EmPatchModule* patchModuleNetlib;
-    static EmPatchModule* patchModuleClieStubAll;
+    static thread_local EmPatchModule* patchModuleSys;
+    static thread_local EmPatchModule* patchModuleHtal;
+    static thread_local EmPatchModule* patchModuleNetlib;
+    static thread_local EmPatchModule* patchModuleClieStubAll;
 };
 
 #endif /* EmPatchMgr_h */
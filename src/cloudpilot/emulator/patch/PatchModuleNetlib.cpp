@@ -134,7 +134,7 @@ namespace {
     }
 
     const char* decodeCreator(uint32 creator) {
-        static char buf[5];
+        static thread_local char buf[5];
 
         buf[0] = creator >> 24;
         buf[1] = (creator >> 16) & 0xff;
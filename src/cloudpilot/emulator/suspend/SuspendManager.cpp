@@ -1,8 +1,9 @@
 #include "SuspendManager.h"
 
+#include "EmCPU68K.h"
 #include "SuspendContext.h"
 
-SuspendContext* SuspendManager::context{nullptr};
+__thread SuspendContext* SuspendManager::context{nullptr};
 
 SuspendContext& SuspendManager::GetContext() { return *context; }
 
@@ -11,6 +12,12 @@ void SuspendManager::Resume() {
     context = nullptr;
 }
 
+// The CPU only checks for suspension at block boundaries.
+
+void SuspendManager::EndCPUBlock() {
+    if (gCPU68K) gCPU68K->EndBlock();
+}
+
 void SuspendManager::Reset() {
     if (IsSuspended()) context->Cancel();
 }
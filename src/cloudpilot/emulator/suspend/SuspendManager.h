@@ -20,9 +20,10 @@ class SuspendManager {
 
    private:
     static void Resume();
+    static void EndCPUBlock();
 
    private:
-    static SuspendContext* context;
+    static __thread SuspendContext* context;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -34,6 +35,8 @@ void SuspendManager::Suspend(Us... args) {
     EmAssert(context == nullptr);
 
     context = new T(args...);
+
+    EndCPUBlock();
 }
 
 bool SuspendManager::IsSuspended() { return context != nullptr; }
@@ -12,10 +12,10 @@ extern "C" {
 
 extern int Software_ProcessJSR_Ind (uaecptr oldpc, uaecptr dest);
 
-extern uae_u32	gStackHigh;
-extern uae_u32	gStackLowWarn;
-extern uae_u32	gStackLow;
-extern uae_u32	gKernelStackOverflowed;
+extern __thread uae_u32	gStackHigh;
+extern __thread uae_u32	gStackLowWarn;
+extern __thread uae_u32	gStackLow;
+extern __thread uae_u32	gKernelStackOverflowed;
 
 #define CHECK_STACK_POINTER_ASSIGNMENT() {}
 
@@ -85,7 +85,7 @@ typedef struct regstruct
     uae_u32 prefetch;
 } regstruct;
 
-extern regstruct regs;
+extern __thread regstruct regs;
 extern regstruct lastint_regs;
 
 #define m68k_dreg(r,num) ((r).regs[(num)])
@@ -123,11 +123,11 @@ extern void MakeFromSR (void);
 extern void Exception (int, uaecptr);
 
 /* Opcode of faulting instruction */
-extern uae_u16 last_op_for_exception_3;
+extern __thread uae_u16 last_op_for_exception_3;
 /* PC at fault time */
-extern uaecptr last_addr_for_exception_3;
+extern __thread uaecptr last_addr_for_exception_3;
 /* Address that generated the exception */
-extern uaecptr last_fault_for_exception_3;
+extern __thread uaecptr last_fault_for_exception_3;
 
 #define CPU_OP_NAME(a) op ## a
 
@@ -16,3 +16,11 @@
 #ifndef STATIC_INLINE
 #define STATIC_INLINE static __inline__
 #endif
+
+#ifndef STATIC_FORCE_INLINE
+	#ifdef __GNUC__
+		#define STATIC_FORCE_INLINE STATIC_INLINE __attribute__((always_inline))
+	#else
+		#define STATIC_FORCE_INLINE STATIC_INLINE
+	#endif
+#endif
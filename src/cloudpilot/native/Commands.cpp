@@ -22,11 +22,16 @@
 #include "StackDump.h"
 #include "ZipfileWalker.h"
 #include "md5.h"
+#include "session/session_delta.h"
 #include "util.h"
 
 using namespace std;
 
 namespace {
+    // The last image written by save-image is the base for save-delta
+    optional<uint32> deltaBase;
+    uint32 deltaSequence{0};
+
     string translateInstallResult(DbInstaller::Result result) {
         switch (result) {
             case DbInstaller::Result::success:
@@ -109,7 +114,100 @@ namespace {
 
         if (stream.fail()) {
             cout << "I/O error writing " << file << endl << flush;
+            return;
         }
+
+        deltaBase = SessionDelta::Fingerprint(image.GetSerializedImageSize(),
+                                              image.GetSerializedImage());
+        deltaSequence = 0;
+
+        gSession->ResetDirtyPages();
+    }
+
+    void SaveDelta(string file) {
+        EmAssert(gSession);
+
+        if (!deltaBase) {
+            cout << "no base image; use save-image first" << endl << flush;
+            return;
+        }
+
+        SessionDelta delta;
+        delta.SetBase(*deltaBase, deltaSequence + 1);
+
+        if (!gSession->SaveDelta(delta)) {
+            cout << "failed to serialize session delta" << endl << flush;
+            return;
+        }
+
+        if (!util::WriteFile(file, static_cast<const uint8_t*>(delta.GetSerializedDelta()),
+                             delta.GetSerializedDeltaSize())) {
+            cout << "I/O error writing " << file << endl << flush;
+            return;
+        }
+
+        cout << "wrote delta " << delta.GetSequence() << " ("
+             << delta.GetPageCount(SessionDelta::Image::memory) << " pages) to " << file << endl
+             << flush;
+
+        deltaSequence++;
+        gSession->ResetDirtyPages();
+    }
+
+    void CompactImage(string baseFile, string outFile, const vector<string>& deltaFiles) {
+        unique_ptr<uint8[]> baseBuffer;
+        size_t baseSize;
+
+        if (!util::ReadFile(baseFile, baseBuffer, baseSize)) {
+            cout << "failed to read " << baseFile << endl << flush;
+            return;
+        }
+
+        SessionImage image;
+        if (!image.Deserialize(baseBuffer.get(), baseSize)) {
+            cout << baseFile << " is not a session image" << endl << flush;
+            return;
+        }
+
+        const uint32 fingerprint = SessionDelta::Fingerprint(baseSize, baseBuffer.get());
+        uint32 sequence = 0;
+
+        for (auto& deltaFile : deltaFiles) {
+            unique_ptr<uint8[]> deltaBuffer;
+            size_t deltaSize;
+            SessionDelta delta;
+
+            if (!util::ReadFile(deltaFile, deltaBuffer, deltaSize) ||
+                !delta.Deserialize(deltaSize, deltaBuffer.get())) {
+                cout << "failed to read delta " << deltaFile << endl << flush;
+                return;
+            }
+
+            if (!delta.Continues(fingerprint, sequence)) {
+                cout << deltaFile << " does not continue the chain" << endl << flush;
+                return;
+            }
+
+            if (!image.ApplyDelta(delta)) {
+                cout << "failed to apply " << deltaFile << endl << flush;
+                return;
+            }
+
+            sequence = delta.GetSequence();
+        }
+
+        if (!image.Serialize()) {
+            cout << "failed to serialize session image" << endl << flush;
+            return;
+        }
+
+        if (!util::WriteFile(outFile, static_cast<const uint8_t*>(image.GetSerializedImage()),
+                             image.GetSerializedImageSize())) {
+            cout << "I/O error writing " << outFile << endl << flush;
+            return;
+        }
+
+        cout << "compacted " << deltaFiles.size() << " deltas into " << outFile << endl << flush;
     }
 
     void DumpMemory(string file) {
@@ -231,6 +329,18 @@ namespace {
         SaveImage(args[0]);
     }
 
+    void CmdSaveDelta(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() != 1) return env.PrintUsage();
+
+        SaveDelta(args[0]);
+    }
+
+    void CmdCompactImage(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() < 3) return env.PrintUsage();
+
+        CompactImage(args[0], args[1], vector<string>(args.begin() + 2, args.end()));
+    }
+
     void CmdSetUserName(vector<string> args, cli::CommandEnvironment& env, void* context) {
         if (args.size() == 0) return env.PrintUsage();
 
@@ -512,6 +622,21 @@ mounted card can be specified as second argument. If save state and card
 image are written simultaneously, CloudpilotEmu will be able to restore the
 mounted image on load (if the image is specified with --mount on launch).)HELP",
          .cmd = CmdSaveImage},
+        {.name = "save-delta",
+         .usage = "save-delta <delta_file>",
+         .description = "Save changes since the last image or delta.",
+         .help = R"HELP(
+Write the memory pages that changed since the last save-image or save-delta,
+together with the save state. Deltas form a chain on top of the image written
+by save-image and can be merged back into a full image with compact-image.)HELP",
+         .cmd = CmdSaveDelta},
+        {.name = "compact-image",
+         .usage = "compact-image <base_image> <output_image> <delta_file>...",
+         .description = "Merge a chain of deltas into an image.",
+         .help = R"HELP(
+Apply a chain of deltas in order to the base image and write the result as a
+full image file. The deltas must have been written on top of the base image.)HELP",
+         .cmd = CmdCompactImage},
         {.name = "switch-image",
          .usage = "switch-image <file>",
          .description = "Switch to another ROM or image.",
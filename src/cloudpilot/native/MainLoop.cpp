@@ -6,19 +6,12 @@
 #include "EmHAL.h"
 #include "EmSession.h"
 #include "EmSystemState.h"
-#include "Nibbler.h"
+#include "FrameConverter.h"
 #include "Silkscreen.h"
 #include "SuspendManager.h"
 
 constexpr uint8 SILKSCREEN_BACKGROUND_HUE = 0xbb;
 constexpr uint32 BACKGROUND_HUE = 0xd2;
-constexpr uint32 FOREGROUND_COLOR = 0xff000000;
-constexpr uint32 BACKGROUND_COLOR =
-    0xff000000 | BACKGROUND_HUE | (BACKGROUND_HUE << 8) | (BACKGROUND_HUE << 16);
-
-constexpr uint32 PALETTE_GRAYSCALE_16[] = {
-    0xffd2d2d2, 0xffc4c4c4, 0xffb6b6b6, 0xffa8a8a8, 0xff9a9a9a, 0xff8c8c8c, 0xff7e7e7e, 0xff707070,
-    0xff626262, 0xff545454, 0xff464646, 0xff383838, 0xff2a2a2a, 0xff1c1c1c, 0xff0e0e0e, 0xff000000};
 
 constexpr long SCREEN_REFRESH_GRACE_TIME = 10;
 
@@ -116,79 +109,33 @@ void MainLoop::UpdateScreen(bool fullRedraw) {
             frame.lines * frame.scaleY == screenDimensions.Height()) {
             uint32* pixels;
             int pitch;
-            uint8* buffer = frame.GetBuffer();
 
             SDL_LockTexture(lcdTempTexture, nullptr, (void**)&pixels, &pitch);
 
-            switch (frame.bpp) {
-                case 1: {
-                    Nibbler<1> nibbler;
-
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        nibbler.reset(buffer + y * frame.bytesPerLine, frame.margin);
-                        uint32* line = pixels + y * pitch / 4;
-
-                        for (uint32 x = 0; x < frame.lineWidth; x++)
-                            *(line++) = nibbler.nibble() == 0 ? BACKGROUND_COLOR : FOREGROUND_COLOR;
-                    }
-                } break;
-
-                case 2: {
-                    uint16 mapping = EmHAL::GetLCD2bitMapping();
-
-                    uint32 palette[4] = {PALETTE_GRAYSCALE_16[mapping & 0x000f],
-                                         PALETTE_GRAYSCALE_16[(mapping >> 4) & 0x000f],
-                                         PALETTE_GRAYSCALE_16[(mapping >> 8) & 0x000f],
-                                         PALETTE_GRAYSCALE_16[(mapping >> 12) & 0x000f]};
-
-                    Nibbler<2> nibbler;
-
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        nibbler.reset(buffer + y * frame.bytesPerLine, frame.margin);
-                        uint32* line = pixels + y * pitch / 4;
-
-                        for (uint32 x = 0; x < frame.lineWidth; x++)
-                            *(line++) = palette[nibbler.nibble()];
-                    }
-                } break;
-
-                case 4: {
-                    Nibbler<4> nibbler;
-
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        nibbler.reset(buffer + y * frame.bytesPerLine, frame.margin);
-                        uint32* line = pixels + y * pitch / 4;
-
-                        for (uint32 x = 0; x < frame.lineWidth; x++)
-                            *(line++) = PALETTE_GRAYSCALE_16[nibbler.nibble()];
-                    }
-                } break;
-
-                case 24: {
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        memcpy(pixels + y * pitch / 4,
-                               buffer + y * frame.bytesPerLine + 4 * frame.margin,
-                               4 * frame.lineWidth);
-                    }
-                } break;
-            }
+            frameConverter.Convert(frame, pixels, pitch / 4, EmHAL::GetLCD2bitMapping());
 
             SDL_UnlockTexture(lcdTempTexture);
 
-            SDL_Rect src = {
-                .x = 0,
-                .y = static_cast<int32>(frame.firstDirtyLine),
-                .w = static_cast<int32>(frame.lineWidth),
-                .h = static_cast<int32>(frame.lastDirtyLine - frame.firstDirtyLine + 1)};
+            SDL_SetRenderTarget(renderer, lcdTexture);
 
-            SDL_Rect dest = {.x = 0,
-                             .y = static_cast<int32>(frame.firstDirtyLine * frame.scaleY),
-                             .w = static_cast<int32>(frame.lineWidth * frame.scaleX),
-                             .h = static_cast<int32>(
-                                 (frame.lastDirtyLine - frame.firstDirtyLine + 1) * frame.scaleY)};
+            // Only the dirty spans were converted, the remainder of the temporary texture is
+            // undefined
+            for (size_t i = 0; i < frame.dirtySpanCount; i++) {
+                const Frame::DirtySpan& span = frame.dirtySpans[i];
 
-            SDL_SetRenderTarget(renderer, lcdTexture);
-            SDL_RenderCopy(renderer, lcdTempTexture, &src, &dest);
+                SDL_Rect src = {.x = 0,
+                                .y = static_cast<int32>(span.firstLine),
+                                .w = static_cast<int32>(frame.lineWidth),
+                                .h = static_cast<int32>(span.lastLine - span.firstLine + 1)};
+
+                SDL_Rect dest = {
+                    .x = 0,
+                    .y = static_cast<int32>(span.firstLine * frame.scaleY),
+                    .w = static_cast<int32>(frame.lineWidth * frame.scaleX),
+                    .h = static_cast<int32>((span.lastLine - span.firstLine + 1) * frame.scaleY)};
+
+                SDL_RenderCopy(renderer, lcdTempTexture, &src, &dest);
+            }
         }
 
         SDL_Rect dest = {.x = 0,
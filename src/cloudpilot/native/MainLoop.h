@@ -6,6 +6,7 @@
 #include "ButtonEvent.h"
 #include "EventHandler.h"
 #include "Frame.h"
+#include "FrameConverter.h"
 #include "Platform.h"
 #include "ScreenDimensions.h"
 
@@ -34,6 +35,7 @@ class MainLoop {
     int scale{1};
     ScreenDimensions screenDimensions;
     Frame frame{320 * 480 * 4};
+    FrameConverter frameConverter;
 
     const long millisOffset{Platform::GetMilliseconds()};
     double clockEmu{0};
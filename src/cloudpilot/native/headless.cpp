@@ -0,0 +1,359 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Cli.h"
+#include "Commands.h"
+#include "Debugger.h"
+#include "EmCommon.h"
+#include "EmHAL.h"
+#include "EmSession.h"
+#include "ExternalStorage.h"
+#include "Frame.h"
+#include "FrameConverter.h"
+#include "GdbStub.h"
+#include "SuspendManager.h"
+#include "argparse.h"
+#include "util.h"
+
+using namespace std;
+
+// cloudpilot-headless runs a session without SDL. Without a script it runs for --seconds
+// of virtual time. With a script, virtual time only advances through the "run" command,
+// so scripted runs are reproducible; --seconds then caps the total virtual time. Frames
+// are only rendered on demand through the "screenshot" command.
+
+struct Options {
+    string image;
+    optional<string> deviceId;
+    optional<string> mountImage;
+    optional<string> scriptFile;
+    optional<double> seconds;
+    double clockFactor;
+};
+
+namespace {
+    constexpr uint32 SLICES_PER_SECOND = 60;
+
+    uint64 timestampNsec() {
+        return chrono::duration_cast<chrono::nanoseconds>(
+                   chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    bool writePpm(const string& file, const uint32* pixels, uint32 width, uint32 height) {
+        FILE* f = fopen(file.c_str(), "wb");
+        if (!f) return false;
+
+        fprintf(f, "P6\n%u %u\n255\n", width, height);
+
+        vector<uint8> line(3 * width);
+
+        for (uint32 y = 0; y < height; y++) {
+            // ABGR8888, so the bytes are RGBA in memory
+            const uint8* rgba = reinterpret_cast<const uint8*>(pixels + y * width);
+
+            for (uint32 x = 0; x < width; x++) {
+                line[3 * x] = rgba[4 * x];
+                line[3 * x + 1] = rgba[4 * x + 1];
+                line[3 * x + 2] = rgba[4 * x + 2];
+            }
+
+            if (fwrite(line.data(), 1, line.size(), f) != line.size()) {
+                fclose(f);
+                return false;
+            }
+        }
+
+        return fclose(f) == 0;
+    }
+
+    class Runner {
+       public:
+        Runner(double secondsLimit, double clockFactor)
+            : secondsLimit(secondsLimit), clockFactor(clockFactor) {}
+
+        // Returns false if emulation cannot proceed (debugger stopped, session suspended)
+        bool Run(double seconds) {
+            const double targetSeconds = min(virtualSeconds + seconds, secondsLimit);
+
+            while (virtualSeconds < targetSeconds) {
+                if (gDebugger.IsStopped()) {
+                    cout << "emulation stopped by debugger" << endl << flush;
+                    return false;
+                }
+
+                if (SuspendManager::IsSuspended()) {
+                    cout << "emulation suspended" << endl << flush;
+                    return false;
+                }
+
+                const uint32 clocksPerSecond = gSession->GetClocksPerSecond();
+                const uint32 sliceCycles = min<double>(
+                    clocksPerSecond / SLICES_PER_SECOND,
+                    ceil((targetSeconds - virtualSeconds) * clocksPerSecond));
+
+                const uint64 sliceStart = timestampNsec();
+                uint32 cycles = 0;
+
+                while (cycles < sliceCycles && !gDebugger.IsStopped() &&
+                       !SuspendManager::IsSuspended())
+                    cycles += gSession->RunEmulation(sliceCycles - cycles);
+
+                hostNsec += timestampNsec() - sliceStart;
+                totalCycles += cycles;
+                virtualSeconds += static_cast<double>(cycles) / clocksPerSecond;
+
+                if (clockFactor > 0) Throttle();
+            }
+
+            return true;
+        }
+
+        bool LimitReached() const { return virtualSeconds >= secondsLimit; }
+
+        bool SaveScreenshot(const string& file) {
+            if (!gSession->IsPowerOn() || !EmHAL::CopyLCDFrame(frame, true)) {
+                cout << "LCD is off" << endl << flush;
+                return false;
+            }
+
+            vector<uint32> pixels(frame.lineWidth * frame.lines);
+            frameConverter.Convert(frame, pixels.data(), frame.lineWidth,
+                                   EmHAL::GetLCD2bitMapping());
+
+            return writePpm(file, pixels.data(), frame.lineWidth, frame.lines);
+        }
+
+        void Report() const {
+            const double hostSeconds = static_cast<double>(hostNsec) / 1E9;
+
+            cout << fixed << setprecision(2);
+            cout << "virtual time: " << virtualSeconds << " sec, " << totalCycles << " cycles"
+                 << endl;
+            cout << "host time: " << hostSeconds << " sec";
+
+            if (hostNsec > 0) {
+                cout << " -> " << (totalCycles * 1000.) / hostNsec << " MHz, "
+                     << virtualSeconds / hostSeconds << "x realtime";
+            }
+
+            cout << endl << flush;
+        }
+
+       private:
+        void Throttle() {
+            if (realtimeStart == 0) realtimeStart = timestampNsec();
+
+            const uint64 dueNsec = realtimeStart + virtualSeconds / clockFactor * 1E9;
+            const uint64 now = timestampNsec();
+
+            if (dueNsec > now) usleep((dueNsec - now) / 1000);
+        }
+
+       private:
+        double secondsLimit;
+        double clockFactor;
+
+        double virtualSeconds{0};
+        uint64 totalCycles{0};
+        uint64 hostNsec{0};
+        uint64 realtimeStart{0};
+
+        Frame frame{320 * 480 * 4};
+        FrameConverter frameConverter;
+    };
+
+    struct Context : commands::Context {
+        Runner& runner;
+    };
+
+    Context* getContext(void* context) {
+        return static_cast<Context*>(static_cast<commands::Context*>(context));
+    }
+
+    void CmdRun(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() != 1) return env.PrintUsage();
+
+        double seconds;
+        istringstream s(args[0]);
+
+        s >> seconds;
+
+        if (s.fail() || !s.eof() || seconds < 0) {
+            cout << "invalid argument" << endl << flush;
+            return;
+        }
+
+        Runner& runner = getContext(context)->runner;
+
+        if (!runner.Run(seconds) || runner.LimitReached()) env.RequestQuit();
+    }
+
+    void CmdScreenshot(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() != 1) return env.PrintUsage();
+
+        if (!getContext(context)->runner.SaveScreenshot(args[0]))
+            cout << "failed to save screenshot to " << args[0] << endl << flush;
+    }
+
+    void CmdStats(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        getContext(context)->runner.Report();
+    }
+
+    const vector<cli::Command> commandList(
+        {{.name = "run",
+          .usage = "run <seconds>",
+          .description = "Run for the given number of virtual seconds.",
+          .cmd = CmdRun},
+         {.name = "screenshot",
+          .usage = "screenshot <file>",
+          .description = "Save the LCD as PPM.",
+          .cmd = CmdScreenshot},
+         {.name = "stats", .description = "Show performance statistics.", .cmd = CmdStats}});
+
+    void setupCard(const Options& options) {
+        string imageKey;
+        if (options.mountImage) imageKey = util::registerImage(*options.mountImage);
+
+        if (!(options.deviceId ? util::initializeSession(options.image, *options.deviceId)
+                               : util::initializeSession(options.image)))
+            exit(1);
+
+        if (!imageKey.empty() && gExternalStorage.RemountFailed()) {
+            cout << "remount failed" << endl << flush;
+
+            gExternalStorage.RemoveImage(imageKey);
+            imageKey.clear();
+        }
+
+        if (!imageKey.empty() && util::mountKey(imageKey))
+            cout << *options.mountImage << " mounted successfully" << endl << flush;
+    }
+
+    void run(const Options& options) {
+        srand(0);
+        signal(SIGPIPE, SIG_IGN);
+
+        setupCard(options);
+
+        Runner runner(options.seconds.value_or(HUGE_VAL), options.clockFactor);
+
+        if (options.scriptFile) {
+            GdbStub gdbStub(gDebugger, 0);
+
+            commands::Register();
+            cli::AddCommands(commandList);
+            cli::Start(options.scriptFile);
+
+            Context commandContext{{.debugger = gDebugger, .gdbStub = gdbStub}, runner};
+
+            while (!runner.LimitReached()) {
+                if (cli::Execute(static_cast<commands::Context*>(&commandContext))) break;
+
+                usleep(1000);
+            }
+
+            cli::Stop();
+        } else {
+            runner.Run(*options.seconds);
+        }
+
+        runner.Report();
+    }
+}  // namespace
+
+int main(int argc, const char** argv) {
+    class bad_device_id : public exception {};
+
+    argparse::ArgumentParser program("cloudpilot-headless");
+
+    program.add_description(
+        "cloudpilot-headless runs CloudpilotEmu sessions without display for testing and "
+        "benchmarking.");
+
+    program.add_argument("image").help("image or ROM file").required();
+
+    program.add_argument("--device-id", "-d")
+        .help("specify device ID")
+        .metavar("<device>")
+        .action([](const string& value) -> string {
+            for (auto& deviceId : util::SUPPORTED_DEVICES)
+                if (value == deviceId) return deviceId;
+
+            throw bad_device_id();
+        });
+
+    program.add_argument("--mount").metavar("<image file>").help("mount card image");
+
+    program.add_argument("--script", "-s")
+        .metavar("<script file>")
+        .help("execute script; virtual time advances only through \"run\"");
+
+    program.add_argument("--seconds")
+        .metavar("<seconds>")
+        .help("stop after the given number of virtual seconds")
+        .scan<'g', double>();
+
+    program.add_argument("--clock-factor")
+        .metavar("<factor>")
+        .help("throttle to the given multiple of realtime (0: unthrottled)")
+        .scan<'g', double>()
+        .default_value(0.);
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const bad_device_id& e) {
+        cerr << "bad device ID; valid IDs are:" << endl;
+
+        for (auto& deviceId : util::SUPPORTED_DEVICES) cerr << "  " << deviceId << endl;
+
+        exit(1);
+    } catch (const invalid_argument& e) {
+        cerr << "invalid argument" << endl << endl;
+        cerr << program;
+
+        exit(1);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl << endl;
+        cerr << program;
+
+        exit(1);
+    }
+
+    Options options;
+
+    options.image = program.get("image");
+    options.deviceId = program.present("--device-id");
+    options.mountImage = program.present("--mount");
+    options.scriptFile = program.present("--script");
+    options.seconds = program.present<double>("--seconds");
+    options.clockFactor = program.get<double>("--clock-factor");
+
+    if (!options.scriptFile && !options.seconds) {
+        cerr << "either a duration or a script is required" << endl << endl;
+        cerr << program;
+
+        exit(1);
+    }
+
+    if (options.clockFactor < 0) {
+        cerr << "clock factor must not be negative" << endl;
+
+        exit(1);
+    }
+
+    run(options);
+}
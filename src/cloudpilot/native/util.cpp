@@ -2,6 +2,7 @@
 
 #include <fstream>
 
+#include "CowImage.h"
 #include "EmSession.h"
 #include "ExternalStorage.h"
 #include "SessionImage.h"
@@ -109,24 +110,24 @@ bool util::initializeSession(string file, optional<string> deviceId) {
 bool util::mountImage(const string& image) { return mountKey(registerImage(image)); }
 
 string util::registerImage(const string& image) {
-    unique_ptr<uint8[]> fileBuffer;
-    size_t fileSize;
+    unique_ptr<CowImage> file = util::MapFile(image);
 
-    if (!util::ReadFile(image, fileBuffer, fileSize)) {
+    if (!file) {
         cerr << "unable to open card " << image << endl;
 
         return "";
     }
 
-    string key = md5(fileBuffer.get(), fileSize);
+    // The card is an overlay over the file, so untouched blocks are never copied into memory
+    auto card = make_shared<CardImage>(*file);
+    string key = md5(card->RawData(), card->BlocksTotal() * CardImage::BLOCK_SIZE);
 
-    if (!gExternalStorage.AddImage(key, fileBuffer.get(), fileSize)) {
+    if (file->GetSize() % CardImage::BLOCK_SIZE != 0 || !gExternalStorage.AddImage(key, card)) {
         cerr << "failed to register card " << image << endl;
 
         return "";
     }
 
-    fileBuffer.release();
     return key;
 }
 
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmCommon.h"
+// clang-format on
+
+#include "Debugger.h"
+#include "SessionTest.h"
+
+namespace {
+    using WatchpointType = Debugger::WatchpointType;
+
+    // Addresses that are 1MB apart share a page in the watchpoint filter
+    constexpr emuptr FILTER_ALIAS = 4096 * 256;
+
+    class DebuggerTest : public SessionTest {
+       protected:
+        void SetUp() override {
+            SessionTest::SetUp();
+
+            debugger.Enable();
+        }
+
+        bool Read8(emuptr address) { return Access(&Debugger::NotifyMemoryRead8, address); }
+        bool Write8(emuptr address) { return Access(&Debugger::NotifyMemoryWrite8, address); }
+        bool Write16(emuptr address) { return Access(&Debugger::NotifyMemoryWrite16, address); }
+        bool Write32(emuptr address) { return Access(&Debugger::NotifyMemoryWrite32, address); }
+
+       private:
+        bool Access(void (Debugger::*notify)(emuptr), emuptr address) {
+            debugger.Continue();
+            (debugger.*notify)(address);
+
+            return debugger.IsStopped();
+        }
+
+       protected:
+        Debugger debugger;
+    };
+
+    TEST_F(DebuggerTest, WatchpointsTriggerOnTheirRangeOnly) {
+        debugger.SetWatchpoint(0x1000, WatchpointType::write, 4);
+
+        EXPECT_FALSE(Write8(0x0fff));
+        for (emuptr address = 0x1000; address < 0x1004; address++)
+            EXPECT_TRUE(Write8(address)) << address;
+        EXPECT_FALSE(Write8(0x1004));
+
+        EXPECT_FALSE(Read8(0x1000));
+
+        EXPECT_TRUE(Write8(0x1002));
+        EXPECT_EQ(debugger.GetBreakState(), Debugger::BreakState::trapWrite);
+        EXPECT_EQ(debugger.GetWatchpointAddress(), 0x1002u);
+        EXPECT_EQ(debugger.GetWatchpointType(), WatchpointType::write);
+    }
+
+    TEST_F(DebuggerTest, ClearingRemovesTheWatchpoint) {
+        debugger.SetWatchpoint(0x1000, WatchpointType::readwrite, 4);
+
+        EXPECT_TRUE(Read8(0x1000));
+        EXPECT_EQ(debugger.GetWatchpointType(), WatchpointType::readwrite);
+
+        debugger.ClearWatchpoint(0x1000, WatchpointType::read, 4);
+
+        EXPECT_FALSE(Read8(0x1000));
+        EXPECT_TRUE(Write8(0x1000));
+
+        debugger.ClearWatchpoint(0x1000, WatchpointType::write, 4);
+
+        EXPECT_FALSE(Write8(0x1000));
+        EXPECT_FALSE(Write32(0x1000));
+    }
+
+    TEST_F(DebuggerTest, PartialClearTrimsTheRange) {
+        debugger.SetWatchpoint(0x1000, WatchpointType::write, 16);
+
+        debugger.ClearWatchpoint(0x1000, WatchpointType::write, 4);
+        debugger.ClearWatchpoint(0x100c, WatchpointType::write, 8);
+
+        EXPECT_FALSE(Write8(0x1003));
+        EXPECT_TRUE(Write8(0x1004));
+        EXPECT_TRUE(Write8(0x100b));
+        EXPECT_FALSE(Write8(0x100c));
+
+        EXPECT_TRUE(Write32(0x1001));
+        EXPECT_FALSE(Write32(0x1000 - 4));
+    }
+
+    TEST_F(DebuggerTest, PartialClearSplitsTheRange) {
+        debugger.SetWatchpoint(0x1000, WatchpointType::write, 16);
+
+        debugger.ClearWatchpoint(0x1004, WatchpointType::write, 8);
+
+        EXPECT_TRUE(Write8(0x1003));
+        for (emuptr address = 0x1004; address < 0x100c; address++)
+            EXPECT_FALSE(Write8(address)) << address;
+        EXPECT_TRUE(Write8(0x100c));
+
+        EXPECT_TRUE(Write16(0x1002));
+        EXPECT_FALSE(Write32(0x1004));
+        EXPECT_FALSE(Write32(0x1008));
+        EXPECT_TRUE(Write32(0x1009));
+    }
+
+    TEST_F(DebuggerTest, AccessesStraddlingAPageBoundaryTrigger) {
+        debugger.SetWatchpoint(0x1100, WatchpointType::write, 1);
+
+        EXPECT_TRUE(Write16(0x10ff));
+        EXPECT_TRUE(Write32(0x10fd));
+        EXPECT_FALSE(Write32(0x10fc));
+
+        debugger.ClearWatchpoint(0x1100, WatchpointType::write, 1);
+        debugger.SetWatchpoint(0x10ff, WatchpointType::write, 1);
+
+        EXPECT_TRUE(Write16(0x10fe));
+        EXPECT_TRUE(Write32(0x10ff));
+        EXPECT_FALSE(Write32(0x1100));
+    }
+
+    TEST_F(DebuggerTest, AliasedPagesOutsideTheBoundsAreRejected) {
+        debugger.SetWatchpoint(0x1000, WatchpointType::write, 4);
+
+        EXPECT_FALSE(Write8(0x1000 + FILTER_ALIAS));
+        EXPECT_FALSE(Write8(0x1000 - 0x100 + FILTER_ALIAS));
+    }
+
+    TEST_F(DebuggerTest, AliasedPagesWithinTheBoundsAreRejected) {
+        debugger.SetWatchpoint(0x1000, WatchpointType::write, 4);
+        debugger.SetWatchpoint(0x1000 + 2 * FILTER_ALIAS, WatchpointType::write, 4);
+
+        // Both the bounds and the filter page match, so only the exact lookup rejects these
+        EXPECT_FALSE(Write8(0x1000 + FILTER_ALIAS));
+        EXPECT_FALSE(Write32(0x1000 + FILTER_ALIAS + 0xfc));
+
+        EXPECT_TRUE(Write8(0x1000));
+        EXPECT_TRUE(Write8(0x1003 + 2 * FILTER_ALIAS));
+    }
+}  // namespace
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmCommon.h"
+// clang-format on
+
+#include <memory>
+#include <thread>
+
+#include "EmMemory.h"
+#include "EmSession.h"
+#include "MemoryRegion.h"
+#include "SessionTest.h"
+
+namespace {
+    // Offsets in three different pages of RAM
+    constexpr size_t SHARED = 0x1000;
+    constexpr size_t PARENT = 0x2000;
+    constexpr size_t CHILD = 0x3000;
+
+    uint8* ram() { return Memory::GetForRegion(MemoryRegion::ram); }
+
+    class EmSessionCloneTest : public SessionTest {
+       protected:
+        // Clones the snapshot on a separate thread, runs the callback on the clone and disposes
+        // the clone before the thread exits.
+        template <typename T>
+        void WithClone(const SessionSnapshot& snapshot, T callback) {
+            std::thread thread([&]() {
+                EXPECT_TRUE(gSession->Clone(snapshot));
+                callback();
+
+                gSession->Deinitialize();
+            });
+
+            thread.join();
+        }
+    };
+
+    TEST_F(EmSessionCloneTest, ClonesDoNotSeeEachOthersWrites) {
+        ram()[SHARED] = 0x11;
+
+        auto snapshot = gSession->Snapshot();
+        ASSERT_TRUE(snapshot);
+
+        ram()[SHARED] = 0x22;
+        ram()[PARENT] = 0x33;
+
+        WithClone(*snapshot, []() {
+            EXPECT_NE(ram(), nullptr);
+            EXPECT_EQ(gSession->GetDevice().GetIDString(), "PalmPilot");
+
+            EXPECT_EQ(ram()[SHARED], 0x11);
+            EXPECT_EQ(ram()[PARENT], 0x00);
+
+            ram()[SHARED] = 0x44;
+            ram()[CHILD] = 0x55;
+        });
+
+        WithClone(*snapshot, []() {
+            EXPECT_EQ(ram()[SHARED], 0x11);
+            EXPECT_EQ(ram()[CHILD], 0x00);
+        });
+
+        EXPECT_EQ(ram()[SHARED], 0x22);
+        EXPECT_EQ(ram()[PARENT], 0x33);
+        EXPECT_EQ(ram()[CHILD], 0x00);
+    }
+
+    TEST_F(EmSessionCloneTest, ClonesStartWithCleanDirtyPages) {
+        gSession->GetDirtyPagesPtr()[0] = 0xff;
+
+        auto snapshot = gSession->Snapshot();
+        ASSERT_TRUE(snapshot);
+
+        WithClone(*snapshot, []() {
+            const uint8* dirtyPages = gSession->GetDirtyPagesPtr();
+            const size_t size = Memory::GetTotalMemorySize() / 1024 / 8;
+
+            for (size_t i = 0; i < size; i++) ASSERT_EQ(dirtyPages[i], 0) << i;
+        });
+    }
+}  // namespace
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "FrameConverter.h"
+// clang-format on
+
+#include <vector>
+
+#include "Nibbler.h"
+
+namespace {
+    constexpr uint32 PITCH = 40;
+    constexpr uint32 LINES = 4;
+
+    class FrameConverterTest : public ::testing::Test {
+       public:
+        FrameConverterTest() : pixels(PITCH * LINES, 0) {
+            uint8* buffer = frame.GetBuffer();
+            for (uint32 i = 0; i < frame.GetBufferSize(); i++) buffer[i] = i * 37 + 11;
+        }
+
+       protected:
+        void SetupFrame(uint8 bpp, uint8 margin, uint32 lineWidth) {
+            frame.bpp = bpp;
+            frame.margin = margin;
+            frame.lineWidth = lineWidth;
+            frame.lines = LINES;
+            frame.bytesPerLine = 16;
+            frame.firstDirtyLine = 1;
+            frame.lastDirtyLine = 2;
+            frame.CollapseDirtySpans();
+        }
+
+        bool IsDirty(uint32 y) {
+            for (size_t i = 0; i < frame.dirtySpanCount; i++)
+                if (y >= frame.dirtySpans[i].firstLine && y <= frame.dirtySpans[i].lastLine)
+                    return true;
+
+            return false;
+        }
+
+        // Palette indices as the renderer used to extract them
+        template <int bpp>
+        uint8 Index(uint32 x, uint32 y) {
+            Nibbler<bpp> nibbler;
+            nibbler.reset(frame.GetBuffer() + y * frame.bytesPerLine, frame.margin + x);
+
+            return nibbler.nibble();
+        }
+
+        template <int bpp>
+        void ExpectIndexedFrame(uint16 palette2bitMapping) {
+            converter.Convert(frame, pixels.data(), PITCH, palette2bitMapping);
+
+            for (uint32 y = 0; y < LINES; y++)
+                for (uint32 x = 0; x < PITCH; x++) {
+                    const bool converted = IsDirty(y) && x < frame.lineWidth;
+
+                    if (!converted) {
+                        ASSERT_EQ(pixels[y * PITCH + x], 0u) << x << ", " << y;
+                        continue;
+                    }
+
+                    const uint32 pixel = pixels[y * PITCH + x];
+                    const uint8 index = Index<bpp>(x, y);
+
+                    if constexpr (bpp == 2) {
+                        const uint8 shade = (palette2bitMapping >> (4 * index)) & 0x0f;
+                        ASSERT_EQ(pixel, pixels4bit[shade]) << x << ", " << y;
+                    } else if constexpr (bpp == 4) {
+                        ASSERT_EQ(pixel, pixels4bit[index]) << x << ", " << y;
+                    } else {
+                        ASSERT_EQ(pixel, index ? 0xff000000 : 0xffd2d2d2) << x << ", " << y;
+                    }
+                }
+        }
+
+       protected:
+        Frame frame{16 * LINES};
+        FrameConverter converter;
+        std::vector<uint32> pixels;
+
+        const uint32 pixels4bit[16] = {0xffd2d2d2, 0xffc4c4c4, 0xffb6b6b6, 0xffa8a8a8,
+                                       0xff9a9a9a, 0xff8c8c8c, 0xff7e7e7e, 0xff707070,
+                                       0xff626262, 0xff545454, 0xff464646, 0xff383838,
+                                       0xff2a2a2a, 0xff1c1c1c, 0xff0e0e0e, 0xff000000};
+    };
+
+    TEST_F(FrameConverterTest, itConverts1bitFramesWithUnalignedMargin) {
+        SetupFrame(1, 3, 37);
+        ExpectIndexedFrame<1>(0);
+    }
+
+    TEST_F(FrameConverterTest, itConverts2bitFramesWithMapping) {
+        SetupFrame(2, 1, 30);
+        ExpectIndexedFrame<2>(0xfa50);
+
+        pixels.assign(PITCH * LINES, 0);
+        ExpectIndexedFrame<2>(0x3210);
+    }
+
+    TEST_F(FrameConverterTest, itConverts4bitFrames) {
+        SetupFrame(4, 0, 24);
+        ExpectIndexedFrame<4>(0);
+
+        pixels.assign(PITCH * LINES, 0);
+        SetupFrame(4, 1, 3);
+        ExpectIndexedFrame<4>(0);
+    }
+
+    TEST_F(FrameConverterTest, itSkipsLinesBetweenDirtySpans) {
+        SetupFrame(4, 0, 24);
+
+        frame.firstDirtyLine = 0;
+        frame.lastDirtyLine = 3;
+        frame.dirtySpans[0] = {0, 0};
+        frame.dirtySpans[1] = {2, 3};
+        frame.dirtySpanCount = 2;
+
+        ExpectIndexedFrame<4>(0);
+    }
+}  // namespace
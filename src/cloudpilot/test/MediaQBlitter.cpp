@@ -0,0 +1,339 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmCommon.h"
+// clang-format on
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EmBankRegs.h"
+#include "EmMemory.h"
+#include "EmRegsFrameBuffer.h"
+#include "EmRegsMediaQ11xx.h"
+#include "MemoryRegion.h"
+
+namespace {
+    constexpr emuptr GE_BASE = MMIO_BASE + 0x80 * 4;
+
+    constexpr uint32 GE00_BITBLT = 2 << 8;
+    constexpr uint32 GE00_X_DIRECTION = 1 << 11;
+    constexpr uint32 GE00_Y_DIRECTION = 1 << 12;
+    constexpr uint32 GE00_MONO_PATTERN = 1 << 15;
+    constexpr uint32 GE00_COLOR_TRANS_ENABLE = 1 << 16;
+    constexpr uint32 GE00_DEST_TRANS_POLARITY = 1 << 17;
+    constexpr uint32 GE00_SOLID_SOURCE_COLOR = 1 << 23;
+    constexpr uint32 GE00_CLIP_ENABLE = 1 << 26;
+    constexpr uint32 GE00_SOLID_PATTERN = 1 << 30;
+    constexpr uint32 GE00_COLOR_TRANS_CMP_DEST = 1u << 31;
+
+    constexpr uint8 ROP_SRC_COPY = 0xCC;
+    constexpr uint8 ROP_PAT_COPY = 0xF0;
+    constexpr uint8 ROP_SRC_INVERT = 0x66;
+    constexpr uint8 ROP_PAT_INVERT = 0x5A;
+
+    constexpr uint8 FAST_ROPS[] = {ROP_SRC_COPY, ROP_PAT_COPY, ROP_SRC_INVERT, ROP_PAT_INVERT};
+
+    constexpr uint32 WIDTH = 160;
+    constexpr uint32 HEIGHT = 120;
+    constexpr uint32 BASE_ADDR = 0x400;
+
+    // Everything beyond the visible area must stay untouched as well
+    constexpr uint32 COMPARED_SIZE = 0x10000;
+
+    // The destination rectangle of most blits
+    constexpr uint16 LEFT = 40;
+    constexpr uint16 TOP = 30;
+    constexpr uint16 BLIT_WIDTH = 48;
+    constexpr uint16 BLIT_HEIGHT = 40;
+
+    struct Rect {
+        uint16 left, top, right, bottom;
+    };
+
+    // Cuts every edge of the destination, covers its left half, and misses it completely
+    constexpr Rect CLIP_RECTS[] = {{50, 35, 80, 60}, {0, 0, 64, 1023}, {100, 0, 150, 20}};
+
+    // Source offsets of overlapping scrolls relative to the destination
+    constexpr int16 SCROLLS[][2] = {{0, 4}, {0, -4}, {6, 0}, {-6, 0}, {3, -2}, {-1, 1}};
+
+    enum class Depth : uint32 { bpp8 = 0, bpp16 = 1 };
+
+    struct Blit {
+        uint8 rop;
+        Depth depth;
+
+        // Solid pattern or solid source color instead of a mono pattern or a screen source
+        bool solid;
+
+        int16 srcDx{100 - LEFT};
+        int16 srcDy{70 - TOP};
+
+        bool xReverse{false};
+        bool yReverse{false};
+
+        const Rect* clip{nullptr};
+
+        bool transparent{false};
+        bool transPolarity{false};
+        bool transCmpDest{false};
+    };
+
+    bool UsesPattern(uint8 rop) { return rop == ROP_PAT_COPY || rop == ROP_PAT_INVERT; }
+
+    uint32 BytesPerPixel(Depth depth) { return depth == Depth::bpp8 ? 1 : 2; }
+
+    uint32 Stride(Depth depth) { return WIDTH * BytesPerPixel(depth) + 16; }
+
+    uint16 TransColor(Depth depth) { return depth == Depth::bpp8 ? 0x3c : 0x3c5a; }
+
+    uint16 Color(Depth depth, uint16 color) { return depth == Depth::bpp8 ? color & 0xff : color; }
+}  // namespace
+
+// A MediaQ chip backed by its framebuffer, without the rest of a device. The blitter accesses
+// the framebuffer through the memory banks, so these are set up as Memory::Initialize would.
+class MediaQBlitterTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        MemoryRegionMap regions;
+        regions.AllocateRegion(MemoryRegion::framebuffer, EmRegsMediaQ11xx::FRAMEBUFFER_SIZE);
+
+        ASSERT_TRUE(Memory::InitializeRegions(regions));
+
+        framebuffer = new EmRegsFrameBuffer(T_BASE);
+        mediaQ = new EmRegsMediaQ11xx(*framebuffer, MMIO_BASE, T_BASE);
+
+        // EmBankRegs takes ownership
+        EmBankRegs::AddSubBank(framebuffer);
+        EmBankRegs::AddSubBank(mediaQ);
+
+        framebuffer->Initialize();
+        mediaQ->Initialize();
+        mediaQ->Reset(true);
+
+        EmBankRegs::SetBankHandlers();
+    }
+
+    void TearDown() override { EmBankRegs::Dispose(); }
+
+    // Runs the blit through the generic pipeline and through the fast path, starting from the
+    // same framebuffer contents, and compares the results.
+    void ExpectFastBlitMatches(const Blit& blit) {
+        SCOPED_TRACE(Describe(blit));
+
+        FillFramebuffer(blit.depth);
+        const std::vector<uint8> initial(Framebuffer(), Framebuffer() + COMPARED_SIZE);
+
+        SetupRegisters(blit);
+
+        mediaQ->PrvIncBlitterInit();
+        ASSERT_TRUE(mediaQ->PrvFastBlitSupported());
+
+        mediaQ->PrvIncBlitterRun();
+        ASSERT_FALSE(mediaQ->fBlitInProgress);
+
+        const std::vector<uint8> generic(Framebuffer(), Framebuffer() + COMPARED_SIZE);
+        memcpy(Framebuffer(), initial.data(), COMPARED_SIZE);
+
+        mediaQ->PrvIncBlitterInit();
+        mediaQ->PrvFastBlit();
+        ASSERT_FALSE(mediaQ->fBlitInProgress);
+
+        for (uint32 offset = 0; offset < COMPARED_SIZE; offset++) {
+            if (Framebuffer()[offset] == generic[offset]) continue;
+
+            const uint32 pixel = offset - BASE_ADDR;
+
+            FAIL() << "first difference at x = "
+                   << (pixel % Stride(blit.depth)) / BytesPerPixel(blit.depth)
+                   << ", y = " << pixel / Stride(blit.depth);
+        }
+
+        // Make sure that the comparison is not vacuous
+        if (!blit.clip && !blit.transparent) {
+            EXPECT_NE(generic, initial);
+        }
+    }
+
+    // Calls back with every blit that the fast path handles, at both color depths
+    template <typename F>
+    void ForEachFastBlit(F callback) {
+        for (uint8 rop : FAST_ROPS)
+            for (Depth depth : {Depth::bpp8, Depth::bpp16})
+                for (bool solid : {false, true}) callback(Blit{rop, depth, solid});
+    }
+
+   private:
+    uint8* Framebuffer() { return Memory::GetForRegion(MemoryRegion::framebuffer); }
+
+    void FillFramebuffer(Depth depth) {
+        uint32 seed = 0x1234567;
+        uint8* buffer = Framebuffer();
+
+        for (uint32 offset = 0; offset < COMPARED_SIZE; offset += BytesPerPixel(depth)) {
+            seed = seed * 1103515245 + 12345;
+
+            // Every fourth pixel is transparent
+            const uint16 color =
+                (seed >> 16) % 4 == 0 ? TransColor(depth) : Color(depth, seed >> 8);
+
+            if (depth == Depth::bpp8)
+                EmMemDoPut8(buffer + offset, color);
+            else
+                EmMemDoPut16(buffer + offset, color);
+        }
+    }
+
+    // With DC00R at its reset value, the bus swaps the bytes of a long
+    void WriteRegister(uint32 index, uint32 value) {
+        mediaQ->MQWrite(GE_BASE + 4 * index, 4, __builtin_bswap32(value));
+    }
+
+    void SetupRegisters(const Blit& blit) {
+        const bool pattern = UsesPattern(blit.rop);
+
+        uint32 ge00 = blit.rop | GE00_BITBLT;
+
+        if (blit.xReverse) ge00 |= GE00_X_DIRECTION;
+        if (blit.yReverse) ge00 |= GE00_Y_DIRECTION;
+        if (blit.clip) ge00 |= GE00_CLIP_ENABLE;
+        if (blit.transparent) ge00 |= GE00_COLOR_TRANS_ENABLE;
+        if (blit.transPolarity) ge00 |= GE00_DEST_TRANS_POLARITY;
+        if (blit.transCmpDest) ge00 |= GE00_COLOR_TRANS_CMP_DEST;
+
+        if (pattern) ge00 |= blit.solid ? GE00_SOLID_PATTERN : GE00_MONO_PATTERN;
+        if (!pattern && blit.solid) ge00 |= GE00_SOLID_SOURCE_COLOR;
+
+        // Reversed blits start at the bottom right corner of the same rectangle
+
+        const uint32 xDest = blit.xReverse ? LEFT + BLIT_WIDTH - 1 : LEFT;
+        const uint32 yDest = blit.yReverse ? TOP + BLIT_HEIGHT - 1 : TOP;
+
+        // Nonzero pattern offsets check the pattern phase
+
+        WriteRegister(0x00, ge00);
+        WriteRegister(0x01, BLIT_WIDTH | (BLIT_HEIGHT << 16));
+        WriteRegister(0x02, xDest | (3 << 13) | (yDest << 16) | (5u << 29));
+        WriteRegister(0x03, (xDest + blit.srcDx) | ((yDest + blit.srcDy) << 16));
+        WriteRegister(0x04, TransColor(blit.depth));
+
+        if (blit.clip) {
+            WriteRegister(0x05, blit.clip->left | (blit.clip->top << 16));
+            WriteRegister(0x06, blit.clip->right | (blit.clip->bottom << 16));
+        }
+
+        WriteRegister(0x07, Color(blit.depth, 0xa5c3));
+        WriteRegister(0x08, Color(blit.depth, 0x0ff0));
+        WriteRegister(0x09, 0);
+        WriteRegister(0x0A, Stride(blit.depth) | (static_cast<uint32>(blit.depth) << 30));
+        WriteRegister(0x0B, BASE_ADDR);
+        WriteRegister(0x10, 0x5aa5c33c);
+        WriteRegister(0x11, 0x0ff01248);
+        WriteRegister(0x12, Color(blit.depth, 0x1e2d));
+        WriteRegister(0x13, TransColor(blit.depth));
+    }
+
+    static std::string Describe(const Blit& blit) {
+        std::stringstream ss;
+
+        ss << "rop " << std::hex << static_cast<int>(blit.rop) << std::dec
+           << (blit.depth == Depth::bpp8 ? ", 8bpp" : ", 16bpp")
+           << (blit.solid ? ", solid" : "") << ", source offset " << blit.srcDx << "/"
+           << blit.srcDy << ", direction " << (blit.xReverse ? "-" : "+")
+           << (blit.yReverse ? "-" : "+");
+
+        if (blit.clip)
+            ss << ", clip " << blit.clip->left << "/" << blit.clip->top << " - "
+               << blit.clip->right << "/" << blit.clip->bottom;
+
+        if (blit.transparent)
+            ss << ", transparency " << (blit.transPolarity ? "opaque " : "")
+               << (blit.transCmpDest ? "dest" : "source");
+
+        return ss.str();
+    }
+
+   private:
+    EmRegsFrameBuffer* framebuffer{nullptr};
+    EmRegsMediaQ11xx* mediaQ{nullptr};
+};
+
+namespace {
+    TEST_F(MediaQBlitterTest, PlainBlitsMatchTheGenericPipeline) {
+        ForEachFastBlit([&](Blit blit) {
+            for (bool xReverse : {false, true})
+                for (bool yReverse : {false, true}) {
+                    blit.xReverse = xReverse;
+                    blit.yReverse = yReverse;
+
+                    ExpectFastBlitMatches(blit);
+                }
+        });
+    }
+
+    TEST_F(MediaQBlitterTest, ClippedBlitsMatchTheGenericPipeline) {
+        ForEachFastBlit([&](Blit blit) {
+            for (const Rect& clip : CLIP_RECTS)
+                for (bool xReverse : {false, true})
+                    for (bool yReverse : {false, true}) {
+                        blit.clip = &clip;
+                        blit.xReverse = xReverse;
+                        blit.yReverse = yReverse;
+
+                        ExpectFastBlitMatches(blit);
+                    }
+        });
+    }
+
+    TEST_F(MediaQBlitterTest, TransparentBlitsMatchTheGenericPipeline) {
+        ForEachFastBlit([&](Blit blit) {
+            for (bool transPolarity : {false, true})
+                for (bool transCmpDest : {false, true})
+                    for (bool xReverse : {false, true}) {
+                        blit.transparent = true;
+                        blit.transPolarity = transPolarity;
+                        blit.transCmpDest = transCmpDest;
+                        blit.xReverse = xReverse;
+
+                        ExpectFastBlitMatches(blit);
+                    }
+        });
+    }
+
+    // Both the direction that the OS picks for a scroll and the opposite one, which reads
+    // pixels that the blit has already written
+    TEST_F(MediaQBlitterTest, OverlappingScrollsMatchTheGenericPipeline) {
+        ForEachFastBlit([&](Blit blit) {
+            for (const auto& scroll : SCROLLS)
+                for (bool xReverse : {false, true})
+                    for (bool yReverse : {false, true}) {
+                        blit.srcDx = scroll[0];
+                        blit.srcDy = scroll[1];
+                        blit.xReverse = xReverse;
+                        blit.yReverse = yReverse;
+
+                        ExpectFastBlitMatches(blit);
+                    }
+        });
+    }
+
+    TEST_F(MediaQBlitterTest, ClippedTransparentScrollsMatchTheGenericPipeline) {
+        ForEachFastBlit([&](Blit blit) {
+            for (const auto& scroll : SCROLLS)
+                for (bool xReverse : {false, true})
+                    for (bool yReverse : {false, true}) {
+                        blit.srcDx = scroll[0];
+                        blit.srcDy = scroll[1];
+                        blit.xReverse = xReverse;
+                        blit.yReverse = yReverse;
+                        blit.clip = &CLIP_RECTS[0];
+                        blit.transparent = true;
+                        blit.transCmpDest = scroll[0] < 0;
+
+                        ExpectFastBlitMatches(blit);
+                    }
+        });
+    }
+}  // namespace
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmCommon.h"
+// clang-format on
+
+#include "EmMemory.h"
+#include "MemoryRegion.h"
+#include "MetaMemory.h"
+#include "SessionTest.h"
+
+namespace {
+    constexpr uint32 PAGE_SIZE = 0x400;
+    constexpr uint32 BANK_SIZE = 0x10000;
+
+    // RAM starts at zero, so emulated addresses and RAM offsets coincide
+    class MetaMemoryTest : public SessionTest {
+       protected:
+        void SetUp() override {
+            SessionTest::SetUp();
+
+            ASSERT_EQ(EmMemGetRealAddress(0), Memory::GetForRegion(MemoryRegion::ram));
+            ASSERT_GE(Memory::GetRegionSize(MemoryRegion::ram), 4 * BANK_SIZE);
+        }
+    };
+
+    TEST_F(MetaMemoryTest, MarksCoverWholePages) {
+        MetaMemory::MarkScreen(0x2100, 0x2101);
+
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(0x1fff, 1));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(0x2000, 1));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(0x23ff, 1));
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(0x2400, 1));
+    }
+
+    TEST_F(MetaMemoryTest, MarkSpansBankBoundary) {
+        MetaMemory::MarkScreen(BANK_SIZE - PAGE_SIZE, BANK_SIZE + PAGE_SIZE);
+
+        EXPECT_EQ(MetaMemory::GetScreenPages(0), 1ULL << 63);
+        EXPECT_EQ(MetaMemory::GetScreenPages(BANK_SIZE), 1ULL);
+        EXPECT_EQ(MetaMemory::GetScreenPages(2 * BANK_SIZE), 0ULL);
+
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(BANK_SIZE - PAGE_SIZE - 1, 1));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(BANK_SIZE - PAGE_SIZE, 1));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(BANK_SIZE + PAGE_SIZE - 1, 1));
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(BANK_SIZE + PAGE_SIZE, 1));
+    }
+
+    TEST_F(MetaMemoryTest, UnmarkSpansBankBoundary) {
+        MetaMemory::MarkScreen(BANK_SIZE - 2 * PAGE_SIZE, BANK_SIZE + 2 * PAGE_SIZE);
+        MetaMemory::UnmarkScreen(BANK_SIZE - PAGE_SIZE, BANK_SIZE + PAGE_SIZE);
+
+        EXPECT_EQ(MetaMemory::GetScreenPages(0), 1ULL << 62);
+        EXPECT_EQ(MetaMemory::GetScreenPages(BANK_SIZE), 1ULL << 1);
+
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(BANK_SIZE - PAGE_SIZE - 1, 1));
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(BANK_SIZE - PAGE_SIZE, 1));
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(BANK_SIZE + PAGE_SIZE - 1, 1));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(BANK_SIZE + PAGE_SIZE, 1));
+    }
+
+    TEST_F(MetaMemoryTest, AccessesStraddlingAMarkedPageEdgeHit) {
+        MetaMemory::MarkScreen(0x2000, 0x2400);
+
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(0x1ffe, 2));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(0x1fff, 2));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(0x1ffd, 4));
+
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(0x23ff, 2));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(0x23fd, 4));
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(0x2400, 4));
+    }
+
+    TEST_F(MetaMemoryTest, AccessesStraddlingABankEdgeHit) {
+        MetaMemory::MarkScreen(BANK_SIZE, BANK_SIZE + PAGE_SIZE);
+
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(BANK_SIZE - 4, 4));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(BANK_SIZE - 2, 4));
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(BANK_SIZE - 1, 2));
+
+        MetaMemory::UnmarkScreen(BANK_SIZE, BANK_SIZE + PAGE_SIZE);
+        MetaMemory::MarkScreen(BANK_SIZE - PAGE_SIZE, BANK_SIZE);
+
+        EXPECT_TRUE(MetaMemory::IsScreenBuffer(BANK_SIZE - 2, 4));
+        EXPECT_FALSE(MetaMemory::IsScreenBuffer(BANK_SIZE, 4));
+    }
+
+    TEST_F(MetaMemoryTest, ResetClearsAllMarks) {
+        MetaMemory::MarkScreen(BANK_SIZE - PAGE_SIZE, BANK_SIZE + PAGE_SIZE);
+        MetaMemory::Reset();
+
+        EXPECT_EQ(MetaMemory::GetScreenPages(0), 0ULL);
+        EXPECT_EQ(MetaMemory::GetScreenPages(BANK_SIZE), 0ULL);
+    }
+}  // namespace
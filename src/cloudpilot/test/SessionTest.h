@@ -0,0 +1,52 @@
+#ifndef _SESSION_TEST_H_
+#define _SESSION_TEST_H_
+
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmCommon.h"
+// clang-format on
+
+#include <cstring>
+
+#include "EmDevice.h"
+#include "EmSession.h"
+
+// Runs each test on a session that is initialized from a synthetic ROM. The ROM consists of
+// nothing but a v1 card header and is never executed, but this is enough to bring up memory
+// and hardware.
+class SessionTest : public ::testing::Test {
+   public:
+    static constexpr size_t ROM_SIZE = 256 * 1024;
+
+   protected:
+    void SetUp() override {
+        ASSERT_TRUE(gSession->Initialize(new EmDevice("PalmPilot"), CreateRom(), ROM_SIZE));
+    }
+
+    void TearDown() override { gSession->Deinitialize(); }
+
+   private:
+    static uint8* CreateRom() {
+        uint8* rom = new uint8[ROM_SIZE];
+        memset(rom, 0, ROM_SIZE);
+
+        Put32(rom, 0, 0x1000);      // initStack
+        Put32(rom, 4, 0x10c00100);  // resetVector
+        Put32(rom, 8, 0xfeedbeef);  // signature
+        Put16(rom, 12, 1);          // hdrVersion
+
+        return rom;
+    }
+
+    static void Put32(uint8* buffer, size_t offset, uint32 value) {
+        for (int i = 0; i < 4; i++) buffer[offset + i] = value >> (24 - 8 * i);
+    }
+
+    static void Put16(uint8* buffer, size_t offset, uint16 value) {
+        buffer[offset] = value >> 8;
+        buffer[offset + 1] = value;
+    }
+};
+
+#endif  // _SESSION_TEST_H_
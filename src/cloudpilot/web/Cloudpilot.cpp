@@ -139,6 +139,11 @@ Frame& Cloudpilot::CopyFrame() {
     return frame;
 }
 
+void Cloudpilot::ConvertFrame(void* pixels, int pitch) {
+    frameConverter.Convert(frame, static_cast<uint32*>(pixels), pitch,
+                           EmHAL::GetLCD2bitMapping());
+}
+
 bool Cloudpilot::IsScreenDirty() { return gSystemState.IsScreenDirty(); }
 
 bool Cloudpilot::IsUIInitialized() { return gSystemState.IsUIInitialized(); }
@@ -292,15 +297,7 @@ bool Cloudpilot::LaunchAppByDbHeader(void* header, int len) {
 void Cloudpilot::ClearExternalStorage() { gExternalStorage.Clear(); }
 
 bool Cloudpilot::AllocateCard(const char* key, uint32 blockCount) {
-    uint8* data = new uint8[CardImage::BLOCK_SIZE * blockCount];
-    memset(data, 0, CardImage::BLOCK_SIZE * blockCount);
-
-    if (!gExternalStorage.AddImage(key, data, CardImage::BLOCK_SIZE * blockCount)) {
-        delete[] data;
-        return false;
-    }
-
-    return true;
+    return gExternalStorage.AddImage(key, make_shared<CardImage>(blockCount));
 }
 
 bool Cloudpilot::AdoptCard(const char* key, void* data, uint32 blockCount) {
@@ -8,6 +8,7 @@
 #include "EmDevice.h"
 #include "EmTransportSerialBuffer.h"
 #include "Frame.h"
+#include "FrameConverter.h"
 #include "SuspendContext.h"
 
 enum class CardSupportLevel : int { unsupported = 0, sdOnly = 1, sdAndMs = 2 };
@@ -29,6 +30,8 @@ class Cloudpilot {
     void SetClockFactor(double clockFactor);
 
     Frame& CopyFrame();
+    // Converts the dirty lines of the last copied frame to RGBA, see FrameConverter::Convert
+    void ConvertFrame(void* pixels, int pitch);
     bool IsScreenDirty();
     void MarkScreenClean();
 
@@ -111,6 +114,7 @@ class Cloudpilot {
 
    private:
     Frame frame{320 * 480 * 4};
+    FrameConverter frameConverter;
 };
 
 #endif  // _CLOUDPILOT_H_
@@ -79,6 +79,7 @@ export interface Cloudpilot {
     SetClockFactor(clockFactor: number): number;
 
     CopyFrame(): Frame;
+    ConvertFrame(pixels: VoidPtr, pitch: number): void;
     IsScreenDirty(): boolean;
     MarkScreenClean(): void;
     IsSetupComplete(): boolean;
@@ -169,6 +170,9 @@ export interface Frame {
 
     GetFirstDirtyLine(): number;
     GetLastDirtyLine(): number;
+    GetDirtySpanCount(): number;
+    GetDirtySpanFirstLine(index: number): number;
+    GetDirtySpanLastLine(index: number): number;
     GetHasChanges(): boolean;
 
     GetBuffer(): VoidPtr;
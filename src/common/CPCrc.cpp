@@ -47,7 +47,7 @@ namespace {
         0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8, 0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93,
         0x3EB2, 0x0ED1, 0x1EF0};
 
-    const uint32_t crc32Table[] = {
+    constexpr uint32_t crc32Table[256] = {
         0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535,
         0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd,
         0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de, 0x1adad47d,
@@ -86,6 +86,26 @@ namespace {
         0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
         0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
+    // Slicing by 8: slice k holds the CRC of a byte followed by k zero bytes
+    struct Crc32Slices {
+        uint32_t slice[8][256];
+    };
+
+    constexpr Crc32Slices makeCrc32Slices() {
+        Crc32Slices slices{};
+
+        for (size_t i = 0; i < 256; i++) slices.slice[0][i] = crc32Table[i];
+
+        for (size_t k = 1; k < 8; k++)
+            for (size_t i = 0; i < 256; i++)
+                slices.slice[k][i] = (slices.slice[k - 1][i] >> 8) ^
+                                     crc32Table[slices.slice[k - 1][i] & 0xff];
+
+        return slices;
+    }
+
+    constexpr Crc32Slices crc32Slices = makeCrc32Slices();
+
 }  // namespace
 
 uint8_t crc::sdCRC7(const uint8_t* data, size_t size) {
@@ -111,6 +131,17 @@ uint32_t crc::CRC32(const uint8_t* data, size_t size) {
     uint32_t crc;
 
     crc = ~0U;
+
+    for (; size >= 8; size -= 8, p += 8) {
+        const uint32_t lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));
+        const uint32_t hi = p[4] | (p[5] << 8) | (p[6] << 16) | (p[7] << 24);
+        const auto& slice = crc32Slices.slice;
+
+        crc = slice[7][lo & 0xff] ^ slice[6][(lo >> 8) & 0xff] ^ slice[5][(lo >> 16) & 0xff] ^
+              slice[4][lo >> 24] ^ slice[3][hi & 0xff] ^ slice[2][(hi >> 8) & 0xff] ^
+              slice[1][(hi >> 16) & 0xff] ^ slice[0][hi >> 24];
+    }
+
     while (size--) crc = crc32Table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
     return ~crc;
 }
@@ -3,12 +3,47 @@
 #include <algorithm>
 #include <cstring>
 
-CardImage::CardImage(uint8_t* data, size_t blocksTotal) : data(data), blocksTotal(blocksTotal) {
+#include "CowImage.h"
+
+CardImage::CardImage(uint8_t* data, size_t blocksTotal)
+    : data(data, DataDeleter{blocksTotal * BLOCK_SIZE, false}), blocksTotal(blocksTotal) {
+    InitializeDirtyPages(true);
+}
+
+CardImage::CardImage(size_t blocksTotal)
+    : data(static_cast<uint8_t*>(CowImage::Allocate(blocksTotal * BLOCK_SIZE)),
+           DataDeleter{blocksTotal * BLOCK_SIZE, true}),
+      blocksTotal(blocksTotal) {
+    InitializeDirtyPages(false);
+}
+
+CardImage::CardImage(const CowImage& base)
+    : data(static_cast<uint8_t*>(base.Instantiate()), DataDeleter{base.GetSize(), true}),
+      blocksTotal(base.GetSize() / BLOCK_SIZE),
+      base(base.Share()) {
+    // A base that cannot be shared is captured as a whole by snapshots
+    InitializeDirtyPages(!this->base);
+}
+
+CardImage::~CardImage() = default;
+
+void CardImage::InitializeDirtyPages(bool modified) {
+    // A failed allocation leaves an empty card
+    if (!data) blocksTotal = 0;
+
     const size_t pageCount = (blocksTotal >> 4) + ((blocksTotal % 16 != 0) > 0 ? 1 : 0);
     const size_t dirtyPageBufferSize = (pageCount >> 3) + ((pageCount % 8) > 0 ? 1 : 0);
 
     dirtyPages = std::make_unique<uint8_t[]>(dirtyPageBufferSize);
     memset(dirtyPages.get(), 0, dirtyPageBufferSize);
+
+    modifiedPages = std::make_unique<uint8_t[]>(dirtyPageBufferSize);
+    memset(modifiedPages.get(), modified ? 0xff : 0, dirtyPageBufferSize);
+}
+
+void CardImage::MarkPageDirty(size_t page) {
+    dirtyPages[page >> 3] |= 1 << (page & 0x07);
+    modifiedPages[page >> 3] |= 1 << (page & 0x07);
 }
 
 size_t CardImage::Read(uint8_t* dest, size_t index, size_t count) {
@@ -16,8 +51,7 @@ size_t CardImage::Read(uint8_t* dest, size_t index, size_t count) {
 
     count = std::min(count, blocksTotal - index);
 
-    for (size_t i = 0; i < count; i++)
-        memcpy(dest + i * BLOCK_SIZE, data.get() + (i + index) * BLOCK_SIZE, BLOCK_SIZE);
+    memcpy(dest, data.get() + index * BLOCK_SIZE, count * BLOCK_SIZE);
 
     return count;
 }
@@ -30,8 +64,7 @@ size_t CardImage::Write(const uint8_t* source, size_t index, size_t count) {
     for (size_t block = index; block < index + count; block++) {
         memcpy(data.get() + block * BLOCK_SIZE, source + (block - index) * BLOCK_SIZE, BLOCK_SIZE);
 
-        const size_t page = block >> 4;
-        dirtyPages[page >> 3] |= 1 << (page & 0x07);
+        MarkPageDirty(block >> 4);
     }
 
     return count;
@@ -62,12 +95,21 @@ void CardImage::MarkRangeDirty(size_t offset, size_t count) {
     const size_t firstBlock = offset / BLOCK_SIZE;
     const size_t lastBlock = (offset + count - 1) / BLOCK_SIZE;
 
-    for (size_t block = firstBlock; block <= lastBlock; block++) {
-        const size_t page = block >> 4;
-        dirtyPages[page >> 3] |= 1 << (page & 0x07);
-    }
+    for (size_t block = firstBlock; block <= lastBlock; block++) MarkPageDirty(block >> 4);
 }
 
 uint8_t* CardImage::RawData() { return data.get(); }
 
 uint8_t* CardImage::DirtyPages() { return dirtyPages.get(); }
+
+std::unique_ptr<CowImage> CardImage::Snapshot() const {
+    return std::make_unique<CowImage>(base.get(), data.get(), blocksTotal * BLOCK_SIZE,
+                                      DIRTY_PAGE_SIZE, modifiedPages.get());
+}
+
+void CardImage::DataDeleter::operator()(uint8_t* data) const {
+    if (mapped)
+        CowImage::Free(data, size);
+    else
+        delete[] data;
+}
@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <memory>
 
+class CowImage;
+
 class CardImage {
    public:
     // Those two values cannot be changed --- they're here for documentation only!
@@ -11,8 +13,19 @@ class CardImage {
     constexpr static size_t DIRTY_PAGE_SIZE = 8192;
 
    public:
+    // Adopts data, which must have been allocated with new[]
     CardImage(uint8_t* data, size_t blocksTotal);
 
+    // A zeroed card. Memory is reserved lazily: blocks that have never been written share the
+    // zero page and cost no RAM.
+    explicit CardImage(size_t blocksTotal);
+
+    // A writable overlay over a read-only base. Blocks are shared with the base until they are
+    // written. The base may be destroyed while the card is alive.
+    explicit CardImage(const CowImage& base);
+
+    ~CardImage();
+
     size_t Read(uint8_t* dest, size_t index, size_t count = 1);
     size_t Write(const uint8_t* source, size_t index, size_t count = 1);
     size_t BlocksTotal() const;
@@ -25,10 +38,31 @@ class CardImage {
     uint8_t* RawData();
     uint8_t* DirtyPages();
 
+    // A sparse copy of the card that shares the base and holds only the pages that were
+    // written since the card was created. Writes through RawData must be marked with
+    // MarkRangeDirty to be included.
+    std::unique_ptr<CowImage> Snapshot() const;
+
    private:
-    std::unique_ptr<uint8_t[]> data;
+    struct DataDeleter {
+        size_t size{0};
+        bool mapped{false};
+
+        void operator()(uint8_t* data) const;
+    };
+
+   private:
+    void InitializeDirtyPages(bool modified);
+    void MarkPageDirty(size_t page);
+
+   private:
+    std::unique_ptr<uint8_t[], DataDeleter> data;
     std::unique_ptr<uint8_t[]> dirtyPages;
     size_t blocksTotal;
+
+    // Unlike dirtyPages, modifiedPages is never cleared and tracks the difference to base
+    std::unique_ptr<CowImage> base;
+    std::unique_ptr<uint8_t[]> modifiedPages;
 };
 
 #endif  // _CARD_IMAGE_H_
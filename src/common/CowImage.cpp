@@ -0,0 +1,243 @@
+#include "CowImage.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifndef __EMSCRIPTEN__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+    int createMemfd(const void* data, size_t size) {
+        int fd = memfd_create("cow-image", MFD_CLOEXEC);
+        if (fd < 0) return -1;
+
+        if (ftruncate(fd, size) != 0) {
+            close(fd);
+            return -1;
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+
+        memcpy(mapping, data, size);
+        munmap(mapping, size);
+
+        return fd;
+    }
+#endif
+}  // namespace
+
+CowImage::CowImage(const void* data, size_t size) : size(size) {
+    if (size == 0) return;
+
+#ifdef __linux__
+    fd = createMemfd(data, size);
+    if (fd >= 0) return;
+#endif
+
+    this->data = std::make_unique<uint8_t[]>(size);
+    memcpy(this->data.get(), data, size);
+}
+
+CowImage::CowImage(const std::string& file, size_t offset, size_t size)
+    : size(size), offset(offset) {
+    if (size == 0) return;
+
+#ifndef __EMSCRIPTEN__
+    if (offset % FILE_ALIGNMENT == 0) {
+        fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+
+        struct stat fileStat;
+        if (fd >= 0 && fstat(fd, &fileStat) == 0 &&
+            static_cast<size_t>(fileStat.st_size) >= offset + size)
+            return;
+
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+#endif
+
+    std::fstream stream(file, std::ios_base::in | std::ios_base::binary);
+    data = std::make_unique<uint8_t[]>(size);
+
+    stream.seekg(offset);
+    stream.read(reinterpret_cast<char*>(data.get()), size);
+
+    if (stream.fail() || static_cast<size_t>(stream.gcount()) != size) data.reset();
+}
+
+CowImage::CowImage(const CowImage* base, const void* data, size_t size, size_t pageSize,
+                   const uint8_t* modifiedPages)
+    : size(size), pageSize(pageSize) {
+    if (size == 0) return;
+
+    if (pageSize == 0 || (modifiedPages && !data) ||
+        (base && (base->size != size || !base->IsValid())) ||
+        (base && !base->pageIndices.empty() && base->pageSize != pageSize))
+        return;
+
+    if (base && base->data) {
+        this->data = std::make_unique<uint8_t[]>(size);
+        memcpy(this->data.get(), base->data.get(), size);
+    }
+
+#ifndef __EMSCRIPTEN__
+    if (base && base->fd >= 0) {
+        fd = dup(base->fd);
+        offset = base->offset;
+
+        if (fd < 0) return;
+    }
+#endif
+
+    const uint8_t* data8 = reinterpret_cast<const uint8_t*>(data);
+    const size_t baseCount = base ? base->pageIndices.size() : 0;
+
+    // Pages marked as modified take precedence over the pages of a sparse base
+    std::vector<const uint8_t*> sources;
+
+    if (modifiedPages) {
+        const size_t pageCount = (size + pageSize - 1) / pageSize;
+
+        for (size_t page = 0, b = 0; page < pageCount; page++) {
+            while (b < baseCount && base->pageIndices[b] < page) b++;
+
+            if (modifiedPages[page >> 3] & (1 << (page & 0x07))) {
+                pageIndices.push_back(page);
+                sources.push_back(data8 + page * pageSize);
+            } else if (b < baseCount && base->pageIndices[b] == page) {
+                pageIndices.push_back(page);
+                sources.push_back(base->pages.get() + b * pageSize);
+            }
+        }
+    } else {
+        for (size_t b = 0; b < baseCount; b++) {
+            pageIndices.push_back(base->pageIndices[b]);
+            sources.push_back(base->pages.get() + b * pageSize);
+        }
+    }
+
+    pages = std::make_unique<uint8_t[]>(pageIndices.size() * pageSize);
+
+    for (size_t i = 0; i < pageIndices.size(); i++)
+        memcpy(pages.get() + i * pageSize, sources[i],
+               std::min(pageSize, size - pageIndices[i] * pageSize));
+
+    sparse = true;
+}
+
+CowImage::~CowImage() {
+#ifndef __EMSCRIPTEN__
+    if (fd >= 0) close(fd);
+#endif
+}
+
+bool CowImage::IsValid() const { return size == 0 || fd >= 0 || data || sparse; }
+
+size_t CowImage::GetSize() const { return size; }
+
+std::unique_ptr<CowImage> CowImage::Share() const {
+    if (size == 0 || data || !IsValid()) return nullptr;
+
+    return std::make_unique<CowImage>(this, nullptr, size, sparse ? pageSize : FILE_ALIGNMENT,
+                                      nullptr);
+}
+
+void* CowImage::Instantiate() const {
+    if (size == 0) return nullptr;
+
+#ifndef __EMSCRIPTEN__
+    if (fd >= 0) {
+        void* instance = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset);
+        if (instance == MAP_FAILED) return nullptr;
+
+        ApplyPages(instance);
+
+        return instance;
+    }
+#endif
+
+    if (!data && !sparse) return nullptr;
+
+    void* instance = Allocate(size);
+    if (!instance) return nullptr;
+
+    if (data) memcpy(instance, data.get(), size);
+    ApplyPages(instance);
+
+    return instance;
+}
+
+bool CowImage::InstantiateAt(void* target) const {
+    if (size == 0) return true;
+
+#ifndef __EMSCRIPTEN__
+    if (fd >= 0) {
+        if (mmap(target, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, offset) !=
+            target)
+            return false;
+
+        ApplyPages(target);
+
+        return true;
+    }
+#endif
+
+    if (data) {
+        memcpy(target, data.get(), size);
+    } else if (sparse) {
+#ifdef __EMSCRIPTEN__
+        memset(target, 0, size);
+#else
+        // Remapping drops the old pages instead of touching every one of them
+        if (mmap(target, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                 -1, 0) != target)
+            return false;
+#endif
+    } else {
+        return false;
+    }
+
+    ApplyPages(target);
+
+    return true;
+}
+
+void CowImage::ApplyPages(void* target) const {
+    uint8_t* target8 = reinterpret_cast<uint8_t*>(target);
+
+    for (size_t i = 0; i < pageIndices.size(); i++)
+        memcpy(target8 + pageIndices[i] * pageSize, pages.get() + i * pageSize,
+               std::min(pageSize, size - pageIndices[i] * pageSize));
+}
+
+void* CowImage::Allocate(size_t size) {
+#ifdef __EMSCRIPTEN__
+    return calloc(size, 1);
+#else
+    void* memory =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return memory == MAP_FAILED ? nullptr : memory;
+#endif
+}
+
+void CowImage::Free(void* memory, size_t size) {
+    if (!memory) return;
+
+#ifdef __EMSCRIPTEN__
+    free(memory);
+#else
+    munmap(memory, size);
+#endif
+}
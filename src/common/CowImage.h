@@ -0,0 +1,80 @@
+#ifndef _COW_IMAGE_H_
+#define _COW_IMAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// An immutable memory image that can be instantiated any number of times, from any thread.
+// On Linux the image lives in a memfd and instances are private mappings of it, so they
+// share all pages with the image until written. Elsewhere every instance is a plain copy.
+// Sparse images only hold the pages that differ from a base image or from zero.
+class CowImage {
+   public:
+    // Alignment of file offsets that can be mapped on all supported hosts
+    static constexpr size_t FILE_ALIGNMENT = 64 * 1024;
+
+   public:
+    CowImage(const void* data, size_t size);
+
+    // An image backed by a region of a file. Instances are private mappings of the file, so
+    // pages are only read when they are touched. offset must be a multiple of FILE_ALIGNMENT.
+    // The file must not be modified in place while the image is alive. Without mmap
+    // (emscripten) the region is read into memory.
+    CowImage(const std::string& file, size_t offset, size_t size);
+
+    // A sparse image that shares its pages with base, except for those marked in modifiedPages
+    // (one bit per page, LSB first), which are copied from data. Without a base, unmarked pages
+    // are zero. Only the marked pages are copied, and base may be destroyed afterwards. If base
+    // is sparse itself, it must use the same page size.
+    CowImage(const CowImage* base, const void* data, size_t size, size_t pageSize,
+             const uint8_t* modifiedPages);
+
+    ~CowImage();
+
+    // An image with the same contents that shares the pages of this one. nullptr if the
+    // contents are held in memory and would have to be copied.
+    std::unique_ptr<CowImage> Share() const;
+
+    // False if a file backed image could not be read
+    bool IsValid() const;
+
+    size_t GetSize() const;
+
+    // Creates a new instance that is owned by the caller. Release it with Free.
+    void* Instantiate() const;
+
+    // Replaces the contents of target with an instance of the image. target must be a
+    // page aligned block of at least GetSize() bytes that was obtained from Allocate.
+    bool InstantiateAt(void* target) const;
+
+    // Zeroed, page aligned memory that can be passed to InstantiateAt.
+    static void* Allocate(size_t size);
+    static void Free(void* memory, size_t size);
+
+   private:
+    void ApplyPages(void* target) const;
+
+   private:
+    size_t size;
+
+    int fd{-1};
+    size_t offset{0};
+    std::unique_ptr<uint8_t[]> data;
+
+    // Pages of a sparse image that differ from the base
+    bool sparse{false};
+    size_t pageSize{0};
+    std::vector<uint32_t> pageIndices;
+    std::unique_ptr<uint8_t[]> pages;
+
+   private:
+    CowImage(const CowImage&) = delete;
+    CowImage(CowImage&&) = delete;
+    CowImage& operator=(const CowImage&) = delete;
+    CowImage& operator=(CowImage&&) = delete;
+};
+
+#endif  // _COW_IMAGE_H_
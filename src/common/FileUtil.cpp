@@ -1,7 +1,15 @@
 #include "FileUtil.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
 #include <fstream>
 
+#include "CowImage.h"
+
 using namespace std;
 
 bool util::ReadFile(optional<string> file, unique_ptr<uint8_t[]>& buffer, size_t& len) {
@@ -21,12 +29,54 @@ bool util::ReadFile(optional<string> file, unique_ptr<uint8_t[]>& buffer, size_t
 
     return true;
 }
+
+unique_ptr<CowImage> util::MapFile(optional<string> file) {
+    if (!file) return nullptr;
+
+    fstream stream(*file, ios_base::in);
+    if (stream.fail()) return nullptr;
+
+    stream.seekg(0, ios_base::end);
+    const size_t len = stream.tellg();
+
+    auto image = make_unique<CowImage>(*file, 0, len);
+
+    return image->IsValid() ? move(image) : nullptr;
+}
+
 bool util::WriteFile(const std::string& file, const uint8_t* buffer, size_t len) {
-    fstream stream(file, std::ios::out);
+    // Write to a temporary file and rename it, so the old file stays intact for anyone who
+    // has it mapped (see CowImage). Syncing before the rename makes sure that a crash leaves
+    // either the old or the new contents behind.
+    const string tmpFile = file + ".tmp";
 
-    if (stream.fail()) return false;
+    struct stat fileStat;
+    const bool exists = stat(file.c_str(), &fileStat) == 0;
+
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) return false;
+
+    bool success = !exists || fchmod(fd, fileStat.st_mode & 07777) == 0;
+
+    while (success && len > 0) {
+        const ssize_t written = write(fd, buffer, len);
 
-    stream.write(reinterpret_cast<const char*>(buffer), len);
+        if (written < 0 && errno == EINTR) continue;
+        success = written > 0;
 
-    return !stream.fail();
+        if (success) {
+            buffer += written;
+            len -= written;
+        }
+    }
+
+    success = success && fsync(fd) == 0;
+    success = close(fd) == 0 && success;
+
+    if (!success || rename(tmpFile.c_str(), file.c_str()) != 0) {
+        remove(tmpFile.c_str());
+        return false;
+    }
+
+    return true;
 }
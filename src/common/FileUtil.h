@@ -7,9 +7,14 @@
 #include <optional>
 #include <string>
 
+class CowImage;
+
 namespace util {
     bool ReadFile(std::optional<std::string> file, std::unique_ptr<uint8_t[]>& buffer, size_t& len);
 
+    // Maps the whole file copy-on-write; pages are read on first access
+    std::unique_ptr<CowImage> MapFile(std::optional<std::string> file);
+
     bool WriteFile(const std::string& file, const uint8_t* buffer, size_t len);
 }  // namespace util
 
@@ -0,0 +1,33 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+    #include <thread>
+#endif
+
+using namespace std;
+
+void worker_pool::Run(size_t count, const function<void(size_t)>& job) {
+#ifdef __EMSCRIPTEN__
+    for (size_t i = 0; i < count; i++) job(i);
+#else
+    const size_t workerCount =
+        min(count, static_cast<size_t>(max(thread::hardware_concurrency(), 1u)));
+
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) job(i);
+    };
+
+    // The calling thread is one of the workers
+    vector<thread> threads;
+    for (size_t i = 1; i < workerCount; i++) threads.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : threads) thread.join();
+#endif
+}
@@ -0,0 +1,14 @@
+#ifndef _WORKER_POOL_H_
+#define _WORKER_POOL_H_
+
+#include <cstddef>
+#include <functional>
+
+// Runs independent jobs on all cores. Without threads (emscripten) jobs run in sequence on the
+// calling thread.
+namespace worker_pool {
+    // Calls job(0) ... job(count - 1) and returns once all jobs have completed.
+    void Run(size_t count, const std::function<void(size_t)>& job);
+}  // namespace worker_pool
+
+#endif  // _WORKER_POOL_H_
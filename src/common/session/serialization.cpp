@@ -0,0 +1,124 @@
+#include "serialization.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "zip/miniz.h"
+
+using namespace std;
+
+uint32_t serialization::Get32(const uint8_t* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+}
+
+void serialization::Put32(uint8_t* data, uint32_t value) {
+    data[0] = value;
+    data[1] = value >> 8;
+    data[2] = value >> 16;
+    data[3] = value >> 24;
+}
+
+bool serialization::Write32(uint8_t*& cursor, const uint8_t* end, uint32_t value) {
+    if (end - cursor < 4) return false;
+
+    Put32(cursor, value);
+    cursor += 4;
+
+    return true;
+}
+
+uint32_t serialization::Read32(const uint8_t*& cursor, const uint8_t* end, bool& success) {
+    if (end - cursor < 4) {
+        success = false;
+        return 0;
+    }
+
+    const uint32_t result = Get32(cursor);
+    cursor += 4;
+
+    return result;
+}
+
+serialization::DeflateBuffer::DeflateBuffer(size_t size, size_t maxSize)
+    : bufferSize(min(size, maxSize)),
+      maxSize(maxSize),
+      buffer(make_unique<uint8_t[]>(bufferSize)),
+      cursor(buffer.get()) {}
+
+serialization::DeflateBuffer::~DeflateBuffer() {
+    if (stream) deflateEnd(stream.get());
+}
+
+bool serialization::DeflateBuffer::Write32(uint32_t value) {
+    return !stream && serialization::Write32(cursor, buffer.get() + bufferSize, value);
+}
+
+bool serialization::DeflateBuffer::Deflate(size_t size, const void* data) {
+    if (!Begin()) return false;
+    if (size == 0) return true;
+
+    stream->next_in = reinterpret_cast<const unsigned char*>(data);
+    stream->avail_in = size;
+
+    int deflateResult;
+    do {
+        const auto outBytesBefore = stream->total_out;
+        deflateResult = deflate(stream.get(), Z_NO_FLUSH);
+        cursor += stream->total_out - outBytesBefore;
+
+        if (deflateResult == Z_BUF_ERROR && Grow()) deflateResult = Z_OK;
+    } while (stream->avail_in != 0 && deflateResult == Z_OK);
+
+    return deflateResult == Z_OK;
+}
+
+bool serialization::DeflateBuffer::Finish() {
+    if (!Begin()) return false;
+
+    int deflateResult;
+    do {
+        const auto outBytesBefore = stream->total_out;
+        deflateResult = deflate(stream.get(), Z_FINISH);
+        cursor += stream->total_out - outBytesBefore;
+    } while ((deflateResult == Z_BUF_ERROR || deflateResult == Z_OK) && Grow());
+
+    return deflateResult == Z_STREAM_END;
+}
+
+size_t serialization::DeflateBuffer::GetSize() const { return cursor - buffer.get(); }
+
+unique_ptr<uint8_t[]> serialization::DeflateBuffer::Release() { return move(buffer); }
+
+bool serialization::DeflateBuffer::Begin() {
+    if (stream) return true;
+
+    auto newStream = make_unique<z_stream>();
+    memset(newStream.get(), 0, sizeof(z_stream));
+
+    if (deflateInit(newStream.get(), Z_DEFAULT_COMPRESSION) != Z_OK) return false;
+
+    stream = move(newStream);
+    stream->next_out = cursor;
+    stream->avail_out = bufferSize - GetSize();
+
+    return true;
+}
+
+bool serialization::DeflateBuffer::Grow() {
+    if (bufferSize == maxSize) return false;
+
+    const size_t size = GetSize();
+    const size_t newBufferSize = min((bufferSize * 3) / 2 + 1, maxSize);
+    unique_ptr<uint8_t[]> newBuffer = make_unique<uint8_t[]>(newBufferSize);
+
+    memcpy(newBuffer.get(), buffer.get(), size);
+    cursor = newBuffer.get() + size;
+    bufferSize = newBufferSize;
+
+    buffer.swap(newBuffer);
+
+    stream->next_out = cursor;
+    stream->avail_out = bufferSize - GetSize();
+
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef _SESSION_SERIALIZATION_H_
+#define _SESSION_SERIALIZATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct mz_stream_s;
+
+// Helpers shared by the session file and session delta formats. All words are little endian.
+
+namespace serialization {
+    uint32_t Get32(const uint8_t* data);
+    void Put32(uint8_t* data, uint32_t value);
+
+    // Writes a word and advances the cursor. Fails if the word does not fit before end.
+    bool Write32(uint8_t*& cursor, const uint8_t* end, uint32_t value);
+
+    // Reads a word and advances the cursor. Clears success if the word does not fit before end.
+    uint32_t Read32(const uint8_t*& cursor, const uint8_t* end, bool& success);
+
+    // An output buffer that grows up to a maximum size. Uncompressed words may be written
+    // before data is deflated into it.
+    class DeflateBuffer {
+       public:
+        DeflateBuffer(size_t size, size_t maxSize);
+        ~DeflateBuffer();
+
+        bool Write32(uint32_t value);
+
+        bool Deflate(size_t size, const void* data);
+        bool Finish();
+
+        size_t GetSize() const;
+        std::unique_ptr<uint8_t[]> Release();
+
+       private:
+        bool Begin();
+        bool Grow();
+
+       private:
+        size_t bufferSize;
+        size_t maxSize;
+        std::unique_ptr<uint8_t[]> buffer;
+        uint8_t* cursor;
+
+        std::unique_ptr<mz_stream_s> stream;
+
+       private:
+        DeflateBuffer(const DeflateBuffer&) = delete;
+        DeflateBuffer(DeflateBuffer&&) = delete;
+        DeflateBuffer& operator=(const DeflateBuffer&) = delete;
+        DeflateBuffer& operator=(DeflateBuffer&&) = delete;
+    };
+}  // namespace serialization
+
+#endif  // _SESSION_SERIALIZATION_H_
@@ -0,0 +1,371 @@
+#include "session_delta.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "CPCrc.h"
+#include "serialization.h"
+#include "zip/miniz.h"
+
+using namespace std;
+using namespace serialization;
+
+// Layout
+//
+// * Header: magic, version, base fingerprint, sequence, uncompressed size of the body
+// * Body (deflated): metadata size, savestate size, size / page size / page count for NOR,
+//   NAND and memory, metadata, savestate, and for each image the page indices followed by the
+//   page contents. The last page of an image may be partial.
+
+namespace {
+    constexpr uint32_t MAGIC = 0x19800920;
+    constexpr uint32_t CURRENT_VERSION = 0;
+
+    constexpr size_t SIZE_HEADER = 20;
+    constexpr size_t SIZE_TOC = (2 + 3 * 3) * 4;
+
+    constexpr size_t BUFFER_MAX_SIZE = 256 * 1024 * 1024;
+    constexpr size_t BUFFER_MIN_SIZE = 1024;
+
+    constexpr size_t IMAGE_COUNT = 3;
+
+    size_t pagesTotal(size_t size, size_t pageSize) {
+        return pageSize == 0 ? 0 : (size + pageSize - 1) / pageSize;
+    }
+
+    bool isDirty(const uint8_t* dirtyPages, size_t page) {
+        return dirtyPages[page >> 3] & (1 << (page & 0x07));
+    }
+}  // namespace
+
+bool SessionDelta::IsSessionDelta(size_t size, const void* data) {
+    const uint8_t* data8 = reinterpret_cast<const uint8_t*>(data);
+
+    if (size < SIZE_HEADER) return false;
+
+    return Get32(data8) == MAGIC && Get32(data8 + 4) <= CURRENT_VERSION;
+}
+
+uint32_t SessionDelta::Fingerprint(size_t size, const void* data) {
+    return crc::CRC32(reinterpret_cast<const uint8_t*>(data), size);
+}
+
+uint32_t SessionDelta::GetBaseFingerprint() const { return baseFingerprint; }
+
+uint32_t SessionDelta::GetSequence() const { return sequence; }
+
+SessionDelta& SessionDelta::SetBase(uint32_t fingerprint, uint32_t sequence) {
+    baseFingerprint = fingerprint;
+    this->sequence = sequence;
+
+    return *this;
+}
+
+bool SessionDelta::Continues(uint32_t fingerprint, uint32_t previousSequence) const {
+    return baseFingerprint == fingerprint && sequence == previousSequence + 1;
+}
+
+const void* SessionDelta::GetMetadata() const { return metadata; }
+
+size_t SessionDelta::GetMetadataSize() const { return metadataSize; }
+
+SessionDelta& SessionDelta::SetMetadata(size_t size, const void* data) {
+    metadataSize = size;
+    metadata = reinterpret_cast<const uint8_t*>(data);
+
+    return *this;
+}
+
+const void* SessionDelta::GetSavestate() const { return savestate; }
+
+size_t SessionDelta::GetSavestateSize() const { return savestateSize; }
+
+SessionDelta& SessionDelta::SetSavestate(size_t size, const void* data) {
+    savestateSize = size;
+    savestate = reinterpret_cast<const uint8_t*>(data);
+
+    return *this;
+}
+
+SessionDelta& SessionDelta::SetImage(Image image, size_t size, const void* data, size_t pageSize,
+                                     const void* dirtyPages) {
+    ImageDelta& imageDelta = images[static_cast<uint8_t>(image)];
+
+    imageDelta = ImageDelta();
+    imageDelta.size = size;
+    imageDelta.pageSize = pageSize;
+    imageDelta.data = reinterpret_cast<const uint8_t*>(data);
+    imageDelta.dirtyPages = reinterpret_cast<const uint8_t*>(dirtyPages);
+
+    return *this;
+}
+
+size_t SessionDelta::GetImageSize(Image image) const {
+    return images[static_cast<uint8_t>(image)].size;
+}
+
+size_t SessionDelta::GetPageSize(Image image) const {
+    return images[static_cast<uint8_t>(image)].pageSize;
+}
+
+size_t SessionDelta::GetPageCount(Image image) const {
+    return images[static_cast<uint8_t>(image)].pageCount;
+}
+
+bool SessionDelta::Serialize() {
+    serializedDeltaSize = 0;
+    serializedDelta = nullptr;
+
+    vector<uint8_t> pageIndices[IMAGE_COUNT];
+    size_t sizeUncompressed = SIZE_TOC + metadataSize + savestateSize;
+
+    for (size_t i = 0; i < IMAGE_COUNT; i++) {
+        ImageDelta& imageDelta = images[i];
+
+        imageDelta.pageCount = 0;
+        if (!imageDelta.dirtyPages || !imageDelta.data) continue;
+
+        const size_t total = pagesTotal(imageDelta.size, imageDelta.pageSize);
+
+        for (size_t page = 0; page < total; page++) {
+            if (!isDirty(imageDelta.dirtyPages, page)) continue;
+
+            pageIndices[i].resize(pageIndices[i].size() + 4);
+            Put32(pageIndices[i].data() + pageIndices[i].size() - 4, page);
+
+            imageDelta.pageCount++;
+            sizeUncompressed += 4 + PageBytes(imageDelta, page);
+        }
+    }
+
+    if (sizeUncompressed > BUFFER_MAX_SIZE) {
+        cerr << "delta too large" << endl;
+        return false;
+    }
+
+    DeflateBuffer out(max(BUFFER_MIN_SIZE, SIZE_HEADER + sizeUncompressed / 2), BUFFER_MAX_SIZE);
+    bool success = true;
+
+    success &= out.Write32(MAGIC);
+    success &= out.Write32(CURRENT_VERSION);
+    success &= out.Write32(baseFingerprint);
+    success &= out.Write32(sequence);
+    success &= out.Write32(sizeUncompressed);
+
+    if (!success) {
+        cerr << "failed to write header" << endl;
+        return false;
+    }
+
+    uint8_t toc[SIZE_TOC];
+
+    Put32(toc, metadataSize);
+    Put32(toc + 4, savestateSize);
+
+    for (size_t i = 0; i < IMAGE_COUNT; i++) {
+        Put32(toc + 8 + 12 * i, images[i].size);
+        Put32(toc + 12 + 12 * i, images[i].pageSize);
+        Put32(toc + 16 + 12 * i, images[i].pageCount);
+    }
+
+    if (!out.Deflate(SIZE_TOC, toc)) {
+        cerr << "failed to write toc" << endl;
+        return false;
+    }
+
+    if (!out.Deflate(metadataSize, metadata)) {
+        cerr << "failed to write metadata" << endl;
+        return false;
+    }
+
+    if (!out.Deflate(savestateSize, savestate)) {
+        cerr << "failed to write savestate" << endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < IMAGE_COUNT; i++) {
+        const ImageDelta& imageDelta = images[i];
+
+        if (!out.Deflate(pageIndices[i].size(), pageIndices[i].data())) {
+            cerr << "failed to write page indices" << endl;
+            return false;
+        }
+
+        // Runs of consecutive pages are compressed in one go
+        const uint8_t* indices = pageIndices[i].data();
+        for (size_t page = 0; page < imageDelta.pageCount;) {
+            const size_t first = Get32(indices + 4 * page);
+            size_t last = first;
+
+            while (++page < imageDelta.pageCount && Get32(indices + 4 * page) == last + 1) last++;
+
+            const size_t offset = first * imageDelta.pageSize;
+            const size_t size = (last - first) * imageDelta.pageSize + PageBytes(imageDelta, last);
+
+            if (!out.Deflate(size, imageDelta.data + offset)) {
+                cerr << "failed to write pages" << endl;
+                return false;
+            }
+        }
+    }
+
+    if (!out.Finish()) {
+        cerr << "failed to flush" << endl;
+        return false;
+    }
+
+    bufferSize = out.GetSize();
+    buffer = out.Release();
+
+    serializedDelta = buffer.get();
+    serializedDeltaSize = bufferSize;
+
+    return true;
+}
+
+const void* SessionDelta::GetSerializedDelta() const { return serializedDelta; }
+
+size_t SessionDelta::GetSerializedDeltaSize() const { return serializedDeltaSize; }
+
+bool SessionDelta::Deserialize(size_t size, const void* data) {
+    metadataSize = savestateSize = 0;
+    metadata = savestate = nullptr;
+
+    for (auto& imageDelta : images) imageDelta = ImageDelta();
+
+    serializedDelta = reinterpret_cast<const uint8_t*>(data);
+    serializedDeltaSize = size;
+
+    const uint8_t* ccursor = serializedDelta;
+    const uint8_t* end = serializedDelta + serializedDeltaSize;
+
+    bool success = true;
+
+    const uint32_t magic = Read32(ccursor, end, success);
+    const uint32_t version = Read32(ccursor, end, success);
+    baseFingerprint = Read32(ccursor, end, success);
+    sequence = Read32(ccursor, end, success);
+    const uint32_t sizeUncompressed = Read32(ccursor, end, success);
+
+    if (!success) {
+        cerr << "unable to read header" << endl;
+        return false;
+    }
+
+    if (magic != MAGIC || version > CURRENT_VERSION) {
+        cerr << "not a session delta" << endl;
+        return false;
+    }
+
+    if (sizeUncompressed < SIZE_TOC || sizeUncompressed > BUFFER_MAX_SIZE) {
+        cerr << "bad delta size" << endl;
+        return false;
+    }
+
+    bufferSize = sizeUncompressed;
+    buffer = make_unique<uint8_t[]>(bufferSize);
+
+    mz_ulong destLen = bufferSize;
+    if (uncompress(buffer.get(), &destLen, ccursor, end - ccursor) != Z_OK ||
+        destLen != bufferSize) {
+        cerr << "failed to uncompress delta" << endl;
+        return false;
+    }
+
+    const uint8_t* toc = buffer.get();
+    size_t expectedSize = SIZE_TOC;
+
+    metadataSize = Get32(toc);
+    savestateSize = Get32(toc + 4);
+    expectedSize += metadataSize + savestateSize;
+
+    for (size_t i = 0; i < IMAGE_COUNT; i++) {
+        ImageDelta& imageDelta = images[i];
+
+        imageDelta.size = Get32(toc + 8 + 12 * i);
+        imageDelta.pageSize = Get32(toc + 12 + 12 * i);
+        imageDelta.pageCount = Get32(toc + 16 + 12 * i);
+
+        if (imageDelta.pageCount > pagesTotal(imageDelta.size, imageDelta.pageSize)) {
+            cerr << "bad page count" << endl;
+            return false;
+        }
+
+        expectedSize += 4 * imageDelta.pageCount;
+    }
+
+    if (expectedSize > bufferSize) {
+        cerr << "delta size mismatch" << endl;
+        return false;
+    }
+
+    const uint8_t* cursor = buffer.get() + SIZE_TOC;
+
+    metadata = metadataSize > 0 ? cursor : nullptr;
+    cursor += metadataSize;
+
+    savestate = savestateSize > 0 ? cursor : nullptr;
+    cursor += savestateSize;
+
+    for (auto& imageDelta : images) {
+        imageDelta.pageIndices = cursor;
+        cursor += 4 * imageDelta.pageCount;
+
+        const size_t total = pagesTotal(imageDelta.size, imageDelta.pageSize);
+        size_t pageBytes = 0;
+
+        // Indices must be strictly increasing
+        for (size_t page = 0, next = 0; page < imageDelta.pageCount; page++) {
+            const size_t index = Get32(imageDelta.pageIndices + 4 * page);
+
+            if (index >= total || index < next) {
+                cerr << "bad page index" << endl;
+                return false;
+            }
+
+            next = index + 1;
+            pageBytes += PageBytes(imageDelta, index);
+        }
+
+        if (static_cast<size_t>(cursor - buffer.get()) + pageBytes > bufferSize) {
+            cerr << "delta size mismatch" << endl;
+            return false;
+        }
+
+        imageDelta.pages = cursor;
+        cursor += pageBytes;
+    }
+
+    if (static_cast<size_t>(cursor - buffer.get()) != bufferSize) {
+        cerr << "delta size mismatch" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool SessionDelta::Apply(Image image, size_t size, void* data) const {
+    const ImageDelta& imageDelta = images[static_cast<uint8_t>(image)];
+
+    if (imageDelta.pageCount == 0) return true;
+    if (size != imageDelta.size || !imageDelta.pages) return false;
+
+    uint8_t* data8 = reinterpret_cast<uint8_t*>(data);
+    const uint8_t* page = imageDelta.pages;
+
+    for (size_t i = 0; i < imageDelta.pageCount; i++) {
+        const size_t index = Get32(imageDelta.pageIndices + 4 * i);
+        const size_t pageBytes = PageBytes(imageDelta, index);
+
+        memcpy(data8 + index * imageDelta.pageSize, page, pageBytes);
+        page += pageBytes;
+    }
+
+    return true;
+}
+
+size_t SessionDelta::PageBytes(const ImageDelta& imageDelta, size_t index) const {
+    return min(imageDelta.pageSize, imageDelta.size - index * imageDelta.pageSize);
+}
@@ -0,0 +1,101 @@
+#ifndef _SESSION_DELTA_H_
+#define _SESSION_DELTA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// A delta session holds the pages of NOR, NAND and memory that changed relative to a base
+// session, together with the full metadata and savestate. Each delta names the fingerprint of
+// the base and a sequence number, so a chain of deltas can be validated and compacted into a
+// new full session by applying the deltas to the base in order.
+
+class SessionDelta {
+   public:
+    enum class Image : uint8_t { nor = 0, nand = 1, memory = 2 };
+
+   public:
+    explicit SessionDelta() = default;
+
+    static bool IsSessionDelta(size_t size, const void* data);
+
+    // Identifies a serialized base session.
+    static uint32_t Fingerprint(size_t size, const void* data);
+
+    uint32_t GetBaseFingerprint() const;
+    uint32_t GetSequence() const;
+    SessionDelta& SetBase(uint32_t fingerprint, uint32_t sequence);
+
+    // Each delta only holds the pages changed since its predecessor, so a chain must not have
+    // gaps: the delta has to follow the given sequence number immediately.
+    bool Continues(uint32_t fingerprint, uint32_t previousSequence) const;
+
+    const void* GetMetadata() const;
+    size_t GetMetadataSize() const;
+    SessionDelta& SetMetadata(size_t size, const void* data);
+
+    const void* GetSavestate() const;
+    size_t GetSavestateSize() const;
+    SessionDelta& SetSavestate(size_t size, const void* data);
+
+    // dirtyPages is a bitmap with one bit per page, LSB first. This matches both the byte
+    // bitmaps of cloudpilot and the 32 bit bitmaps of uarm on a little endian host. Without
+    // a bitmap, only the image size is recorded.
+    SessionDelta& SetImage(Image image, size_t size, const void* data, size_t pageSize,
+                           const void* dirtyPages);
+
+    size_t GetImageSize(Image image) const;
+    size_t GetPageSize(Image image) const;
+    size_t GetPageCount(Image image) const;
+
+    bool Serialize();
+    const void* GetSerializedDelta() const;
+    size_t GetSerializedDeltaSize() const;
+
+    bool Deserialize(size_t size, const void* data);
+
+    // Copies the recorded pages into an image of the recorded size.
+    bool Apply(Image image, size_t size, void* data) const;
+
+   private:
+    struct ImageDelta {
+        size_t size{0};
+        size_t pageSize{0};
+
+        const uint8_t* data{nullptr};
+        const uint8_t* dirtyPages{nullptr};
+
+        size_t pageCount{0};
+        const uint8_t* pageIndices{nullptr};
+        const uint8_t* pages{nullptr};
+    };
+
+   private:
+    size_t PageBytes(const ImageDelta& imageDelta, size_t index) const;
+
+   private:
+    uint32_t baseFingerprint{0};
+    uint32_t sequence{0};
+
+    size_t metadataSize{0};
+    const uint8_t* metadata{nullptr};
+
+    size_t savestateSize{0};
+    const uint8_t* savestate{nullptr};
+
+    ImageDelta images[3];
+
+    size_t serializedDeltaSize{0};
+    const uint8_t* serializedDelta{nullptr};
+
+    size_t bufferSize{0};
+    std::unique_ptr<uint8_t[]> buffer;
+
+   private:
+    SessionDelta(const SessionDelta&) = delete;
+    SessionDelta(SessionDelta&&) = delete;
+    SessionDelta& operator=(const SessionDelta&) = delete;
+    SessionDelta& operator=(SessionDelta&&) = delete;
+};
+
+#endif  // _SESSION_DELTA_H_
@@ -3,11 +3,15 @@
 #include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 #include "CPCrc.h"
-#include "Defer.h"
+#include "CowImage.h"
+#include "WorkerPool.h"
 #include "rle.h"
 #include "rom_info5.h"
+#include "serialization.h"
+#include "session_delta.h"
 #include "zip/miniz.h"
 
 using namespace std;
@@ -18,16 +22,49 @@ using namespace std;
 // * V1: Replace RLE with Gzip compression
 // * V2: Add RAM size to header
 // * V3: RAM page size change 512b -> 1k: migrate memory image
+// * V4: Split regions into chunks that are compressed independently and in parallel, with a
+//       CRC per chunk
+// * V5: Mappable: uncompressed, regions aligned for mmap. V4 remains the default.
 
 namespace {
     constexpr uint32_t MAGIC = 0x19800819;
-    constexpr uint32_t CURRENT_VERSION = 3;
+    constexpr uint32_t CURRENT_VERSION = 4;
+    constexpr uint32_t MAPPABLE_VERSION = 5;
 
-    constexpr size_t SIZE_HEADER = 12;  // 4 byte magic + 4 byte version + 4 byte device ID
+    constexpr size_t SIZE_HEADER = 16;  // magic + version + device ID + RAM size
     constexpr size_t SIZE_TOC = 5 * 4;
+    constexpr size_t SIZE_CHUNK_HEADER = 2 * 4;  // chunk size + chunk count
+    constexpr size_t SIZE_CHUNK_ENTRY = 2 * 4;   // compressed size + CRC
+    constexpr size_t SIZE_OFFSETS = 5 * 4;
+
+    constexpr size_t align(size_t offset) {
+        return (offset + CowImage::FILE_ALIGNMENT - 1) & ~(CowImage::FILE_ALIGNMENT - 1);
+    }
+
+    constexpr size_t CHUNK_SIZE = 1024 * 1024;
+    constexpr size_t REGION_COUNT = 5;
+    const char* const REGION_NAMES[REGION_COUNT] = {"metadata", "NOR", "NAND", "memory",
+                                                    "savestate"};
 
     constexpr size_t BUFFER_MAX_SIZE = 128 * 1024 * 1024;
-    constexpr size_t BUFFER_MIN_SIZE = 1024;
+
+    struct Chunk {
+        size_t region;
+        size_t offset;
+        size_t size;
+    };
+
+    // Chunks cover the regions in order, and every region starts with a new chunk
+    vector<Chunk> chunkRegions(const size_t (&regionSizes)[REGION_COUNT], size_t chunkSize) {
+        vector<Chunk> chunks;
+
+        for (size_t region = 0; region < REGION_COUNT; region++) {
+            for (size_t offset = 0; offset < regionSizes[region]; offset += chunkSize)
+                chunks.push_back({region, offset, min(chunkSize, regionSizes[region] - offset)});
+        }
+
+        return chunks;
+    }
 }  // namespace
 
 bool SessionFile5::IsSessionFile(size_t size, const void* data) {
@@ -39,11 +76,21 @@ bool SessionFile5::IsSessionFile(size_t size, const void* data) {
     if (magic != MAGIC) return false;
 
     const uint32_t version = data8[4] | (data8[5] << 8) | (data8[6] << 16) | (data8[7] << 24);
-    if (version > CURRENT_VERSION) return false;
+    if (version > MAPPABLE_VERSION) return false;
 
     return true;
 }
 
+bool SessionFile5::IsMappableSessionFile(size_t size, const void* data) {
+    const uint8_t* data8 = reinterpret_cast<const uint8_t*>(data);
+
+    if (!IsSessionFile(size, data)) return false;
+
+    const uint32_t version = data8[4] | (data8[5] << 8) | (data8[6] << 16) | (data8[7] << 24);
+
+    return version == MAPPABLE_VERSION;
+}
+
 uint32_t SessionFile5::GetDeviceId() const { return deviceId; }
 
 SessionFile5& SessionFile5::SetDeviceId(uint32_t deviceId) {
@@ -68,6 +115,7 @@ const void* SessionFile5::GetNor() const { return nor; }
 size_t SessionFile5::GetNorSize() const { return norSize; }
 
 SessionFile5& SessionFile5::SetNor(size_t size, const void* data) {
+    ownsImages = false;
     norSize = size;
     nor = reinterpret_cast<const uint8_t*>(data);
 
@@ -79,6 +127,7 @@ const void* SessionFile5::GetNand() const { return nand; }
 size_t SessionFile5::GetNandSize() const { return nandSize; }
 
 SessionFile5& SessionFile5::SetNand(size_t size, const void* data) {
+    ownsImages = false;
     nandSize = size;
     nand = reinterpret_cast<const uint8_t*>(data);
 
@@ -90,6 +139,7 @@ const void* SessionFile5::GetMemory() const { return memory; }
 size_t SessionFile5::GetMemorySize() const { return memorySize; }
 
 SessionFile5& SessionFile5::SetMemory(size_t size, const void* data) {
+    ownsImages = false;
     memorySize = size;
     memory = reinterpret_cast<const uint8_t*>(data);
 
@@ -115,75 +165,138 @@ SessionFile5& SessionFile5::SetRamSize(uint32_t size) {
     return *this;
 }
 
+bool SessionFile5::IsMappable() const { return mappable; }
+
+SessionFile5& SessionFile5::SetMappable(bool mappable) {
+    this->mappable = mappable;
+
+    return *this;
+}
+
+size_t SessionFile5::GetOffset(const void* image) const {
+    return reinterpret_cast<const uint8_t*>(image) - serializedSession;
+}
+
 bool SessionFile5::Serialize() {
+    // Unless a delta was applied, deserialized images live in the buffer that we are about to
+    // replace
+    if (!imageBuffer) ownsImages = false;
+
     serializedSessionSize = 0;
     serializedSession = nullptr;
 
-    const size_t sizeUncompressed = metadataSize + norSize + nandSize + memorySize + savestateSize;
+    const uint8_t* regions[REGION_COUNT] = {metadata, nor, nand, memory, savestate};
+    const size_t regionSizes[REGION_COUNT] = {metadataSize, norSize, nandSize, memorySize,
+                                              savestateSize};
 
-    bufferSize =
-        max(static_cast<size_t>(BUFFER_MIN_SIZE), SIZE_HEADER + SIZE_TOC + sizeUncompressed / 2);
-    buffer = make_unique<uint8_t[]>(bufferSize);
-    cursor = buffer.get();
+    if (metadataSize + norSize + nandSize + memorySize + savestateSize > BUFFER_MAX_SIZE) {
+        cerr << "session too large" << endl;
+        return false;
+    }
 
-    bool success = true;
+    if (mappable) {
+        size_t regionOffsets[REGION_COUNT];
+        size_t offset = SIZE_HEADER + SIZE_TOC + SIZE_OFFSETS;
 
-    success &= Write32(MAGIC);
-    success &= Write32(CURRENT_VERSION);
-    success &= Write32(deviceId);
-    success &= Write32(ramSize);
+        for (size_t region = 0; region < REGION_COUNT; region++) {
+            regionOffsets[region] = 0;
+            if (regionSizes[region] == 0) continue;
 
-    success &= Write32(metadataSize);
-    success &= Write32(norSize);
-    success &= Write32(nandSize);
-    success &= Write32(memorySize);
-    success &= Write32(savestateSize);
+            regionOffsets[region] = align(offset);
+            offset = regionOffsets[region] + regionSizes[region];
+        }
 
-    if (!success) {
-        cerr << "failed to write header" << endl;
-        return false;
-    }
+        bufferSize = offset;
+        buffer = make_unique<uint8_t[]>(bufferSize);
+        cursor = buffer.get();
 
-    z_stream stream;
-    memset(&stream, 0, sizeof(stream));
+        bool success = true;
 
-    if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
-        return false;
-    }
+        success &= Write32(MAGIC);
+        success &= Write32(MAPPABLE_VERSION);
+        success &= Write32(deviceId);
+        success &= Write32(ramSize);
 
-    Defer cleanupDeflate([&]() { deflateEnd(&stream); });
+        for (size_t size : regionSizes) success &= Write32(size);
+        for (size_t regionOffset : regionOffsets) success &= Write32(regionOffset);
 
-    stream.next_out = cursor;
-    stream.avail_out = bufferSize - (cursor - buffer.get());
+        if (!success) {
+            cerr << "failed to write header" << endl;
+            return false;
+        }
 
-    if (!AppendToCompressionStream(metadataSize, metadata, stream)) {
-        cerr << "failed to write metadata" << endl;
-        return false;
-    }
+        memset(cursor, 0, bufferSize - (cursor - buffer.get()));
 
-    if (!AppendToCompressionStream(norSize, nor, stream)) {
-        cerr << "failed to write NOR" << endl;
-        return false;
+        for (size_t region = 0; region < REGION_COUNT; region++) {
+            if (regionSizes[region] > 0)
+                memcpy(buffer.get() + regionOffsets[region], regions[region], regionSizes[region]);
+        }
+
+        serializedSession = buffer.get();
+        serializedSessionSize = bufferSize;
+
+        return true;
     }
 
-    if (!AppendToCompressionStream(nandSize, nand, stream)) {
-        cerr << "failed to write NAND" << endl;
+    const vector<Chunk> chunks = chunkRegions(regionSizes, CHUNK_SIZE);
+    const size_t sizeHeaders =
+        SIZE_HEADER + SIZE_TOC + SIZE_CHUNK_HEADER + chunks.size() * SIZE_CHUNK_ENTRY;
+
+    // Each chunk is compressed into a slot large enough for the worst case. Afterwards, the
+    // chunks are moved down to close the gaps.
+    vector<size_t> slots(chunks.size() + 1);
+    slots[0] = sizeHeaders;
+
+    for (size_t i = 0; i < chunks.size(); i++)
+        slots[i + 1] = slots[i] + compressBound(chunks[i].size);
+
+    bufferSize = slots.back();
+    buffer = make_unique<uint8_t[]>(bufferSize);
+
+    vector<mz_ulong> compressedSizes(chunks.size());
+    vector<uint32_t> crcs(chunks.size());
+    vector<uint8_t> success(chunks.size());
+
+    worker_pool::Run(chunks.size(), [&](size_t i) {
+        const uint8_t* data = regions[chunks[i].region] + chunks[i].offset;
+
+        compressedSizes[i] = slots[i + 1] - slots[i];
+        success[i] = compress2(buffer.get() + slots[i], &compressedSizes[i], data,
+                               chunks[i].size, Z_DEFAULT_COMPRESSION) == Z_OK;
+        crcs[i] = crc::CRC32(data, chunks[i].size);
+    });
+
+    if (find(success.begin(), success.end(), 0) != success.end()) {
+        cerr << "failed to compress session" << endl;
         return false;
     }
 
-    if (!AppendToCompressionStream(memorySize, memory, stream)) {
-        cerr << "failed to write memory" << endl;
-        return false;
+    cursor = buffer.get();
+    bool headerWritten = true;
+
+    headerWritten &= Write32(MAGIC);
+    headerWritten &= Write32(CURRENT_VERSION);
+    headerWritten &= Write32(deviceId);
+    headerWritten &= Write32(ramSize);
+
+    for (size_t size : regionSizes) headerWritten &= Write32(size);
+
+    headerWritten &= Write32(CHUNK_SIZE);
+    headerWritten &= Write32(chunks.size());
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        headerWritten &= Write32(compressedSizes[i]);
+        headerWritten &= Write32(crcs[i]);
     }
 
-    if (!AppendToCompressionStream(savestateSize, savestate, stream)) {
-        cerr << "failed to write savestate" << endl;
+    if (!headerWritten) {
+        cerr << "failed to write header" << endl;
         return false;
     }
 
-    if (!Flush(stream)) {
-        cerr << "failed to flush" << endl;
-        return false;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        memmove(cursor, buffer.get() + slots[i], compressedSizes[i]);
+        cursor += compressedSizes[i];
     }
 
     serializedSession = buffer.get();
@@ -202,6 +315,11 @@ bool SessionFile5::Deserialize(size_t size, const void* data) {
     metadataSize = norSize = nandSize = memorySize = savestateSize = 0;
     metadata = nor = nand = memory = savestate = nullptr;
 
+    ownsImages = false;
+    mappable = false;
+    imageBuffer.reset();
+    deltaState.reset();
+
     serializedSession = reinterpret_cast<const uint8_t*>(data);
     serializedSessionSize = size;
 
@@ -230,84 +348,67 @@ bool SessionFile5::Deserialize(size_t size, const void* data) {
         case 3:
             return Deserialize_v1_v2_v3(version);
 
+        case 4:
+            return Deserialize_v4();
+
+        case 5:
+            return Deserialize_v5();
+
         default:
             cerr << "unsupported session version " << version << endl;
             return false;
     }
 }
 
-bool SessionFile5::Write32(uint32_t data) {
-    if (!buffer || cursor - buffer.get() + 4 > static_cast<ssize_t>(bufferSize)) return false;
-
-    *(cursor++) = data;
-    *(cursor++) = (data >> 8);
-    *(cursor++) = (data >> 16);
-    *(cursor++) = (data >> 24);
-
-    return true;
-}
-
-uint32_t SessionFile5::Read32(bool& success) {
-    if (!serializedSession ||
-        ccursor - serializedSession + 4 > static_cast<ssize_t>(serializedSessionSize)) {
-        success = false;
-        return 0;
+bool SessionFile5::ApplyDelta(const SessionDelta& delta) {
+    if (!ownsImages) {
+        cerr << "delta requires a deserialized session" << endl;
+        return false;
     }
 
-    uint32_t result = *(ccursor++);
-    result |= (*(ccursor++) << 8);
-    result |= (*(ccursor++) << 16);
-    result |= (*(ccursor++) << 24);
-
-    return result;
-}
-
-bool SessionFile5::AppendToCompressionStream(size_t size, const uint8_t* data, mz_stream& stream) {
-    if (size == 0) return true;
-
-    stream.next_in = reinterpret_cast<const unsigned char*>(data);
-    stream.avail_in = size;
-
-    int deflateResult;
-    do {
-        const auto outBytesBefore = stream.total_out;
-        deflateResult = deflate(&stream, Z_NO_FLUSH);
-        cursor += stream.total_out - outBytesBefore;
-
-        if (deflateResult == Z_BUF_ERROR && GrowBuffer(stream)) deflateResult = Z_OK;
-    } while (stream.avail_in != 0 && deflateResult == Z_OK);
-
-    return deflateResult == Z_OK;
-}
+    if ((delta.GetPageCount(SessionDelta::Image::nor) > 0 &&
+         delta.GetImageSize(SessionDelta::Image::nor) != norSize) ||
+        (delta.GetPageCount(SessionDelta::Image::nand) > 0 &&
+         delta.GetImageSize(SessionDelta::Image::nand) != nandSize) ||
+        (delta.GetPageCount(SessionDelta::Image::memory) > 0 &&
+         delta.GetImageSize(SessionDelta::Image::memory) != memorySize)) {
+        cerr << "delta does not match session" << endl;
+        return false;
+    }
 
-bool SessionFile5::GrowBuffer(mz_stream& stream) {
-    if (bufferSize == BUFFER_MAX_SIZE) return false;
+    // Keep the images alive if the session is serialized
+    if (!imageBuffer) imageBuffer = move(buffer);
 
-    size_t newBufferSize = min((bufferSize * 3) / 2, BUFFER_MAX_SIZE);
-    unique_ptr<uint8_t[]> newBuffer = make_unique<uint8_t[]>(newBufferSize);
+    // The images point into buffers that we own
+    delta.Apply(SessionDelta::Image::nor, norSize, const_cast<uint8_t*>(nor));
+    delta.Apply(SessionDelta::Image::nand, nandSize, const_cast<uint8_t*>(nand));
+    delta.Apply(SessionDelta::Image::memory, memorySize, const_cast<uint8_t*>(memory));
 
-    memcpy(newBuffer.get(), buffer.get(), cursor - buffer.get());
-    cursor = newBuffer.get() + (cursor - buffer.get());
-    bufferSize = newBufferSize;
+    deltaState = make_unique<uint8_t[]>(delta.GetMetadataSize() + delta.GetSavestateSize());
 
-    buffer.swap(newBuffer);
+    metadataSize = delta.GetMetadataSize();
+    metadata = deltaState.get();
+    if (metadataSize > 0) memcpy(deltaState.get(), delta.GetMetadata(), metadataSize);
 
-    stream.next_out = cursor;
-    stream.avail_out = bufferSize - (cursor - buffer.get());
+    savestateSize = delta.GetSavestateSize();
+    savestate = deltaState.get() + metadataSize;
+    if (savestateSize > 0)
+        memcpy(deltaState.get() + metadataSize, delta.GetSavestate(), savestateSize);
 
     return true;
 }
 
-bool SessionFile5::Flush(mz_stream& stream) {
-    int deflateResult;
+bool SessionFile5::Write32(uint32_t data) {
+    return buffer && serialization::Write32(cursor, buffer.get() + bufferSize, data);
+}
 
-    do {
-        const auto outBytesBefore = stream.total_out;
-        deflateResult = deflate(&stream, Z_FINISH);
-        cursor += stream.total_out - outBytesBefore;
-    } while ((deflateResult == Z_BUF_ERROR || deflateResult == Z_OK) && GrowBuffer(stream));
+uint32_t SessionFile5::Read32(bool& success) {
+    if (!serializedSession) {
+        success = false;
+        return 0;
+    }
 
-    return deflateResult == Z_STREAM_END;
+    return serialization::Read32(ccursor, serializedSession + serializedSessionSize, success);
 }
 
 bool SessionFile5::Deserialize_v0() {
@@ -428,6 +529,7 @@ bool SessionFile5::Deserialize_v0() {
     }
 
     deviceId = info.GetDeviceType();
+    ownsImages = true;
 
     return true;
 }
@@ -489,6 +591,155 @@ bool SessionFile5::Deserialize_v1_v2_v3(uint32_t sessionVersion) {
     savestate = cursor;
 
     if (version == 2) MigrateV2Memory();
+    ownsImages = true;
+
+    return true;
+}
+
+bool SessionFile5::Deserialize_v4() {
+    bool success = true;
+
+    deviceId = Read32(success);
+    ramSize = Read32(success);
+
+    metadataSize = Read32(success);
+    norSize = Read32(success);
+    nandSize = Read32(success);
+    memorySize = Read32(success);
+    savestateSize = Read32(success);
+
+    const size_t chunkSize = Read32(success);
+    const size_t chunkCount = Read32(success);
+
+    if (!success) {
+        cerr << "failed to read v4 toc" << endl;
+        return false;
+    }
+
+    const size_t regionSizes[REGION_COUNT] = {metadataSize, norSize, nandSize, memorySize,
+                                              savestateSize};
+
+    bufferSize = metadataSize + norSize + nandSize + memorySize + savestateSize;
+    if (bufferSize > BUFFER_MAX_SIZE || chunkSize == 0) {
+        cerr << "v4 image: bad image size" << endl;
+        return false;
+    }
+
+    const vector<Chunk> chunks = chunkRegions(regionSizes, chunkSize);
+    if (chunks.size() != chunkCount) {
+        cerr << "v4 image: bad chunk count" << endl;
+        return false;
+    }
+
+    vector<size_t> compressedOffsets(chunkCount + 1);
+    vector<uint32_t> crcs(chunkCount);
+
+    compressedOffsets[0] = ccursor - serializedSession + chunkCount * SIZE_CHUNK_ENTRY;
+
+    for (size_t i = 0; i < chunkCount; i++) {
+        compressedOffsets[i + 1] = compressedOffsets[i] + Read32(success);
+        crcs[i] = Read32(success);
+    }
+
+    if (!success || compressedOffsets.back() != serializedSessionSize) {
+        cerr << "v4 image: bad chunk table" << endl;
+        return false;
+    }
+
+    size_t regionOffsets[REGION_COUNT] = {0};
+    for (size_t region = 1; region < REGION_COUNT; region++)
+        regionOffsets[region] = regionOffsets[region - 1] + regionSizes[region - 1];
+
+    buffer = make_unique<uint8_t[]>(bufferSize);
+
+    vector<uint8_t> chunkValid(chunkCount);
+
+    worker_pool::Run(chunkCount, [&](size_t i) {
+        uint8_t* data = buffer.get() + regionOffsets[chunks[i].region] + chunks[i].offset;
+        mz_ulong destLen = chunks[i].size;
+
+        chunkValid[i] = uncompress(data, &destLen, serializedSession + compressedOffsets[i],
+                                   compressedOffsets[i + 1] - compressedOffsets[i]) == Z_OK &&
+                        destLen == chunks[i].size && crc::CRC32(data, destLen) == crcs[i];
+    });
+
+    for (size_t i = 0; i < chunkCount; i++) {
+        if (chunkValid[i]) continue;
+
+        cerr << "v4 image: " << REGION_NAMES[chunks[i].region] << " corrupt at offset "
+             << chunks[i].offset << endl;
+        success = false;
+    }
+
+    if (!success) return false;
+
+    cursor = buffer.get();
+
+    metadata = cursor;
+    cursor += metadataSize;
+
+    nor = cursor;
+    cursor += norSize;
+
+    nand = cursor;
+    cursor += nandSize;
+
+    memory = cursor;
+    cursor += memorySize;
+
+    savestate = cursor;
+    ownsImages = true;
+
+    return true;
+}
+
+bool SessionFile5::Deserialize_v5() {
+    bool success = true;
+
+    deviceId = Read32(success);
+    ramSize = Read32(success);
+
+    size_t regionSizes[REGION_COUNT];
+    size_t regionOffsets[REGION_COUNT];
+
+    for (auto& size : regionSizes) size = Read32(success);
+    for (auto& offset : regionOffsets) offset = Read32(success);
+
+    if (!success) {
+        cerr << "failed to read v5 toc" << endl;
+        return false;
+    }
+
+    const uint8_t* regions[REGION_COUNT];
+
+    for (size_t region = 0; region < REGION_COUNT; region++) {
+        if (regionSizes[region] > serializedSessionSize ||
+            regionOffsets[region] > serializedSessionSize - regionSizes[region]) {
+            cerr << "v5 image: " << REGION_NAMES[region] << " out of bounds" << endl;
+            return false;
+        }
+
+        regions[region] = regionSizes[region] > 0 ? serializedSession + regionOffsets[region]
+                                                  : nullptr;
+    }
+
+    // The images are not copied and point into the serialized session
+    metadataSize = regionSizes[0];
+    metadata = regions[0];
+
+    norSize = regionSizes[1];
+    nor = regions[1];
+
+    nandSize = regionSizes[2];
+    nand = regions[2];
+
+    memorySize = regionSizes[3];
+    memory = regions[3];
+
+    savestateSize = regionSizes[4];
+    savestate = regions[4];
+
+    mappable = true;
 
     return true;
 }
@@ -5,13 +5,14 @@
 #include <cstdint>
 #include <memory>
 
-struct mz_stream_s;
+class SessionDelta;
 
 class SessionFile5 {
    public:
     explicit SessionFile5() = default;
 
     static bool IsSessionFile(size_t size, const void* data);
+    static bool IsMappableSessionFile(size_t size, const void* data);
 
     uint32_t GetDeviceId() const;
     SessionFile5& SetDeviceId(uint32_t deviceId);
@@ -39,6 +40,15 @@ class SessionFile5 {
     size_t GetRamSize();
     SessionFile5& SetRamSize(uint32_t size);
 
+    // A mappable session is stored uncompressed, with all images aligned to
+    // CowImage::FILE_ALIGNMENT. Deserializing it does not copy, and the images can be mapped
+    // copy-on-write directly from the file.
+    bool IsMappable() const;
+    SessionFile5& SetMappable(bool mappable);
+
+    // Offset of an image within the serialized session
+    size_t GetOffset(const void* image) const;
+
     bool Serialize();
     const void* GetSerializedSession() const;
     size_t GetSerializedSessionSize() const;
@@ -47,16 +57,18 @@ class SessionFile5 {
 
     bool Deserialize(size_t size, const void* data);
 
+    // Applies a delta to a deserialized session. Metadata and savestate are replaced, so
+    // serializing the result compacts base and delta into a new full session.
+    bool ApplyDelta(const SessionDelta& delta);
+
    private:
     bool Write32(uint32_t data);
     uint32_t Read32(bool& success);
 
-    bool AppendToCompressionStream(size_t size, const uint8_t* data, mz_stream_s& stream);
-    bool GrowBuffer(mz_stream_s& stream);
-    bool Flush(mz_stream_s& stream);
-
     bool Deserialize_v0();
     bool Deserialize_v1_v2_v3(uint32_t version);
+    bool Deserialize_v4();
+    bool Deserialize_v5();
 
     void MigrateV2Memory();
 
@@ -85,8 +97,12 @@ class SessionFile5 {
     std::unique_ptr<uint8_t[]> buffer;
 
     std::unique_ptr<uint8_t[]> migratedMemory;
+    std::unique_ptr<uint8_t[]> imageBuffer;
+    std::unique_ptr<uint8_t[]> deltaState;
+    bool ownsImages{false};
 
     uint32_t ramSize{0};
+    bool mappable{false};
 
     uint8_t* cursor;
     const uint8_t* ccursor;
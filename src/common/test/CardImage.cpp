@@ -0,0 +1,106 @@
+// clang-format off
+#include <gtest/gtest.h>
+// clang-format on
+
+#include "CardImage.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "CowImage.h"
+
+namespace {
+    constexpr size_t BLOCKS = 64;
+
+    TEST(CardImage, ItStartsZeroedWhenSparse) {
+        CardImage image(BLOCKS);
+        uint8_t block[CardImage::BLOCK_SIZE];
+
+        ASSERT_EQ(image.BlocksTotal(), BLOCKS);
+
+        memset(block, 0xff, sizeof(block));
+        ASSERT_EQ(image.Read(block, BLOCKS - 1), 1u);
+
+        for (uint8_t byte : block) ASSERT_EQ(byte, 0);
+    }
+
+    TEST(CardImage, ItWritesToTheOverlayOnly) {
+        uint8_t baseData[BLOCKS * CardImage::BLOCK_SIZE];
+        for (size_t i = 0; i < sizeof(baseData); i++) baseData[i] = i >> 9;
+
+        CowImage base(baseData, sizeof(baseData));
+        CardImage image(base);
+
+        uint8_t block[CardImage::BLOCK_SIZE];
+        memset(block, 0xaa, sizeof(block));
+
+        ASSERT_EQ(image.Write(block, 17), 1u);
+        ASSERT_EQ(image.DirtyPages()[0], 0x02);
+
+        uint8_t readback[2 * CardImage::BLOCK_SIZE];
+        ASSERT_EQ(image.Read(readback, 16, 2), 2u);
+        ASSERT_EQ(readback[0], 16);
+        ASSERT_EQ(memcmp(readback + CardImage::BLOCK_SIZE, block, sizeof(block)), 0);
+
+        CardImage other(base);
+        ASSERT_EQ(other.Read(readback, 17), 1u);
+        ASSERT_EQ(readback[0], 17);
+    }
+
+    TEST(CardImage, ItSnapshotsWrittenPagesOverTheBase) {
+        uint8_t baseData[BLOCKS * CardImage::BLOCK_SIZE];
+        for (size_t i = 0; i < sizeof(baseData); i++) baseData[i] = i >> 9;
+
+        CowImage base(baseData, sizeof(baseData));
+        CardImage image(base);
+
+        uint8_t block[CardImage::BLOCK_SIZE];
+        memset(block, 0xaa, sizeof(block));
+
+        ASSERT_EQ(image.Write(block, 17), 1u);
+
+        // Saving a session clears the dirty pages; the snapshot still has to see the write
+        image.DirtyPages()[0] = 0;
+
+        auto snapshot = image.Snapshot();
+        ASSERT_TRUE(snapshot->IsValid());
+        ASSERT_EQ(snapshot->GetSize(), sizeof(baseData));
+
+        memset(block, 0x55, sizeof(block));
+        ASSERT_EQ(image.Write(block, 40), 1u);
+
+        CardImage clone(*snapshot);
+        uint8_t readback[CardImage::BLOCK_SIZE];
+
+        for (size_t i = 0; i < BLOCKS; i++) {
+            ASSERT_EQ(clone.Read(readback, i), 1u);
+            ASSERT_EQ(readback[0], i == 17 ? 0xaa : i) << i;
+        }
+
+        ASSERT_EQ(clone.Write(block, 60), 1u);
+
+        CardImage secondClone(*clone.Snapshot());
+
+        for (size_t i = 0; i < BLOCKS; i++) {
+            ASSERT_EQ(secondClone.Read(readback, i), 1u);
+            ASSERT_EQ(readback[0], i == 17 ? 0xaa : i == 60 ? 0x55 : i) << i;
+        }
+    }
+
+    TEST(CardImage, ItSnapshotsSparseCardsOverZero) {
+        CardImage image(BLOCKS);
+
+        uint8_t block[CardImage::BLOCK_SIZE];
+        memset(block, 0xaa, sizeof(block));
+
+        ASSERT_EQ(image.Write(block, BLOCKS - 1), 1u);
+
+        CardImage clone(*image.Snapshot());
+        uint8_t readback[CardImage::BLOCK_SIZE];
+
+        for (size_t i = 0; i < BLOCKS; i++) {
+            ASSERT_EQ(clone.Read(readback, i), 1u);
+            ASSERT_EQ(readback[CardImage::BLOCK_SIZE - 1], i == BLOCKS - 1 ? 0xaa : 0) << i;
+        }
+    }
+}  // namespace
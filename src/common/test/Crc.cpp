@@ -21,4 +21,10 @@ namespace {
 
         ASSERT_EQ(crc::CRC32(reinterpret_cast<const uint8_t*>(fixture), 9), 0xcbf43926);
     }
+
+    TEST(CRC32, itCalculatesCRC32OverLongerBuffers) {
+        const char* fixture = "The quick brown fox jumps over the lazy dog";
+
+        ASSERT_EQ(crc::CRC32(reinterpret_cast<const uint8_t*>(fixture), 43), 0x414fa339u);
+    }
 }  // namespace
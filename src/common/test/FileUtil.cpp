@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "FileUtil.h"
+
+using namespace std;
+
+namespace {
+    class FileUtilTest : public ::testing::Test {
+       public:
+        void SetUp() override {
+            char pattern[] = "/tmp/fileutil-XXXXXX";
+            ASSERT_NE(mkdtemp(pattern), nullptr);
+
+            dir = pattern;
+            file = dir + "/file";
+        }
+
+        void TearDown() override {
+            unlink(file.c_str());
+            unlink((file + ".tmp").c_str());
+            rmdir(dir.c_str());
+        }
+
+       protected:
+        string dir;
+        string file;
+    };
+
+    TEST_F(FileUtilTest, itWritesANewFile) {
+        const uint8_t data[] = {1, 2, 3, 4};
+        ASSERT_TRUE(util::WriteFile(file, data, sizeof(data)));
+
+        unique_ptr<uint8_t[]> buffer;
+        size_t len;
+
+        ASSERT_TRUE(util::ReadFile(file, buffer, len));
+        ASSERT_EQ(len, sizeof(data));
+        ASSERT_EQ(memcmp(buffer.get(), data, len), 0);
+
+        ASSERT_NE(access((file + ".tmp").c_str(), F_OK), 0);
+    }
+
+    TEST_F(FileUtilTest, itKeepsThePermissionsOfAnExistingFile) {
+        const uint8_t data[] = {1, 2, 3, 4};
+        ASSERT_TRUE(util::WriteFile(file, data, sizeof(data)));
+        ASSERT_EQ(chmod(file.c_str(), 0604), 0);
+
+        const uint8_t newData[] = {5, 6};
+        ASSERT_TRUE(util::WriteFile(file, newData, sizeof(newData)));
+
+        struct stat fileStat;
+        ASSERT_EQ(stat(file.c_str(), &fileStat), 0);
+        ASSERT_EQ(fileStat.st_mode & 07777, 0604u);
+
+        unique_ptr<uint8_t[]> buffer;
+        size_t len;
+
+        ASSERT_TRUE(util::ReadFile(file, buffer, len));
+        ASSERT_EQ(len, sizeof(newData));
+        ASSERT_EQ(memcmp(buffer.get(), newData, len), 0);
+    }
+}  // namespace
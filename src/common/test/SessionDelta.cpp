@@ -0,0 +1,198 @@
+// clang-format off
+#include <gtest/gtest.h>
+// clang-format on
+
+#include "session/session_delta.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "session/session_file5.h"
+
+namespace {
+    constexpr size_t PAGE_SIZE = 1024;
+    constexpr size_t MEMORY_SIZE = 16 * PAGE_SIZE;
+    constexpr size_t NAND_SIZE = 4 * PAGE_SIZE + 100;
+
+    class SessionDeltaTest : public ::testing::Test {
+       public:
+        SessionDeltaTest() {
+            for (size_t i = 0; i < MEMORY_SIZE; i++) memory[i] = i;
+            for (size_t i = 0; i < NAND_SIZE; i++) nand[i] = i * 3;
+
+            memset(memoryDirtyPages, 0, sizeof(memoryDirtyPages));
+            memset(nandDirtyPages, 0, sizeof(nandDirtyPages));
+        }
+
+       protected:
+        void SetupDelta() {
+            delta.SetBase(0x12345678, 1)
+                .SetImage(SessionDelta::Image::nand, NAND_SIZE, nand, PAGE_SIZE, nandDirtyPages)
+                .SetImage(SessionDelta::Image::memory, MEMORY_SIZE, memory, PAGE_SIZE,
+                          memoryDirtyPages)
+                .SetSavestate(sizeof(savestate), savestate);
+        }
+
+       protected:
+        uint8_t memory[MEMORY_SIZE];
+        uint8_t nand[NAND_SIZE];
+        uint8_t memoryDirtyPages[2];
+        uint8_t nandDirtyPages[1];
+        uint8_t savestate[5]{1, 2, 3, 4, 5};
+
+        SessionDelta delta;
+    };
+
+    TEST_F(SessionDeltaTest, ItRoundtripsHeaderAndSavestate) {
+        SetupDelta();
+        ASSERT_TRUE(delta.Serialize());
+
+        SessionDelta deserialized;
+        ASSERT_TRUE(SessionDelta::IsSessionDelta(delta.GetSerializedDeltaSize(),
+                                                 delta.GetSerializedDelta()));
+        ASSERT_TRUE(
+            deserialized.Deserialize(delta.GetSerializedDeltaSize(), delta.GetSerializedDelta()));
+
+        ASSERT_EQ(deserialized.GetBaseFingerprint(), 0x12345678u);
+        ASSERT_EQ(deserialized.GetSequence(), 1u);
+        ASSERT_EQ(deserialized.GetSavestateSize(), sizeof(savestate));
+        ASSERT_EQ(memcmp(deserialized.GetSavestate(), savestate, sizeof(savestate)), 0);
+        ASSERT_EQ(deserialized.GetPageCount(SessionDelta::Image::memory), 0u);
+    }
+
+    TEST_F(SessionDeltaTest, ItAppliesDirtyPagesOnly) {
+        memoryDirtyPages[0] = 0x06;
+        memoryDirtyPages[1] = 0x80;
+        nandDirtyPages[0] = 0x10;
+
+        SetupDelta();
+        ASSERT_TRUE(delta.Serialize());
+
+        SessionDelta deserialized;
+        ASSERT_TRUE(
+            deserialized.Deserialize(delta.GetSerializedDeltaSize(), delta.GetSerializedDelta()));
+
+        ASSERT_EQ(deserialized.GetPageCount(SessionDelta::Image::memory), 3u);
+        ASSERT_EQ(deserialized.GetPageCount(SessionDelta::Image::nand), 1u);
+
+        uint8_t target[MEMORY_SIZE];
+        memset(target, 0, MEMORY_SIZE);
+        ASSERT_TRUE(deserialized.Apply(SessionDelta::Image::memory, MEMORY_SIZE, target));
+
+        for (size_t page = 0; page < MEMORY_SIZE / PAGE_SIZE; page++) {
+            const bool dirty = page == 1 || page == 2 || page == 15;
+
+            ASSERT_EQ(memcmp(target + page * PAGE_SIZE, memory + page * PAGE_SIZE, PAGE_SIZE) == 0,
+                      dirty);
+        }
+
+        uint8_t nandTarget[NAND_SIZE];
+        memset(nandTarget, 0, NAND_SIZE);
+        ASSERT_TRUE(deserialized.Apply(SessionDelta::Image::nand, NAND_SIZE, nandTarget));
+
+        ASSERT_EQ(memcmp(nandTarget + 4 * PAGE_SIZE, nand + 4 * PAGE_SIZE, 100), 0);
+        ASSERT_FALSE(deserialized.Apply(SessionDelta::Image::nand, NAND_SIZE - 1, nandTarget));
+    }
+
+    TEST_F(SessionDeltaTest, ItFailsOnTruncatedDelta) {
+        memoryDirtyPages[0] = 0xff;
+
+        SetupDelta();
+        ASSERT_TRUE(delta.Serialize());
+
+        SessionDelta deserialized;
+        ASSERT_FALSE(deserialized.Deserialize(delta.GetSerializedDeltaSize() - 4,
+                                              delta.GetSerializedDelta()));
+    }
+
+    TEST_F(SessionDeltaTest, ItGrowsTheBufferForIncompressiblePages) {
+        uint32_t state = 0x12345678;
+        for (size_t i = 0; i < MEMORY_SIZE; i++) {
+            state = state * 1664525 + 1013904223;
+            memory[i] = state >> 24;
+        }
+
+        memset(memoryDirtyPages, 0xff, sizeof(memoryDirtyPages));
+
+        SetupDelta();
+        ASSERT_TRUE(delta.Serialize());
+        ASSERT_GT(delta.GetSerializedDeltaSize(), MEMORY_SIZE);
+
+        SessionDelta deserialized;
+        ASSERT_TRUE(
+            deserialized.Deserialize(delta.GetSerializedDeltaSize(), delta.GetSerializedDelta()));
+
+        uint8_t target[MEMORY_SIZE];
+        ASSERT_TRUE(deserialized.Apply(SessionDelta::Image::memory, MEMORY_SIZE, target));
+        ASSERT_EQ(memcmp(target, memory, MEMORY_SIZE), 0);
+    }
+
+    TEST_F(SessionDeltaTest, ItRejectsGapsInTheChain) {
+        SetupDelta();
+
+        ASSERT_TRUE(delta.Continues(0x12345678, 0));
+
+        delta.SetBase(0x12345678, 3);
+
+        ASSERT_TRUE(delta.Continues(0x12345678, 2));
+        ASSERT_FALSE(delta.Continues(0x12345678, 1));
+        ASSERT_FALSE(delta.Continues(0x12345678, 3));
+        ASSERT_FALSE(delta.Continues(0x12345679, 2));
+    }
+
+    TEST_F(SessionDeltaTest, ItCompactsIntoSessionFile) {
+        uint8_t baseMemory[MEMORY_SIZE];
+        uint8_t baseNand[NAND_SIZE];
+        uint8_t nor[PAGE_SIZE];
+
+        memset(baseMemory, 0, MEMORY_SIZE);
+        memset(baseNand, 0xff, NAND_SIZE);
+        memset(nor, 0x55, PAGE_SIZE);
+
+        SessionFile5 base;
+        base.SetDeviceId(1)
+            .SetNor(PAGE_SIZE, nor)
+            .SetNand(NAND_SIZE, baseNand)
+            .SetMemory(MEMORY_SIZE, baseMemory);
+        ASSERT_TRUE(base.Serialize());
+
+        memset(memoryDirtyPages, 0xff, sizeof(memoryDirtyPages));
+        memset(nandDirtyPages, 0xff, sizeof(nandDirtyPages));
+
+        SetupDelta();
+        ASSERT_TRUE(delta.Serialize());
+
+        SessionDelta deserializedDelta;
+        ASSERT_TRUE(deserializedDelta.Deserialize(delta.GetSerializedDeltaSize(),
+                                                  delta.GetSerializedDelta()));
+
+        SessionFile5 compacted;
+        ASSERT_TRUE(
+            compacted.Deserialize(base.GetSerializedSessionSize(), base.GetSerializedSession()));
+        ASSERT_TRUE(compacted.ApplyDelta(deserializedDelta));
+        ASSERT_TRUE(compacted.Serialize());
+
+        SessionFile5 result;
+        ASSERT_TRUE(result.Deserialize(compacted.GetSerializedSessionSize(),
+                                       compacted.GetSerializedSession()));
+
+        ASSERT_EQ(result.GetMemorySize(), MEMORY_SIZE);
+        ASSERT_EQ(memcmp(result.GetMemory(), memory, MEMORY_SIZE), 0);
+        ASSERT_EQ(memcmp(result.GetNand(), nand, NAND_SIZE), 0);
+        ASSERT_EQ(memcmp(result.GetNor(), nor, PAGE_SIZE), 0);
+        ASSERT_EQ(result.GetSavestateSize(), sizeof(savestate));
+    }
+
+    TEST_F(SessionDeltaTest, ItRejectsDeltasOnSessionsThatAreNotDeserialized) {
+        SessionFile5 session;
+        session.SetMemory(MEMORY_SIZE, memory);
+
+        SetupDelta();
+        ASSERT_TRUE(delta.Serialize());
+
+        SessionDelta deserialized;
+        ASSERT_TRUE(
+            deserialized.Deserialize(delta.GetSerializedDeltaSize(), delta.GetSerializedDelta()));
+        ASSERT_FALSE(session.ApplyDelta(deserialized));
+    }
+}  // namespace
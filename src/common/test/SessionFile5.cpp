@@ -0,0 +1,113 @@
+// clang-format off
+#include <gtest/gtest.h>
+// clang-format on
+
+#include "session/session_file5.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "CowImage.h"
+
+namespace {
+    constexpr size_t NOR_SIZE = 100;
+    constexpr size_t NAND_SIZE = 3 * 1024 * 1024 + 17;
+    constexpr size_t MEMORY_SIZE = 2 * 1024 * 1024;
+
+    class SessionFile5Test : public ::testing::Test {
+       public:
+        SessionFile5Test()
+            : nor(std::make_unique<uint8_t[]>(NOR_SIZE)),
+              nand(std::make_unique<uint8_t[]>(NAND_SIZE)),
+              memory(std::make_unique<uint8_t[]>(MEMORY_SIZE)) {
+            for (size_t i = 0; i < NOR_SIZE; i++) nor[i] = i;
+            for (size_t i = 0; i < NAND_SIZE; i++) nand[i] = (i * 7) >> 5;
+            for (size_t i = 0; i < MEMORY_SIZE; i++) memory[i] = i >> 10;
+
+            session.SetDeviceId(3)
+                .SetRamSize(MEMORY_SIZE)
+                .SetNor(NOR_SIZE, nor.get())
+                .SetNand(NAND_SIZE, nand.get())
+                .SetMemory(MEMORY_SIZE, memory.get())
+                .SetSavestate(sizeof(savestate), savestate);
+        }
+
+       protected:
+        std::unique_ptr<uint8_t[]> nor;
+        std::unique_ptr<uint8_t[]> nand;
+        std::unique_ptr<uint8_t[]> memory;
+        uint8_t savestate[3]{1, 2, 3};
+
+        SessionFile5 session;
+    };
+
+    TEST_F(SessionFile5Test, ItRoundtripsChunkedImages) {
+        ASSERT_TRUE(session.Serialize());
+        ASSERT_TRUE(SessionFile5::IsSessionFile(session.GetSerializedSessionSize(),
+                                                session.GetSerializedSession()));
+
+        SessionFile5 deserialized;
+        ASSERT_TRUE(deserialized.Deserialize(session.GetSerializedSessionSize(),
+                                             session.GetSerializedSession()));
+
+        ASSERT_EQ(deserialized.GetDeviceId(), 3u);
+        ASSERT_EQ(deserialized.GetRamSize(), MEMORY_SIZE);
+        ASSERT_EQ(deserialized.GetMetadataSize(), 0u);
+        ASSERT_EQ(deserialized.GetNorSize(), NOR_SIZE);
+        ASSERT_EQ(memcmp(deserialized.GetNor(), nor.get(), NOR_SIZE), 0);
+        ASSERT_EQ(deserialized.GetNandSize(), NAND_SIZE);
+        ASSERT_EQ(memcmp(deserialized.GetNand(), nand.get(), NAND_SIZE), 0);
+        ASSERT_EQ(deserialized.GetMemorySize(), MEMORY_SIZE);
+        ASSERT_EQ(memcmp(deserialized.GetMemory(), memory.get(), MEMORY_SIZE), 0);
+        ASSERT_EQ(deserialized.GetSavestateSize(), sizeof(savestate));
+        ASSERT_EQ(memcmp(deserialized.GetSavestate(), savestate, sizeof(savestate)), 0);
+    }
+
+    TEST_F(SessionFile5Test, ItDetectsCorruptChunks) {
+        ASSERT_TRUE(session.Serialize());
+
+        const size_t size = session.GetSerializedSessionSize();
+        auto corrupted = std::make_unique<uint8_t[]>(size);
+        memcpy(corrupted.get(), session.GetSerializedSession(), size);
+
+        corrupted[size - 10] ^= 0xff;
+
+        SessionFile5 deserialized;
+        ASSERT_FALSE(deserialized.Deserialize(size, corrupted.get()));
+    }
+
+    TEST_F(SessionFile5Test, ItFailsOnTruncatedSession) {
+        ASSERT_TRUE(session.Serialize());
+
+        SessionFile5 deserialized;
+        ASSERT_FALSE(deserialized.Deserialize(session.GetSerializedSessionSize() - 1,
+                                              session.GetSerializedSession()));
+    }
+
+    TEST_F(SessionFile5Test, ItRoundtripsMappableSessionsWithAlignedImages) {
+        ASSERT_TRUE(session.SetMappable(true).Serialize());
+        ASSERT_TRUE(SessionFile5::IsMappableSessionFile(session.GetSerializedSessionSize(),
+                                                        session.GetSerializedSession()));
+
+        SessionFile5 deserialized;
+        ASSERT_TRUE(deserialized.Deserialize(session.GetSerializedSessionSize(),
+                                             session.GetSerializedSession()));
+
+        ASSERT_TRUE(deserialized.IsMappable());
+        ASSERT_EQ(deserialized.GetNorSize(), NOR_SIZE);
+        ASSERT_EQ(memcmp(deserialized.GetNor(), nor.get(), NOR_SIZE), 0);
+        ASSERT_EQ(memcmp(deserialized.GetNand(), nand.get(), NAND_SIZE), 0);
+        ASSERT_EQ(memcmp(deserialized.GetMemory(), memory.get(), MEMORY_SIZE), 0);
+        ASSERT_EQ(memcmp(deserialized.GetSavestate(), savestate, sizeof(savestate)), 0);
+
+        ASSERT_EQ(deserialized.GetOffset(deserialized.GetNor()) % CowImage::FILE_ALIGNMENT, 0u);
+        ASSERT_EQ(deserialized.GetOffset(deserialized.GetNand()) % CowImage::FILE_ALIGNMENT, 0u);
+        ASSERT_EQ(deserialized.GetOffset(deserialized.GetMemory()) % CowImage::FILE_ALIGNMENT,
+                  0u);
+
+        ASSERT_TRUE(session.SetMappable(false).Serialize());
+        ASSERT_FALSE(SessionFile5::IsMappableSessionFile(session.GetSerializedSessionSize(),
+                                                         session.GetSerializedSession()));
+    }
+}  // namespace
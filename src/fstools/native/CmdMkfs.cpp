@@ -23,9 +23,7 @@ bool CmdMkfs::Run() {
         return false;
     }
 
-    uint8_t* buffer = new uint8_t[sizeBytes];
-
-    CardImage image(buffer, sizeBytes >> 9);
+    CardImage image(sizeBytes >> 9);
     CardVolume volume(image);
     card_initialize(&volume);
 
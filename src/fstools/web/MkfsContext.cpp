@@ -18,7 +18,7 @@ bool MkfsContext::Mkfs(unsigned int size, const char* label) {
     uint32_t imageSize = FSToolsUtil::determineImageSize(size);
     if (imageSize == 0) return false;
 
-    image = new CardImage(new uint8_t[imageSize], imageSize >> 9);
+    image = new CardImage(imageSize >> 9);
     CardVolume volume(*image);
     card_initialize(&volume);
 
@@ -25,6 +25,7 @@ extern "C" {
 #endif
 
 uint64_t timestampUsec();
+uint64_t timestampNsec();
 void uarmAbort();
 
 #ifdef __cplusplus
@@ -3,14 +3,17 @@
 #include "Commands.h"
 
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "CPEndian.h"
 #include "Cli.h"
+#include "CowImage.h"
 #include "FileUtil.h"
 #include "SoC.h"
 #include "app_launcher.h"
@@ -19,50 +22,28 @@
 #include "db_list.h"
 #include "md5.h"
 #include "sdcard.h"
+#include "session/session_delta.h"
 #include "session/session_file5.h"
 #include "syscall_dispatch.h"
 
 using namespace std;
 
 namespace {
-    Rotation rotate(Rotation rotation) {
-        switch (rotation) {
-            case Rotation::portrait_0:
-                return Rotation::landscape_90;
+    constexpr size_t MEMORY_PAGE_SIZE = 1024;
+    constexpr size_t NAND_PAGE_SIZE = 4224;
 
-            case Rotation::landscape_90:
-                return Rotation::portrait_180;
+    // The last session written by save-session is the base for save-delta
+    optional<uint32_t> deltaBase;
+    uint32_t deltaSequence{0};
 
-            case Rotation::portrait_180:
-                return Rotation::landscape_270;
+    void resetDirtyPages(SoC* soc) {
+        const Buffer memoryDirtyPages = soc->GetMemoryDirtyPages();
+        const Buffer nandDirtyPages = soc->GetNandDirtyPages();
 
-            default:
-                return Rotation::portrait_0;
-        }
-    }
-
-    void CmdSetMips(vector<string> args, cli::CommandEnvironment& env, void* context) {
-        if (args.size() != 1) return env.PrintUsage();
-
-        uint32_t mips;
-        istringstream s(args[0]);
-
-        s >> mips;
-
-        if (s.fail() || !s.eof()) {
-            cout << "invalid argument" << endl;
-            return;
-        }
-
-        static_cast<commands::Context*>(context)->mainLoop.SetCyclesPerSecondLimit(mips * 1000000);
-    }
+        memset(memoryDirtyPages.data, 0, memoryDirtyPages.size);
+        if (nandDirtyPages.data) memset(nandDirtyPages.data, 0, nandDirtyPages.size);
 
-    void CmdEnableAudio(vector<string> args, cli::CommandEnvironment& env, void* context) {
-        static_cast<commands::Context*>(context)->audioDriver.Start();
-    }
-
-    void CmdDisableAudio(vector<string> args, cli::CommandEnvironment& env, void* context) {
-        static_cast<commands::Context*>(context)->audioDriver.Pause();
+        soc->SetNandDirty(false);
     }
 
     void CmdUnmount(vector<string> args, cli::CommandEnvironment& env, void* context) {
@@ -85,23 +66,22 @@ namespace {
 
         if (args.size() != 1) return env.PrintUsage();
 
-        size_t len{0};
-        unique_ptr<uint8_t[]> data;
+        unique_ptr<CowImage> image = util::MapFile(args[0]);
 
-        if (!util::ReadFile(args[0], data, len)) {
+        if (!image) {
             cout << "failed to read " << args[0];
             return;
         }
 
-        if (len % SD_SECTOR_SIZE) {
+        if (!sdCardInitializeWithImage(*image, "")) {
             cout << "sd card image has bad size" << endl;
             return;
         }
 
         auto ctx = reinterpret_cast<commands::Context*>(context);
-        string key = md5(data.get(), len);
+        string key = md5(reinterpret_cast<uint8_t*>(sdCardData().data), sdCardData().size);
 
-        sdCardInitializeWithData(len / SD_SECTOR_SIZE, data.release(), key.c_str());
+        sdCardRekey(key.c_str());
         ctx->soc->SdInsert();
     }
 
@@ -125,13 +105,8 @@ namespace {
         ctx->soc->Reset();
     }
 
-    void CmdRotate(vector<string> args, cli::CommandEnvironment& env, void* context) {
-        auto ctx = reinterpret_cast<commands::Context*>(context);
-
-        ctx->rotation = rotate(ctx->rotation);
-    }
-
-    void CmdSaveSession(vector<string> args, cli::CommandEnvironment& env, void* context) {
+    void saveSession(vector<string> args, cli::CommandEnvironment& env, void* context,
+                     bool mappable) {
         if (args.size() != 1 && args.size() != 2) return env.PrintUsage();
 
         auto ctx = reinterpret_cast<commands::Context*>(context);
@@ -159,7 +134,8 @@ namespace {
             .SetNor(rom.size, reinterpret_cast<uint8_t*>(rom.data))
             .SetNand(nand.size, reinterpret_cast<uint8_t*>(nand.data))
             .SetMemory(memory.size, reinterpret_cast<uint8_t*>(memory.data))
-            .SetSavestate(savestate.size, reinterpret_cast<uint8_t*>(savestate.data));
+            .SetSavestate(savestate.size, reinterpret_cast<uint8_t*>(savestate.data))
+            .SetMappable(mappable);
 
         if (!sessionFile.Serialize()) {
             cout << "failed to serialize session" << endl;
@@ -172,6 +148,12 @@ namespace {
             cout << "failed to write session to " << args[0] << endl;
         } else {
             cout << "wrote session to " << args[0] << endl;
+
+            deltaBase = SessionDelta::Fingerprint(sessionFile.GetSerializedSessionSize(),
+                                                  sessionFile.GetSerializedSession());
+            deltaSequence = 0;
+
+            resetDirtyPages(ctx->soc);
         }
 
         if (args.size() == 2 && sdCardInitialized()) {
@@ -183,6 +165,121 @@ namespace {
         }
     }
 
+    void CmdSaveSession(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        saveSession(args, env, context, false);
+    }
+
+    void CmdSaveSessionMappable(vector<string> args, cli::CommandEnvironment& env,
+                                void* context) {
+        saveSession(args, env, context, true);
+    }
+
+    void CmdSaveDelta(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() != 1) return env.PrintUsage();
+
+        if (!deltaBase) {
+            cout << "no base session; use save-session first" << endl;
+            return;
+        }
+
+        auto ctx = reinterpret_cast<commands::Context*>(context);
+
+        if (!ctx->soc->Save()) {
+            cout << "failed to save state" << endl;
+            return;
+        }
+
+        SessionDelta delta;
+
+        const Buffer rom = ctx->soc->GetRomData();
+        const Buffer nand = ctx->soc->GetNandData();
+        const Buffer nandDirtyPages = ctx->soc->GetNandDirtyPages();
+        const Buffer memory = ctx->soc->GetMemoryData();
+        const Buffer memoryDirtyPages = ctx->soc->GetMemoryDirtyPages();
+        const Buffer savestate = ctx->soc->GetSavestate();
+
+        delta.SetBase(*deltaBase, deltaSequence + 1)
+            .SetImage(SessionDelta::Image::nor, rom.size, rom.data, MEMORY_PAGE_SIZE, nullptr)
+            .SetImage(SessionDelta::Image::nand, nand.size, nand.data, NAND_PAGE_SIZE,
+                      nandDirtyPages.data)
+            .SetImage(SessionDelta::Image::memory, memory.size, memory.data, MEMORY_PAGE_SIZE,
+                      memoryDirtyPages.data)
+            .SetSavestate(savestate.size, savestate.data);
+
+        if (!delta.Serialize()) {
+            cout << "failed to serialize delta" << endl;
+            return;
+        }
+
+        if (!util::WriteFile(args[0], reinterpret_cast<const uint8_t*>(delta.GetSerializedDelta()),
+                             delta.GetSerializedDeltaSize())) {
+            cout << "failed to write delta to " << args[0] << endl;
+            return;
+        }
+
+        cout << "wrote delta " << delta.GetSequence() << " ("
+             << delta.GetPageCount(SessionDelta::Image::nand) << " NAND pages, "
+             << delta.GetPageCount(SessionDelta::Image::memory) << " RAM pages) to " << args[0]
+             << endl;
+
+        deltaSequence++;
+        resetDirtyPages(ctx->soc);
+    }
+
+    void CmdCompactSession(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() < 3) return env.PrintUsage();
+
+        size_t baseLen{0};
+        unique_ptr<uint8_t[]> baseData;
+        SessionFile5 sessionFile;
+
+        if (!util::ReadFile(args[0], baseData, baseLen) ||
+            !sessionFile.Deserialize(baseLen, baseData.get())) {
+            cout << "failed to read session from " << args[0] << endl;
+            return;
+        }
+
+        const uint32_t fingerprint = SessionDelta::Fingerprint(baseLen, baseData.get());
+        uint32_t sequence = 0;
+
+        for (size_t i = 2; i < args.size(); i++) {
+            size_t deltaLen{0};
+            unique_ptr<uint8_t[]> deltaData;
+            SessionDelta delta;
+
+            if (!util::ReadFile(args[i], deltaData, deltaLen) ||
+                !delta.Deserialize(deltaLen, deltaData.get())) {
+                cout << "failed to read delta from " << args[i] << endl;
+                return;
+            }
+
+            if (!delta.Continues(fingerprint, sequence)) {
+                cout << args[i] << " does not continue the chain" << endl;
+                return;
+            }
+
+            if (!sessionFile.ApplyDelta(delta)) {
+                cout << "failed to apply " << args[i] << endl;
+                return;
+            }
+
+            sequence = delta.GetSequence();
+        }
+
+        if (!sessionFile.Serialize()) {
+            cout << "failed to serialize session" << endl;
+            return;
+        }
+
+        if (!util::WriteFile(args[1],
+                             reinterpret_cast<const uint8_t*>(sessionFile.GetSerializedSession()),
+                             sessionFile.GetSerializedSessionSize())) {
+            cout << "failed to write session to " << args[1] << endl;
+        } else {
+            cout << "compacted " << args.size() - 2 << " deltas into " << args[1] << endl;
+        }
+    }
+
     void CmdSaveSd(vector<string> args, cli::CommandEnvironment& env, void* context) {
         if (args.size() != 1) return env.PrintUsage();
 
@@ -402,13 +499,7 @@ namespace {
     }
 
     const vector<cli::Command> commandList(
-        {{.name = "set-mips",
-          .usage = "set-mips <mips>",
-          .description = "Set target MIPS.",
-          .cmd = CmdSetMips},
-         {.name = "audio-on", .description = "Enable audio.", .cmd = CmdEnableAudio},
-         {.name = "audio-off", .description = "Disable audio.", .cmd = CmdDisableAudio},
-         {.name = "unmount", .description = "Unmount SD card.", .cmd = CmdUnmount},
+        {{.name = "unmount", .description = "Unmount SD card.", .cmd = CmdUnmount},
          {.name = "mount",
           .usage = "mount <image>",
           .description = "Unmount SD card.",
@@ -418,11 +509,22 @@ namespace {
           .description = "Reset Pilot w/o loading extensions.",
           .cmd = CmdResetNoExtensions},
          {.name = "reset-hard", .description = "Hard reset Pilot.", .cmd = CmdResetHard},
-         {.name = "rotate", .description = "Rotate 90° CCW", .cmd = CmdRotate},
          {.name = "save-session",
           .usage = "save-session <session file> [card image]",
           .description = "Save session.",
           .cmd = CmdSaveSession},
+         {.name = "save-session-mappable",
+          .usage = "save-session-mappable <session file> [card image]",
+          .description = "Save uncompressed session that loads copy-on-write.",
+          .cmd = CmdSaveSessionMappable},
+         {.name = "save-delta",
+          .usage = "save-delta <delta file>",
+          .description = "Save changes since the last session or delta.",
+          .cmd = CmdSaveDelta},
+         {.name = "compact-session",
+          .usage = "compact-session <base session> <output session> <delta file>...",
+          .description = "Merge a chain of deltas into a session.",
+          .cmd = CmdCompactSession},
          {.name = "save-sd",
           .usage = "save-sd <card image>",
           .description = "Save SD card.",
@@ -0,0 +1,76 @@
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+
+#include "SdlCommands.h"
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Cli.h"
+
+using namespace std;
+
+namespace {
+    sdl_commands::Context* getContext(void* context) {
+        return static_cast<sdl_commands::Context*>(static_cast<commands::Context*>(context));
+    }
+
+    Rotation rotate(Rotation rotation) {
+        switch (rotation) {
+            case Rotation::portrait_0:
+                return Rotation::landscape_90;
+
+            case Rotation::landscape_90:
+                return Rotation::portrait_180;
+
+            case Rotation::portrait_180:
+                return Rotation::landscape_270;
+
+            default:
+                return Rotation::portrait_0;
+        }
+    }
+
+    void CmdSetMips(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() != 1) return env.PrintUsage();
+
+        uint32_t mips;
+        istringstream s(args[0]);
+
+        s >> mips;
+
+        if (s.fail() || !s.eof()) {
+            cout << "invalid argument" << endl;
+            return;
+        }
+
+        getContext(context)->mainLoop.SetCyclesPerSecondLimit(mips * 1000000);
+    }
+
+    void CmdEnableAudio(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        getContext(context)->audioDriver.Start();
+    }
+
+    void CmdDisableAudio(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        getContext(context)->audioDriver.Pause();
+    }
+
+    void CmdRotate(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        auto ctx = getContext(context);
+
+        ctx->rotation = rotate(ctx->rotation);
+    }
+
+    const vector<cli::Command> commandList(
+        {{.name = "set-mips",
+          .usage = "set-mips <mips>",
+          .description = "Set target MIPS.",
+          .cmd = CmdSetMips},
+         {.name = "audio-on", .description = "Enable audio.", .cmd = CmdEnableAudio},
+         {.name = "audio-off", .description = "Disable audio.", .cmd = CmdDisableAudio},
+         {.name = "rotate", .description = "Rotate 90° CCW", .cmd = CmdRotate}});
+}  // namespace
+
+void sdl_commands::Register() { cli::AddCommands(commandList); }
@@ -0,0 +1,19 @@
+#ifndef _CLI_UARM_SDL_COMMANDS_H_
+#define _CLI_UARM_SDL_COMMANDS_H_
+
+#include "Commands.h"
+#include "MainLoop.h"
+#include "Rotation.h"
+#include "SdlAudioDriver.h"
+
+namespace sdl_commands {
+    struct Context : commands::Context {
+        MainLoop& mainLoop;
+        SdlAudioDriver& audioDriver;
+        Rotation rotation;
+    };
+
+    void Register();
+}  // namespace sdl_commands
+
+#endif  // _CLI_UARM_SDL_COMMANDS_H_
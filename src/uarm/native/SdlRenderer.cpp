@@ -65,21 +65,22 @@ void SdlRenderer::Draw(bool forceRedraw) {
     if (!frame && !forceRedraw && lcdEnabled == wasLcdEnabled) return;
 
     if (frame) {
-        uint8_t* pixels;
-        int pitch;
-        SDL_LockTexture(frameTexture, NULL, (void**)&pixels, &pitch);
-
-        if (pitch == 4 * displayConfiguration.width) {
-            memcpy(pixels, frame, 4 * displayConfiguration.width * displayConfiguration.height);
-        } else {
-            for (int y = 0; y < displayConfiguration.height; y++) {
-                memcpy(pixels, frame, 4 * displayConfiguration.width);
-                frame += displayConfiguration.width;
-                pixels += pitch;
-            }
+        // Only upload damaged lines; the texture keeps the rest of the previous frame
+        SoC::FrameDamage damage = soc->GetPendingFrameDamage();
+        if (!frameTextureValid)
+            damage = {0, static_cast<uint32_t>(displayConfiguration.height)};
+
+        if (damage.lineCount > 0) {
+            SDL_Rect rect = {.x = 0,
+                             .y = static_cast<int>(damage.firstLine),
+                             .w = displayConfiguration.width,
+                             .h = static_cast<int>(damage.lineCount)};
+
+            SDL_UpdateTexture(frameTexture, &rect,
+                              frame + damage.firstLine * displayConfiguration.width,
+                              4 * displayConfiguration.width);
         }
 
-        SDL_UnlockTexture(frameTexture);
         frameTextureValid = true;
     }
 
@@ -0,0 +1,276 @@
+#include "SocFactory.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include "CowImage.h"
+#include "Defer.h"
+#include "FileUtil.h"
+#include "buffer.h"
+#include "device.h"
+#include "md5.h"
+#include "rom_info5.h"
+#include "sdcard.h"
+#include "session/session_file5.h"
+#include "soc_PXA.h"
+#include "soc_pv.h"
+
+using namespace std;
+
+namespace {
+    constexpr size_t NAND_SIZE = 34603008;
+
+    void copy(Buffer& buffer, size_t size, const void* data) {
+        if (size == 0 || data == nullptr) {
+            buffer.data = nullptr;
+            buffer.size = 0;
+
+            return;
+        }
+
+        buffer.data = malloc(size);
+        buffer.size = size;
+
+        memcpy(buffer.data, data, size);
+    }
+
+    // Maps NOR, NAND and RAM of a mappable session copy-on-write from the file, so only the
+    // pages that are touched are read. Returns false if the file is not a mappable session.
+    bool mapSession(const SocOptions& options, Buffer& nor, Buffer& nand,
+                    unique_ptr<CowImage>& ram, Buffer& savestate, uint32_t& ramSize) {
+        int fd = open(options.norOrSession.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        Defer closeFd([&]() { close(fd); });
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) return false;
+
+        const size_t size = fileStat.st_size;
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) return false;
+
+        Defer unmap([&]() { munmap(data, size); });
+
+        SessionFile5 sessionFile;
+        if (!SessionFile5::IsMappableSessionFile(size, data) ||
+            !sessionFile.Deserialize(size, data))
+            return false;
+
+        if (options.nand) {
+            cerr << "separate NAND image cannot be used with session file" << endl;
+            return false;
+        }
+
+        nor = nand = Buffer();
+        bool mapped = false;
+
+        // The caller falls back to reading the file if mapping fails halfway
+        Defer releaseImages([&]() {
+            if (mapped) return;
+
+            if (nor.data) CowImage::Free(nor.data, nor.size);
+            if (nand.data) CowImage::Free(nand.data, nand.size);
+
+            nor = nand = Buffer();
+            ram.reset();
+        });
+
+        auto instantiate = [&](Buffer& buffer, size_t imageSize, const void* image) {
+            buffer.size = imageSize;
+            buffer.data = imageSize > 0 ? CowImage(options.norOrSession,
+                                                   sessionFile.GetOffset(image), imageSize)
+                                              .Instantiate()
+                                        : nullptr;
+
+            return imageSize == 0 || buffer.data;
+        };
+
+        if (!instantiate(nor, sessionFile.GetNorSize(), sessionFile.GetNor()) ||
+            !instantiate(nand, sessionFile.GetNandSize(), sessionFile.GetNand()))
+            return false;
+
+        if (sessionFile.GetMemorySize() > 0) {
+            ram = make_unique<CowImage>(options.norOrSession,
+                                        sessionFile.GetOffset(sessionFile.GetMemory()),
+                                        sessionFile.GetMemorySize());
+
+            if (!ram->IsValid()) return false;
+        }
+
+        ramSize = sessionFile.GetRamSize();
+        copy(savestate, sessionFile.GetSavestateSize(), sessionFile.GetSavestate());
+
+        mapped = true;
+        return true;
+    }
+
+    bool readSession(const SocOptions& options, Buffer& nor, Buffer& nand, Buffer& ram,
+                     unique_ptr<CowImage>& ramImage, Buffer& savestate, uint32_t& ramSize) {
+        ram.size = 0;
+        ram.data = nullptr;
+
+        if (mapSession(options, nor, nand, ramImage, savestate, ramSize)) return true;
+
+        SessionFile5 sessionFile;
+
+        size_t norOrSessionLen{0};
+        unique_ptr<uint8_t[]> norOrSessionData;
+        if (!util::ReadFile(options.norOrSession, norOrSessionData, norOrSessionLen)) return false;
+
+        if (SessionFile5::IsSessionFile(norOrSessionLen, norOrSessionData.get()) &&
+            sessionFile.Deserialize(norOrSessionLen, norOrSessionData.get())) {
+            if (options.nand) {
+                cerr << "separate NAND image cannot be used with session file" << endl;
+                return false;
+            }
+
+            ramSize = sessionFile.GetRamSize();
+            copy(nor, sessionFile.GetNorSize(), sessionFile.GetNor());
+            copy(nand, sessionFile.GetNandSize(), sessionFile.GetNand());
+            copy(ram, sessionFile.GetMemorySize(), sessionFile.GetMemory());
+            copy(savestate, sessionFile.GetSavestateSize(), sessionFile.GetSavestate());
+        } else {
+            size_t nandLen{0};
+            unique_ptr<uint8_t[]> nandData;
+
+            if (options.nand) {
+                if (!util::ReadFile(options.nand, nandData, nandLen)) return false;
+            } else {
+                nandLen = NAND_SIZE;
+                nandData = make_unique<uint8_t[]>(NAND_SIZE);
+                memset(nandData.get(), 0xff, NAND_SIZE);
+            }
+
+            ramSize = 0;
+
+            nor.size = norOrSessionLen;
+            nor.data = norOrSessionData.release();
+
+            nand.size = nandLen;
+            nand.data = nandData.release();
+
+            ram.size = savestate.size = 0;
+            ram.data = savestate.data = nullptr;
+        }
+
+        return true;
+    }
+}  // namespace
+
+SoC* createSoc(const SocOptions& options, DisplayConfiguration& displayConfiguration) {
+    Buffer nor, nand, memory, savestate;
+    unique_ptr<CowImage> memoryImage;
+    uint32_t ramSize{0};
+
+    if (!readSession(options, nor, nand, memory, memoryImage, savestate, ramSize)) return nullptr;
+
+    RomInfo5 romInfo(reinterpret_cast<uint8_t*>(nor.data), nor.size);
+    cerr << romInfo;
+
+    if (!romInfo.IsValid() || romInfo.GetDeviceType() == DeviceType5::deviceTypeInvalid)
+        return nullptr;
+
+    if (options.ramSize) {
+        if (ramSize == 0) {
+            ramSize = *options.ramSize << 20;
+        } else {
+            cerr << "cannot specify RAM size for an existing session" << endl;
+            return nullptr;
+        }
+    }
+
+    if (ramSize == 0) ramSize = romInfo.GetRecommendedRamSize();
+
+    if (!deviceSupportsRamSize(ramSize)) {
+        cerr << "unsupported RAM size: " << ramSize << " bytes" << endl;
+        return nullptr;
+    }
+
+    cerr << "using RAM size: " << ramSize << " bytes" << endl << endl;
+
+    if (nand.size != NAND_SIZE) {
+        cerr << "invalid NAND size; expected " << NAND_SIZE << " bytes" << endl;
+        return nullptr;
+    }
+
+    unique_ptr<CowImage> sdImage = util::MapFile(options.sd);
+    if (options.sd && !sdImage) return nullptr;
+
+    if (sdImage) {
+        if (!sdCardInitializeWithImage(*sdImage, "")) {
+            cout << "sd card image has bad size" << endl;
+            return nullptr;
+        }
+
+        string key = md5(reinterpret_cast<uint8_t*>(sdCardData().data), sdCardData().size);
+        sdCardRekey(key.c_str());
+    }
+
+    const DeviceType5 deviceType = romInfo.GetDeviceType();
+    const int gdbPort = options.gdbPort.value_or(-1);
+
+    displayConfigurationGet(romInfo.GetDeviceType(), &displayConfiguration);
+
+    SoC* soc = (deviceType == deviceTypePV)
+                   ? static_cast<SoC*>(new SocPV(ramSize, nor.data, nor.size,
+                                                 displayConfiguration.width,
+                                                 displayConfiguration.height,
+                                                 SocPV::DISPLAY_DENSITY, gdbPort))
+                   : static_cast<SoC*>(new SocPXA(deviceType, ramSize, nor.data, nor.size,
+                                                  reinterpret_cast<uint8_t*>(nand.data),
+                                                  nand.size, gdbPort, deviceGetSocRev()));
+
+    if (memory.data && memory.size > soc->GetMemoryData().size) {
+        cerr << "RAM size mismatch" << endl;
+        return nullptr;
+    }
+
+    if (memory.data) {
+        memcpy(soc->GetMemoryData().data, memory.data, memory.size);
+        free(memory.data);
+    }
+
+    if (memoryImage) {
+        if (memoryImage->GetSize() > soc->GetMemoryData().size) {
+            cerr << "RAM size mismatch" << endl;
+            return nullptr;
+        }
+
+        if (memoryImage->GetSize() < soc->GetMemoryData().size ||
+            !soc->LoadMemoryImage(*memoryImage)) {
+            void* instance = memoryImage->Instantiate();
+            if (!instance) {
+                cerr << "failed to read RAM" << endl;
+                return nullptr;
+            }
+
+            memcpy(soc->GetMemoryData().data, instance, memoryImage->GetSize());
+            CowImage::Free(instance, memoryImage->GetSize());
+        }
+    }
+
+    if (!soc->Load(savestate.size, savestate.data)) {
+        cerr << "failed to restore savestate" << endl;
+    }
+
+    if (savestate.data) free(savestate.data);
+
+    if (soc->SdInserted()) {
+        if (!soc->SdRemount()) {
+            cerr << "failed to remount SD card" << endl;
+            sdCardReset();
+        }
+    } else if (sdCardInitialized()) {
+        soc->SdInsert();
+    }
+
+    return soc;
+}
@@ -0,0 +1,22 @@
+#ifndef _SOC_FACTORY_H_
+#define _SOC_FACTORY_H_
+
+#include <optional>
+#include <string>
+
+#include "SoC.h"
+#include "display_configuration.h"
+
+struct SocOptions {
+    std::string norOrSession;
+    std::optional<std::string> nand;
+    std::optional<std::string> sd;
+    std::optional<unsigned int> gdbPort;
+    std::optional<unsigned int> ramSize;
+};
+
+// Loads NOR + NAND or a session, sets up the SD card and builds and restores the
+// matching SoC. Returns nullptr (after logging the reason) on failure.
+SoC* createSoc(const SocOptions& options, DisplayConfiguration& displayConfiguration);
+
+#endif  // _SOC_FACTORY_H_
@@ -0,0 +1,390 @@
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+#include "Cli.h"
+#include "Commands.h"
+#include "Logging.h"
+#include "MainLoop.h"
+#include "SocFactory.h"
+#include "argparse.h"
+#include "cputil.h"
+#include "display_configuration.h"
+#include "icache.h"
+
+using namespace std;
+
+// uarm-headless runs the emulator without SDL and without throttling. Without a script
+// it runs for --seconds of virtual time. With a script, virtual time only advances
+// through the "run" command, so scripted runs are reproducible; --seconds then caps the
+// total virtual time.
+
+struct Options {
+    SocOptions soc;
+    unsigned int mips;
+    optional<double> seconds;
+    optional<string> script;
+    optional<string> frames;
+    unsigned int frameInterval;
+    bool profile;
+};
+
+namespace {
+    const char* TASK_NAMES[SCHEDULER_TASK_COUNT] = {"timer", "rtc",   "lcd",   "i2s",
+                                                    "pcm",   "aux 1", "aux 2", "aux 3"};
+
+    bool writePpm(const string& file, const uint32_t* frame, uint32_t width, uint32_t height) {
+        FILE* f = fopen(file.c_str(), "wb");
+        if (!f) return false;
+
+        fprintf(f, "P6\n%u %u\n255\n", width, height);
+
+        vector<uint8_t> line(3 * width);
+
+        for (uint32_t y = 0; y < height; y++) {
+            // ABGR8888, so the bytes are RGBA in memory
+            const uint8_t* pixels = reinterpret_cast<const uint8_t*>(frame + y * width);
+
+            for (uint32_t x = 0; x < width; x++) {
+                line[3 * x] = pixels[4 * x];
+                line[3 * x + 1] = pixels[4 * x + 1];
+                line[3 * x + 2] = pixels[4 * x + 2];
+            }
+
+            if (fwrite(line.data(), 1, line.size(), f) != line.size()) {
+                fclose(f);
+                return false;
+            }
+        }
+
+        return fclose(f) == 0;
+    }
+
+    class Runner {
+       public:
+        Runner(SoC* soc, const DisplayConfiguration& displayConfiguration,
+               uint64_t cyclesPerSecond, uint64_t cycleLimit, optional<string> framesDir,
+               unsigned int frameInterval)
+            : soc(soc),
+              width(displayConfiguration.width),
+              height(displayConfiguration.height),
+              cyclesPerSecond(cyclesPerSecond),
+              cycleLimit(cycleLimit),
+              framesDir(framesDir),
+              frameInterval(frameInterval),
+              lastFrame(width * height) {}
+
+        void Run(uint64_t cycles) {
+            const uint64_t target = cycles < cycleLimit - totalCycles ? totalCycles + cycles
+                                                                      : cycleLimit;
+            const uint64_t sliceCycles = cyclesPerSecond / MAIN_LOOP_FPS;
+
+            while (totalCycles < target) {
+                const uint64_t sliceStart = timestampNsec();
+
+                totalCycles += soc->Run(min(sliceCycles, target - totalCycles), cyclesPerSecond);
+                hostNsec += timestampNsec() - sliceStart;
+
+                const uint32_t* frame = soc->GetPendingFrame();
+                if (frame) HandleFrame(frame);
+            }
+        }
+
+        bool LimitReached() const { return totalCycles >= cycleLimit; }
+
+        bool SaveScreenshot(const string& file) const {
+            return writePpm(file, lastFrame.data(), width, height);
+        }
+
+        void Report(const SocProfile* profile) const {
+            const double virtualSeconds = static_cast<double>(totalCycles) / cyclesPerSecond;
+            const double hostSeconds = static_cast<double>(hostNsec) / 1E9;
+
+            cout << fixed << setprecision(2);
+            cout << "virtual time: " << virtualSeconds << " sec, " << totalCycles << " cycles"
+                 << endl;
+            cout << "host time: " << hostSeconds << " sec";
+
+            if (hostNsec > 0) {
+                cout << " -> " << (totalCycles * 1000.) / hostNsec << " MIPS, "
+                     << virtualSeconds / hostSeconds << "x realtime";
+            }
+
+            cout << endl;
+
+            struct icacheStats icacheStats;
+            icacheGetStats(cpuGetICache(soc->GetCpu()), &icacheStats);
+
+            const uint64_t lookups = icacheStats.hits + icacheStats.misses;
+            cout << "icache: " << icacheStats.hits << " hits, " << icacheStats.misses
+                 << " misses, " << icacheStats.evictions << " evictions";
+            if (lookups > 0) cout << ", hit rate " << (100. * icacheStats.hits) / lookups << "%";
+            cout << endl;
+
+            cout << "frames: " << framesEmitted << " emitted, " << framesWritten << " written"
+                 << endl;
+
+            if (!profile) return;
+
+            uint64_t accountedNsec = profile->cpuNsec;
+
+            cout << "profile:" << endl;
+            ReportItem("cpu", profile->cpuNsec, 0);
+
+            for (size_t i = 0; i < SCHEDULER_TASK_COUNT; i++) {
+                if (profile->scheduler.dispatches[i] == 0) continue;
+
+                ReportItem(TASK_NAMES[i], profile->scheduler.dispatchNsec[i],
+                           profile->scheduler.dispatches[i]);
+                accountedNsec += profile->scheduler.dispatchNsec[i];
+            }
+
+            ReportItem("other", hostNsec > accountedNsec ? hostNsec - accountedNsec : 0, 0);
+        }
+
+       private:
+        void HandleFrame(const uint32_t* frame) {
+            const SoC::FrameDamage damage = soc->GetPendingFrameDamage();
+            copy(frame + damage.firstLine * width,
+                 frame + (damage.firstLine + damage.lineCount) * width,
+                 lastFrame.begin() + damage.firstLine * width);
+            soc->ResetPendingFrame();
+
+            if (framesDir && framesEmitted % frameInterval == 0) {
+                ostringstream file;
+                file << *framesDir << "/frame-" << setw(6) << setfill('0') << framesEmitted
+                     << ".ppm";
+
+                if (writePpm(file.str(), lastFrame.data(), width, height))
+                    framesWritten++;
+                else
+                    cerr << "failed to write " << file.str() << endl;
+            }
+
+            framesEmitted++;
+        }
+
+        void ReportItem(const char* name, uint64_t nsec, uint64_t dispatches) const {
+            cout << "    " << setw(8) << left << name << right << setw(10)
+                 << static_cast<double>(nsec) / 1E6 << " msec";
+            if (hostNsec > 0) cout << setw(8) << (100. * nsec) / hostNsec << "%";
+            if (dispatches > 0) cout << "    " << dispatches << " dispatches";
+            cout << endl;
+        }
+
+       private:
+        SoC* soc;
+        uint32_t width;
+        uint32_t height;
+
+        uint64_t cyclesPerSecond;
+        uint64_t cycleLimit;
+
+        optional<string> framesDir;
+        unsigned int frameInterval;
+
+        vector<uint32_t> lastFrame;
+
+        uint64_t totalCycles{0};
+        uint64_t hostNsec{0};
+        uint64_t framesEmitted{0};
+        uint64_t framesWritten{0};
+    };
+
+    struct Context : commands::Context {
+        Runner& runner;
+        const SocProfile* profile;
+        uint64_t cyclesPerSecond;
+    };
+
+    Context* getContext(void* context) {
+        return static_cast<Context*>(static_cast<commands::Context*>(context));
+    }
+
+    void CmdRun(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() != 1) return env.PrintUsage();
+
+        double seconds;
+        istringstream s(args[0]);
+
+        s >> seconds;
+
+        if (s.fail() || !s.eof() || seconds < 0) {
+            cout << "invalid argument" << endl;
+            return;
+        }
+
+        auto ctx = getContext(context);
+        ctx->runner.Run(seconds * ctx->cyclesPerSecond);
+
+        if (ctx->runner.LimitReached()) env.RequestQuit();
+    }
+
+    void CmdScreenshot(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        if (args.size() != 1) return env.PrintUsage();
+
+        if (!getContext(context)->runner.SaveScreenshot(args[0]))
+            cout << "failed to write " << args[0] << endl;
+    }
+
+    void CmdStats(vector<string> args, cli::CommandEnvironment& env, void* context) {
+        auto ctx = getContext(context);
+
+        ctx->runner.Report(ctx->profile);
+    }
+
+    const vector<cli::Command> commandList(
+        {{.name = "run",
+          .usage = "run <seconds>",
+          .description = "Run for the given number of virtual seconds.",
+          .cmd = CmdRun},
+         {.name = "screenshot",
+          .usage = "screenshot <file>",
+          .description = "Save the last frame as PPM.",
+          .cmd = CmdScreenshot},
+         {.name = "stats", .description = "Show performance statistics.", .cmd = CmdStats}});
+
+    bool run(const Options& options) {
+        if (options.mips == 0) {
+            cerr << "MIPS must be finite" << endl;
+            return false;
+        }
+
+        if (options.frameInterval == 0) {
+            cerr << "frame interval must be positive" << endl;
+            return false;
+        }
+
+        if (!options.seconds && !options.script) {
+            cerr << "either a duration or a script is required" << endl;
+            return false;
+        }
+
+        DisplayConfiguration displayConfiguration;
+
+        SoC* soc = createSoc(options.soc, displayConfiguration);
+        if (!soc) return false;
+
+        SocProfile profile{};
+        if (options.profile) soc->SetProfile(&profile);
+
+        icacheResetStats(cpuGetICache(soc->GetCpu()));
+
+        const uint64_t cyclesPerSecond = static_cast<uint64_t>(options.mips) * 1000000;
+        const uint64_t cycleLimit =
+            options.seconds ? static_cast<uint64_t>(*options.seconds * cyclesPerSecond)
+                            : UINT64_MAX;
+
+        Runner runner(soc, displayConfiguration, cyclesPerSecond, cycleLimit, options.frames,
+                      options.frameInterval);
+
+        if (options.script) {
+            commands::Register();
+            cli::AddCommands(commandList);
+            cli::Start(options.script);
+
+            Context commandContext{
+                {soc}, runner, options.profile ? &profile : nullptr, cyclesPerSecond};
+
+            while (!runner.LimitReached()) {
+                if (cli::Execute(static_cast<commands::Context*>(&commandContext))) break;
+
+                usleep(1000);
+            }
+
+            cli::Stop();
+        } else {
+            runner.Run(cycleLimit);
+        }
+
+        runner.Report(options.profile ? &profile : nullptr);
+
+        return true;
+    }
+}  // namespace
+
+int main(int argc, const char** argv) {
+    argparse::ArgumentParser program("uarm-headless");
+
+    program.add_description(
+        "uarm-headless runs cp-uarm unthrottled and without display or audio for testing and "
+        "benchmarking");
+
+    program.add_argument("nor_or_session").help("NOR rom or saved session").required();
+
+    program.add_argument("--nand", "-n").help("NAND rom file").metavar("<nand file>");
+
+    program.add_argument("--sd", "-s").help("SD card file").metavar("<SD card file>");
+
+    program.add_argument("--ram-size")
+        .help("RAM size in MB (16 or 32)")
+        .metavar("<size>")
+        .scan<'u', unsigned int>();
+
+    program.add_argument("--mips")
+        .help("virtual clock in MIPS")
+        .metavar("<mips>")
+        .scan<'u', unsigned int>()
+        .default_value(100u);
+
+    program.add_argument("--seconds")
+        .help("stop after the given number of virtual seconds")
+        .metavar("<seconds>")
+        .scan<'g', double>();
+
+    program.add_argument("--script")
+        .help("execute script; virtual time advances only through \"run\"")
+        .metavar("<script file>");
+
+    program.add_argument("--frames").help("write frames as PPM to directory").metavar("<dir>");
+
+    program.add_argument("--frame-interval")
+        .help("write only every nth frame")
+        .metavar("<n>")
+        .scan<'u', unsigned int>()
+        .default_value(1u);
+
+    program.add_argument("--profile")
+        .help("report host time spent per subsystem")
+        .default_value(false)
+        .implicit_value(true);
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const invalid_argument& e) {
+        cerr << "invalid argument" << endl << endl;
+        cerr << program;
+
+        exit(1);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl << endl;
+        cerr << program;
+
+        exit(1);
+    }
+
+    Options options = {.soc = {.norOrSession = program.get("nor_or_session"),
+                               .nand = program.present("--nand"),
+                               .sd = program.present("--sd"),
+                               .ramSize = program.present<unsigned int>("--ram-size")},
+                       .mips = program.get<unsigned int>("--mips"),
+                       .seconds = program.present<double>("--seconds"),
+                       .script = program.present("--script"),
+                       .frames = program.present("--frames"),
+                       .frameInterval = program.get<unsigned int>("--frame-interval"),
+                       .profile = program.get<bool>("--profile")};
+
+    logEnable();
+
+    if (!run(options)) exit(1);
+}
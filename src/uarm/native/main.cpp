@@ -1,5 +1,3 @@
-#include "device_type5.h"
-#include "soc_PXA.h"
 #pragma GCC diagnostic ignored "-Wmultichar"
 
 #include <SDL.h>
@@ -15,44 +13,31 @@
 #include <string>
 
 #include "Cli.h"
-#include "Commands.h"
-#include "FileUtil.h"
 #include "Logging.h"
 #include "MainLoop.h"
 #include "Rotation.h"
 #include "SdlAudioDriver.h"
+#include "SdlCommands.h"
 #include "SdlEventHandler.h"
 #include "SdlRenderer.h"
+#include "SocFactory.h"
 #include "argparse.h"
 #include "audio_queue.h"
-#include "buffer.h"
 #include "cputil.h"
-#include "device.h"
 #include "display_configuration.h"
-#include "md5.h"
-#include "rom_info5.h"
-#include "sdcard.h"
-#include "session/session_file5.h"
-#include "soc_PXA.h"
-#include "soc_pv.h"
 
 using namespace std;
 
 struct Options {
-    string norOrSession;
-    optional<string> nand;
-    optional<string> sd;
-    optional<unsigned int> gdbPort;
+    SocOptions soc;
     unsigned int mips;
     bool disableAudio;
     optional<string> script;
-    optional<unsigned int> ramSize;
     bool smallWindow;
 };
 
 namespace {
     constexpr size_t AUDIO_QUEUE_SIZE = 44100 / MAIN_LOOP_FPS * 10;
-    constexpr size_t NAND_SIZE = 34603008;
 
     int windowWidth(DisplayConfiguration& displayConfiguration, Rotation rotation) {
         switch (rotation) {
@@ -100,159 +85,16 @@ namespace {
                           scale * windowHeight(displayConfiguration, rotation));
     }
 
-    void copy(Buffer& buffer, size_t size, const void* data) {
-        if (size == 0 || data == nullptr) {
-            buffer.data = nullptr;
-            buffer.size = 0;
-
-            return;
-        }
-
-        buffer.data = malloc(size);
-        buffer.size = size;
-
-        memcpy(buffer.data, data, size);
-    }
-
-    bool readSession(const Options& options, Buffer& nor, Buffer& nand, Buffer& ram,
-                     Buffer& savestate, uint32_t& ramSize) {
-        SessionFile5 sessionFile;
-
-        size_t norOrSessionLen{0};
-        unique_ptr<uint8_t[]> norOrSessionData;
-        if (!util::ReadFile(options.norOrSession, norOrSessionData, norOrSessionLen)) return false;
-
-        if (SessionFile5::IsSessionFile(norOrSessionLen, norOrSessionData.get()) &&
-            sessionFile.Deserialize(norOrSessionLen, norOrSessionData.get())) {
-            if (options.nand) {
-                cerr << "separate NAND image cannot be used with session file" << endl;
-                return false;
-            }
-
-            ramSize = sessionFile.GetRamSize();
-            copy(nor, sessionFile.GetNorSize(), sessionFile.GetNor());
-            copy(nand, sessionFile.GetNandSize(), sessionFile.GetNand());
-            copy(ram, sessionFile.GetMemorySize(), sessionFile.GetMemory());
-            copy(savestate, sessionFile.GetSavestateSize(), sessionFile.GetSavestate());
-        } else {
-            size_t nandLen{0};
-            unique_ptr<uint8_t[]> nandData;
-
-            if (options.nand) {
-                if (!util::ReadFile(options.nand, nandData, nandLen)) return false;
-            } else {
-                nandLen = NAND_SIZE;
-                nandData = make_unique<uint8_t[]>(NAND_SIZE);
-                memset(nandData.get(), 0xff, NAND_SIZE);
-            }
-
-            ramSize = 0;
-
-            nor.size = norOrSessionLen;
-            nor.data = norOrSessionData.release();
-
-            nand.size = nandLen;
-            nand.data = nandData.release();
-
-            ram.size = savestate.size = 0;
-            ram.data = savestate.data = nullptr;
-        }
-
-        return true;
-    }
-
     bool run(const Options& options) {
         if (options.mips == 0) {
             cerr << "MIPS must be finite" << endl;
             return false;
         }
 
-        Buffer nor, nand, memory, savestate;
-        uint32_t ramSize{0};
-
-        if (!readSession(options, nor, nand, memory, savestate, ramSize)) return false;
-
-        RomInfo5 romInfo(reinterpret_cast<uint8_t*>(nor.data), nor.size);
-        cerr << romInfo;
-
-        if (!romInfo.IsValid() || romInfo.GetDeviceType() == DeviceType5::deviceTypeInvalid)
-            return false;
-
-        if (options.ramSize) {
-            if (ramSize == 0) {
-                ramSize = *options.ramSize << 20;
-            } else {
-                cerr << "cannot specify RAM size for an existing session" << endl;
-                return false;
-            }
-        }
-
-        if (ramSize == 0) ramSize = romInfo.GetRecommendedRamSize();
-
-        if (!deviceSupportsRamSize(ramSize)) {
-            cerr << "unsupported RAM size: " << ramSize << " bytes" << endl;
-            return false;
-        }
-
-        cerr << "using RAM size: " << ramSize << " bytes" << endl << endl;
-
-        if (nand.size != NAND_SIZE) {
-            cerr << "invalid NAND size; expected " << NAND_SIZE << " bytes" << endl;
-            return false;
-        }
-
-        size_t sdLen{0};
-        unique_ptr<uint8_t[]> sdData;
-        if (options.sd && !util::ReadFile(options.sd, sdData, sdLen)) return false;
-
-        if (sdData) {
-            if (sdLen % SD_SECTOR_SIZE) {
-                cout << "sd card image has bad size" << endl;
-                return false;
-            }
-
-            string key = md5(sdData.get(), sdLen);
-            sdCardInitializeWithData(sdLen / SD_SECTOR_SIZE, sdData.release(), key.c_str());
-        }
-
-        const DeviceType5 deviceType = romInfo.GetDeviceType();
-        const int gdbPort = options.gdbPort.value_or(-1);
-
         DisplayConfiguration displayConfiguration;
-        displayConfigurationGet(romInfo.GetDeviceType(), &displayConfiguration);
-
-        SoC* soc = (deviceType == deviceTypePV)
-                       ? static_cast<SoC*>(new SocPV(ramSize, nor.data, nor.size,
-                                                     displayConfiguration.width,
-                                                     displayConfiguration.height, 144, gdbPort))
-                       : static_cast<SoC*>(new SocPXA(deviceType, ramSize, nor.data, nor.size,
-                                                      reinterpret_cast<uint8_t*>(nand.data),
-                                                      nand.size, gdbPort, deviceGetSocRev()));
-
-        if (memory.data && memory.size > soc->GetMemoryData().size) {
-            cerr << "RAM size mismatch" << endl;
-            return false;
-        }
-
-        if (memory.data) {
-            memcpy(soc->GetMemoryData().data, memory.data, memory.size);
-            free(memory.data);
-        }
-
-        if (!soc->Load(savestate.size, savestate.data)) {
-            cerr << "failed to restore savestate" << endl;
-        }
 
-        if (savestate.data) free(savestate.data);
-
-        if (soc->SdInserted()) {
-            if (!soc->SdRemount()) {
-                cerr << "failed to remount SD card" << endl;
-                sdCardReset();
-            }
-        } else if (sdCardInitialized()) {
-            soc->SdInsert();
-        }
+        SoC* soc = createSoc(options.soc, displayConfiguration);
+        if (!soc) return false;
 
         AudioQueue* audioQueue = audioQueueCreate(AUDIO_QUEUE_SIZE);
         soc->SetAudioQueue(audioQueue);
@@ -276,9 +118,9 @@ namespace {
         if (!options.disableAudio) audioDriver.Start();
 
         commands::Register();
+        sdl_commands::Register();
         cli::Start(options.script);
-        commands::Context commandContext{
-            .soc = soc, .mainLoop = mainLoop, .audioDriver = audioDriver, .rotation = rotation};
+        sdl_commands::Context commandContext{{soc}, mainLoop, audioDriver, rotation};
 
         uint64_t lastSpeedDump = timestampUsec();
 
@@ -313,7 +155,7 @@ namespace {
             const int64_t timesliceRemaining =
                 mainLoop.GetTimesliceSizeUsec() - static_cast<int64_t>(timestampUsec() - now);
 
-            if (cli::Execute(&commandContext)) break;
+            if (cli::Execute(static_cast<commands::Context*>(&commandContext))) break;
 
             if (commandContext.rotation != rotation) {
                 rotation = commandContext.rotation;
@@ -324,7 +166,7 @@ namespace {
                 sdlRenderer = make_unique<SdlRenderer>(window, soc, scale, rotation);
                 sdlEventHandler.SetRotation(rotation);
 
-                soc->SetFramebufferDirty();
+                soc->RedrawFramebuffer();
             }
 
             if (timesliceRemaining > 10) usleep(timesliceRemaining);
@@ -392,14 +234,14 @@ int main(int argc, const char** argv) {
         exit(1);
     }
 
-    Options options = {.norOrSession = program.get("nor_or_session"),
-                       .nand = program.present("--nand"),
-                       .sd = program.present("--sd"),
-                       .gdbPort = program.present<unsigned int>("--gdb"),
+    Options options = {.soc = {.norOrSession = program.get("nor_or_session"),
+                               .nand = program.present("--nand"),
+                               .sd = program.present("--sd"),
+                               .gdbPort = program.present<unsigned int>("--gdb"),
+                               .ramSize = program.present<unsigned int>("--ram-size")},
                        .mips = program.get<unsigned int>("--mips"),
                        .disableAudio = program.get<bool>("--no-sound"),
                        .script = program.present("--script"),
-                       .ramSize = program.present<unsigned int>("--ram-size"),
                        .smallWindow = program.get<bool>("--small-window")};
 
     logEnable();
@@ -0,0 +1,71 @@
+#include "../uarm/pixel_convert.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+    uint32_t unpackRgb565Reference(uint16_t rgb16) {
+        const uint32_t r = (rgb16 >> 11) & 0x1f;
+        const uint32_t g = (rgb16 >> 5) & 0x3f;
+        const uint32_t b = rgb16 & 0x1f;
+
+        return 0xff000000 | (((b << 3) | (b >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) |
+               ((r << 3) | (r >> 2));
+    }
+}  // namespace
+
+TEST(PixelConvert, Rgb565MatchesReferenceForAllValues) {
+    std::vector<uint16_t> src(0x10000);
+    std::vector<uint32_t> dest(0x10000);
+
+    for (uint32_t i = 0; i < 0x10000; i++) src[i] = i;
+
+    pixelConvertRgb565(dest.data(), src.data(), 0x10000);
+
+    for (uint32_t i = 0; i < 0x10000; i++) ASSERT_EQ(dest[i], unpackRgb565Reference(i)) << i;
+}
+
+TEST(PixelConvert, Rgb565HandlesUnalignedTails) {
+    uint16_t src[24];
+    uint32_t dest[25];
+
+    for (uint32_t i = 0; i < 24; i++) src[i] = 0x1234 * (i + 1);
+
+    for (uint32_t count = 0; count < 23; count++) {
+        for (auto& pixel : dest) pixel = 0;
+
+        pixelConvertRgb565(dest + 1, src + 1, count);
+
+        EXPECT_EQ(dest[0], 0u);
+        for (uint32_t i = 0; i < count; i++)
+            EXPECT_EQ(dest[i + 1], unpackRgb565Reference(src[i + 1]));
+        EXPECT_EQ(dest[count + 1], 0u);
+    }
+}
+
+TEST(PixelConvert, IndexedUnpacksLsbFirst) {
+    uint32_t palette[256];
+    for (uint32_t i = 0; i < 256; i++) palette[i] = 0x1000 + i;
+
+    const uint8_t src[] = {0xb4, 0x1e};
+    uint32_t dest[16];
+
+    pixelConvertIndexed(dest, src, 16, 1, palette);
+    const uint32_t expected1[] = {0, 0, 1, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 0, 0, 0};
+    for (uint32_t i = 0; i < 16; i++) EXPECT_EQ(dest[i], 0x1000 + expected1[i]);
+
+    pixelConvertIndexed(dest, src, 7, 2, palette);
+    const uint32_t expected2[] = {0, 1, 3, 2, 2, 3, 1};
+    for (uint32_t i = 0; i < 7; i++) EXPECT_EQ(dest[i], 0x1000 + expected2[i]);
+
+    pixelConvertIndexed(dest, src, 3, 4, palette);
+    EXPECT_EQ(dest[0], 0x1004u);
+    EXPECT_EQ(dest[1], 0x100bu);
+    EXPECT_EQ(dest[2], 0x100eu);
+
+    pixelConvertIndexed(dest, src, 2, 8, palette);
+    EXPECT_EQ(dest[0], 0x10b4u);
+    EXPECT_EQ(dest[1], 0x101eu);
+}
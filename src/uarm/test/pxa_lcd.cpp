@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "../uarm/SoC.h"
+#include "../uarm/memory_buffer.h"
+#include "../uarm/pxa_LCD.h"
+#include "../uarm/soc_pv.h"
+
+namespace {
+    constexpr uint32_t RAM_BASE = 0x20000000;
+    constexpr uint32_t RAM_SIZE = 2 << 20;
+    constexpr uint32_t ROM_SIZE = 1 << 20;
+
+    constexpr uint32_t LCD_BASE = 0x44000000;
+    constexpr uint32_t LCD_LCCR0 = 0x00;
+    constexpr uint32_t LCD_LCCR3 = 0x0c;
+    constexpr uint32_t LCD_FDADR0 = 0x200;
+
+    constexpr uint16_t WIDTH = 320;
+    constexpr uint16_t HEIGHT = 320;
+    constexpr uint32_t STRIDE = 2 * WIDTH;
+    constexpr uint32_t FRAMEBUFFER_SIZE = STRIDE * HEIGHT;
+
+    constexpr uint32_t FRAMEBUFFER = 0x10000;
+    constexpr uint32_t DESCRIPTOR = 0x100000;
+
+    // Only every 64th frame is converted, and each frame takes three ticks
+    constexpr size_t TICKS_PER_CONVERSION = 3 * 64;
+
+    constexpr uint32_t BLACK = 0xff000000;
+    constexpr uint32_t WHITE = 0xffffffff;
+
+    // Exposes the memory system, so the test can attach an LCD to a SoC without one
+    class LcdTestSoc : public SocPV {
+       public:
+        LcdTestSoc(void *romData)
+            : SocPV(RAM_SIZE, romData, ROM_SIZE, WIDTH, HEIGHT, SocPV::DISPLAY_DENSITY, -1) {
+            // SocPV has no LCD and leaves this unset
+            ramBase = RAM_BASE;
+        }
+
+        struct ArmMem *GetMem() { return mem; }
+    };
+
+    class PxaLcdTest : public ::testing::Test {
+       public:
+        PxaLcdTest() : rom(ROM_SIZE, 0) {}
+
+       protected:
+        void SetUp() override {
+            soc = std::make_unique<LcdTestSoc>(rom.data());
+
+            ASSERT_TRUE(memoryBufferAllocate(&paletteBuffer, MEMORY_BUFFER_GRANULARITY));
+            lcd = pxaLcdInit(soc->GetMem(), soc.get(), nullptr, &paletteBuffer, WIDTH, HEIGHT);
+
+            uint32_t *descriptor = reinterpret_cast<uint32_t *>(Ram() + DESCRIPTOR);
+            descriptor[0] = RAM_BASE + DESCRIPTOR;
+            descriptor[1] = RAM_BASE + FRAMEBUFFER;
+            descriptor[2] = 0;
+            descriptor[3] = FRAMEBUFFER_SIZE;
+
+            // 16 bpp
+            WriteRegister(LCD_LCCR3, 4 << 24);
+            WriteRegister(LCD_FDADR0, RAM_BASE + DESCRIPTOR);
+            WriteRegister(LCD_LCCR0, 1);
+
+            Convert();
+            ASSERT_NE(pxaLcdGetPendingFrame(lcd), nullptr);
+            pxaLcdResetPendingFrame(lcd);
+        }
+
+        uint8_t *Ram() { return static_cast<uint8_t *>(soc->GetMemoryData().data); }
+
+        void WriteRegister(uint32_t offset, uint32_t value) {
+            ASSERT_TRUE(memAccess(soc->GetMem(), LCD_BASE + offset, 4, true, &value));
+        }
+
+        // A store by the guest, subject to damage tracking
+        void WritePixel(uint32_t x, uint32_t y, uint16_t color) {
+            ASSERT_TRUE(memAccess(soc->GetMem(), RAM_BASE + FRAMEBUFFER + y * STRIDE + 2 * x, 2,
+                                  true, &color));
+
+            // This is what SocPXA forwards from SoC::SetFramebufferDirty
+            pxaLcdSetFramebufferDirty(lcd);
+        }
+
+        // A store that bypasses damage tracking
+        void PokePixel(uint32_t x, uint32_t y, uint16_t color) {
+            memcpy(Ram() + FRAMEBUFFER + y * STRIDE + 2 * x, &color, 2);
+        }
+
+        void Convert() {
+            for (size_t i = 0; i < TICKS_PER_CONVERSION; i++) pxaLcdTick(lcd);
+        }
+
+        uint32_t Pixel(uint32_t x, uint32_t y) {
+            return pxaLcdGetPendingFrame(lcd)[y * WIDTH + x];
+        }
+
+        SoC::FrameDamage Damage() {
+            SoC::FrameDamage damage;
+            pxaLcdGetPendingFrameDamage(lcd, &damage.firstLine, &damage.lineCount);
+
+            return damage;
+        }
+
+       protected:
+        std::vector<uint8_t> rom;
+        std::unique_ptr<LcdTestSoc> soc;
+
+        MemoryBuffer paletteBuffer{};
+        struct PxaLcd *lcd{nullptr};
+    };
+
+    TEST_F(PxaLcdTest, WritesMarkTheirPagesInTheDamageBitmap) {
+        WritePixel(10, 100, 0xffff);
+
+        // Offset 64020 lies in page 62
+        const Buffer damage = soc->GetFramebufferDamage();
+        const uint32_t *words = static_cast<const uint32_t *>(damage.data);
+
+        ASSERT_EQ(damage.size, 4u * 7);
+        for (size_t i = 0; i < damage.size / 4; i++)
+            EXPECT_EQ(words[i], i == 1 ? 1u << 30 : 0u) << i;
+    }
+
+    TEST_F(PxaLcdTest, OnlyDamagedLinesAreConverted) {
+        PokePixel(0, 10, 0xffff);
+        WritePixel(10, 100, 0xffff);
+
+        Convert();
+        ASSERT_NE(pxaLcdGetPendingFrame(lcd), nullptr);
+
+        // Page 62 covers lines 99 and 100
+        EXPECT_EQ(Damage().firstLine, 99u);
+        EXPECT_EQ(Damage().lineCount, 2u);
+
+        EXPECT_EQ(Pixel(10, 100), WHITE);
+        EXPECT_EQ(Pixel(0, 10), BLACK);
+    }
+
+    TEST_F(PxaLcdTest, NoFrameIsPendingWithoutDamage) {
+        pxaLcdSetFramebufferDirty(lcd);
+
+        Convert();
+        EXPECT_EQ(pxaLcdGetPendingFrame(lcd), nullptr);
+    }
+
+    TEST_F(PxaLcdTest, RedrawConvertsTheWholeFramebuffer) {
+        PokePixel(0, 10, 0xffff);
+        pxaLcdRedrawFramebuffer(lcd);
+
+        Convert();
+        ASSERT_NE(pxaLcdGetPendingFrame(lcd), nullptr);
+
+        EXPECT_EQ(Damage().firstLine, 0u);
+        EXPECT_EQ(Damage().lineCount, static_cast<uint32_t>(HEIGHT));
+
+        EXPECT_EQ(Pixel(0, 10), WHITE);
+    }
+}  // namespace
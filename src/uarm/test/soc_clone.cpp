@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../uarm/SoC.h"
+#include "../uarm/soc_pv.h"
+
+namespace {
+    constexpr uint32_t RAM_SIZE = 2 << 20;
+    constexpr uint32_t ROM_SIZE = 1 << 20;
+
+    // Offsets in three different pages of RAM
+    constexpr size_t SHARED = 0x1000;
+    constexpr size_t PARENT = 0x2000;
+    constexpr size_t CHILD = 0x3000;
+
+    uint8_t* ram(SoC& soc) { return static_cast<uint8_t*>(soc.GetMemoryData().data); }
+
+    size_t countMappings() {
+        std::ifstream maps("/proc/self/maps");
+
+        size_t count = 0;
+        for (std::string line; std::getline(maps, line);) count++;
+
+        return count;
+    }
+
+    class SocCloneTest : public ::testing::Test {
+       public:
+        SocCloneTest() : rom(ROM_SIZE, 0) {}
+
+       protected:
+        std::unique_ptr<SoC> CreateSoc() {
+            return std::make_unique<SocPV>(RAM_SIZE, rom.data(), ROM_SIZE, 320, 320,
+                                           SocPV::DISPLAY_DENSITY, -1);
+        }
+
+       protected:
+        std::vector<uint8_t> rom;
+    };
+
+    TEST_F(SocCloneTest, ClonesDoNotSeeEachOthersWrites) {
+        auto parent = CreateSoc();
+
+        ram(*parent)[SHARED] = 0x11;
+
+        auto snapshot = parent->Snapshot();
+        ASSERT_TRUE(snapshot);
+
+        std::unique_ptr<SoC> child(SoC::Clone(*snapshot));
+        ASSERT_TRUE(child);
+
+        std::unique_ptr<SoC> sibling(SoC::Clone(*snapshot));
+        ASSERT_TRUE(sibling);
+
+        ASSERT_EQ(child->GetMemoryData().size, parent->GetMemoryData().size);
+        EXPECT_NE(ram(*child), ram(*parent));
+        EXPECT_EQ(ram(*child)[SHARED], 0x11);
+
+        ram(*parent)[SHARED] = 0x22;
+        ram(*parent)[PARENT] = 0x33;
+
+        ram(*child)[SHARED] = 0x44;
+        ram(*child)[CHILD] = 0x55;
+
+        EXPECT_EQ(ram(*parent)[SHARED], 0x22);
+        EXPECT_EQ(ram(*parent)[PARENT], 0x33);
+        EXPECT_EQ(ram(*parent)[CHILD], 0x00);
+
+        EXPECT_EQ(ram(*child)[SHARED], 0x44);
+        EXPECT_EQ(ram(*child)[PARENT], 0x00);
+        EXPECT_EQ(ram(*child)[CHILD], 0x55);
+
+        EXPECT_EQ(ram(*sibling)[SHARED], 0x11);
+        EXPECT_EQ(ram(*sibling)[PARENT], 0x00);
+        EXPECT_EQ(ram(*sibling)[CHILD], 0x00);
+    }
+
+    TEST_F(SocCloneTest, ClonesStartWithCleanDirtyPages) {
+        auto parent = CreateSoc();
+        static_cast<uint8_t*>(parent->GetMemoryDirtyPages().data)[0] = 0xff;
+
+        auto snapshot = parent->Snapshot();
+        ASSERT_TRUE(snapshot);
+
+        std::unique_ptr<SoC> child(SoC::Clone(*snapshot));
+        ASSERT_TRUE(child);
+
+        const Buffer dirtyPages = child->GetMemoryDirtyPages();
+        const uint8_t* data = static_cast<const uint8_t*>(dirtyPages.data);
+
+        for (size_t i = 0; i < dirtyPages.size; i++) ASSERT_EQ(data[i], 0) << i;
+    }
+
+    TEST_F(SocCloneTest, DestroyedClonesReleaseTheirMappings) {
+        auto parent = CreateSoc();
+        ram(*parent)[SHARED] = 0x11;
+
+        auto snapshot = parent->Snapshot();
+        ASSERT_TRUE(snapshot);
+
+        // Let the allocator settle before taking the baseline
+        delete SoC::Clone(*snapshot);
+        const size_t mappings = countMappings();
+
+        for (int i = 0; i < 16; i++) {
+            std::unique_ptr<SoC> child(SoC::Clone(*snapshot));
+            ASSERT_TRUE(child);
+
+            EXPECT_EQ(ram(*child)[SHARED], 0x11);
+            ram(*child)[CHILD] = i;
+        }
+
+        EXPECT_EQ(countMappings(), mappings);
+        EXPECT_EQ(ram(*parent)[SHARED], 0x11);
+        EXPECT_EQ(ram(*parent)[CHILD], 0x00);
+    }
+}  // namespace
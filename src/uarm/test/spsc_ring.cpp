@@ -0,0 +1,125 @@
+#include "../uarm/spsc_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+TEST(SpscRing, RingStartsEmpty) {
+    SpscRing<int> ring(3);
+
+    EXPECT_EQ(ring.GetSize(), static_cast<size_t>(0));
+    EXPECT_EQ(ring.GetCapacity(), static_cast<size_t>(3));
+}
+
+TEST(SpscRing, RingIsFifoAcrossWraparound) {
+    SpscRing<int> ring(6);
+    int items[] = {1, 2, 3, 4, 5};
+    int popped[5];
+
+    EXPECT_EQ(ring.PushBulk(items, 5), static_cast<size_t>(5));
+    EXPECT_EQ(ring.PopBulk(popped, 3), static_cast<size_t>(3));
+    EXPECT_EQ(popped[2], 3);
+
+    EXPECT_EQ(ring.PushBulk(items, 4), static_cast<size_t>(4));
+    EXPECT_EQ(ring.GetSize(), static_cast<size_t>(6));
+
+    EXPECT_EQ(ring.PopBulk(popped, 5), static_cast<size_t>(5));
+    EXPECT_EQ(popped[0], 4);
+    EXPECT_EQ(popped[1], 5);
+    EXPECT_EQ(popped[2], 1);
+    EXPECT_EQ(popped[4], 3);
+}
+
+TEST(SpscRing, RingDropsItemsThatDoNotFit) {
+    SpscRing<int> ring(3);
+    int items[] = {1, 2, 3, 4};
+    int popped[4];
+
+    EXPECT_EQ(ring.PushBulk(items, 4), static_cast<size_t>(3));
+    EXPECT_EQ(ring.PushBulk(items, 1), static_cast<size_t>(0));
+
+    EXPECT_EQ(ring.PopBulk(popped, 4), static_cast<size_t>(3));
+    EXPECT_EQ(popped[2], 3);
+}
+
+TEST(SpscRing, ClearDiscardsPendingItems) {
+    SpscRing<int> ring(4);
+    int items[] = {1, 2, 3};
+    int popped[3];
+
+    ring.PushBulk(items, 3);
+    ring.Clear();
+
+    EXPECT_EQ(ring.GetSize(), static_cast<size_t>(0));
+
+    ring.PushBulk(items, 1);
+    EXPECT_EQ(ring.PopBulk(popped, 3), static_cast<size_t>(1));
+    EXPECT_EQ(popped[0], 1);
+}
+
+TEST(SpscRing, RingTransfersInOrderBetweenThreads) {
+    constexpr uint32_t COUNT = 100000;
+    SpscRing<uint32_t> ring(64);
+
+    std::thread producer([&]() {
+        for (uint32_t next = 0; next < COUNT;) {
+            uint32_t burst[7];
+            for (uint32_t i = 0; i < 7; i++) burst[i] = next + i;
+
+            next += ring.PushBulk(burst, std::min<uint32_t>(7, COUNT - next));
+        }
+    });
+
+    uint32_t expected = 0;
+    while (expected < COUNT) {
+        uint32_t popped[5];
+        const size_t count = ring.PopBulk(popped, 5);
+
+        for (size_t i = 0; i < count; i++) ASSERT_EQ(popped[i], expected++);
+    }
+
+    producer.join();
+}
+
+TEST(SpscRing, ClearDoesNotRaceWithPops) {
+    constexpr uint32_t COUNT = 1000000;
+    SpscRing<uint32_t> ring(64);
+    std::atomic<bool> done{false};
+
+    std::thread producer([&]() {
+        for (uint32_t next = 1; next <= COUNT;) {
+            uint32_t burst[7];
+            for (uint32_t i = 0; i < 7; i++) burst[i] = next + i;
+
+            const size_t pushed = ring.PushBulk(burst, std::min<uint32_t>(7, COUNT + 1 - next));
+            if (pushed == 0) std::this_thread::yield();
+
+            next += pushed;
+            if (next % 5 == 0) ring.Clear();
+        }
+
+        done = true;
+    });
+
+    // Clear may drop items, but must never resurrect stale ones or corrupt the indices
+    uint32_t last = 0;
+    while (!done || ring.GetSize() > 0) {
+        ASSERT_LE(ring.GetSize(), ring.GetCapacity());
+
+        uint32_t popped[5];
+        const size_t count = ring.PopBulk(popped, 5);
+        ASSERT_LE(count, static_cast<size_t>(5));
+
+        if (count == 0) std::this_thread::yield();
+
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_GT(popped[i], last);
+            last = popped[i];
+        }
+    }
+
+    producer.join();
+}
@@ -5,6 +5,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <unordered_map>
 
 #include "CPEndian.h"
@@ -14,6 +15,7 @@
 #include "cp15mpu.h"
 #include "cputil.h"
 #include "gdbstub.h"
+#include "host_tlb.h"
 #include "icache.h"
 #include "mem.h"
 #include "memcpy.h"
@@ -144,6 +146,7 @@ struct ArmCpu {
 
     struct icache *ic;
     struct ArmMem *mem;
+    struct HostTlb *hostTlb;
 
     union {
         struct ArmCP15MMU *cp15mmu;
@@ -716,6 +719,14 @@ static FORCE_INLINE bool cpuPrvMemOpEx(struct ArmCpu *cpu, void *buf, uint32_t v
 
     uint32_t pa;
     if constexpr (memorySystemKind == ARM_MEMORY_SYSTEM_MMU) {
+        struct HostTlbEntry *hostTlbEntry =
+            hostTlbLookup<write>(cpu->hostTlb, vaddr, priviledged);
+
+        if (hostTlbEntry) {
+            hostTlbAccess<size, write>(hostTlbEntry, vaddr, buf);
+            return true;
+        }
+
         MMUTranslateResult translateResult =
             mmuTranslate(cpu->memorySystem.mmu, vaddr, priviledged, write);
 
@@ -742,6 +753,13 @@ static FORCE_INLINE bool cpuPrvMemOpEx(struct ArmCpu *cpu, void *buf, uint32_t v
         return false;
     }
 
+    if constexpr (memorySystemKind == ARM_MEMORY_SYSTEM_MMU) {
+        struct HostPage hostPage;
+
+        if (memResolveHostPage(cpu->mem, pa, write, &hostPage))
+            hostTlbInsert<write>(cpu->hostTlb, vaddr, priviledged, &hostPage);
+    }
+
     return true;
 }
 
@@ -3206,10 +3224,7 @@ void cpuReset(struct ArmCpu *cpu, uint32_t pc) {
     cpuUpdateSlowPath(cpu);
 }
 
-static void initStatic() {
-    static bool initialized = false;
-    if (initialized) return;
-
+static void initStaticTables() {
     table_thumb2arm = (uint32_t *)malloc(0x10000 * sizeof(uint32_t));
 
     for (uint32_t instr = 0; instr < 0x10000; instr++)
@@ -3220,6 +3235,11 @@ static void initStatic() {
     for (int i = 0; i < 128; i++) table_immShiftImm[i] = cpuPrvImmShiftImmTableEntry(i);
 }
 
+static void initStatic() {
+    static std::once_flag initialized;
+    std::call_once(initialized, initStaticTables);
+}
+
 struct ArmCpu *cpuInit(uint32_t pc, struct ArmMem *mem, uint8_t memorySystemKind, bool xscale,
                        bool omap, int debugPort, uint32_t cpuid, uint32_t cacheId,
                        struct PatchDispatch *patchDispatch, struct PacePatch *pacePatch,
@@ -3240,6 +3260,7 @@ struct ArmCpu *cpuInit(uint32_t pc, struct ArmMem *mem, uint8_t memorySystemKind
     cpu->memorySystemKind = memorySystemKind;
     if (memorySystemKind == ARM_MEMORY_SYSTEM_MMU) {
         cpu->memorySystem.mmu = mmuInit(mem, xscale);
+        cpu->hostTlb = mmuGetHostTlb(cpu->memorySystem.mmu);
         cpu->ic = icacheInit(mem, cpu->memorySystem.mmu);
         cpu->cp15.cp15mmu =
             cp15MMUInit(cpu, cpu->memorySystem.mmu, cpu->ic, cpuid, cacheId, xscale, omap);
@@ -3269,6 +3290,13 @@ struct ArmCpu *cpuInit(uint32_t pc, struct ArmMem *mem, uint8_t memorySystemKind
     return cpu;
 }
 
+void cpuDeinit(struct ArmCpu *cpu) {
+    icacheDeinit(cpu->ic);
+    delete cpu->m68kTrap0Handlers;
+
+    free(cpu);
+}
+
 uint32_t *cpuGetRegisters(struct ArmCpu *cpu) { return cpu->regs; }
 
 static bool cpuPrvPaceCallout(struct ArmCpu *cpu, uint32_t destination) {
@@ -3469,103 +3497,77 @@ ATTR_EMCC_NOINLINE static uint32_t cpuCyclePace(struct ArmCpu *cpu, uint32_t cyc
     return cycleAcc;
 }
 
-template <int memorySystemKind, bool injected>
-ATTR_EMCC_NOINLINE static uint32_t cpuCycleThumb(struct ArmCpu *cpu, uint32_t cycles) {
+template <int memorySystemKind, bool injected, bool thumb>
+static FORCE_INLINE uint32_t cpuPrvCycleBlocks(struct ArmCpu *cpu, uint32_t cycles) {
+    constexpr uint32_t instrSize = thumb ? 2 : 4;
+
     uint32_t cycleAcc = 0;
-    bool ok;
-    uint32_t translatedInstr;
-    uint32_t decoded;
     uint_fast8_t fsr;
+    struct icacheblock *block = nullptr;
 
     while (cycleAcc < cycles) {
-        cpu->curInstrPC = cpu->regs[REG_NO_PC];  // needed for stub to get proper pc
-        gdbStubReportPc(cpu->debugStub, cpu->regs[REG_NO_PC],
-                        true);  // early in case it changes PC
-
-        cycleAcc += 1;
-
-        // FCSE
-#ifdef SUPPORT_FCSE
-        if (fetchPc < 0x02000000UL) fetchPc |= cpu->pid;
-#endif
+        block = icacheFetchBlock<memorySystemKind, instrSize>(cpu->ic, cpu->regs[REG_NO_PC], &fsr,
+                                                              block);
 
-        ok = icacheFetch<memorySystemKind, 2, injected>(cpu->ic, cpu->curInstrPC, &fsr,
-                                                        translatedInstr, decoded);
+        if (!block) {
+            cpu->curInstrPC = cpu->regs[REG_NO_PC];
+            gdbStubReportPc(cpu->debugStub, cpu->regs[REG_NO_PC], true);
 
-        if (!ok) {
             cpuPrvHandleMemErr(cpu, cpu->curInstrPC, false, true, fsr);
-            return cycleAcc;  // exit here so that debugger can see us execute first instr
-                              // of execption handler
-        }
-
-        cpu->regs[REG_NO_PC] += 2;
-
-#ifdef __EMSCRIPTEN__
-        cpuPrvDispatchExecFnThumb<memorySystemKind, injected>(cpuPrvDecompressExecFn(decoded), cpu,
-                                                              translatedInstr);
-#else
-        cpuPrvDecompressExecFn(decoded)(cpu, translatedInstr);
-#endif
-
-        if constexpr (injected) {
-            if (cpu->regs[REG_NO_PC] == INJECTED_CALL_LR_MAGIC)
-                cpuSetSlowPath(cpu, SLOW_PATH_REASON_INJECTED_CALL_DONE);
+            return cycleAcc + 1;  // exit here so that debugger can see us execute first instr
+                                  // of execption handler
         }
 
-        if (cpu->slowPath) break;
-    }
-
-    return cycleAcc;
-}
-
-template <int memorySystemKind, bool injected>
-ATTR_EMCC_NOINLINE static uint32_t cpuCycleArm(struct ArmCpu *cpu, uint32_t cycles) {
-    uint32_t cycleAcc = 0;
-    bool ok;
-    uint32_t instr, decoded;
-    uint_fast8_t fsr;
-
-    while (cycleAcc < cycles) {
-        cpu->curInstrPC = cpu->regs[REG_NO_PC];  // needed for stub to get proper pc
-        gdbStubReportPc(cpu->debugStub, cpu->regs[REG_NO_PC],
-                        true);  // early in case it changes PC
+        uint32_t pc = block->va;
 
-        cycleAcc += 1;
+        // block->size drops to zero if the block is invalidated by one of its instructions
+        for (uint32_t i = 0; i < block->size; i++) {
+            cpu->curInstrPC = pc;  // needed for stub to get proper pc
+            gdbStubReportPc(cpu->debugStub, pc, true);  // early in case it changes PC
 
-        // FCSE
-#ifdef SUPPORT_FCSE
-        if (fetchPc < 0x02000000UL) fetchPc |= cpu->pid;
+#ifdef GDB_STUB_ENABLED
+            if (cpu->regs[REG_NO_PC] != pc) break;
 #endif
 
-        ok = icacheFetch<memorySystemKind, 4, injected>(cpu->ic, cpu->curInstrPC, &fsr, instr,
-                                                        decoded);
+            cycleAcc += 1;
 
-        if (!ok) {
-            cpuPrvHandleMemErr(cpu, cpu->curInstrPC, false, true, fsr);
-            return cycleAcc;  // exit here so that debugger can see us execute first instr
-                              // of execption handler
-        }
-
-        cpu->regs[REG_NO_PC] += 4;
+            pc += instrSize;
+            cpu->regs[REG_NO_PC] = pc;
 
 #ifdef __EMSCRIPTEN__
-        cpuPrvDispatchExecFnArm<memorySystemKind, injected>(cpuPrvDecompressExecFn(decoded), cpu,
-                                                            instr);
+            if constexpr (thumb)
+                cpuPrvDispatchExecFnThumb<memorySystemKind, injected>(
+                    cpuPrvDecompressExecFn(block->decoded[i]), cpu, block->instr[i]);
+            else
+                cpuPrvDispatchExecFnArm<memorySystemKind, injected>(
+                    cpuPrvDecompressExecFn(block->decoded[i]), cpu, block->instr[i]);
 #else
-        cpuPrvDecompressExecFn(decoded)(cpu, instr);
+            cpuPrvDecompressExecFn(block->decoded[i])(cpu, block->instr[i]);
 #endif
 
-        if constexpr (injected) {
-            if (cpu->regs[REG_NO_PC] == INJECTED_CALL_LR_MAGIC)
-                cpuSetSlowPath(cpu, SLOW_PATH_REASON_INJECTED_CALL_DONE);
-        }
+            if constexpr (injected) {
+                if (cpu->regs[REG_NO_PC] == INJECTED_CALL_LR_MAGIC)
+                    cpuSetSlowPath(cpu, SLOW_PATH_REASON_INJECTED_CALL_DONE);
+            }
 
-        if (cpu->slowPath) break;
+            if (cpu->slowPath) return cycleAcc;
+            if (cpu->regs[REG_NO_PC] != pc || cycleAcc >= cycles) break;
+        }
     }
 
     return cycleAcc;
 }
 
+template <int memorySystemKind, bool injected>
+ATTR_EMCC_NOINLINE static uint32_t cpuCycleThumb(struct ArmCpu *cpu, uint32_t cycles) {
+    return cpuPrvCycleBlocks<memorySystemKind, injected, true>(cpu, cycles);
+}
+
+template <int memorySystemKind, bool injected>
+ATTR_EMCC_NOINLINE static uint32_t cpuCycleArm(struct ArmCpu *cpu, uint32_t cycles) {
+    return cpuPrvCycleBlocks<memorySystemKind, injected, false>(cpu, cycles);
+}
+
 template <int memorySystemKind, bool injected>
 ATTR_EMCC_NOINLINE uint32_t cpuCycle(struct ArmCpu *cpu, uint32_t cycles) {
     if (cpu->waitingEventsTotal) {
@@ -3730,6 +3732,8 @@ struct ArmMpu *cpuGetMPU(struct ArmCpu *cpu) {
 
 struct ArmMem *cpuGetMem(struct ArmCpu *cpu) { return cpu->mem; }
 
+struct icache *cpuGetICache(struct ArmCpu *cpu) { return cpu->ic; }
+
 uint32_t cpuGetMemorySystemKind(struct ArmCpu *cpu) { return cpu->memorySystemKind; }
 
 void cpuAddM68kTrap0Handler(struct ArmCpu *cpu, uint32_t address, M68kTrapHandler handler) {
@@ -71,6 +71,7 @@ typedef bool (*ArmCoprocTwoRegF)(struct ArmCpu *cpu, void *userData, bool MRRC,
 struct ArmMmu;
 struct ArmMpu;
 struct ArmMem;
+struct icache;
 struct PatchDispatch;
 struct SystemState;
 
@@ -87,6 +88,9 @@ struct ArmCpu *cpuInit(uint32_t pc, struct ArmMem *mem, uint8_t memorySystemKind
                        struct PatchDispatch *patchDispatch, struct PacePatch *pacePatch,
                        struct SystemState *systemState);
 
+// Releases the CPU together with its icache
+void cpuDeinit(struct ArmCpu *cpu);
+
 uint32_t *cpuGetRegisters(struct ArmCpu *cpu);
 
 void cpuStartInjectedSyscall(struct ArmCpu *cpu, uint32_t syscall);
@@ -124,6 +128,7 @@ void cpuSetBreakPaceSyscall(struct ArmCpu *cpu, uint16_t syscall);
 struct ArmMmu *cpuGetMMU(struct ArmCpu *cpu);
 struct ArmMpu *cpuGetMPU(struct ArmCpu *cpu);
 struct ArmMem *cpuGetMem(struct ArmCpu *cpu);
+struct icache *cpuGetICache(struct ArmCpu *cpu);
 
 uint32_t cpuGetMemorySystemKind(struct ArmCpu *cpu);
 
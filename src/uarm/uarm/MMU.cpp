@@ -6,6 +6,7 @@
 #include <cstring>
 
 #include "cputil.h"
+#include "host_tlb.h"
 #include "mem.h"
 #include "savestate/savestateAll.h"
 
@@ -34,12 +35,18 @@ struct ArmMmu {
 
     struct TlbEntry tlb[TLB_SIZE];
     uint16_t revision;
+    uint32_t flushCount;
+
+    struct HostTlb hostTlb;
 
     template <typename T>
     void DoSaveLoad(T &chunkHelper);
 };
 
 void mmuTlbFlush(struct ArmMmu *mmu) {
+    hostTlbFlush(&mmu->hostTlb);
+    mmu->flushCount++;
+
     mmu->revision = (mmu->revision + 1) & 0x0f;
 
     if (mmu->revision == 0) {
@@ -64,6 +71,8 @@ struct ArmMmu *mmuInit(struct ArmMem *mem, bool xscaleMode) {
     mmu->xscale = xscaleMode;
     mmuReset(mmu);
 
+    memSetHostTlb(mem, &mmu->hostTlb);
+
     return mmu;
 }
 
@@ -283,7 +292,14 @@ bool mmuGetR(struct ArmMmu *mmu) { return mmu->R; }
 
 uint32_t mmuGetDomainCfg(struct ArmMmu *mmu) { return mmu->domainCfg; }
 
-void mmuSetDomainCfg(struct ArmMmu *mmu, uint32_t val) { mmu->domainCfg = val; }
+void mmuSetDomainCfg(struct ArmMmu *mmu, uint32_t val) {
+    hostTlbFlush(&mmu->hostTlb);
+    mmu->domainCfg = val;
+}
+
+struct HostTlb *mmuGetHostTlb(struct ArmMmu *mmu) { return &mmu->hostTlb; }
+
+uint32_t mmuGetFlushCount(struct ArmMmu *mmu) { return mmu->flushCount; }
 
 ///////////////////////////  debugging helpers  ///////////////////////////
 
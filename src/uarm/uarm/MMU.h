@@ -8,6 +8,7 @@
 #include "mem.h"
 
 struct ArmMmu;
+struct HostTlb;
 
 typedef uint64_t MMUTranslateResult;
 
@@ -40,6 +41,12 @@ void mmuSetDomainCfg(struct ArmMmu *mmu, uint32_t val);
 
 void mmuTlbFlush(struct ArmMmu *mmu);
 
+// VA -> host pointer cache for data accesses, flushed together with the TLB
+struct HostTlb *mmuGetHostTlb(struct ArmMmu *mmu);
+
+// Incremented on every TLB flush, so cached translations can be validated cheaply
+uint32_t mmuGetFlushCount(struct ArmMmu *mmu);
+
 void mmuDump(struct ArmMmu *mmu);  // for calling in GDB :)
 
 template <typename T>
@@ -2,12 +2,14 @@
 
 #include "RAM.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
 #include "CPEndian.h"
 #include "SoC.h"
 #include "cputil.h"
+#include "host_tlb.h"
 #include "memory_buffer.h"
 
 struct ArmRam {
@@ -15,6 +17,10 @@ struct ArmRam {
     uint32_t sz;
     struct MemoryBuffer buf;
     class SoC* soc;
+    struct ArmMem* mem;
+
+    // 1k pages that hold cached code, same layout as the dirty page bitmap
+    uint32_t* codePages;
 
     uint32_t framebufferStart;
     uint32_t framebufferStart_2;
@@ -24,8 +30,52 @@ struct ArmRam {
     uint32_t framebufferStart_32;
     uint32_t framebufferStart_64;
     uint32_t framebufferEnd;
+
+    // 1k pages of the framebuffer (relative to its start) that were written
+    uint32_t* framebufferDamage;
+    uint32_t framebufferDamageSize;
 };
 
+#define CODE_PAGE_WORD(offset) ((offset) >> 15)
+#define CODE_PAGE_MASK(offset) (1u << (((offset) >> 10) & 0x1f))
+
+static void ramPrvCodeWritten(struct ArmRam* ram, uint32_t offset) {
+    ram->codePages[CODE_PAGE_WORD(offset)] &= ~CODE_PAGE_MASK(offset);
+
+    memNotifyCodeWrite(ram->mem, ram->adr + (offset & ~0x3ffu));
+}
+
+template <int size>
+static FORCE_INLINE void ramPrvCheckCodeWrite(struct ArmRam* ram, uint32_t offset) {
+    if (ram->codePages[CODE_PAGE_WORD(offset)] & CODE_PAGE_MASK(offset))
+        ramPrvCodeWritten(ram, offset);
+
+    if constexpr (size > 8) {
+        const uint32_t last = offset + size - 1;
+
+        if (ram->codePages[CODE_PAGE_WORD(last)] & CODE_PAGE_MASK(last))
+            ramPrvCodeWritten(ram, last);
+    }
+}
+
+template <int size>
+static FORCE_INLINE void ramPrvFramebufferWritten(struct ArmRam* ram, uint32_t offset) {
+    if (ram->framebufferDamage) {
+        // The range checks in ramAccessF include writes that end right before the framebuffer
+        if (offset + size <= ram->framebufferStart) return;
+
+        const uint32_t first =
+            (offset > ram->framebufferStart ? offset - ram->framebufferStart : 0) >> 10;
+        const uint32_t last =
+            (std::min(offset + size, ram->framebufferEnd) - 1 - ram->framebufferStart) >> 10;
+
+        ram->framebufferDamage[first >> 5] |= 1u << (first & 0x1f);
+        ram->framebufferDamage[last >> 5] |= 1u << (last & 0x1f);
+    }
+
+    ram->soc->SetFramebufferDirty();
+}
+
 template <int size, bool write>
 bool ramAccessF(void* userData, uint32_t pa, void* bufP) {
     struct ArmRam* ram = (struct ArmRam*)userData;
@@ -34,18 +84,19 @@ bool ramAccessF(void* userData, uint32_t pa, void* bufP) {
 
     if constexpr (write) {
         MEMORY_BUFFER_MARK_DIRTY(ram->buf, offset);
+        ramPrvCheckCodeWrite<size>(ram, offset);
 
         switch (size) {
             case 1:
                 if (offset < ram->framebufferEnd && offset >= ram->framebufferStart)
-                    ram->soc->SetFramebufferDirty();
+                    ramPrvFramebufferWritten<1>(ram, offset);
 
                 *((uint8_t*)addr) = *(uint8_t*)bufP;  // our memory system is little-endian
                 break;
 
             case 2:
                 if (offset < ram->framebufferEnd && offset >= ram->framebufferStart_2)
-                    ram->soc->SetFramebufferDirty();
+                    ramPrvFramebufferWritten<2>(ram, offset);
 
                 *((uint16_t*)addr) =
                     htole16(*(uint16_t*)bufP);  // our memory system is little-endian
@@ -53,14 +104,14 @@ bool ramAccessF(void* userData, uint32_t pa, void* bufP) {
 
             case 4:
                 if (offset < ram->framebufferEnd && offset >= ram->framebufferStart_4)
-                    ram->soc->SetFramebufferDirty();
+                    ramPrvFramebufferWritten<4>(ram, offset);
 
                 *((uint32_t*)addr) = htole32(*(uint32_t*)bufP);
                 break;
 
             case 64:
                 if (offset < ram->framebufferEnd && offset >= ram->framebufferStart_64)
-                    ram->soc->SetFramebufferDirty();
+                    ramPrvFramebufferWritten<64>(ram, offset);
 
                 if (offset & 0x3f) MEMORY_BUFFER_MARK_DIRTY(ram->buf, offset + 0x3f);
 
@@ -76,7 +127,7 @@ bool ramAccessF(void* userData, uint32_t pa, void* bufP) {
 
             case 32:
                 if (offset < ram->framebufferEnd && offset >= ram->framebufferStart_32)
-                    ram->soc->SetFramebufferDirty();
+                    ramPrvFramebufferWritten<32>(ram, offset);
 
                 if (offset & 0x1f) MEMORY_BUFFER_MARK_DIRTY(ram->buf, offset + 0x1f);
 
@@ -88,7 +139,7 @@ bool ramAccessF(void* userData, uint32_t pa, void* bufP) {
 
             case 16:
                 if (offset < ram->framebufferEnd && offset >= ram->framebufferStart_16)
-                    ram->soc->SetFramebufferDirty();
+                    ramPrvFramebufferWritten<16>(ram, offset);
 
                 if (offset & 0x0f) MEMORY_BUFFER_MARK_DIRTY(ram->buf, offset + 0x0f);
 
@@ -98,7 +149,7 @@ bool ramAccessF(void* userData, uint32_t pa, void* bufP) {
 
             case 8:
                 if (offset < ram->framebufferEnd && offset >= ram->framebufferStart_8)
-                    ram->soc->SetFramebufferDirty();
+                    ramPrvFramebufferWritten<8>(ram, offset);
 
                 *((uint64_t*)(addr + 0)) = htole64(((uint64_t*)bufP)[0]);
                 break;
@@ -239,6 +290,30 @@ void ramSetFramebuffer(struct ArmRam* ram, uint32_t base, uint32_t size) {
         ram->framebufferStart_64 = 0;
         ram->framebufferEnd = 0xffffffff;
     }
+
+    free(ram->framebufferDamage);
+    ram->framebufferDamage = nullptr;
+    ram->framebufferDamageSize = 0;
+
+    if (size > 0) {
+        ram->framebufferDamageSize = (((size + 0x3ff) >> 10) + 31) / 32;
+        ram->framebufferDamage = (uint32_t*)malloc(ram->framebufferDamageSize * 4);
+        if (!ram->framebufferDamage) ERR("cannot alloc framebuffer damage bitmap");
+
+        // The whole framebuffer is new
+        memset(ram->framebufferDamage, 0xff, ram->framebufferDamageSize * 4);
+    }
+
+    // Pages that were resolved for writing may now overlap the framebuffer
+    memFlushHostTlb(ram->mem);
+}
+
+struct Buffer ramGetFramebufferDamage(struct ArmRam* ram) {
+    return {.size = ram->framebufferDamageSize * 4, .data = ram->framebufferDamage};
+}
+
+void ramClearFramebufferDamage(struct ArmRam* ram) {
+    if (ram->framebufferDamage) memset(ram->framebufferDamage, 0, ram->framebufferDamageSize * 4);
 }
 
 struct ArmRam* ramInit(struct ArmMem* mem, class SoC* soc, uint32_t adr, uint32_t sz,
@@ -250,10 +325,14 @@ struct ArmRam* ramInit(struct ArmMem* mem, class SoC* soc, uint32_t adr, uint32_
     memset(ram, 0, sizeof(*ram));
 
     ram->soc = soc;
+    ram->mem = mem;
     ram->adr = adr;
     ram->sz = sz;
     memcpy(&ram->buf, buf, sizeof(ram->buf));
 
+    ram->codePages = (uint32_t*)calloc(((sz >> 10) + 31) / 32, sizeof(uint32_t));
+    if (!ram->codePages) ERR("cannot alloc RAM code page bitmap");
+
     ramSetFramebuffer(ram, 0, 0);
 
     if (!(primary ? memRegionAddRam(mem, adr, sz, ramAccessF, ram)
@@ -264,6 +343,37 @@ struct ArmRam* ramInit(struct ArmMem* mem, class SoC* soc, uint32_t adr, uint32_
     return ram;
 }
 
+bool ramResolveHostPage(struct ArmRam* ram, uint32_t pa, bool write, struct HostPage* page) {
+    const uint32_t offset = pa - ram->adr;
+
+    if (write) {
+        // Writes to the framebuffer must go through ramAccessF in order to track damage. Without
+        // a known framebuffer, any write might hit it. The same holds for pages with cached code.
+        if (ram->framebufferEnd == 0xffffffff) return false;
+        if (ram->codePages[CODE_PAGE_WORD(offset)] & CODE_PAGE_MASK(offset)) return false;
+        if (offset < ram->framebufferEnd &&
+            offset + (1 << HOST_TLB_PAGE_BITS) > ram->framebufferStart)
+            return false;
+    }
+
+    page->data = ram->buf.buffer + offset;
+    page->dirtyWord = ram->buf.dirtyPages + (offset >> 15);
+    page->dirtyMask = 1u << ((offset >> 10) & 0x1f);
+
+    return true;
+}
+
+void ramWatchCodePage(struct ArmRam* ram, uint32_t pa) {
+    const uint32_t offset = pa - ram->adr;
+
+    if (ram->codePages[CODE_PAGE_WORD(offset)] & CODE_PAGE_MASK(offset)) return;
+
+    ram->codePages[CODE_PAGE_WORD(offset)] |= CODE_PAGE_MASK(offset);
+
+    // The host TLB may hold a write mapping for this page that bypasses the check
+    memInvalidateHostTlbWrite(ram->mem, ram->buf.buffer + (offset & ~0x3ffu));
+}
+
 void* ramResolveAddress(struct ArmRam* ram, uint32_t pv, uint32_t size) {
     if (pv < ram->adr || pv + size > ram->adr + ram->sz) return nullptr;
 
@@ -5,6 +5,7 @@
 
 #include <cstdint>
 
+#include "buffer.h"
 #include "mem.h"
 
 struct ArmRam;
@@ -21,6 +22,16 @@ bool ramAccessF(void* userData, uint32_t pa, uint_fast8_t size, bool write, void
 
 void ramSetFramebuffer(struct ArmRam* ram, uint32_t base, uint32_t size);
 
+// One bit per 1k page of the framebuffer, counted from its start, for every page that was written
+// since the last clear. All bits are set when the framebuffer moves.
+struct Buffer ramGetFramebufferDamage(struct ArmRam* ram);
+void ramClearFramebufferDamage(struct ArmRam* ram);
+
+bool ramResolveHostPage(struct ArmRam* ram, uint32_t pa, bool write, struct HostPage* page);
+
+// The first write to a watched page is reported with memNotifyCodeWrite and removes the watch
+void ramWatchCodePage(struct ArmRam* ram, uint32_t pa);
+
 void* ramResolveAddress(struct ArmRam* ram, uint32_t pv, uint32_t size);
 
 #endif
@@ -8,6 +8,7 @@
 
 #include "CPEndian.h"
 #include "cputil.h"
+#include "host_tlb.h"
 #include "mem.h"
 
 struct ArmRom {
@@ -127,6 +128,14 @@ template bool romInstructionFetch<16>(void *userData, uint32_t pa, void *bufP);
 template bool romInstructionFetch<32>(void *userData, uint32_t pa, void *bufP);
 template bool romInstructionFetch<64>(void *userData, uint32_t pa, void *bufP);
 
+bool romResolveHostPage(struct ArmRom *rom, uint32_t pa, struct HostPage *page) {
+    page->data = (uint8_t *)rom->data + (pa - rom->base);
+    page->dirtyWord = nullptr;
+    page->dirtyMask = 0;
+
+    return true;
+}
+
 uint32_t romGetSize(struct ArmRom *rom) { return rom->size; }
 
 void *romGetData(struct ArmRom *rom) { return rom->data; }
@@ -21,6 +21,8 @@ bool romAccessF(void *userData, uint32_t pa, uint_fast8_t size, bool write, void
 template <int size>
 bool romInstructionFetch(void *userData, uint32_t pa, void *bufP);
 
+bool romResolveHostPage(struct ArmRom *rom, uint32_t pa, struct HostPage *page);
+
 uint32_t romGetSize(struct ArmRom *rom);
 
 void *romGetData(struct ArmRom *rom);
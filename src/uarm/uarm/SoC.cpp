@@ -1,5 +1,11 @@
 #include "SoC.h"
 
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "CPU.h"
+#include "CowImage.h"
 #include "RAM.h"
 #include "ROM.h"
 #include "audio_queue.h"
@@ -7,7 +13,11 @@
 #include "nand.h"
 #include "pace_patch.h"
 #include "patch_dispatch.h"
+#include "device.h"
+#include "display_configuration.h"
 #include "sdcard.h"
+#include "soc_PXA.h"
+#include "soc_pv.h"
 #include "system_state.h"
 #include "vSD.h"
 
@@ -15,6 +25,21 @@
 
 using namespace std;
 
+struct SocSnapshot {
+    DeviceType5 deviceType;
+    uint32_t ramSize;
+
+    unique_ptr<CowImage> nor;
+    unique_ptr<CowImage> nand;
+    unique_ptr<CowImage> memory;
+
+    size_t savestateSize;
+    unique_ptr<uint8_t[]> savestate;
+
+    unique_ptr<CowImage> sd;
+    string sdId;
+};
+
 SoC::PenEvent SoC::PenEvent::PenDown(int x, int y) { return {.penDown = true, .x = x, .y = y}; }
 SoC::PenEvent SoC::PenEvent::PenUp() { return {.penDown = false, .x = -1, .y = -1}; }
 
@@ -35,6 +60,15 @@ SoC::SoC()
     vSD = vsdInit(sdCardRead, sdCardWrite, 0);
 }
 
+SoC::~SoC() {
+    if (cpu) cpuDeinit(cpu);
+
+    memoryBufferRelease(&bufferMemory);
+
+    CowImage::Free(clonedNor, clonedNorSize);
+    CowImage::Free(clonedNand, clonedNandSize);
+}
+
 void SoC::KeyDown(enum KeyId key) { keyEventQueue->Push(KeyEvent::KeyDown(key)); }
 
 void SoC::KeyUp(enum KeyId key) { keyEventQueue->Push(KeyEvent::KeyUp(key)); }
@@ -53,6 +87,11 @@ void SoC::SetFramebufferDirty() {
     OnSetFramebufferDirty();
 }
 
+void SoC::RedrawFramebuffer() {
+    framebufferDirty = true;
+    OnRedrawFramebuffer();
+}
+
 bool SoC::SetFramebuffer(uint32_t start, uint32_t size) {
     if (start < ramBase || start - ramBase + size > ramSize) {
         fprintf(stderr, "framebuffer not in RAM\n");
@@ -64,7 +103,16 @@ bool SoC::SetFramebuffer(uint32_t start, uint32_t size) {
     return size != 0;
 }
 
-void SoC::ClearFramebufferDirty() { framebufferDirty = false; }
+void SoC::ClearFramebufferDirty() {
+    framebufferDirty = false;
+    ramClearFramebufferDamage(ram);
+}
+
+struct Buffer SoC::GetFramebufferDamage() { return ramGetFramebufferDamage(ram); }
+
+const void *SoC::ResolveFramebuffer(uint32_t start, uint32_t size) {
+    return ramResolveAddress(ram, start, size);
+}
 
 void SoC::Sleep() {
     if (sleeping || !OnSleep()) return;
@@ -130,10 +178,88 @@ Buffer SoC::GetMemoryDirtyPages() {
     return {.size = bufferMemory.dirtyPagesSize, .data = bufferMemory.dirtyPages};
 }
 
+bool SoC::LoadMemoryImage(const CowImage &image) {
+    return memoryBufferLoadImage(&bufferMemory, image);
+}
+
 struct Buffer SoC::GetSavestate() {
     return {.size = savestate->GetSize(), .data = savestate->GetBuffer()};
 }
 
+shared_ptr<const SocSnapshot> SoC::Snapshot() {
+    if (!Save()) return nullptr;
+
+    auto snapshot = make_shared<SocSnapshot>();
+
+    snapshot->deviceType = GetDeviceType();
+    snapshot->ramSize = ramSize;
+
+    snapshot->nor = make_unique<CowImage>(romGetData(rom), romGetSize(rom));
+    if (nand) {
+        Buffer nandData = nandGetData(nand);
+        snapshot->nand = make_unique<CowImage>(nandData.data, nandData.size);
+    }
+
+    snapshot->memory = make_unique<CowImage>(bufferMemory.buffer, bufferMemory.size);
+
+    snapshot->savestateSize = savestate->GetSize();
+    snapshot->savestate = make_unique<uint8_t[]>(snapshot->savestateSize);
+    memcpy(snapshot->savestate.get(), savestate->GetBuffer(), snapshot->savestateSize);
+
+    if (sdCardInitialized()) {
+        snapshot->sd = sdCardSnapshot();
+        snapshot->sdId = sdCardGetId();
+    }
+
+    return snapshot;
+}
+
+SoC *SoC::Clone(const SocSnapshot &snapshot) {
+    void *nor = snapshot.nor->Instantiate();
+    void *nandData = snapshot.nand ? snapshot.nand->Instantiate() : nullptr;
+
+    if (!nor || (snapshot.nand && !nandData)) {
+        CowImage::Free(nor, snapshot.nor->GetSize());
+        if (snapshot.nand) CowImage::Free(nandData, snapshot.nand->GetSize());
+
+        return nullptr;
+    }
+
+    if (!snapshot.sd || !sdCardInitializeWithImage(*snapshot.sd, snapshot.sdId.c_str()))
+        sdCardReset();
+
+    unique_ptr<SoC> soc;
+
+    if (snapshot.deviceType == deviceTypePV) {
+        DisplayConfiguration displayConfiguration;
+        displayConfigurationGet(snapshot.deviceType, &displayConfiguration);
+
+        soc = make_unique<SocPV>(snapshot.ramSize, nor, snapshot.nor->GetSize(),
+                                 displayConfiguration.width, displayConfiguration.height,
+                                 SocPV::DISPLAY_DENSITY, -1);
+    } else {
+        soc = make_unique<SocPXA>(snapshot.deviceType, snapshot.ramSize, nor,
+                                  snapshot.nor->GetSize(), reinterpret_cast<uint8_t *>(nandData),
+                                  snapshot.nand ? snapshot.nand->GetSize() : 0, -1,
+                                  deviceGetSocRev());
+    }
+
+    soc->clonedNor = nor;
+    soc->clonedNorSize = snapshot.nor->GetSize();
+    soc->clonedNand = nandData;
+    soc->clonedNandSize = snapshot.nand ? snapshot.nand->GetSize() : 0;
+
+    if (!memoryBufferLoadImage(&soc->bufferMemory, *snapshot.memory) ||
+        !soc->Load(snapshot.savestateSize, snapshot.savestate.get())) {
+        fprintf(stderr, "failed to restore cloned session\n");
+        return nullptr;
+    }
+
+    if (soc->SdInserted() && !soc->SdRemount()) sdCardReset();
+
+    return soc.release();
+}
+
 void SoC::SdInsert() {
     if (cardInserted || !sdCardInitialized()) return;
     cardInserted = true;
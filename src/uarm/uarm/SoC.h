@@ -4,6 +4,7 @@
 #include <memory.h>
 
 #include <cstdint>
+#include <memory>
 
 #include "buffer.h"
 #include "device_type5.h"
@@ -12,6 +13,7 @@
 #include "queue.h"
 #include "savestate/ChunkTypeUarm.h"
 #include "savestate/Savestate.h"
+#include "scheduler.h"
 #include "sdcard.h"
 
 struct VSD;
@@ -26,9 +28,27 @@ struct PacePatch;
 struct PatchDispatch;
 struct AudioQueue;
 struct PatchContext;
+struct SocSnapshot;
 
+// Host time spent emulating the CPU and servicing the scheduler tasks
+struct SocProfile {
+    uint64_t cpuNsec;
+    struct SchedulerProfile scheduler;
+};
+
+// The PACE core and the SD card keep their state in thread local storage, so a process can
+// host several instances as long as each of them is created and run on its own thread.
 class SoC {
    public:
+    // Lines of a pending frame that changed since the previous frame
+    struct FrameDamage {
+        uint32_t firstLine;
+        uint32_t lineCount;
+    };
+
+   public:
+    virtual ~SoC();
+
     virtual void Reset() = 0;
 
     virtual uint64_t Run(uint64_t maxCycles, uint64_t cyclesPerSecond) = 0;
@@ -45,8 +65,14 @@ class SoC {
     void PenUp();
 
     void SetFramebufferDirty();
+    // Converts the whole framebuffer on the next frame, e.g. after the display was rotated
+    void RedrawFramebuffer();
     bool SetFramebuffer(uint32_t start, uint32_t size);
     void ClearFramebufferDirty();
+    // See ramGetFramebufferDamage; cleared by ClearFramebufferDirty
+    struct Buffer GetFramebufferDamage();
+    // Host memory backing the framebuffer, or nullptr if it is not in RAM
+    const void *ResolveFramebuffer(uint32_t start, uint32_t size);
 
     void Sleep();
     void Wakeup(uint8_t wakeupSource);
@@ -65,10 +91,25 @@ class SoC {
     Buffer GetMemoryData();
     Buffer GetMemoryDirtyPages();
 
+    // Replaces RAM with a copy-on-write instance of an image of the same size and clears the
+    // dirty pages. Must be called before the SoC runs.
+    bool LoadMemoryImage(const CowImage &image);
+
     virtual bool Save() = 0;
     virtual bool Load(size_t savestateSize, void *savestateData) = 0;
     struct Buffer GetSavestate();
 
+    // Captures the session (NOR, NAND, RAM, SD card and savestate) for cloning. Must be called
+    // between Run slices on the thread that runs this SoC. The snapshot is immutable and may be
+    // shared across threads.
+    std::shared_ptr<const SocSnapshot> Snapshot();
+
+    // Builds an independent SoC from a snapshot. NOR, NAND and RAM are shared with the snapshot
+    // copy-on-write, so a clone only pays for the pages it writes, and its dirty page bitmaps
+    // start out clear and track where it diverged. The clone takes over the SD card of the
+    // calling thread and must be run on that thread. Returns nullptr on failure.
+    static SoC *Clone(const SocSnapshot &snapshot);
+
     void SdInsert();
     bool SdRemount();
     void SdEject();
@@ -87,9 +128,13 @@ class SoC {
     bool IsPacePatched();
     virtual uint64_t GetTime() = 0;
 
+    // Pass nullptr to stop profiling. The profile is accumulated, not reset.
+    virtual void SetProfile(struct SocProfile *profile) = 0;
+
     // Actual SoC needs to implement those, the other virtuals are taken
     // care of in soc_generic.h
     virtual uint32_t *GetPendingFrame() = 0;
+    virtual FrameDamage GetPendingFrameDamage() = 0;
     virtual void ResetPendingFrame() = 0;
     virtual enum DeviceType5 GetDeviceType() = 0;
     virtual void SuspendTimerInterrupts(bool suspendInterrupts) = 0;
@@ -99,6 +144,7 @@ class SoC {
     // Actual SoC needs to implement those, the other virtuals are taken
     // care of in soc_generic.h
     virtual void OnSetFramebufferDirty() = 0;
+    virtual void OnRedrawFramebuffer() = 0;
     virtual bool OnSleep() = 0;
     virtual void OnWakeup() = 0;
     virtual void OnSetAudioQueue(struct AudioQueue *audioQueue) = 0;
@@ -144,6 +190,12 @@ class SoC {
 
     MemoryBuffer bufferMemory{};
 
+    // NOR and NAND images instantiated by Clone, released on destruction
+    void *clonedNor{nullptr};
+    size_t clonedNorSize{0};
+    void *clonedNand{nullptr};
+    size_t clonedNandSize{0};
+
     std::unique_ptr<Savestate<ChunkType>> savestate;
     std::unique_ptr<Savestate<ChunkType>> powerOnState;
 
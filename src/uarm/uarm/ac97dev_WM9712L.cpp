@@ -12,6 +12,9 @@
 
 #define SAVESTATE_VERSION 0
 
+// Playback samples are staged and pushed to the audio queue in bursts
+#define PLAYBACK_BURST 32
+
 enum WM9712REG {
     RESET = 0x00,
     OUT2VOL = 0x02,
@@ -97,6 +100,8 @@ struct WM9712L {
     uint16_t otherTwo[2];
 
     struct AudioQueue *audioQueue;
+    uint32_t playbackBurst[PLAYBACK_BURST];
+    uint8_t playbackBurstSize;
 
     template <typename T>
     void DoSaveLoad(T &chunkHelper) {
@@ -455,8 +460,18 @@ struct WM9712L *wm9712LInit(struct PxaAC97 *ac97, struct PxaGpio *gpio, int8_t p
     return wm;
 }
 
+static void wm9712LprvFlushAudioPlayback(struct WM9712L *wm) {
+    if (wm->audioQueue && wm->playbackBurstSize > 0)
+        audioQueuePushBulk(wm->audioQueue, wm->playbackBurst, wm->playbackBurstSize);
+
+    wm->playbackBurstSize = 0;
+}
+
 static void wm9712LprvNewAudioPlaybackSample(struct WM9712L *wm, uint32_t samp) {
-    if (wm->audioQueue) audioQueuePush(wm->audioQueue, samp);
+    if (!wm->audioQueue) return;
+
+    wm->playbackBurst[wm->playbackBurstSize++] = samp;
+    if (wm->playbackBurstSize == PLAYBACK_BURST) wm9712LprvFlushAudioPlayback(wm);
 }
 
 static bool wm9712LprvHaveAudioOutSample(struct WM9712L *wm, uint32_t *sampP) {
@@ -626,6 +641,7 @@ void wm9712LsetPen(struct WM9712L *wm, int16_t x, int16_t y,
 }
 
 void wm9712LsetAudioQueue(struct WM9712L *wm, struct AudioQueue *audioQueue) {
+    wm9712LprvFlushAudioPlayback(wm);
     wm->audioQueue = audioQueue;
 }
 
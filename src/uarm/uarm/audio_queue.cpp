@@ -1,27 +1,11 @@
 #include "audio_queue.h"
 
-#include "queue.h"
-
-#ifndef __EMSCRIPTEN__
-    #define AUDIO_QUEUE_THREADSAFE
-#endif
-
-#ifdef AUDIO_QUEUE_THREADSAFE
-    #include <mutex>
-
-    #define AUDIO_QUEUE_LOCK std::lock_guard lock(audioQueue->mutex)
-#else
-    #define AUDIO_QUEUE_LOCK
-#endif
+#include "spsc_ring.h"
 
 struct AudioQueue {
-    Queue<uint32_t> queue;
+    SpscRing<uint32_t> ring;
 
-    AudioQueue(size_t capacity) : queue(capacity) {}
-
-#ifdef AUDIO_QUEUE_THREADSAFE
-    std::mutex mutex;
-#endif
+    AudioQueue(size_t capacity) : ring(capacity) {}
 };
 
 struct AudioQueue* audioQueueCreate(size_t capacity) {
@@ -31,29 +15,19 @@ struct AudioQueue* audioQueueCreate(size_t capacity) {
 }
 
 void audioQueuePush(struct AudioQueue* audioQueue, uint32_t sample) {
-    AUDIO_QUEUE_LOCK;
+    audioQueue->ring.PushBulk(&sample, 1);
+}
 
-    audioQueue->queue.Push(sample);
+size_t audioQueuePushBulk(struct AudioQueue* audioQueue, const uint32_t* samples, size_t count) {
+    return audioQueue->ring.PushBulk(samples, count);
 }
 
 size_t audioQueuePopChunk(struct AudioQueue* audioQueue, uint32_t* destination, size_t count) {
-    AUDIO_QUEUE_LOCK;
-
-    size_t actualCount = 0;
-    while (audioQueue->queue.GetSize() > 0 && actualCount < count)
-        destination[actualCount++] = audioQueue->queue.Pop();
-
-    return actualCount;
+    return audioQueue->ring.PopBulk(destination, count);
 }
 
 size_t audioQueuePendingSamples(struct AudioQueue* audioQueue) {
-    AUDIO_QUEUE_LOCK;
-
-    return audioQueue->queue.GetSize();
+    return audioQueue->ring.GetSize();
 }
 
-void audioQueueClear(struct AudioQueue* audioQueue) {
-    AUDIO_QUEUE_LOCK;
-
-    audioQueue->queue.Clear();
-}
+void audioQueueClear(struct AudioQueue* audioQueue) { audioQueue->ring.Clear(); }
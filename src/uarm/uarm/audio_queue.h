@@ -4,16 +4,21 @@
 #include <cstddef>
 #include <cstdint>
 
+// Single producer (the emulator) and single consumer (the audio callback); neither side
+// blocks. Samples that do not fit are dropped.
 struct AudioQueue;
 
 struct AudioQueue* audioQueueCreate(size_t capacity);
 
 void audioQueuePush(struct AudioQueue* audioQueue, uint32_t sample);
 
+size_t audioQueuePushBulk(struct AudioQueue* audioQueue, const uint32_t* samples, size_t count);
+
 size_t audioQueuePopChunk(struct AudioQueue* audioQueue, uint32_t* destination, size_t count);
 
 size_t audioQueuePendingSamples(struct AudioQueue* audioQueue);
 
+// Producer side
 void audioQueueClear(struct AudioQueue* audioQueue);
 
 #endif  //  _AUDIO_QUEUE_H_
@@ -0,0 +1,95 @@
+#ifndef _HOST_TLB_H_
+#define _HOST_TLB_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "cputil.h"
+
+// Direct mapped VA -> host pointer TLB for data accesses that hit RAM or ROM. Entries are tagged
+// with the page, the privilege level and the TLB revision, so a flush is just a revision bump.
+
+#define HOST_TLB_PAGE_BITS 10
+#define HOST_TLB_INDEX_BITS 8
+#define HOST_TLB_REVISION_MASK (~(0xffffffff << (HOST_TLB_PAGE_BITS - 1)))
+
+struct HostTlbEntry {
+    uint32_t tag;
+    uint32_t dirtyMask;
+    uint8_t* data;
+    uint32_t* dirtyWord;  // RAM writes only
+};
+
+struct HostTlb {
+    struct HostTlbEntry read[1 << HOST_TLB_INDEX_BITS];
+    struct HostTlbEntry write[1 << HOST_TLB_INDEX_BITS];
+
+    uint32_t revision;
+};
+
+// A 1k page of host memory as resolved by memResolveHostPage
+struct HostPage {
+    uint8_t* data;
+    uint32_t* dirtyWord;
+    uint32_t dirtyMask;
+};
+
+inline void hostTlbFlush(struct HostTlb* tlb) {
+    tlb->revision = (tlb->revision + 1) & HOST_TLB_REVISION_MASK;
+
+    if (tlb->revision == 0) {
+        memset(tlb->read, 0, sizeof(tlb->read));
+        memset(tlb->write, 0, sizeof(tlb->write));
+
+        tlb->revision = 1;
+    }
+}
+
+// Drops the write mappings of a single host page, whatever virtual addresses it is mapped at. Tags
+// never become zero, so a cleared entry never hits.
+inline void hostTlbInvalidateWrite(struct HostTlb* tlb, const uint8_t* data) {
+    for (auto& entry : tlb->write)
+        if (entry.data == data) entry.tag = 0;
+}
+
+inline uint32_t hostTlbPrvTag(struct HostTlb* tlb, uint32_t va, bool privileged) {
+    return (va & (0xffffffff << HOST_TLB_PAGE_BITS)) | (tlb->revision << 1) | (privileged ? 1 : 0);
+}
+
+inline uint32_t hostTlbPrvIndex(uint32_t va) {
+    return (va >> HOST_TLB_PAGE_BITS) & ~(0xffffffff << HOST_TLB_INDEX_BITS);
+}
+
+template <bool write>
+FORCE_INLINE struct HostTlbEntry* hostTlbLookup(struct HostTlb* tlb, uint32_t va,
+                                                bool privileged) {
+    struct HostTlbEntry* entry = (write ? tlb->write : tlb->read) + hostTlbPrvIndex(va);
+
+    return entry->tag == hostTlbPrvTag(tlb, va, privileged) ? entry : nullptr;
+}
+
+template <bool write>
+inline void hostTlbInsert(struct HostTlb* tlb, uint32_t va, bool privileged,
+                          const struct HostPage* page) {
+    struct HostTlbEntry* entry = (write ? tlb->write : tlb->read) + hostTlbPrvIndex(va);
+
+    entry->tag = hostTlbPrvTag(tlb, va, privileged);
+    entry->data = page->data;
+    entry->dirtyWord = page->dirtyWord;
+    entry->dirtyMask = page->dirtyMask;
+}
+
+// Our memory system is little-endian, and so is the host (see icache.cpp)
+template <int size, bool write>
+FORCE_INLINE void hostTlbAccess(struct HostTlbEntry* entry, uint32_t va, void* buf) {
+    uint8_t* data = entry->data + (va & ~(0xffffffff << HOST_TLB_PAGE_BITS));
+
+    if constexpr (write) {
+        *entry->dirtyWord |= entry->dirtyMask;
+        memcpy(data, buf, size);
+    } else {
+        memcpy(buf, data, size);
+    }
+}
+
+#endif  // _HOST_TLB_H_
@@ -7,23 +7,29 @@
 
 #include "CPU.h"
 #include "cputil.h"
+#include "peephole.h"
 
 #define CACHE_LINE_WIDTH_BITS 5
-#define CACHE_INDEX_BITS 17
 
-// THIS FILE IS ABSOLUTELY NOT ENDIAN SAFE!
+#define BLOCK_WINDOW_BITS 6
+#define BLOCK_INDEX_BITS 12
+#define BLOCK_GENERATION_INDEX_BITS 14
+#define PEEPHOLE_PAGE_BITS 10
+#define PEEPHOLE_PAGE_WORDS ((1 << PEEPHOLE_PAGE_BITS) / 32)
 
-#if (32 - CACHE_LINE_WIDTH_BITS - CACHE_INDEX_BITS <= 8)
-    #define CACHE_TAG_TYPE uint_fast8_t
-#else
-    #define CACHE_TAG_TYPE uint_fast16_t
-#endif
+// THIS FILE IS ABSOLUTELY NOT ENDIAN SAFE!
 
-#define calculateIndex(va) ((va >> CACHE_LINE_WIDTH_BITS) & ~(0xffffffff << CACHE_INDEX_BITS))
-#define calculateTag(va) (va >> (CACHE_LINE_WIDTH_BITS + CACHE_INDEX_BITS))
+#define calculateIndex(ic, va) \
+    ((va >> CACHE_LINE_WIDTH_BITS) & ~(0xffffffff << (ic)->indexBits))
 #define calculateLineIndex(va) (va & ~(0xffffffff << CACHE_LINE_WIDTH_BITS))
 #define maskLine(va) (va & (0xffffffff << CACHE_LINE_WIDTH_BITS))
 
+#define calculateBlockIndex(va) \
+    (((va >> 1) ^ (va >> (BLOCK_INDEX_BITS + 1))) & ~(0xffffffff << BLOCK_INDEX_BITS))
+#define calculateGenerationIndex(va) \
+    ((va >> BLOCK_WINDOW_BITS) & ~(0xffffffff << BLOCK_GENERATION_INDEX_BITS))
+#define maskBlockWindow(va) (va & (0xffffffff << BLOCK_WINDOW_BITS))
+
 #ifdef __EMSCRIPTEN__
     #define DECODED_INSTRUCTION_TYPE uint16_t
     #define DECODED_BITS 0xc000
@@ -41,9 +47,9 @@
 struct icacheline {
     uint8_t data[1 << CACHE_LINE_WIDTH_BITS];
     DECODED_INSTRUCTION_TYPE decoded[1 << (CACHE_LINE_WIDTH_BITS - 1)];
-    uint32_t translatedThumbInstructions[1 << (CACHE_LINE_WIDTH_BITS - 1)];
+    uint32_t* translatedThumbInstructions;  // allocated once the line holds thumb code
 
-    CACHE_TAG_TYPE tag;
+    uint32_t tag;  // line aligned VA
     uint32_t revision;
 } __attribute__((aligned(8)));
 
@@ -55,16 +61,50 @@ struct icache {
     struct ArmMem* mem;
 
     uint32_t revision;
-    struct icacheline cache[1 << CACHE_INDEX_BITS];
+
+    uint8_t indexBits;
+    uint8_t ways;
+    struct icacheline* cache;  // (1 << indexBits) sets of ways lines each
+    uint8_t* victims;          // next way to evict, per set
+
+    struct icacheStats stats;
+
+    // 1k pages with peephole replacements in lines filled from RAM, hashed into a bitmap
+    uint32_t peepholePages[PEEPHOLE_PAGE_WORDS];
+
+    struct icacheblock* activeBlock;
+    struct icacheblock scratchBlock;
+    uint32_t generations[1 << BLOCK_GENERATION_INDEX_BITS];
+    struct icacheblock blocks[1 << BLOCK_INDEX_BITS];
 };
 
+static void icachePrvRetireActiveBlock(struct icache* ic, uint32_t va) {
+    struct icacheblock* block = ic->activeBlock;
+
+    if (block && maskBlockWindow(block->va) == maskBlockWindow(va)) block->size = 0;
+}
+
 void icacheInval(struct icache* ic) {
     ic->revision++;
+    memset(ic->peepholePages, 0, sizeof(ic->peepholePages));
 
     if (ic->revision == 0) {
         ic->revision = 1;
-        for (size_t i = 0; i < (1 << CACHE_INDEX_BITS); i++) ic->cache[i].revision = 0;
+        for (size_t i = 0; i < ((size_t)ic->ways << ic->indexBits); i++)
+            ic->cache[i].revision = 0;
+        for (size_t i = 0; i < (1 << BLOCK_INDEX_BITS); i++) ic->blocks[i].size = 0;
     }
+
+    if (ic->activeBlock) ic->activeBlock->size = 0;
+}
+
+// Peephole replacements depend on words outside of their line, so a write anywhere on the page
+// drops them all
+static void icachePrvCodeWritten(void* userData, uint32_t pa) {
+    struct icache* ic = (struct icache*)userData;
+    const uint32_t page = (pa >> 10) & ~(0xffffffff << PEEPHOLE_PAGE_BITS);
+
+    if (ic->peepholePages[page >> 5] & (1u << (page & 0x1f))) icacheInval(ic);
 }
 
 static icache* icacheInitCommon(struct ArmMem* mem) {
@@ -75,12 +115,123 @@ static icache* icacheInitCommon(struct ArmMem* mem) {
     memset(ic, 0, sizeof(*ic));
 
     ic->mem = mem;
+    memAddCodeWriteHandler(mem, icachePrvCodeWritten, ic);
 
-    icacheInval(ic);
+    if (!icacheConfigure(ic, ICACHE_DEFAULT_INDEX_BITS, ICACHE_DEFAULT_WAYS))
+        ERR("cannot alloc icache lines");
 
     return ic;
 }
 
+static void icachePrvFreeLines(struct icache* ic) {
+    if (!ic->cache) return;
+
+    for (size_t i = 0; i < ((size_t)ic->ways << ic->indexBits); i++)
+        free(ic->cache[i].translatedThumbInstructions);
+
+    free(ic->cache);
+    free(ic->victims);
+
+    ic->cache = nullptr;
+    ic->victims = nullptr;
+}
+
+bool icacheConfigure(struct icache* ic, uint8_t indexBits, uint8_t ways) {
+    if (indexBits < 1 || indexBits > ICACHE_MAX_INDEX_BITS || ways < 1 || ways > ICACHE_MAX_WAYS)
+        return false;
+
+    // calloc leaves untouched lines to the zero page, so sparse use stays cheap
+    struct icacheline* cache =
+        (struct icacheline*)calloc((size_t)ways << indexBits, sizeof(struct icacheline));
+    uint8_t* victims = (uint8_t*)calloc((size_t)1 << indexBits, 1);
+
+    if (!cache || !victims) {
+        free(cache);
+        free(victims);
+
+        return false;
+    }
+
+    icachePrvFreeLines(ic);
+
+    ic->indexBits = indexBits;
+    ic->ways = ways;
+    ic->cache = cache;
+    ic->victims = victims;
+
+    icacheInval(ic);
+
+    return true;
+}
+
+void icacheGetStats(struct icache* ic, struct icacheStats* stats) { *stats = ic->stats; }
+
+void icacheResetStats(struct icache* ic) { memset(&ic->stats, 0, sizeof(ic->stats)); }
+
+// Code that is loaded into RAM does not go through peepholeOptimize, so we match signatures when
+// a line is filled instead. Signatures may extend beyond the line, but never beyond the 1k page of
+// the line, as the next page may not be physically contiguous. Writes to the page would not touch
+// the line, so the page is watched and invalidates the cache when it changes.
+static void icachePrvPeephole(struct icache* ic, uint32_t pa, uint8_t* data, size_t size) {
+    uint32_t* words = (uint32_t*)data;
+    const uint32_t pageEnd = (pa | 0x3ff) + 1;
+
+    for (size_t i = 0; i < size / 4; i++) {
+        const uint32_t wordPa = pa + 4 * i;
+        uint32_t second;
+
+        if (i + 1 < size / 4)
+            second = words[i + 1];
+        else if (wordPa + 4 >= pageEnd || !memInstructionFetch<4>(ic->mem, wordPa + 4, &second))
+            continue;
+
+        if (!peepholeIsCandidate(words[i], second)) continue;
+
+        uint32_t code[PEEPHOLE_MAX_SIGNATURE_WORDS];
+        size_t codeWords = 0;
+
+        for (uint32_t addr = wordPa;
+             addr < pageEnd && codeWords < PEEPHOLE_MAX_SIGNATURE_WORDS &&
+             memInstructionFetch<4>(ic->mem, addr, code + codeWords);
+             addr += 4)
+            codeWords++;
+
+        const uint32_t replacement = peepholeMatch(code, 4 * codeWords);
+        if (!replacement || !memWatchCodePage(ic->mem, wordPa)) continue;
+
+        const uint32_t page = (wordPa >> 10) & ~(0xffffffff << PEEPHOLE_PAGE_BITS);
+        ic->peepholePages[page >> 5] |= 1u << (page & 0x1f);
+
+        words[i] = replacement;
+    }
+}
+
+static FORCE_INLINE struct icacheline* icachePrvLookupLine(struct icache* ic, uint32_t va) {
+    struct icacheline* set = ic->cache + calculateIndex(ic, va) * ic->ways;
+    const uint32_t tag = maskLine(va);
+
+    for (uint_fast8_t way = 0; way < ic->ways; way++) {
+        if (set[way].tag == tag && set[way].revision == ic->revision) return set + way;
+    }
+
+    return nullptr;
+}
+
+static struct icacheline* icachePrvAllocateLine(struct icache* ic, uint32_t va) {
+    const uint32_t index = calculateIndex(ic, va);
+    struct icacheline* set = ic->cache + index * ic->ways;
+
+    for (uint_fast8_t way = 0; way < ic->ways; way++) {
+        if (set[way].revision != ic->revision) return set + way;
+    }
+
+    const uint8_t victim = ic->victims[index];
+    ic->victims[index] = victim + 1 == ic->ways ? 0 : victim + 1;
+    ic->stats.evictions++;
+
+    return set + victim;
+}
+
 struct icache* icacheInit(struct ArmMem* mem, struct ArmMmu* mmu) {
     struct icache* ic = icacheInitCommon(mem);
     ic->memorySystem.mmu = mmu;
@@ -95,33 +246,54 @@ struct icache* icacheInit(struct ArmMem* mem, struct ArmMpu* mpu) {
     return ic;
 }
 
-void icacheInvalAddr(struct icache* ic, uint32_t va) {
-    struct icacheline* line = ic->cache + calculateIndex(va);
+void icacheDeinit(struct icache* ic) {
+    icachePrvFreeLines(ic);
+    free(ic);
+}
+
+static void icachePrvInvalLine(struct icache* ic, uint32_t va) {
+    struct icacheline* line = icachePrvLookupLine(ic, va);
 
-    if (line->revision != ic->revision || line->tag != calculateTag(va)) return;
+    if (line) line->revision = ic->revision - 1;
+}
 
-    line->revision = ic->revision - 1;
+static void icachePrvInvalBlocks(struct icache* ic, uint32_t va) {
+    ic->generations[calculateGenerationIndex(va)]++;
+    icachePrvRetireActiveBlock(ic, va);
+}
+
+void icacheInvalAddr(struct icache* ic, uint32_t va) {
+    icachePrvInvalLine(ic, va);
+    icachePrvInvalBlocks(ic, va);
 }
 
 void icacheInvalRange(struct icache* ic, uint32_t addr, uint32_t size) {
     for (uint32_t line = maskLine(addr); line < addr + size; line += (1 << CACHE_LINE_WIDTH_BITS)) {
-        icacheInvalAddr(ic, line);
+        icachePrvInvalLine(ic, line);
+    }
+
+    for (uint32_t window = maskBlockWindow(addr); window < addr + size;
+         window += (1 << BLOCK_WINDOW_BITS)) {
+        icachePrvInvalBlocks(ic, window);
     }
 }
 
-template <int msys, int sz, int tier>
-bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP, uint32_t& instr,
-                 uint32_t& decoded) {
+template <int msys, int sz>
+static FORCE_INLINE bool icachePrvFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP,
+                                        uint32_t& instr, uint32_t& decoded, bool& cached) {
+    cached = false;
+
     if (va & (sz - 1)) {  // alignment issue
 
         *fsrP = 3;
         return false;
     }
 
-    struct icacheline* line = ic->cache + calculateIndex(va);
-    const uint_fast8_t tag = calculateTag(va);
+    struct icacheline* line = icachePrvLookupLine(ic, va);
 
-    if (line->revision != ic->revision || line->tag != tag) {
+    if (line) {
+        ic->stats.hits++;
+    } else {
         uint8_t data[sizeof(line->data)];
         bool cacheable;
         uint32_t pa = va;
@@ -178,6 +350,11 @@ bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP, uint32_t& i
             return false;
         };
 
+        if (sz == 4) icachePrvPeephole(ic, maskLine(pa), data, sizeof(data));
+
+        ic->stats.misses++;
+        line = icachePrvAllocateLine(ic, va);
+
         for (size_t i = 0; i < sizeof(data); i += 8) {
             const uint64_t d = *(uint64_t*)(data + i);
             if ((uint32_t)d != *(uint32_t*)(line->data + i))
@@ -198,7 +375,7 @@ bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP, uint32_t& i
         }
 
         line->revision = ic->revision;
-        line->tag = tag;
+        line->tag = maskLine(va);
     }
 
     switch (sz) {
@@ -231,6 +408,14 @@ bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP, uint32_t& i
                 const uint16_t instrThumb = *(uint16_t*)(line->data + i);
 
                 decoded = cpuDecodeThumb<msys>(instrThumb, instr);
+
+                if (!line->translatedThumbInstructions) {
+                    line->translatedThumbInstructions = (uint32_t*)malloc(
+                        sizeof(uint32_t) << (CACHE_LINE_WIDTH_BITS - 1));
+
+                    if (!line->translatedThumbInstructions) ERR("cannot alloc icache line");
+                }
+
                 line->decoded[iInst] = (decoded << DECODED_BITS_SHIFT) | DECODED_BITS_THUMB;
                 line->translatedThumbInstructions[iInst] = instr;
             } else {
@@ -249,9 +434,95 @@ bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP, uint32_t& i
             __builtin_unreachable();
     }
 
+    cached = true;
     return true;
 }
 
+template <int msys, int sz, int tier>
+bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP, uint32_t& instr,
+                 uint32_t& decoded) {
+    bool cached;
+
+    return icachePrvFetch<msys, sz>(ic, va, fsrP, instr, decoded, cached);
+}
+
+template <int msys, int sz>
+static FORCE_INLINE bool icachePrvBlockValid(struct icache* ic, struct icacheblock* block,
+                                             uint32_t va) {
+    return block->size > 0 && block->va == va && block->thumb == (sz == 2) &&
+           block->revision == ic->revision &&
+           block->generation == ic->generations[calculateGenerationIndex(va)];
+}
+
+template <int msys, int sz>
+static struct icacheblock* icachePrvBuildBlock(struct icache* ic, uint32_t va,
+                                               uint_fast8_t* fsrP) {
+    uint32_t instr, decoded;
+    bool cached;
+
+    if (!icachePrvFetch<msys, sz>(ic, va, fsrP, instr, decoded, cached)) return nullptr;
+
+    struct icacheblock* block = cached ? ic->blocks + calculateBlockIndex(va) : &ic->scratchBlock;
+
+    block->va = va;
+    block->thumb = sz == 2;
+    block->successor = nullptr;
+    block->instr[0] = instr;
+    block->decoded[0] = decoded;
+
+    if (!cached) {
+        // This block is never found by lookup or chaining, it just carries a single instruction
+        block->revision = ic->revision - 1;
+        block->size = 1;
+
+        return block;
+    }
+
+    block->revision = ic->revision;
+    block->generation = ic->generations[calculateGenerationIndex(va)];
+
+    uint32_t size = 1;
+    for (uint32_t nextVa = va + sz;
+         size < ICACHE_BLOCK_MAX_INSTRUCTIONS && maskBlockWindow(nextVa) == maskBlockWindow(va);
+         nextVa += sz, size++) {
+        uint_fast8_t fsr;
+
+        if (!icachePrvFetch<msys, sz>(ic, nextVa, &fsr, block->instr[size], block->decoded[size],
+                                      cached) ||
+            !cached)
+            break;
+    }
+
+    block->size = size;
+
+    return block;
+}
+
+template <int msys, int sz>
+struct icacheblock* icacheFetchBlock(struct icache* ic, uint32_t va, uint_fast8_t* fsrP,
+                                     struct icacheblock* predecessor) {
+    struct icacheblock* block;
+
+    if (predecessor && predecessor->successorVa == va && predecessor->successor &&
+        icachePrvBlockValid<msys, sz>(ic, predecessor->successor, va)) {
+        block = predecessor->successor;
+    } else {
+        block = ic->blocks + calculateBlockIndex(va);
+
+        if (!icachePrvBlockValid<msys, sz>(ic, block, va)) {
+            block = icachePrvBuildBlock<msys, sz>(ic, va, fsrP);
+            if (!block) return ic->activeBlock = nullptr;
+        }
+
+        if (predecessor && predecessor != &ic->scratchBlock && block != &ic->scratchBlock) {
+            predecessor->successor = block;
+            predecessor->successorVa = va;
+        }
+    }
+
+    return ic->activeBlock = block;
+}
+
 #define DEFINE_FETCH_MSYS_SZ_TIER(msys, sz, tier)                                                  \
     template bool icacheFetch<msys, sz, tier>(struct icache * ic, uint32_t va, uint_fast8_t* fsrP, \
                                               uint32_t& instr, uint32_t& decoded);
@@ -266,3 +537,15 @@ bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsrP, uint32_t& i
 
 DEFINE_FETCH_MSYS(ARM_MEMORY_SYSTEM_MMU);
 DEFINE_FETCH_MSYS(ARM_MEMORY_SYSTEM_MPU);
+
+#define DEFINE_FETCH_BLOCK_MSYS_SZ(msys, sz)                                                      \
+    template struct icacheblock* icacheFetchBlock<msys, sz>(struct icache * ic, uint32_t va,      \
+                                                            uint_fast8_t * fsrP,                  \
+                                                            struct icacheblock * predecessor);
+
+#define DEFINE_FETCH_BLOCK_MSYS(msys)    \
+    DEFINE_FETCH_BLOCK_MSYS_SZ(msys, 2); \
+    DEFINE_FETCH_BLOCK_MSYS_SZ(msys, 4);
+
+DEFINE_FETCH_BLOCK_MSYS(ARM_MEMORY_SYSTEM_MMU);
+DEFINE_FETCH_BLOCK_MSYS(ARM_MEMORY_SYSTEM_MPU);
@@ -10,12 +10,51 @@
 #include "MPU.h"
 #include "mem.h"
 
+#define ICACHE_BLOCK_MAX_INSTRUCTIONS 16
+
+#define ICACHE_DEFAULT_INDEX_BITS 15
+#define ICACHE_DEFAULT_WAYS 4
+#define ICACHE_MAX_INDEX_BITS 20
+#define ICACHE_MAX_WAYS 16
+
 struct icache;
 
+struct icacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
 typedef uint32_t (*DecodeFn)(uint32_t opcode);
 
+// A straight-line run of predecoded instructions starting at va. Blocks never cross a block window
+// (64 bytes), so invalidating an address only needs to retire the blocks of its window. Execution
+// has to leave the block as soon as the PC deviates from the sequential flow.
+struct icacheblock {
+    uint32_t va;
+    uint32_t revision;
+    uint32_t generation;
+    uint32_t size;  // set to zero if the block is invalidated while it is executing
+    bool thumb;
+
+    struct icacheblock* successor;
+    uint32_t successorVa;
+
+    uint32_t instr[ICACHE_BLOCK_MAX_INSTRUCTIONS];
+    uint32_t decoded[ICACHE_BLOCK_MAX_INSTRUCTIONS];
+};
+
 struct icache* icacheInit(struct ArmMem* mem, struct ArmMmu* mmu);
 struct icache* icacheInit(struct ArmMem* mem, struct ArmMpu* mpu);
+void icacheDeinit(struct icache* ic);
+
+// Select the geometry: (1 << indexBits) sets of 32 byte lines with the given number of ways.
+// Invalidates the cache. Returns false if the geometry is invalid or allocation fails; the previous
+// geometry is kept in this case.
+bool icacheConfigure(struct icache* ic, uint8_t indexBits, uint8_t ways);
+
+void icacheGetStats(struct icache* ic, struct icacheStats* stats);
+void icacheResetStats(struct icache* ic);
 
 void icacheInval(struct icache* ic);
 void icacheInvalAddr(struct icache* ic, uint32_t addr);
@@ -25,4 +64,11 @@ template <int msys, int sz, int tier = 0>
 bool icacheFetch(struct icache* ic, uint32_t va, uint_fast8_t* fsr, uint32_t& instr,
                  uint32_t& decoded);
 
+// Returns the block starting at va, building it if necessary. Returns NULL and sets *fsr if the
+// first instruction faults. Blocks for uncacheable memory contain a single instruction and are not
+// retained. If predecessor is set, the result is chained to it.
+template <int msys, int sz>
+struct icacheblock* icacheFetchBlock(struct icache* ic, uint32_t va, uint_fast8_t* fsr,
+                                     struct icacheblock* predecessor);
+
 #endif
@@ -8,13 +8,25 @@
 #include "RAM.h"
 #include "ROM.h"
 #include "cputil.h"
+#include "host_tlb.h"
 
 #define NUM_MEM_REGIONS 128
+#define NUM_CODE_WRITE_HANDLERS 2
 
 #define REGION_RAM 0
 #define REGION_ROM 1
 #define REGION_BASE 2
 
+// Dispatch of the generic regions goes through a two level table that maps 4k pages to region
+// indices. RAM and ROM are never entered into the table, so their indices double as markers for
+// unmapped pages and for pages that are shared by several regions.
+#define PAGE_UNMAPPED REGION_RAM
+#define PAGE_MIXED REGION_ROM
+
+#define PAGE_TABLE_L1_BITS 12
+#define PAGE_TABLE_L2_BITS 8
+#define PAGE_BITS (32 - PAGE_TABLE_L1_BITS - PAGE_TABLE_L2_BITS)
+
 struct ArmMemRegion {
     uint32_t pa;
     uint32_t ub;
@@ -22,8 +34,17 @@ struct ArmMemRegion {
     void *uD;
 };
 
+struct ArmMemCodeWriteHandler {
+    ArmMemCodeWriteF f;
+    void *uD;
+};
+
 struct ArmMem {
     struct ArmMemRegion regions[NUM_MEM_REGIONS];
+    uint8_t *pageTable[1 << PAGE_TABLE_L1_BITS];
+    struct HostTlb *hostTlb;
+
+    struct ArmMemCodeWriteHandler codeWriteHandlers[NUM_CODE_WRITE_HANDLERS];
 };
 
 struct ArmMem *memInit(void) {
@@ -36,7 +57,52 @@ struct ArmMem *memInit(void) {
     return mem;
 }
 
-void memDeinit(struct ArmMem *mem) { (void)mem; }
+void memDeinit(struct ArmMem *mem) {
+    for (size_t i = 0; i < (1 << PAGE_TABLE_L1_BITS); i++) free(mem->pageTable[i]);
+}
+
+static void memPrvMapRegion(struct ArmMem *mem, uint8_t region) {
+    if (mem->regions[region].ub <= mem->regions[region].pa) return;
+
+    const uint32_t firstPage = mem->regions[region].pa >> PAGE_BITS;
+    const uint32_t lastPage = (mem->regions[region].ub - 1) >> PAGE_BITS;
+
+    for (uint32_t page = firstPage; page <= lastPage; page++) {
+        uint8_t **l2 = mem->pageTable + (page >> PAGE_TABLE_L2_BITS);
+
+        if (!*l2) {
+            *l2 = (uint8_t *)malloc(1 << PAGE_TABLE_L2_BITS);
+            if (!*l2) ERR("cannot alloc MEM page table");
+
+            memset(*l2, PAGE_UNMAPPED, 1 << PAGE_TABLE_L2_BITS);
+        }
+
+        uint8_t *entry = *l2 + (page & ~(0xffffffff << PAGE_TABLE_L2_BITS));
+        *entry = *entry == PAGE_UNMAPPED ? region : PAGE_MIXED;
+    }
+}
+
+static FORCE_INLINE struct ArmMemRegion *memPrvFindRegion(struct ArmMem *mem, uint32_t addr,
+                                                          uint32_t ub) {
+    const uint8_t *l2 = mem->pageTable[addr >> (32 - PAGE_TABLE_L1_BITS)];
+    if (!l2) return nullptr;
+
+    const uint8_t region = l2[(addr >> PAGE_BITS) & ~(0xffffffff << PAGE_TABLE_L2_BITS)];
+
+    if (region == PAGE_UNMAPPED) return nullptr;
+
+    if (region != PAGE_MIXED) {
+        struct ArmMemRegion *r = mem->regions + region;
+
+        return r->pa <= addr && r->ub >= ub ? r : nullptr;
+    }
+
+    for (uint_fast8_t i = REGION_BASE; i < NUM_MEM_REGIONS; i++) {
+        if (mem->regions[i].pa <= addr && mem->regions[i].ub >= ub) return mem->regions + i;
+    }
+
+    return nullptr;
+}
 
 static bool checkForIntersection(struct ArmMem *mem, uint32_t pa, uint32_t sz) {
     uint_fast8_t i;
@@ -75,6 +141,8 @@ bool memRegionAdd(struct ArmMem *mem, uint32_t pa, uint32_t sz, ArmMemAccessF aF
             mem->regions[i].uD = uD;
             mem->regions[i].ub = pa + sz;
 
+            memPrvMapRegion(mem, i);
+
             return true;
         }
     }
@@ -92,6 +160,59 @@ bool memRegionAddRom(struct ArmMem *mem, uint32_t pa, uint32_t sz, ArmMemAccessF
     return memRegionAddFixed(mem, REGION_ROM, pa, sz, af, uD);
 }
 
+void memSetHostTlb(struct ArmMem *mem, struct HostTlb *tlb) { mem->hostTlb = tlb; }
+
+void memFlushHostTlb(struct ArmMem *mem) {
+    if (mem->hostTlb) hostTlbFlush(mem->hostTlb);
+}
+
+void memInvalidateHostTlbWrite(struct ArmMem *mem, const uint8_t *data) {
+    if (mem->hostTlb) hostTlbInvalidateWrite(mem->hostTlb, data);
+}
+
+bool memResolveHostPage(struct ArmMem *mem, uint32_t pa, bool write, struct HostPage *page) {
+    const uint32_t base = pa & (0xffffffff << HOST_TLB_PAGE_BITS);
+    const uint32_t ub = base + (1 << HOST_TLB_PAGE_BITS);
+
+    if (mem->regions[REGION_RAM].pa <= base && mem->regions[REGION_RAM].ub >= ub)
+        return ramResolveHostPage((struct ArmRam *)mem->regions[REGION_RAM].uD, base, write, page);
+
+    if (!write && mem->regions[REGION_ROM].pa <= base && mem->regions[REGION_ROM].ub >= ub)
+        return romResolveHostPage((struct ArmRom *)mem->regions[REGION_ROM].uD, base, page);
+
+    return false;
+}
+
+void memAddCodeWriteHandler(struct ArmMem *mem, ArmMemCodeWriteF f, void *userData) {
+    for (auto &handler : mem->codeWriteHandlers) {
+        if (handler.f) continue;
+
+        handler.f = f;
+        handler.uD = userData;
+
+        return;
+    }
+
+    ERR("too many code write handlers");
+}
+
+void memNotifyCodeWrite(struct ArmMem *mem, uint32_t pa) {
+    for (auto &handler : mem->codeWriteHandlers)
+        if (handler.f) handler.f(handler.uD, pa);
+}
+
+bool memWatchCodePage(struct ArmMem *mem, uint32_t pa) {
+    const uint32_t base = pa & ~0x3ffu;
+    const uint32_t ub = base + 0x400;
+
+    if (mem->regions[REGION_RAM].pa <= base && mem->regions[REGION_RAM].ub >= ub) {
+        ramWatchCodePage((struct ArmRam *)mem->regions[REGION_RAM].uD, base);
+        return true;
+    }
+
+    return mem->regions[REGION_ROM].pa <= base && mem->regions[REGION_ROM].ub >= ub;
+}
+
 template <int size, bool write>
 bool memAccess(struct ArmMem *mem, uint32_t addr, void *buf) {
     const uint32_t ub = addr + size;
@@ -103,17 +224,9 @@ bool memAccess(struct ArmMem *mem, uint32_t addr, void *buf) {
     if (mem->regions[REGION_ROM].pa <= addr && mem->regions[REGION_ROM].ub >= ub)
         return romAccessF<size, write>(mem->regions[REGION_ROM].uD, addr, buf);
 
-    bool ret = false;
-    uint_fast8_t i;
-
-    for (i = REGION_BASE; i < NUM_MEM_REGIONS; i++) {
-        if (mem->regions[i].pa <= addr && mem->regions[i].ub >= ub) {
-            ret = mem->regions[i].aF(mem->regions[i].uD, addr, size, write, buf);
-            break;
-        }
-    }
+    struct ArmMemRegion *region = memPrvFindRegion(mem, addr, ub);
 
-    return ret;
+    return region ? region->aF(region->uD, addr, size, write, buf) : false;
 }
 
 #define DECLARE_MEM_ACCESS_SIZE(sz)                                                   \
@@ -138,17 +251,9 @@ bool memAccess(struct ArmMem *mem, uint32_t addr, uint_fast8_t size, bool write,
     if (mem->regions[REGION_ROM].pa <= addr && mem->regions[REGION_ROM].ub >= ub)
         return romAccessF(mem->regions[REGION_ROM].uD, addr, size, write, buf);
 
-    bool ret = false;
-    uint_fast8_t i;
-
-    for (i = REGION_BASE; i < NUM_MEM_REGIONS; i++) {
-        if (mem->regions[i].pa <= addr && mem->regions[i].ub >= ub) {
-            ret = mem->regions[i].aF(mem->regions[i].uD, addr, size, write, buf);
-            break;
-        }
-    }
+    struct ArmMemRegion *region = memPrvFindRegion(mem, addr, ub);
 
-    return ret;
+    return region ? region->aF(region->uD, addr, size, write, buf) : false;
 }
 
 template <int size>
@@ -161,17 +266,9 @@ bool memInstructionFetch(struct ArmMem *mem, uint32_t addr, void *buf) {
     if (mem->regions[REGION_ROM].pa <= addr && mem->regions[REGION_ROM].ub >= ub)
         return romInstructionFetch<size>(mem->regions[REGION_ROM].uD, addr, buf);
 
-    bool ret = false;
-    uint_fast8_t i;
-
-    for (i = REGION_BASE; i < NUM_MEM_REGIONS; i++) {
-        if (mem->regions[i].pa <= addr && mem->regions[i].ub >= ub) {
-            ret = mem->regions[i].aF(mem->regions[i].uD, addr, size, false, buf);
-            break;
-        }
-    }
+    struct ArmMemRegion *region = memPrvFindRegion(mem, addr, ub);
 
-    return ret;
+    return region ? region->aF(region->uD, addr, size, false, buf) : false;
 }
 
 template bool memInstructionFetch<1>(struct ArmMem *mem, uint32_t addr, void *buf);
@@ -6,9 +6,12 @@
 #include <cstdint>
 
 struct ArmMem;
+struct HostTlb;
+struct HostPage;
 
 typedef bool (*ArmMemAccessF)(void* userData, uint32_t pa, uint_fast8_t size, bool write,
                               void* buf);
+typedef void (*ArmMemCodeWriteF)(void* userData, uint32_t pa);
 
 struct ArmMem* memInit(void);
 void memDeinit(struct ArmMem* mem);
@@ -17,6 +20,22 @@ bool memRegionAdd(struct ArmMem* mem, uint32_t pa, uint32_t sz, ArmMemAccessF af
 bool memRegionAddRam(struct ArmMem* mem, uint32_t pa, uint32_t sz, ArmMemAccessF af, void* uD);
 bool memRegionAddRom(struct ArmMem* mem, uint32_t pa, uint32_t sz, ArmMemAccessF af, void* uD);
 
+// The host TLB is flushed whenever a previously resolved host page may have become stale
+void memSetHostTlb(struct ArmMem* mem, struct HostTlb* tlb);
+void memFlushHostTlb(struct ArmMem* mem);
+// Drop the write mappings of the host page that backs a 1k page
+void memInvalidateHostTlbWrite(struct ArmMem* mem, const uint8_t* data);
+
+// Resolve the 1k page containing pa to host memory. Only plain RAM and ROM (read only) qualify.
+bool memResolveHostPage(struct ArmMem* mem, uint32_t pa, bool write, struct HostPage* page);
+
+// Cached code can watch the 1k page it lives on. All handlers are called with the page address on
+// the first write to a watched page. memWatchCodePage returns false if the page can neither be
+// watched nor is immutable, and the code must not be cached.
+void memAddCodeWriteHandler(struct ArmMem* mem, ArmMemCodeWriteF f, void* userData);
+bool memWatchCodePage(struct ArmMem* mem, uint32_t pa);
+void memNotifyCodeWrite(struct ArmMem* mem, uint32_t pa);
+
 template <int size, bool write>
 bool memAccess(struct ArmMem* mem, uint32_t addr, void* buf);
 
@@ -2,14 +2,16 @@
 
 #include <cstring>
 
+#include "CowImage.h"
+
 bool memoryBufferAllocate(struct MemoryBuffer* memoryBuffer, size_t size) {
     if (size % MEMORY_BUFFER_GRANULARITY) return false;
 
     size_t pageCount = size / 1024;
 
     memoryBuffer->size = pageCount * 1024;
-    memoryBuffer->buffer = reinterpret_cast<uint8_t*>(malloc(memoryBuffer->size));
-    memset(memoryBuffer->buffer, 0, memoryBuffer->size);
+    memoryBuffer->buffer = reinterpret_cast<uint8_t*>(CowImage::Allocate(memoryBuffer->size));
+    if (!memoryBuffer->buffer) return false;
 
     size_t dirtyPageCount4 = pageCount / 32;
     if (dirtyPageCount4 * 32 < pageCount) dirtyPageCount4++;
@@ -24,7 +26,7 @@ bool memoryBufferAllocate(struct MemoryBuffer* memoryBuffer, size_t size) {
 void memoryBufferRelease(struct MemoryBuffer* memoryBuffer) {
     if (memoryBuffer->isSubBuffer) return;
 
-    free(memoryBuffer->buffer);
+    CowImage::Free(memoryBuffer->buffer, memoryBuffer->size);
     free(memoryBuffer->dirtyPages);
 }
 
@@ -50,4 +52,14 @@ void memoryBufferMarkRangeDirty(struct MemoryBuffer* memoryBuffer, size_t addres
         memoryBuffer->dirtyPages[page >> 5] |= (1 << (page & 0x1f));
 }
 
+bool memoryBufferLoadImage(struct MemoryBuffer* memoryBuffer, const CowImage& image) {
+    if (memoryBuffer->isSubBuffer || image.GetSize() != memoryBuffer->size ||
+        !image.InstantiateAt(memoryBuffer->buffer))
+        return false;
+
+    memset(memoryBuffer->dirtyPages, 0, memoryBuffer->dirtyPagesSize);
+
+    return true;
+}
+
 bool memoryBufferValid(struct MemoryBuffer* memoryBuffer) { return memoryBuffer->buffer; }
@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <cstdlib>
 
+class CowImage;
+
 #define MEMORY_BUFFER_GRANULARITY (32 * 1024)
 
 #define MEMORY_BUFFER_MARK_DIRTY(buf, addr) \
@@ -31,4 +33,8 @@ bool memoryBufferGetSubBuffer(struct MemoryBuffer* memoryBuffer, struct MemoryBu
 
 void memoryBufferMarkRangeDirty(struct MemoryBuffer* memoryBuffer, size_t address, size_t size);
 
+// Replaces the contents with a copy-on-write instance of the image and clears the dirty pages,
+// so they track divergence from the image from now on. Sub buffers remain valid.
+bool memoryBufferLoadImage(struct MemoryBuffer* memoryBuffer, const CowImage& image);
+
 #endif  // _MEMORY_BACKBUFFER_H_
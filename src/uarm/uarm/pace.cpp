@@ -1,6 +1,7 @@
 #include "pace.h"
 
 #include <cstdlib>
+#include <mutex>
 
 #include "CPEndian.h"
 #include "CPU.h"
@@ -18,6 +19,10 @@
 
 #define SAVESTATE_VERSION 1
 
+#define INSTRUCTION_CACHE_BITS 12
+#define INSTRUCTION_MAX_WORDS 5
+#define CODE_GENERATION_BITS 12
+
 #ifdef __BIG_ENDIAN__
     #define HI_WORD(x) ((uint16_t*)(x))
     #define LO_WORD(x) ((uint16_t*)(x) + 1)
@@ -33,22 +38,42 @@ namespace {
     cpuop_func* cpufunctbl[65536];  // (normally in newcpu.c)
 #endif
 
-    struct ArmMem* mem = nullptr;
+    // Emulator instances are confined to a thread, so all PACE state is thread local. The
+    // opcode table is immutable once initialized and shared.
+    thread_local struct ArmMem* mem = nullptr;
 
-    union {
+    thread_local union {
         struct ArmMpu* mpu{nullptr};
         struct ArmMmu* mmu;
     } memorySystem;
 
-    uint8_t memorySystemKind = ARM_MEMORY_SYSTEM_MMU;
-
-    uint_fast8_t fsr = 0;
-    uint32_t lastAddr = 0;
-    bool wasWrite = false;
-
-    uint32_t pendingStatus = 0;
-    uint32_t statePtr;
-    bool priviledged = false;
+    thread_local uint8_t memorySystemKind = ARM_MEMORY_SYSTEM_MMU;
+
+    thread_local uint_fast8_t fsr = 0;
+    thread_local uint32_t lastAddr = 0;
+    thread_local bool wasWrite = false;
+
+    thread_local uint32_t pendingStatus = 0;
+    thread_local uint32_t statePtr;
+    thread_local bool priviledged = false;
+
+    // Instructions are cached together with their extension words, keyed by PC. Entries are
+    // validated against the generation of the physical 1k page they were fetched from, which is
+    // bumped if the page is written to.
+    struct CachedInstruction {
+        uint32_t pc;
+        uint32_t revision;
+        uint32_t generation;
+        uint16_t generationIndex;
+        uint16_t size;
+        uint16_t words[INSTRUCTION_MAX_WORDS];
+    };
+
+    thread_local CachedInstruction instructionCache[1 << INSTRUCTION_CACHE_BITS];
+    thread_local CachedInstruction uncachedInstruction;
+    thread_local uint32_t instructionCacheRevision = 1;
+    thread_local uint32_t instructionCacheMmuFlushCount = 0;
+    thread_local uint32_t codeGenerations[1 << CODE_GENERATION_BITS];
 
     template <int size>
     uint32_t pace_get_le(uint32_t addr) {
@@ -240,11 +265,31 @@ namespace {
         }
     }
 
+    void invalidateInstructionCache() {
+        instructionCacheRevision++;
+
+        if (instructionCacheRevision == 0) {
+            instructionCacheRevision = 1;
+            for (auto& instruction : instructionCache) instruction.revision = 0;
+        }
+    }
+
+    void codeWritten(void*, uint32_t pa) {
+        codeGenerations[(pa >> 10) & ~(0xffffffff << CODE_GENERATION_BITS)]++;
+    }
+
+    uint32_t translatePc(uint32_t pc) {
+        if (memorySystemKind == ARM_MEMORY_SYSTEM_MPU) return pc;
+
+        return MMU_TRANSLATE_RESULT_PA(mmuTranslate(memorySystem.mmu, pc, priviledged, false));
+    }
 }  // namespace
 
 // The following functions are called by UAE
 extern "C" {
 
+__thread struct pace_prefetch pace_prefetch = {0, 0, nullptr};
+
 uint8_t uae_get8(uint32_t addr) { return pace_get_le<1>(addr); }
 
 uint16_t uae_get16(uint32_t addr) {
@@ -337,10 +382,7 @@ unsigned long op_line1010(uint32_t opcode) REGPARAM {
 void notifiyReturn() { pendingStatus = pace_status_return; }
 }
 
-static void staticInit() {
-    static bool initialized = false;
-    if (initialized) return;
-
+static void initStaticTables() {
     int i, j;
     for (i = 0; i < 256; i++) {
         for (j = 0; j < 8; j++) {
@@ -415,14 +457,20 @@ static void staticInit() {
 
     // (hey readcpu doesn't free this guy!)
     free(table68k);
+}
 
-    initialized = true;
+static void staticInit() {
+    static std::once_flag initialized;
+    std::call_once(initialized, initStaticTables);
 }
 
 void paceInit(struct ArmMem* _mem, struct ArmMmu* mmu) {
     staticInit();
     mem = _mem;
 
+    memAddCodeWriteHandler(mem, codeWritten, nullptr);
+    invalidateInstructionCache();
+
     memorySystemKind = ARM_MEMORY_SYSTEM_MMU;
     memorySystem.mmu = mmu;
 }
@@ -431,6 +479,9 @@ void paceInit(struct ArmMem* _mem, struct ArmMpu* mpu) {
     staticInit();
     mem = _mem;
 
+    memAddCodeWriteHandler(mem, codeWritten, nullptr);
+    invalidateInstructionCache();
+
     memorySystemKind = ARM_MEMORY_SYSTEM_MPU;
     memorySystem.mpu = mpu;
 }
@@ -513,7 +564,7 @@ void pacePush32(uint32_t value) {
 }
 
 bool paceLoad68kState() {
-    static uint32_t stateScratchBuffer[19];
+    thread_local uint32_t stateScratchBuffer[19];
 
     uint8_t* state = (sizeof(struct regstruct) == sizeof(stateScratchBuffer))
                          ? (uint8_t*)&regs
@@ -550,7 +601,7 @@ bool paceLoad68kState() {
 }
 
 bool paceSave68kState() {
-    static uint32_t stateScratchBuffer[19];
+    thread_local uint32_t stateScratchBuffer[19];
     uint8_t* state;
 
     MakeSR();
@@ -614,14 +665,70 @@ void paceSetAreg(uint8_t index, uint32_t value) { m68k_areg(regs, index) = value
 
 void paceSetPriviledged(bool _priviledged) { priviledged = _priviledged; }
 
+static const CachedInstruction* paceFetchInstruction(uint32_t pc) {
+    if (memorySystemKind == ARM_MEMORY_SYSTEM_MMU &&
+        mmuGetFlushCount(memorySystem.mmu) != instructionCacheMmuFlushCount) {
+        instructionCacheMmuFlushCount = mmuGetFlushCount(memorySystem.mmu);
+        invalidateInstructionCache();
+    }
+
+    CachedInstruction* instruction =
+        instructionCache + ((pc >> 1) & ~(0xffffffff << INSTRUCTION_CACHE_BITS));
+
+    if (instruction->pc == pc && instruction->revision == instructionCacheRevision &&
+        instruction->generation == codeGenerations[instruction->generationIndex])
+        return instruction;
+
+    // This takes care of translation, permissions and alignment
+    const uint16_t opcode = uae_get16(pc);
+    if (fsr != 0) return nullptr;
+
+    const uint32_t pa = translatePc(pc);
+
+    if (!memWatchCodePage(mem, pa)) {
+        uncachedInstruction.words[0] = opcode;
+        uncachedInstruction.size = 2;
+
+        return &uncachedInstruction;
+    }
+
+    instruction->pc = pc;
+    instruction->revision = instructionCacheRevision;
+    instruction->generationIndex = (pa >> 10) & ~(0xffffffff << CODE_GENERATION_BITS);
+    instruction->generation = codeGenerations[instruction->generationIndex];
+    instruction->words[0] = opcode;
+    instruction->size = 2;
+
+    // Prefetch extension words from the same page, they share translation and permissions
+    while (instruction->size < 2 * INSTRUCTION_MAX_WORDS &&
+           ((pa + instruction->size) & 0x3ff) != 0) {
+        uint16_t word;
+        if (!memAccess<2, false>(mem, pa + instruction->size, &word)) break;
+
+        instruction->words[instruction->size >> 1] = htobe16(word);
+        instruction->size += 2;
+    }
+
+    return instruction;
+}
+
 enum paceStatus paceExecute() {
     fsr = 0;
     pendingStatus = pace_status_ok;
 
-    uint16_t opcode = uae_get16(regs.pc);
+    const CachedInstruction* instruction = paceFetchInstruction(regs.pc);
+
+    if (!instruction) {
+        regs.lastOpcode = 0;
+        return pace_status_memory_fault;
+    }
+
+    const uint16_t opcode = instruction->words[0];
     regs.lastOpcode = opcode;
 
-    if (fsr != 0) return pace_status_memory_fault;
+    pace_prefetch.pc = regs.pc;
+    pace_prefetch.size = instruction->size;
+    pace_prefetch.words = instruction->words;
 
     // fprintf(stderr, "execute m68k opcode %#06x at %#010x\n", opcode, regs.pc);
 
@@ -631,6 +738,8 @@ enum paceStatus paceExecute() {
     cpufunctbl[opcode](opcode);
 #endif
 
+    pace_prefetch.size = 0;
+
     //    fprintf(stderr, "a7 now %#010x, top of stack is %#010x\n", m68k_areg(regs, 7),
     //            uae_get32(m68k_areg(regs, 7)));
 
@@ -658,6 +767,8 @@ void paceLoad(T& loader) {
     paceDoSaveLoad(helper, version);
 
     MakeFromSR();
+
+    invalidateInstructionCache();
 }
 
 template <typename T>
@@ -3,7 +3,7 @@
 #include "pace.h"
 #include "syscall_68k.h"
 
-static bool patchNVFS = false;
+static thread_local bool patchNVFS = false;
 
 void patch68kInit(uint32_t patches) { patchNVFS = (patches & PATCH_68K_NVFS) != 0; }
 
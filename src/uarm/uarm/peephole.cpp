@@ -1,7 +1,8 @@
 #include "peephole.h"
 
 #include <cstdio>
-#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace {
     const uint32_t sig_adc_udivmod_first[] = {
@@ -43,58 +44,141 @@ namespace {
         0xE8BD4010, 0xE1B0CF02, 0x24913004, 0x24803004, 0x012FFF1E, 0xE1B02F82, 0x44D12001,
         0x24D13001, 0x24D1C001, 0x44C02001, 0x24C03001, 0x24C0C001, 0xE12FFF1E};
 
-    void optimizeAt_ADC_udivmod(uint32_t* code, size_t size) {
-        if (size < sizeof(sig_adc_udivmod_first) + sizeof(sig_adc_udivmod_second) + 4) return;
+    // A signature word matches if (word & mask) == value
+    struct SignatureWord {
+        uint32_t value;
+        uint32_t mask;
+    };
+
+    struct Signature {
+        const char* name;
+        uint32_t replacement;
+        std::vector<SignatureWord> words;
+    };
+
+    class SignatureBuilder {
+       public:
+        SignatureBuilder(const char* name, uint32_t replacement) {
+            signature.name = name;
+            signature.replacement = replacement;
+        }
+
+        template <size_t N>
+        SignatureBuilder& Words(const uint32_t (&words)[N]) {
+            for (uint32_t word : words) signature.words.push_back({word, 0xffffffff});
+
+            return *this;
+        }
+
+        SignatureBuilder& Masked(uint32_t value, uint32_t mask) {
+            signature.words.push_back({value, mask});
+
+            return *this;
+        }
+
+        Signature Build() { return signature; }
+
+       private:
+        Signature signature;
+    };
+
+    // The first two words of every signature are matched exactly and key the prefix table. A new
+    // routine needs a replacement opcode in peephole.h and a handler in cpuPrvDecoderArm in
+    // CPU.cpp. Only register code that has been taken verbatim from shipped binaries.
+    class SignatureTable {
+       public:
+        SignatureTable() {
+            Add(SignatureBuilder("ADS udivmod", INSTR_PEEPHOLE_ADS_UDIVMOD)
+                    .Words(sig_adc_udivmod_first)
+                    .Masked(0x2a000000, 0xff000000)
+                    .Words(sig_adc_udivmod_second)
+                    .Build());
+
+            Add(SignatureBuilder("ADS sdivmod", INSTR_PEEPHOLE_ADS_SDIVMOD)
+                    .Words(sig_adc_sdivmod_first)
+                    .Masked(0x2a000000, 0xff000000)
+                    .Words(sig_adc_sdivmod_second)
+                    .Build());
+
+            Add(SignatureBuilder("ADS udiv10", INSTR_PEEPHOLE_ADS_UDIV10)
+                    .Words(sig_adc_udiv10)
+                    .Build());
+
+            Add(SignatureBuilder("ADS sdiv10", INSTR_PEEPHOLE_ADS_SDIV10)
+                    .Words(sig_adc_sdiv10)
+                    .Build());
+
+            Add(SignatureBuilder("ADS memcpy", INSTR_PEEPHOLE_ADS_MEMCPY)
+                    .Words(sig_adc_memcpy)
+                    .Build());
+        }
+
+        bool IsCandidate(uint32_t first, uint32_t second) const {
+            return buckets[Hash(first, second)].size() > 0;
+        }
+
+        uint32_t Match(const uint32_t* code, size_t words) const {
+            if (words < 2) return 0;
+
+            for (const Signature* signature : buckets[Hash(code[0], code[1])]) {
+                if (signature->words.size() > words) continue;
+
+                bool matches = true;
+                for (size_t i = 0; i < signature->words.size() && matches; i++)
+                    matches = (code[i] & signature->words[i].mask) == signature->words[i].value;
+
+                if (matches) return signature->replacement;
+            }
+
+            return 0;
+        }
+
+       private:
+        static constexpr size_t BUCKET_BITS = 8;
+
+        static size_t Hash(uint32_t first, uint32_t second) {
+            return ((first ^ (second * 0x9e3779b1)) * 0x85ebca6b) >> (32 - BUCKET_BITS);
+        }
+
+        void Add(Signature signature) {
+            if (signature.words.size() > PEEPHOLE_MAX_SIGNATURE_WORDS ||
+                signature.words.size() < 2 || signature.words[0].mask != 0xffffffff ||
+                signature.words[1].mask != 0xffffffff) {
+                fprintf(stderr, "peephole: invalid signature %s\n", signature.name);
+                return;
+            }
+
+            signatures.push_back(std::make_unique<Signature>(std::move(signature)));
+
+            const Signature* s = signatures.back().get();
+            buckets[Hash(s->words[0].value, s->words[1].value)].push_back(s);
+        }
+
+        std::vector<std::unique_ptr<Signature>> signatures;
+        std::vector<const Signature*> buckets[1 << BUCKET_BITS];
+    };
+
+    const SignatureTable& signatureTable() {
+        static const SignatureTable table;
 
-        if (memcmp(code, sig_adc_udivmod_first, sizeof(sig_adc_udivmod_first)) != 0) return;
-        if ((code[sizeof(sig_adc_udivmod_first) / 4] >> 24) != 0x2a) return;
-        if (memcmp(code + sizeof(sig_adc_udivmod_first) / 4 + 1, sig_adc_udivmod_second,
-                   sizeof(sig_adc_udivmod_second)) != 0)
-            return;
-
-        *code = INSTR_PEEPHOLE_ADS_UDIVMOD;
-    }
-
-    void optimizeAt_ADC_sdivmod(uint32_t* code, size_t size) {
-        if (size < sizeof(sig_adc_sdivmod_first) + sizeof(sig_adc_sdivmod_second) + 4) return;
-
-        if (memcmp(code, sig_adc_sdivmod_first, sizeof(sig_adc_sdivmod_first)) != 0) return;
-        if ((code[sizeof(sig_adc_sdivmod_first) / 4] >> 24) != 0x2a) return;
-        if (memcmp(code + sizeof(sig_adc_sdivmod_first) / 4 + 1, sig_adc_sdivmod_second,
-                   sizeof(sig_adc_sdivmod_second)) != 0)
-            return;
-
-        *code = INSTR_PEEPHOLE_ADS_SDIVMOD;
-    }
-
-    void optimizeAt_ADC_udiv10(uint32_t* code, size_t size) {
-        if (size < sizeof(sig_adc_udiv10)) return;
-        if (memcmp(code, sig_adc_udiv10, sizeof(sig_adc_udiv10)) != 0) return;
-
-        *code = INSTR_PEEPHOLE_ADS_UDIV10;
-    }
-
-    void optimizeAt_ADC_sdiv10(uint32_t* code, size_t size) {
-        if (size < sizeof(sig_adc_sdiv10)) return;
-        if (memcmp(code, sig_adc_sdiv10, sizeof(sig_adc_sdiv10)) != 0) return;
-
-        *code = INSTR_PEEPHOLE_ADS_SDIV10;
+        return table;
     }
+}  // namespace
 
-    void optimizeAt_ADC_memcpy(uint32_t* code, size_t size) {
-        if (size < sizeof(sig_adc_memcpy)) return;
-        if (memcmp(code, sig_adc_memcpy, sizeof(sig_adc_memcpy)) != 0) return;
+bool peepholeIsCandidate(uint32_t first, uint32_t second) {
+    return signatureTable().IsCandidate(first, second);
+}
 
-        *code = INSTR_PEEPHOLE_ADS_MEMCPY;
-    }
-}  // namespace
+uint32_t peepholeMatch(const uint32_t* code, size_t size) {
+    return signatureTable().Match(code, size >> 2);
+}
 
 void peepholeOptimize(uint32_t* code, size_t size) {
+    const SignatureTable& table = signatureTable();
+
     for (size = size & ~0x03; size > 0; size -= 4, code++) {
-        optimizeAt_ADC_udivmod(code, size);
-        optimizeAt_ADC_sdivmod(code, size);
-        optimizeAt_ADC_udiv10(code, size);
-        optimizeAt_ADC_sdiv10(code, size);
-        optimizeAt_ADC_memcpy(code, size);
+        const uint32_t replacement = table.Match(code, size >> 2);
+
+        if (replacement) *code = replacement;
     }
 }
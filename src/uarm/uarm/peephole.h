@@ -13,6 +13,16 @@
 #define FIRST_INSTRUCTION_ADS_UDIVMOD 0xE3A02000
 #define FIRST_INSTRUCTION_ADS_SDIVMOD 0xE2102480
 
+// Signatures never span more than this number of words
+#define PEEPHOLE_MAX_SIGNATURE_WORDS 64
+
+// Replace the first word of every recognized routine in place
 void peepholeOptimize(uint32_t* code, size_t size);
 
+// Cheap prefilter: can a signature start with these two words?
+bool peepholeIsCandidate(uint32_t first, uint32_t second);
+
+// Returns the replacement instruction if a signature matches at code, 0 otherwise
+uint32_t peepholeMatch(const uint32_t* code, size_t size);
+
 #endif  // _PEEPHOLE_H_
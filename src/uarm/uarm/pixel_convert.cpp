@@ -0,0 +1,161 @@
+#include "pixel_convert.h"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    #include <immintrin.h>
+
+    #define PIXEL_CONVERT_AVX2
+#endif
+
+namespace {
+    inline uint32_t unpackRgb565(uint16_t rgb16) {
+        uint8_t r = (rgb16 >> 11) & 0x1f;
+        uint8_t g = (rgb16 >> 5) & 0x3f;
+        uint8_t b = (rgb16 >> 0) & 0x1f;
+
+        r = (r << 3) | (r >> 2);
+        g = (g << 2) | (g >> 4);
+        b = (b << 3) | (b >> 2);
+
+        return 0xff000000 | (b << 16) | (g << 8) | r;
+    }
+
+    void convertRgb565Scalar(uint32_t* dest, const uint16_t* src, uint32_t count) {
+        while (count--) *(dest++) = unpackRgb565(*(src++));
+    }
+
+    // The vector kernels work on 16 bit lanes: the low half of each output pixel holds R and G,
+    // the high half B and alpha. Interleaving both halves yields the final pixels.
+
+#if defined(__SSE2__)
+    void convertRgb565Sse2(uint32_t* dest, const uint16_t* src, uint32_t count) {
+        const __m128i maskR = _mm_set1_epi16(0x00f8);
+        const __m128i maskGHi = _mm_set1_epi16(static_cast<short>(0xfc00));
+        const __m128i maskGLo = _mm_set1_epi16(0x0300);
+        const __m128i maskBLo = _mm_set1_epi16(0x0007);
+        const __m128i alpha = _mm_set1_epi16(static_cast<short>(0xff00));
+
+        for (; count >= 8; count -= 8, src += 8, dest += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+            const __m128i rg = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 8), maskR), _mm_srli_epi16(v, 13)),
+                _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 5), maskGHi),
+                             _mm_and_si128(_mm_srli_epi16(v, 1), maskGLo)));
+
+            const __m128i ba = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 3), maskR),
+                             _mm_and_si128(_mm_srli_epi16(v, 2), maskBLo)),
+                alpha);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), _mm_unpackhi_epi16(rg, ba));
+        }
+
+        convertRgb565Scalar(dest, src, count);
+    }
+#endif
+
+#ifdef PIXEL_CONVERT_AVX2
+    __attribute__((target("avx2"))) void convertRgb565Avx2(uint32_t* dest, const uint16_t* src,
+                                                           uint32_t count) {
+        const __m256i maskR = _mm256_set1_epi16(0x00f8);
+        const __m256i maskGHi = _mm256_set1_epi16(static_cast<short>(0xfc00));
+        const __m256i maskGLo = _mm256_set1_epi16(0x0300);
+        const __m256i maskBLo = _mm256_set1_epi16(0x0007);
+        const __m256i alpha = _mm256_set1_epi16(static_cast<short>(0xff00));
+
+        for (; count >= 16; count -= 16, src += 16, dest += 16) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+
+            const __m256i rg = _mm256_or_si256(
+                _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(v, 8), maskR),
+                                _mm256_srli_epi16(v, 13)),
+                _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(v, 5), maskGHi),
+                                _mm256_and_si256(_mm256_srli_epi16(v, 1), maskGLo)));
+
+            const __m256i ba = _mm256_or_si256(
+                _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(v, 3), maskR),
+                                _mm256_and_si256(_mm256_srli_epi16(v, 2), maskBLo)),
+                alpha);
+
+            // Unpacking works within 128 bit lanes, so the halves need to be put back in order
+            const __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+            const __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest),
+                                _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 8),
+                                _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+
+        convertRgb565Scalar(dest, src, count);
+    }
+#endif
+
+    using ConvertRgb565F = void (*)(uint32_t*, const uint16_t*, uint32_t);
+
+    ConvertRgb565F selectConvertRgb565() {
+#ifdef PIXEL_CONVERT_AVX2
+        // This runs during static initialization, possibly before libgcc has probed the CPU
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return convertRgb565Avx2;
+#endif
+
+#if defined(__SSE2__)
+        return convertRgb565Sse2;
+#else
+        return convertRgb565Scalar;
+#endif
+    }
+
+    const ConvertRgb565F convertRgb565 = selectConvertRgb565();
+
+    // Palette lookups are gathers and do not vectorize profitably without AVX512, so the
+    // indexed kernels are unrolled per source byte instead.
+    template <int bpp>
+    void convertIndexed(uint32_t* dest, const uint8_t* src, uint32_t count,
+                        const uint32_t* palette) {
+        constexpr uint32_t pixelsPerByte = 8 / bpp;
+        constexpr uint32_t mask = (1 << bpp) - 1;
+
+        for (; count >= pixelsPerByte; count -= pixelsPerByte) {
+            const uint32_t byte = *(src++);
+
+            for (uint32_t i = 0; i < pixelsPerByte; i++)
+                *(dest++) = palette[(byte >> (i * bpp)) & mask];
+        }
+
+        if (count == 0) return;
+
+        const uint32_t byte = *src;
+        for (uint32_t i = 0; i < count; i++) *(dest++) = palette[(byte >> (i * bpp)) & mask];
+    }
+}  // namespace
+
+void pixelConvertRgb565(uint32_t* dest, const uint16_t* src, uint32_t count) {
+    convertRgb565(dest, src, count);
+}
+
+void pixelConvertIndexed(uint32_t* dest, const uint8_t* src, uint32_t count, uint8_t bpp,
+                         const uint32_t* palette) {
+    switch (bpp) {
+        case 1:
+            return convertIndexed<1>(dest, src, count, palette);
+
+        case 2:
+            return convertIndexed<2>(dest, src, count, palette);
+
+        case 4:
+            return convertIndexed<4>(dest, src, count, palette);
+
+        case 8:
+            return convertIndexed<8>(dest, src, count, palette);
+
+        default:
+            break;
+    }
+}
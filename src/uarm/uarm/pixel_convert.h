@@ -0,0 +1,16 @@
+#ifndef _PIXEL_CONVERT_H_
+#define _PIXEL_CONVERT_H_
+
+#include <cstdint>
+
+// Line conversion from guest framebuffer formats to host pixels (0xAABBGGRR). Source data is
+// little endian, indexed pixels are packed starting with the least significant bits of each byte.
+
+// Expand count RGB565 pixels. Uses SSE2 or AVX2 where available.
+void pixelConvertRgb565(uint32_t* dest, const uint16_t* src, uint32_t count);
+
+// Expand count palette indices with 1, 2, 4 or 8 bits per pixel.
+void pixelConvertIndexed(uint32_t* dest, const uint8_t* src, uint32_t count, uint8_t bpp,
+                         const uint32_t* palette);
+
+#endif  // _PIXEL_CONVERT_H_
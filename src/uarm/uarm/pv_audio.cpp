@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 
@@ -112,15 +113,32 @@ void pvAudioPullSamples(PvAudio* audio, uint32_t count) {
                                        audio->ram, audio->bufferBase, audio->bufferLength))
                                  : nullptr;
     if (!sampleBuffer) {
-        for (uint32_t i = 0; i < count; i++) audioQueuePush(audio->queue, 0);
+        static const uint32_t silence[256] = {0};
+
+        while (count > 0) {
+            const uint32_t span = std::min(count, static_cast<uint32_t>(sizeof(silence) >> 2));
+
+            audioQueuePushBulk(audio->queue, silence, span);
+            count -= span;
+        }
+
         return;
     }
 
     const uint32_t bufferLengthSamples = audio->bufferLength >> 2;
     const uint32_t bufferLengthSamplesHalf = bufferLengthSamples >> 1;
 
-    for (uint32_t i = 0; i < count; i++) {
-        audioQueuePush(audio->queue, sampleBuffer[audio->offset++]);
+    // Push contiguous spans up to the next half / full buffer boundary at once
+    while (count > 0) {
+        const uint32_t boundary = audio->offset < bufferLengthSamplesHalf
+                                      ? bufferLengthSamplesHalf
+                                      : bufferLengthSamples;
+        const uint32_t span = std::min(count, boundary - audio->offset);
+
+        if (audio->queue) audioQueuePushBulk(audio->queue, sampleBuffer + audio->offset, span);
+
+        audio->offset += span;
+        count -= span;
 
         if (audio->offset == bufferLengthSamplesHalf) {
             pvIcInt(audio->ic, IRQ_NO_SOUND_HALF, true);
@@ -3,12 +3,12 @@
 #include <cstdio>
 
 #include "CPEndian.h"
-#include "Nibbler.h"
 #include "RAM.h"
 #include "cputil.h"
 #include "mem.h"
 #include "memory_buffer.h"
 #include "miniz.h"
+#include "pixel_convert.h"
 #include "savestate/savestateAll.h"
 
 #define DISPLAY_BASE 0x30000200
@@ -43,18 +43,6 @@ struct PvDisplay {
     }
 };
 
-static uint32_t unpack_rgb16(uint16_t rgb16) {
-    uint8_t r = (rgb16 >> 11) & 0x1f;
-    uint8_t g = (rgb16 >> 5) & 0x3f;
-    uint8_t b = (rgb16 >> 0) & 0x1f;
-
-    r = (r << 3) | (r >> 2);
-    g = (g << 2) | (g >> 4);
-    b = (b << 3) | (b >> 2);
-
-    return 0xff000000 | (b << 16) | (g << 8) | r;
-}
-
 static void updateFramebufferLocation(PvDisplay* display) {
     if (display->base > RAM_BASE && display->stride > 0) {
         ramSetFramebuffer(display->ram, display->base, display->stride * display->height);
@@ -156,82 +144,29 @@ PvDisplay* pvDisplayInit(ArmMem* mem, ArmRam* ram, MemoryBuffer* bufferClut, uin
     return display;
 }
 
-template <int bpp>
-static bool pvDisplayRenderFramebufferIndexed(PvDisplay* display, uint32_t* target) {
-    auto framebuffer = reinterpret_cast<uint8_t*>(
-        ramResolveAddress(display->ram, display->base, display->stride * display->height));
-    if (!framebuffer) return false;
-
-    const auto clut = reinterpret_cast<uint32_t*>(display->bufferClut->buffer);
+bool pvDisplayRenderFramebuffer(PvDisplay* display, uint32_t* target) {
+    if (display->base == 0 || display->stride == 0 || display->depth > 4) return false;
 
+    const uint32_t bpp = 1 << display->depth;
     const uint32_t lineBytes = (display->width * bpp) / 8;
-    if (lineBytes < display->stride) return false;
+    if (lineBytes > display->stride) return false;
+    if (bpp == 16 && display->stride & 0x01) return false;
 
-    const uint32_t pitchDelta = display->stride - lineBytes;
+    auto framebuffer = reinterpret_cast<const uint8_t*>(
+        ramResolveAddress(display->ram, display->base, display->stride * display->height));
+    if (!framebuffer) return false;
 
-    Nibbler<bpp, false, true> nibbler;
-    if constexpr (bpp != 8) {
-        nibbler.reset(framebuffer, 0);
-    }
+    const auto clut = reinterpret_cast<const uint32_t*>(display->bufferClut->buffer);
 
     for (uint32_t y = 0; y < display->height; y++) {
-        for (uint32_t x = 0; x < display->width; x++) {
-            if constexpr (bpp != 8) {
-                *(target++) = clut[nibbler.nibble()];
-            } else {
-                *(target++) = clut[*(framebuffer++)];
-            }
-        }
-
-        if constexpr (bpp != 8) {
-            nibbler.skipBytes(pitchDelta);
-        } else {
-            framebuffer += pitchDelta;
-        }
-    }
-
-    return true;
-}
-
-bool pvDisplayRenderFramebuffer(PvDisplay* display, uint32_t* target) {
-    if (display->base == 0 || display->stride == 0) return false;
-
-    switch (display->depth) {
-        case 0:
-            return pvDisplayRenderFramebufferIndexed<1>(display, target);
-
-        case 1:
-            return pvDisplayRenderFramebufferIndexed<2>(display, target);
-
-        case 2:
-            return pvDisplayRenderFramebufferIndexed<4>(display, target);
-
-        case 3:
-            return pvDisplayRenderFramebufferIndexed<8>(display, target);
-
-        case 4: {
-            const uint32_t lineBytes = display->width << 1;
-            if (lineBytes < display->stride || display->stride & 0x01) return false;
-
-            const uint32_t pitchDelta = (display->stride - lineBytes) >> 1;
-
-            auto framebuffer = reinterpret_cast<uint16_t*>(
-                ramResolveAddress(display->ram, display->base, display->stride * display->height));
-            if (!framebuffer) return false;
-
-            for (uint32_t y = 0; y < display->height; y++) {
-                for (uint32_t x = 0; x < display->width; x++) {
-                    *(target++) = unpack_rgb16(*(framebuffer++));
-                }
-
-                framebuffer += pitchDelta;
-            }
-
-            break;
-        }
-
-        default:
-            break;
+        if (bpp == 16)
+            pixelConvertRgb565(target, reinterpret_cast<const uint16_t*>(framebuffer),
+                               display->width);
+        else
+            pixelConvertIndexed(target, framebuffer, display->width, bpp, clut);
+
+        framebuffer += display->stride;
+        target += display->width;
     }
 
     return true;
@@ -2,6 +2,7 @@
 
 #include "pxa_LCD.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -11,6 +12,7 @@
 #include "cputil.h"
 #include "mem.h"
 #include "memory_buffer.h"
+#include "pixel_convert.h"
 #include "pxa_IC.h"
 #include "savestate/savestateAll.h"
 
@@ -54,6 +56,8 @@ struct PxaLcd {
 
     uint32_t i_pixel;
     bool frame_pending;
+    uint32_t damageFirstLine;
+    uint32_t damageLastLine;
 
     uint32_t frameNum;
 
@@ -61,6 +65,7 @@ struct PxaLcd {
     uint32_t framebufferSize;
     uint8_t framebufferBpp;
     bool framebufferDirty;
+    bool framebufferFullRedraw;
     bool framebufferTrackingActive;
 
     template <typename T>
@@ -350,7 +355,58 @@ static void pxaLcdUpdatePalette(struct PxaLcd *lcd, int32_t len) {
         if (dirty) *entry_mapped = unpack_rgb16(*entry);
     }
 
-    if (dirty) lcd->soc->SetFramebufferDirty();
+    if (dirty) {
+        lcd->framebufferFullRedraw = true;
+        lcd->soc->SetFramebufferDirty();
+    }
+}
+
+// Expands one word of framebuffer data into up to 32 pixels and returns the pixel count
+static uint32_t pxaLcdPrvConvertWord(struct PxaLcd *lcd, uint32_t word, uint8_t bpp,
+                                     uint32_t *pixels) {
+    switch (bpp) {
+        case 0:  // 1BPP
+            for (uint32_t i = 0; i < 32; i++) pixels[i] = lcd->palette_mapped[(word >> i) & 1];
+            return 32;
+
+        case 1:  // 2BPP
+            for (uint32_t i = 0; i < 16; i++) pixels[i] = lcd->palette_mapped[(word >> 2 * i) & 3];
+            return 16;
+
+        case 2:  // 4BPP
+            for (uint32_t i = 0; i < 8; i++) pixels[i] = lcd->palette_mapped[(word >> 4 * i) & 15];
+            return 8;
+
+        case 3:  // 8BPP
+            for (uint32_t i = 0; i < 4; i++)
+                pixels[i] = lcd->palette_mapped[(word >> 8 * i) & 0xff];
+            return 4;
+
+        case 4:  // 16BPP
+            pixels[0] = unpack_rgb16(word);
+            pixels[1] = unpack_rgb16(word >> 16);
+            return 2;
+
+        default:
+            return 0;  // BAD
+    }
+}
+
+// Converts len bytes of framebuffer data. Data in RAM is read directly from host memory.
+static void pxaLcdPrvConvert(struct PxaLcd *lcd, uint32_t addr, uint32_t len, uint8_t bpp,
+                             uint32_t *target) {
+    len &= ~3u;
+
+    const void *data = bpp <= 4 ? lcd->soc->ResolveFramebuffer(addr, len) : nullptr;
+
+    if (data && bpp == 4)
+        pixelConvertRgb565(target, (const uint16_t *)data, len >> 1);
+    else if (data)
+        pixelConvertIndexed(target, (const uint8_t *)data, (len << 3) >> bpp, 1 << bpp,
+                            lcd->palette_mapped);
+    else
+        for (len /= 4; len--; addr += 4)
+            target += pxaLcdPrvConvertWord(lcd, pxaLcdPrvGetWord(lcd, addr), bpp, target);
 }
 
 static void pxaLcdPrvScreenDataPixel(struct PxaLcd *lcd, uint32_t color) {
@@ -359,6 +415,8 @@ static void pxaLcdPrvScreenDataPixel(struct PxaLcd *lcd, uint32_t color) {
     if (lcd->i_pixel == lcd->width * lcd->height) {
         lcd->i_pixel = 0;
         lcd->frame_pending = true;
+        lcd->damageFirstLine = 0;
+        lcd->damageLastLine = lcd->height - 1;
 
         uint32_t *front_buffer = lcd->front_buffer;
         lcd->front_buffer = lcd->back_buffer;
@@ -366,15 +424,65 @@ static void pxaLcdPrvScreenDataPixel(struct PxaLcd *lcd, uint32_t color) {
     }
 }
 
+static void pxaLcdPrvAddDamage(struct PxaLcd *lcd, uint32_t firstLine, uint32_t lastLine) {
+    if (lcd->frame_pending) {
+        lcd->damageFirstLine = std::min(lcd->damageFirstLine, firstLine);
+        lcd->damageLastLine = std::max(lcd->damageLastLine, lastLine);
+    } else {
+        lcd->damageFirstLine = firstLine;
+        lcd->damageLastLine = lastLine;
+    }
+
+    lcd->frame_pending = true;
+}
+
+// The framebuffer is tracked and matches the screen. Only lines that overlap written 1k pages
+// are converted, in place into the front buffer.
+static void pxaLcdPrvScreenDataDamaged(struct PxaLcd *lcd, uint32_t addr, uint32_t len,
+                                       uint8_t bpp) {
+    const uint32_t stride = len / lcd->height;
+    const struct Buffer damage = lcd->soc->GetFramebufferDamage();
+    const uint32_t *damageWords = (const uint32_t *)damage.data;
+
+    uint32_t firstLine = lcd->height, lastLine = 0;
+    uint32_t nextLine = 0;
+
+    for (uint32_t word = 0; word < damage.size / 4; word++) {
+        if (damageWords[word] == 0) continue;
+
+        for (uint32_t bit = 0; bit < 32; bit++) {
+            if (!(damageWords[word] & (1u << bit))) continue;
+
+            const uint32_t page = word * 32 + bit;
+            const uint32_t pageFirstLine = std::max((page << 10) / stride, nextLine);
+            const uint32_t pageLastLine = std::min((((page + 1) << 10) - 1) / stride,
+                                                   (uint32_t)lcd->height - 1);
+
+            if (pageFirstLine > pageLastLine) continue;
+
+            // Lines are contiguous, so the range converts in one go
+            pxaLcdPrvConvert(lcd, addr + pageFirstLine * stride,
+                             (pageLastLine - pageFirstLine + 1) * stride, bpp,
+                             lcd->front_buffer + pageFirstLine * lcd->width);
+
+            firstLine = std::min(firstLine, pageFirstLine);
+            lastLine = pageLastLine;
+            nextLine = pageLastLine + 1;
+        }
+    }
+
+    if (firstLine <= lastLine) pxaLcdPrvAddDamage(lcd, firstLine, lastLine);
+}
+
 static void pxaLcdPrvScreenDataDma(struct PxaLcd *lcd, uint32_t addr /*PA*/, uint32_t len) {
-    uint8_t data[4];
-    uint32_t i, j;
+    uint32_t pixels[32];
     const uint8_t bpp = (lcd->lccr3 >> 24) & 7;
 
     if (addr != lcd->framebufferBase || len != lcd->framebufferSize || bpp != lcd->framebufferBpp) {
         lcd->framebufferBase = addr;
         lcd->framebufferSize = len;
         lcd->framebufferBpp = bpp;
+        lcd->framebufferFullRedraw = true;
 
         if (len == ((uint32_t)(lcd->width * lcd->height) << bpp) >> 3) {
             // fprintf(stderr, "framebuffer now at 0x%08x , size %u bytes, %d bpp\n", addr, len,
@@ -396,55 +504,38 @@ static void pxaLcdPrvScreenDataDma(struct PxaLcd *lcd, uint32_t addr /*PA*/, uin
 
     if (lcd->framebufferTrackingActive && !lcd->framebufferDirty) return;
 
-    len /= 4;
-    while (len--) {
-        pxaLcdPrvDma(lcd, data, addr, 4);
-        addr += 4;
-
-        switch (bpp) {
-            case 0:  // 1BPP
+    if (lcd->framebufferTrackingActive && !lcd->framebufferFullRedraw) {
+        pxaLcdPrvScreenDataDamaged(lcd, addr, len, bpp);
+    } else if (lcd->framebufferTrackingActive) {
+        pxaLcdPrvConvert(lcd, addr, len, bpp, lcd->back_buffer);
 
-                for (i = 0; i < 4; i++) {
-                    for (j = 0; j < 8; j++)
-                        pxaLcdPrvScreenDataPixel(lcd, lcd->palette_mapped[((data[i] >> j) & 1)]);
-                }
-                break;
-
-            case 1:  // 2BPP
-
-                for (i = 0; i < 4; i++) {
-                    for (j = 0; j < 8; j += 2)
-                        pxaLcdPrvScreenDataPixel(lcd, lcd->palette_mapped[((data[i] >> j) & 3)]);
-                }
-                break;
-
-            case 2:  // 4BPP
-
-                for (i = 0; i < 4; i++) {
-                    for (j = 0; j < 8; j += 4)
-                        pxaLcdPrvScreenDataPixel(lcd, lcd->palette_mapped[((data[i] >> j) & 15)]);
-                }
-                break;
-
-            case 3:  // 8BPP
-
-                for (i = 0; i < 4; i++) pxaLcdPrvScreenDataPixel(lcd, lcd->palette_mapped[data[i]]);
-
-                break;
-
-            case 4:  // 16BPP
+        uint32_t *front_buffer = lcd->front_buffer;
+        lcd->front_buffer = lcd->back_buffer;
+        lcd->back_buffer = front_buffer;
 
-                pxaLcdPrvScreenDataPixel(lcd, unpack_rgb16(*(uint16_t *)(&data[0])));
-                pxaLcdPrvScreenDataPixel(lcd, unpack_rgb16(*(uint16_t *)(&data[2])));
-                break;
+        lcd->frame_pending = true;
+        lcd->damageFirstLine = 0;
+        lcd->damageLastLine = lcd->height - 1;
+    } else {
+        // Segmented framebuffer: frames may span several DMA transfers. Transfers that do not
+        // complete the frame are converted in one go.
+        const uint32_t pixelCount = bpp <= 4 ? ((len & ~3u) << 3) >> bpp : 0;
 
-            default:
+        if (pixelCount > 0 && lcd->i_pixel + pixelCount < lcd->width * lcd->height) {
+            pxaLcdPrvConvert(lcd, addr, len, bpp, lcd->back_buffer + lcd->i_pixel);
+            lcd->i_pixel += pixelCount;
+        } else {
+            for (len /= 4; len--; addr += 4) {
+                const uint32_t count =
+                    pxaLcdPrvConvertWord(lcd, pxaLcdPrvGetWord(lcd, addr), bpp, pixels);
 
-                ;  // BAD
+                for (uint32_t i = 0; i < count; i++) pxaLcdPrvScreenDataPixel(lcd, pixels[i]);
+            }
         }
     }
 
     lcd->framebufferDirty = false;
+    lcd->framebufferFullRedraw = false;
     lcd->soc->ClearFramebufferDirty();
 }
 
@@ -455,6 +546,7 @@ void pxaLcdTick(struct PxaLcd *lcd) {
     if (lcd->enbChanged) {
         if (lcd->lccr0 & 0x0001) {  // just got enabled
             lcd->framebufferDirty = true;
+            lcd->framebufferFullRedraw = true;
             // TODO: perhaps check settings?
         } else {  // we just got quick disabled - kill current frame and do no more
 
@@ -530,10 +622,21 @@ uint32_t *pxaLcdGetPendingFrame(struct PxaLcd *lcd) {
     return lcd->frame_pending ? lcd->front_buffer : NULL;
 }
 
+void pxaLcdGetPendingFrameDamage(struct PxaLcd *lcd, uint32_t *firstLine,
+                                 uint32_t *lineCount) {
+    *firstLine = lcd->frame_pending ? lcd->damageFirstLine : 0;
+    *lineCount = lcd->frame_pending ? lcd->damageLastLine - lcd->damageFirstLine + 1 : 0;
+}
+
 void pxaLcdResetPendingFrame(struct PxaLcd *lcd) { lcd->frame_pending = false; }
 
 void pxaLcdSetFramebufferDirty(struct PxaLcd *lcd) { lcd->framebufferDirty = true; }
 
+void pxaLcdRedrawFramebuffer(struct PxaLcd *lcd) {
+    lcd->framebufferDirty = true;
+    lcd->framebufferFullRedraw = true;
+}
+
 bool pxaLcdIsEnabled(struct PxaLcd *lcd) { return lcd->lccr0 & 0x0001; }
 
 struct PxaLcd *pxaLcdInit(struct ArmMem *physMem, class SoC *soc, struct PxaIc *ic,
@@ -584,6 +687,7 @@ void pxaLcdLoad(struct PxaLcd *lcd, T &loader) {
     lcd->DoSaveLoad(helper);
 
     pxaLcdUpdatePalette(lcd, PALETTE_SIZE);
+    lcd->framebufferFullRedraw = true;
 
     if (lcd->framebufferTrackingActive) {
         lcd->framebufferTrackingActive =
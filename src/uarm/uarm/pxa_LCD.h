@@ -19,9 +19,14 @@ void pxaLcdResetPaletteBuffer(struct PxaLcd *lcd);
 void pxaLcdTick(struct PxaLcd *lcd);
 
 uint32_t *pxaLcdGetPendingFrame(struct PxaLcd *lcd);
+// Lines that changed since the last frame; valid while a frame is pending
+void pxaLcdGetPendingFrameDamage(struct PxaLcd *lcd, uint32_t *firstLine,
+                                 uint32_t *lineCount);
 void pxaLcdResetPendingFrame(struct PxaLcd *lcd);
 
 void pxaLcdSetFramebufferDirty(struct PxaLcd *lcd);
+// Converts the whole framebuffer on the next frame instead of the damaged lines only
+void pxaLcdRedrawFramebuffer(struct PxaLcd *lcd);
 
 bool pxaLcdIsEnabled(struct PxaLcd *lcd);
 
@@ -16,11 +16,19 @@
 #define SCHEDULER_TASK_AUX_2 6
 #define SCHEDULER_TASK_AUX_3 7
 
+#define SCHEDULER_TASK_COUNT (SCHEDULER_TASK_AUX_3 + 1)
+
 constexpr uint64_t operator""_sec(unsigned long long seconds) { return seconds * 1000000000ull; }
 constexpr uint64_t operator""_msec(unsigned long long mseconds) { return mseconds * 1000000ull; }
 constexpr uint64_t operator""_usec(unsigned long long useconds) { return useconds * 1000ull; }
 constexpr uint64_t operator""_nsec(unsigned long long nseconds) { return nseconds; }
 
+// Host time spent dispatching each task, collected only if a profile is attached
+struct SchedulerProfile {
+    uint64_t dispatchNsec[SCHEDULER_TASK_COUNT];
+    uint64_t dispatches[SCHEDULER_TASK_COUNT];
+};
+
 template <typename T>
 class Scheduler {
    public:
@@ -37,6 +45,8 @@ class Scheduler {
 
     uint64_t GetTime() const;
 
+    void SetProfile(SchedulerProfile* profile);
+
     template <typename U>
     void Save(U& savestate);
 
@@ -74,6 +84,8 @@ class Scheduler {
 
     uint64_t accTime{0};
     uint64_t nextUpdate{1_sec};
+
+    SchedulerProfile* profile{nullptr};
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -191,7 +203,18 @@ void Scheduler<T>::Advance(uint64_t cycles, uint64_t cyclesPerSecond) {
 
         if (task.nextUpdate > accTime) break;
 
-        const uint32_t batchTicks = dispatchDelegate.DispatchTicks(taskType, task.batchedTicks);
+        uint32_t batchTicks;
+
+        if (profile) {
+            const uint64_t dispatchStart = timestampNsec();
+            batchTicks = dispatchDelegate.DispatchTicks(taskType, task.batchedTicks);
+
+            profile->dispatchNsec[taskType] += timestampNsec() - dispatchStart;
+            profile->dispatches[taskType]++;
+        } else {
+            batchTicks = dispatchDelegate.DispatchTicks(taskType, task.batchedTicks);
+        }
+
         task.lastUpdate += task.batchedTicks * task.period;
 
         RescheduleTaskImpl<false>(taskType, batchTicks);
@@ -205,6 +228,11 @@ uint64_t Scheduler<T>::GetTime() const {
     return accTime;
 }
 
+template <typename T>
+void Scheduler<T>::SetProfile(SchedulerProfile* profile) {
+    this->profile = profile;
+}
+
 template <typename T>
 void Scheduler<T>::UpdateNextUpdate() {
     if (queue[-1] <= SCHEDULER_TASK_MAX) {
@@ -4,41 +4,71 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "CowImage.h"
+
 namespace {
-    size_t sectorsTotal = 0;
-    bool sdCardDirty = false;
+    thread_local size_t sectorsTotal = 0;
+    thread_local bool sdCardDirty = false;
+
+    thread_local uint8_t* data = NULL;
+    thread_local bool dataMapped = false;
+    thread_local uint32_t* dirtyPages = NULL;
+
+    // Unlike dirtyPages, modifiedPages is never cleared and tracks the difference to base
+    thread_local CowImage* base = NULL;
+    thread_local uint32_t* modifiedPages = NULL;
+
+    thread_local size_t dirtyPagesSize = 0;
 
-    uint8_t* data = NULL;
-    uint32_t* dirtyPages = NULL;
+    thread_local char cardId[SD_CARD_ID_MAX_LEN + 1];
 
-    size_t dirtyPagesSize = 0;
+    void initialize(size_t sectors, void* buf, bool mapped, bool modified, const char* id) {
+        sdCardReset();
 
-    char cardId[SD_CARD_ID_MAX_LEN + 1];
+        size_t dirtyPagesSize4 = sectors / (16 * 32);
+        if ((dirtyPagesSize4 * 16 * 32) < sectors) dirtyPagesSize4++;
 
+        data = reinterpret_cast<uint8_t*>(buf);
+        dataMapped = mapped;
+        sectorsTotal = sectors;
+        dirtyPagesSize = dirtyPagesSize4 * 4;
+        sdCardDirty = false;
+
+        dirtyPages = reinterpret_cast<uint32_t*>(malloc(dirtyPagesSize));
+        memset(dirtyPages, 0, dirtyPagesSize);
+
+        modifiedPages = reinterpret_cast<uint32_t*>(malloc(dirtyPagesSize));
+        memset(modifiedPages, modified ? 0xff : 0, dirtyPagesSize);
+
+        sdCardRekey(id);
+    }
 }  // namespace
 
 void sdCardInitializeWithData(size_t sectors, void* buf, const char* id) {
-    sdCardReset();
+    initialize(sectors, buf, false, true, id);
+}
 
-    size_t dirtyPagesSize4 = sectors / (16 * 32);
-    if ((dirtyPagesSize4 * 16 * 32) < sectors) dirtyPagesSize4++;
+bool sdCardInitializeWithImage(const CowImage& image, const char* id) {
+    if (image.GetSize() == 0 || image.GetSize() % SD_SECTOR_SIZE) return false;
 
-    data = reinterpret_cast<uint8_t*>(buf);
-    sectorsTotal = sectors;
-    dirtyPagesSize = dirtyPagesSize4 * 4;
-    sdCardDirty = false;
+    void* buf = image.Instantiate();
+    if (!buf) return false;
+
+    // A base that cannot be shared is captured as a whole by snapshots
+    std::unique_ptr<CowImage> sharedBase = image.Share();
 
-    dirtyPages = reinterpret_cast<uint32_t*>(malloc(dirtyPagesSize));
-    memset(dirtyPages, 0, dirtyPagesSize);
+    initialize(image.GetSize() / SD_SECTOR_SIZE, buf, true, !sharedBase, id);
+    base = sharedBase.release();
 
-    sdCardRekey(id);
+    return true;
 }
 
 void sdCardInitialize(size_t sectors, const char* id) {
-    uint8_t* buf = reinterpret_cast<uint8_t*>(malloc(sectors * SD_SECTOR_SIZE));
-    memset(buf, 0, sectors * SD_SECTOR_SIZE);
+    // Untouched sectors share the zero page and cost no memory
+    void* buf = CowImage::Allocate(sectors * SD_SECTOR_SIZE);
+    if (!buf) return;
 
-    sdCardInitializeWithData(sectors, buf, id);
+    initialize(sectors, buf, true, false, id);
 }
 
 bool sdCardRead(uint32_t sector, void* buf) {
@@ -58,10 +88,20 @@ void sdCardRekey(const char* id) {
 
 void sdCardReset() {
     if (dirtyPages) free(dirtyPages);
-    if (data) free(data);
+    if (modifiedPages) free(modifiedPages);
+
+    delete base;
+
+    if (data && dataMapped)
+        CowImage::Free(data, sectorsTotal * SD_SECTOR_SIZE);
+    else if (data)
+        free(data);
 
     dirtyPages = NULL;
+    modifiedPages = NULL;
+    base = NULL;
     data = NULL;
+    dataMapped = false;
 
     sectorsTotal = 0;
     dirtyPagesSize = 0;
@@ -77,6 +117,7 @@ bool sdCardWrite(uint32_t sector, const void* buf) {
 
     const uint32_t page = sector >> 4;
     dirtyPages[page / 32] |= (1u << (page % 32));
+    modifiedPages[page / 32] |= (1u << (page % 32));
 
     sdCardDirty = true;
     return true;
@@ -92,6 +133,15 @@ struct Buffer sdCardDirtyPages() {
     return (struct Buffer){.size = dirtyPagesSize, .data = dirtyPages};
 }
 
+std::unique_ptr<CowImage> sdCardSnapshot() {
+    if (!sdCardInitialized()) return nullptr;
+
+    // Pages span 16 sectors, and the bitmap words are little endian
+    return std::make_unique<CowImage>(base, data, sectorsTotal * SD_SECTOR_SIZE,
+                                      16 * SD_SECTOR_SIZE,
+                                      reinterpret_cast<const uint8_t*>(modifiedPages));
+}
+
 bool sdCardIsDirty() { return sdCardDirty; }
 
 void sdCardSetDirty(bool isDirty) { sdCardDirty = isDirty; }
@@ -3,14 +3,19 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 #include "buffer.h"
 
+class CowImage;
+
 #define SD_SECTOR_SIZE 512
 #define SD_CARD_ID_MAX_LEN 32
 
 void sdCardInitialize(size_t sectors, const char* id);
 void sdCardInitializeWithData(size_t sectors, void* buf, const char* id);
+// Sectors are shared with the image until they are written
+bool sdCardInitializeWithImage(const CowImage& image, const char* id);
 
 void sdCardRekey(const char* id);
 
@@ -26,6 +31,9 @@ size_t sdCardSectorCount();
 struct Buffer sdCardData();
 struct Buffer sdCardDirtyPages();
 
+// A sparse copy of the card that only holds the sectors written since it was initialized
+std::unique_ptr<CowImage> sdCardSnapshot();
+
 bool sdCardIsDirty();
 void sdCardSetDirty(bool isDirty);
 
@@ -220,6 +220,13 @@ SocPXA::SocPXA(enum DeviceType5 deviceType, uint32_t ramSize, void *romData, con
 
 uint32_t *SocPXA::GetPendingFrame() { return pxaLcdGetPendingFrame(lcd); }
 
+SoC::FrameDamage SocPXA::GetPendingFrameDamage() {
+    uint32_t firstLine, lineCount;
+    pxaLcdGetPendingFrameDamage(lcd, &firstLine, &lineCount);
+
+    return {firstLine, lineCount};
+}
+
 void SocPXA::ResetPendingFrame() { return pxaLcdResetPendingFrame(lcd); }
 
 enum DeviceType5 SocPXA::GetDeviceType() { return deviceGetType(dev); }
@@ -268,6 +275,8 @@ uint32_t SocPXA::DispatchTicks(uint32_t clientType, uint32_t batchedTicks) {
 
 void SocPXA::OnSetFramebufferDirty() { pxaLcdSetFramebufferDirty(lcd); }
 
+void SocPXA::OnRedrawFramebuffer() { pxaLcdRedrawFramebuffer(lcd); }
+
 bool SocPXA::OnSleep() {
     if (cpuHasPendingInterrupt(cpu)) return false;
 
@@ -360,7 +369,7 @@ void SocPXA::OnLoad(SavestateLoader<ChunkType> &loader) {
 
     SchedulePcmTask();
     keypadReset(kp);
-    SetFramebufferDirty();
+    RedrawFramebuffer();
 }
 
 template <typename T>
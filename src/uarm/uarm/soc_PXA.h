@@ -44,6 +44,7 @@ class SocPXA : public SocGeneric<SocPXA> {
            uint8_t *nandContent, size_t nandSize, int gdbPort, uint_fast8_t socRev);
 
     uint32_t *GetPendingFrame() override;
+    FrameDamage GetPendingFrameDamage() override;
     void ResetPendingFrame() override;
     enum DeviceType5 GetDeviceType() override;
     void SuspendTimerInterrupts(bool suspendInterrupts) override;
@@ -53,6 +54,7 @@ class SocPXA : public SocGeneric<SocPXA> {
 
    protected:
     void OnSetFramebufferDirty() override;
+    void OnRedrawFramebuffer() override;
     bool OnSleep() override;
     void OnWakeup() override;
     void OnSetAudioQueue(struct AudioQueue *audioQueue) override;
@@ -20,6 +20,7 @@ class SocGeneric : public SoC {
     void DumpMMU() override;
     void JamKey(enum KeyId key, uint32_t durationMsec) override;
     uint64_t GetTime() override;
+    void SetProfile(struct SocProfile* profile) override;
 
     bool Save() override;
     bool Load(size_t savestateSize, void* savestateData) override;
@@ -51,6 +52,7 @@ class SocGeneric : public SoC {
 
    private:
     uint16_t paceBreakSyscall{0};
+    SocProfile* profile{nullptr};
 };
 
 #endif  // _SOC_GENERIC_H_
@@ -176,6 +176,7 @@ uint64_t SocGeneric<T>::RunUntil(uint64_t maxCycles, uint64_t cyclesPerSecond) {
         if (cyclesToAdvance + cycles > maxCycles) cyclesToAdvance = maxCycles - cycles;
 
         uint64_t cyclesAdvanced;
+        const uint64_t cpuStart = profile ? timestampNsec() : 0;
 
         if constexpr (injected) {
             cyclesAdvanced = cpuCycle<T::MEMORY_SYSTEM_KIND, injected>(cpu, cyclesToAdvance);
@@ -185,6 +186,8 @@ uint64_t SocGeneric<T>::RunUntil(uint64_t maxCycles, uint64_t cyclesPerSecond) {
                                  : cpuCycle<T::MEMORY_SYSTEM_KIND, injected>(cpu, cyclesToAdvance);
         }
 
+        if (profile) profile->cpuNsec += timestampNsec() - cpuStart;
+
         scheduler->Advance(cyclesAdvanced, cyclesPerSecond);
         cycles += cyclesAdvanced;
 
@@ -249,6 +252,12 @@ uint64_t SocGeneric<T>::GetTime() {
     return scheduler->GetTime();
 }
 
+template <class T>
+void SocGeneric<T>::SetProfile(struct SocProfile* profile) {
+    this->profile = profile;
+    scheduler->SetProfile(profile ? &profile->scheduler : nullptr);
+}
+
 template <class T>
 void SocGeneric<T>::JamKey(enum KeyId key, uint32_t durationMsec) {
     jammedKey = key;
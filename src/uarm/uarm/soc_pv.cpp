@@ -116,6 +116,8 @@ uint32_t *SocPV::GetPendingFrame() {
     return framebuffer.get();
 }
 
+SoC::FrameDamage SocPV::GetPendingFrameDamage() { return {0, displayHeight}; }
+
 void SocPV::ResetPendingFrame() {
     ClearFramebufferDirty();
     pvDisplayClearDirty(display);
@@ -156,6 +158,10 @@ void SocPV::OnSetFramebufferDirty() {
     // NOP - we track that directly here
 }
 
+void SocPV::OnRedrawFramebuffer() {
+    // NOP - dirty frames are always rendered in full
+}
+
 bool SocPV::OnSleep() {
     if (cpuHasPendingInterrupt(cpu)) return false;
 
@@ -26,12 +26,14 @@ class SocPV : public SocGeneric<SocPV> {
 
    public:
     static constexpr int MEMORY_SYSTEM_KIND = ARM_MEMORY_SYSTEM_MPU;
+    static constexpr uint32_t DISPLAY_DENSITY = 144;
 
    public:
     SocPV(uint32_t ramSize, void *romData, const uint32_t romSize, uint32_t displayWidth,
           uint32_t displayHeight, uint32_t displayDensity, int gdbPort);
 
     uint32_t *GetPendingFrame() override;
+    FrameDamage GetPendingFrameDamage() override;
     void ResetPendingFrame() override;
     enum DeviceType5 GetDeviceType() override;
     void SuspendTimerInterrupts(bool suspendInterrupts) override;
@@ -41,6 +43,7 @@ class SocPV : public SocGeneric<SocPV> {
 
    protected:
     void OnSetFramebufferDirty() override;
+    void OnRedrawFramebuffer() override;
     bool OnSleep() override;
     void OnWakeup() override;
     void OnSetAudioQueue(struct AudioQueue *audioQueue) override;
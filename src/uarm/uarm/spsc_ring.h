@@ -0,0 +1,144 @@
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Lock-free ring for exactly one producer thread and one consumer thread. Storage is rounded up
+// to a power of two, so indices wrap with a mask. Items that do not fit are dropped on push.
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+   public:
+    explicit SpscRing(size_t capacity);
+
+    // Producer
+    size_t PushBulk(const T* items, size_t count);
+
+    // Consumer
+    size_t PopBulk(T* destination, size_t count);
+
+    // Producer. Discards everything that has been pushed so far.
+    void Clear();
+
+    size_t GetSize() const;
+    size_t GetCapacity() const;
+
+   private:
+    size_t ReadIndex() const;
+
+   private:
+    const size_t capacity;
+    const size_t storageSize;
+    const size_t mask;
+    std::unique_ptr<T[]> items;
+
+    // Both indices increase monotonically and are reduced with mask on access
+    std::atomic<size_t> writeIndex{0};
+    std::atomic<size_t> readIndex{0};
+
+    // Written by the producer on Clear; the consumer skips everything before it
+    std::atomic<size_t> clearIndex{0};
+
+   private:
+    SpscRing(const SpscRing&) = delete;
+    SpscRing(SpscRing&&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    SpscRing& operator=(SpscRing&&) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+///////////////////////////////////////////////////////////////////////////////
+
+namespace spsc_ring {
+    constexpr size_t roundToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) result <<= 1;
+
+        return result;
+    }
+}  // namespace spsc_ring
+
+template <typename T>
+SpscRing<T>::SpscRing(size_t capacity)
+    : capacity(capacity),
+      storageSize(spsc_ring::roundToPowerOfTwo(capacity)),
+      mask(storageSize - 1),
+      items(std::make_unique<T[]>(storageSize)) {}
+
+template <typename T>
+size_t SpscRing<T>::PushBulk(const T* source, size_t count) {
+    const size_t write = writeIndex.load(std::memory_order_relaxed);
+    const size_t read = readIndex.load(std::memory_order_acquire);
+
+    count = std::min(count, capacity - (write - read));
+    if (count == 0) return 0;
+
+    const size_t offset = write & mask;
+    const size_t firstSpan = std::min(count, storageSize - offset);
+
+    memcpy(items.get() + offset, source, firstSpan * sizeof(T));
+    memcpy(items.get(), source + firstSpan, (count - firstSpan) * sizeof(T));
+
+    writeIndex.store(write + count, std::memory_order_release);
+
+    return count;
+}
+
+template <typename T>
+size_t SpscRing<T>::PopBulk(T* destination, size_t count) {
+    // Clear publishes an index that writeIndex has already reached, so loading the read side
+    // first guarantees read <= write
+    const size_t read = ReadIndex();
+    const size_t write = writeIndex.load(std::memory_order_acquire);
+
+    count = std::min(count, write - read);
+    if (count == 0) {
+        readIndex.store(read, std::memory_order_release);
+        return 0;
+    }
+
+    const size_t offset = read & mask;
+    const size_t firstSpan = std::min(count, storageSize - offset);
+
+    memcpy(destination, items.get() + offset, firstSpan * sizeof(T));
+    memcpy(destination + firstSpan, items.get(), (count - firstSpan) * sizeof(T));
+
+    readIndex.store(read + count, std::memory_order_release);
+
+    return count;
+}
+
+template <typename T>
+void SpscRing<T>::Clear() {
+    clearIndex.store(writeIndex.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+template <typename T>
+size_t SpscRing<T>::GetSize() const {
+    const size_t read = ReadIndex();
+
+    return writeIndex.load(std::memory_order_acquire) - read;
+}
+
+template <typename T>
+size_t SpscRing<T>::GetCapacity() const {
+    return capacity;
+}
+
+template <typename T>
+size_t SpscRing<T>::ReadIndex() const {
+    const size_t read = readIndex.load(std::memory_order_acquire);
+    const size_t clear = clearIndex.load(std::memory_order_acquire);
+
+    // Indices are monotonic, so the difference is meaningful even after wraparound
+    return static_cast<std::make_signed_t<size_t>>(clear - read) > 0 ? clear : read;
+}
+
+#endif  // _SPSC_RING_H_
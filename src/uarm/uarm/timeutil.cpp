@@ -7,8 +7,8 @@
 #define PALM_EPOCH_OFFSET 2082844800ull
 
 uint64_t palmEpochSeconds() {
-    static time_t lastUpdate = 0;
-    static long int tzoffset = 0;
+    static thread_local time_t lastUpdate = 0;
+    static thread_local long int tzoffset = 0;
 
     time_t now = time(NULL);
 
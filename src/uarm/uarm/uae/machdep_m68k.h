@@ -18,7 +18,7 @@ struct flag_struct {
   unsigned int x;
 };
 
-extern struct flag_struct regflags;
+extern __thread struct flag_struct regflags;
 
 #define ZFLG (regflags.z)
 #define NFLG (regflags.n)
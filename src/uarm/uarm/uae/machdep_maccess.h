@@ -21,3 +21,35 @@ extern uint32_t uae_get32(uint32_t addr);
 extern void uae_put8(uint32_t addr, uint8_t value);
 extern void uae_put16(uint32_t addr, uint16_t value);
 extern void uae_put32(uint32_t addr, uint32_t value);
+
+/* Words of the current instruction as prefetched by the PACE instruction cache */
+struct pace_prefetch {
+    uint32_t pc;
+    uint32_t size;
+    const uint16_t* words;
+};
+
+extern __thread struct pace_prefetch pace_prefetch;
+
+static inline uint16_t pace_get_iword(uint32_t addr) {
+    const uint32_t offset = addr - pace_prefetch.pc;
+
+    return (offset < pace_prefetch.size && !(offset & 1)) ? pace_prefetch.words[offset >> 1]
+                                                          : uae_get16(addr);
+}
+
+static inline uint32_t pace_get_ilong(uint32_t addr) {
+    const uint32_t offset = addr - pace_prefetch.pc;
+
+    return (offset < pace_prefetch.size && pace_prefetch.size - offset >= 4 && !(offset & 1))
+               ? ((uint32_t)pace_prefetch.words[offset >> 1] << 16) |
+                     pace_prefetch.words[(offset >> 1) + 1]
+               : uae_get32(addr);
+}
+
+static inline uint8_t pace_get_ibyte(uint32_t addr) {
+    const uint32_t offset = addr - pace_prefetch.pc;
+
+    return (offset < pace_prefetch.size && !(offset & 1)) ? pace_prefetch.words[offset >> 1]
+                                                          : uae_get8(addr + 1);
+}
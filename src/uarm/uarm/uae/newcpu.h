@@ -64,14 +64,14 @@ typedef struct regstruct {
   uae_u16 padding;
 } __attribute__((aligned(8))) regstruct;
 
-extern regstruct regs;
+extern __thread regstruct regs;
 
 #define m68k_dreg(r, num) ((r).regs[(num)])
 #define m68k_areg(r, num) (((r).regs + 8)[(num)])
 
-#define get_ibyte(o) get_byte(regs.pc + (o) + 1)
-#define get_iword(o) get_word(regs.pc + (o))
-#define get_ilong(o) get_long(regs.pc + (o))
+#define get_ibyte(o) pace_get_ibyte(regs.pc + (o))
+#define get_iword(o) pace_get_iword(regs.pc + (o))
+#define get_ilong(o) pace_get_ilong(regs.pc + (o))
 
 #define m68k_incpc(o) (regs.pc += (o))
 